@@ -0,0 +1,179 @@
+// Simulates crawling a synthetic frontier under three politeness strategies, in virtual time.
+//
+// Usage: bench_host_scheduler [num_urls] [num_hosts] [concurrency]
+//
+// URLs are spread over hosts with Zipf(1.0) popularity and arrive shuffled, the way crawl_queue
+// fills up. Each host has its own response latency; every host must be hit at most once per
+// CRAWL_DELAY (measured from dispatch).
+//   global_sleep   - the old loop: one fetch at a time, then sleep CRAWL_DELAY
+//   fifo           - concurrent fetches from one FIFO; a head URL whose host is cooling down
+//                    blocks everything behind it
+//   host_scheduler - concurrent fetches, URLs picked by HostScheduler
+// Reports throughput over the first ten simulated minutes (a full drain is bound by the most
+// popular host alone), politeness violations, and the scheduler's real CPU cost.
+
+#include "../src/host_scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = crawler::HostScheduler::Clock;
+using Millis = std::chrono::milliseconds;
+
+const Millis CRAWL_DELAY(1000);
+const Millis WINDOW(10 * 60 * 1000);
+
+struct Workload {
+    std::vector<std::string> urls;
+    std::unordered_map<std::string, Millis> latency;  // Per host
+};
+
+Workload build_workload(size_t num_urls, size_t num_hosts, std::mt19937& rng) {
+    Workload workload;
+    std::vector<double> cumulative(num_hosts);
+    double total = 0.0;
+    std::lognormal_distribution<double> latency_ms(5.0, 0.6);  // ~150ms median
+    for (size_t h = 0; h < num_hosts; ++h) {
+        total += 1.0 / (h + 1);
+        cumulative[h] = total;
+        workload.latency["host" + std::to_string(h) + ".example"] = Millis(static_cast<long>(latency_ms(rng)) + 5);
+    }
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    for (size_t i = 0; i < num_urls; ++i) {
+        size_t h = std::lower_bound(cumulative.begin(), cumulative.end(), uniform(rng)) - cumulative.begin();
+        h = std::min(h, num_hosts - 1);
+        workload.urls.push_back("http://host" + std::to_string(h) + ".example/page/" + std::to_string(i));
+    }
+    return workload;
+}
+
+struct SimResult {
+    double sim_seconds = 0;
+    size_t done_in_window = 0;
+    size_t violations = 0;
+    double scheduler_ms = 0;  // Real time spent choosing URLs
+};
+
+// Tracks dispatches per host and flags any that come sooner than CRAWL_DELAY.
+struct PolitenessCheck {
+    std::unordered_map<std::string, Clock::time_point> last;
+    size_t violations = 0;
+    void dispatch(const std::string& host, Clock::time_point now) {
+        auto it = last.find(host);
+        if (it != last.end() && now - it->second < CRAWL_DELAY) ++violations;
+        last[host] = now;
+    }
+};
+
+SimResult simulate_global_sleep(const Workload& workload) {
+    SimResult result;
+    Millis total(0);
+    for (const auto& url : workload.urls) {
+        total += workload.latency.at(crawler::extract_host(url)) + CRAWL_DELAY;
+        if (total <= WINDOW) ++result.done_in_window;
+    }
+    result.sim_seconds = std::chrono::duration<double>(total).count();
+    return result;
+}
+
+// Event loop shared by the concurrent strategies. pick(now) returns the next URL to fetch or ""
+// if none may start yet; next_ready() says when that could change.
+SimResult simulate_concurrent(const Workload& workload, size_t concurrency,
+                              const std::function<std::string(Clock::time_point)>& pick,
+                              const std::function<Clock::time_point()>& next_ready) {
+    SimResult result;
+    PolitenessCheck politeness;
+    std::priority_queue<Clock::time_point, std::vector<Clock::time_point>, std::greater<>> completions;
+    Clock::time_point start{}, now{};
+    size_t done = 0;
+
+    while (done < workload.urls.size()) {
+        auto pick_start = std::chrono::steady_clock::now();
+        while (completions.size() < concurrency) {
+            std::string url = pick(now);
+            if (url.empty()) break;
+            std::string host = crawler::extract_host(url);
+            politeness.dispatch(host, now);
+            completions.push(now + workload.latency.at(host));
+        }
+        result.scheduler_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pick_start).count();
+
+        // Advance to the next completion or the next moment a host becomes ready
+        Clock::time_point next = Clock::time_point::max();
+        if (!completions.empty()) next = completions.top();
+        if (completions.size() < concurrency) next = std::min(next, next_ready());
+        now = std::max(now, next);
+        while (!completions.empty() && completions.top() <= now) {
+            if (completions.top() - start <= WINDOW) ++result.done_in_window;
+            completions.pop();
+            ++done;
+        }
+    }
+    result.sim_seconds = std::chrono::duration<double>(now - start).count();
+    result.violations = politeness.violations;
+    return result;
+}
+
+SimResult simulate_fifo(const Workload& workload, size_t concurrency) {
+    std::deque<std::string> queue(workload.urls.begin(), workload.urls.end());
+    std::unordered_map<std::string, Clock::time_point> next_allowed;
+    auto head_ready = [&]() -> Clock::time_point {
+        if (queue.empty()) return Clock::time_point::max();
+        auto it = next_allowed.find(crawler::extract_host(queue.front()));
+        return it == next_allowed.end() ? Clock::time_point{} : it->second;
+    };
+    return simulate_concurrent(workload, concurrency,
+        [&](Clock::time_point now) -> std::string {
+            if (queue.empty() || head_ready() > now) return "";
+            std::string url = std::move(queue.front());
+            queue.pop_front();
+            next_allowed[crawler::extract_host(url)] = now + CRAWL_DELAY;
+            return url;
+        },
+        head_ready);
+}
+
+SimResult simulate_host_scheduler(const Workload& workload, size_t concurrency) {
+    crawler::HostScheduler scheduler(CRAWL_DELAY);
+    for (const auto& url : workload.urls) scheduler.push(url);
+    return simulate_concurrent(workload, concurrency,
+        [&](Clock::time_point now) { return scheduler.pop_ready(now).value_or(""); },
+        [&] { return scheduler.next_ready_time().value_or(Clock::time_point::max()); });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t num_urls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t num_hosts = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    size_t concurrency = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+
+    std::mt19937 rng(7);
+    Workload workload = build_workload(num_urls, num_hosts, rng);
+    std::cout << num_urls << " URLs over " << num_hosts << " hosts, concurrency " << concurrency
+              << ", delay " << CRAWL_DELAY.count() << "ms per host" << std::endl;
+
+    std::cout << std::left << std::setw(16) << "strategy" << std::right << std::setw(14) << "drain_s"
+              << std::setw(14) << "pages/s@10m" << std::setw(12) << "violations" << std::setw(14) << "sched_ns/url" << std::endl;
+    auto report = [&](const std::string& name, const SimResult& r) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << r.sim_seconds << std::setw(14) << r.done_in_window / (WINDOW.count() / 1000.0)
+                  << std::setw(12) << r.violations << std::setw(14) << r.scheduler_ms * 1e6 / num_urls << std::endl;
+    };
+    report("global_sleep", simulate_global_sleep(workload));
+    report("fifo", simulate_fifo(workload, concurrency));
+    report("host_scheduler", simulate_host_scheduler(workload, concurrency));
+    return 0;
+}
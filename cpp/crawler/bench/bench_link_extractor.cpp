@@ -0,0 +1,79 @@
+// Measures outlink extraction throughput (scan + resolve + normalize + dedupe).
+//
+// Usage: bench_link_extractor [num_pages] [links_per_page]
+//
+// Pages are synthetic but shaped like encyclopedia articles: paragraphs of text interleaved with
+// links in the forms found in the wild (root-relative, relative with dot-segments, absolute,
+// protocol-relative, fragments, entities), plus script and style blocks the scanner must skip.
+
+#include "../src/link_extractor.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string build_page(size_t links, std::mt19937& rng) {
+    std::uniform_int_distribution<int> article(1, 500000);
+    std::uniform_int_distribution<int> form(0, 9);
+    std::string html = "<!DOCTYPE html><html><head><title>Article</title>"
+                       "<style>.mw-body{margin:0} a:hover{color:red}</style>"
+                       "<script>var config = {\"wgPage\": \"<a href='/skip'>\"};</script></head><body>";
+    for (size_t i = 0; i < links; ++i) {
+        std::string id = std::to_string(article(rng));
+        html += "<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor ";
+        switch (form(rng)) {
+            case 0: case 1: case 2: case 3:
+                html += "<a href=\"/wiki/Article_" + id + "\" title=\"Article " + id + "\">link</a>"; break;
+            case 4:
+                html += "<a href=\"/wiki/Article_" + id + "#History\">section</a>"; break;
+            case 5:
+                html += "<a href=\"../w/index.php?title=Article_" + id + "&amp;action=edit\">edit</a>"; break;
+            case 6:
+                html += "<a class=\"external\" href=\"https://Example" + id.substr(0, 2) + ".ORG:443/ref/" + id + "\">ref</a>"; break;
+            case 7:
+                html += "<a href=\"//upload.example.org/media/" + id + ".jpg\">img</a>"; break;
+            case 8:
+                html += "<a href='./Article_" + id + "'>rel</a>"; break;
+            default:
+                html += "<a href=\"#cite_note-" + id + "\">[" + id + "]</a>"; break;
+        }
+        html += " incididunt ut labore et dolore magna aliqua.</p>\n";
+    }
+    html += "</body></html>";
+    return html;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t num_pages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+    size_t links_per_page = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 800;
+
+    std::mt19937 rng(7);
+    std::vector<std::string> pages;
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < num_pages; ++i) {
+        pages.push_back(build_page(links_per_page, rng));
+        total_bytes += pages.back().size();
+    }
+
+    size_t total_links = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& page : pages) {
+        total_links += crawler::extract_links(page, "https://en.example.org/wiki/Some_Page").size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << num_pages << " pages, " << total_bytes / (1024 * 1024) << " MB, " << total_links << " unique links\n"
+              << "pages/s:  " << num_pages / seconds << "\n"
+              << "links/s:  " << total_links / seconds << "\n"
+              << "MB/s:     " << total_bytes / (1024.0 * 1024.0) / seconds << std::endl;
+    return 0;
+}
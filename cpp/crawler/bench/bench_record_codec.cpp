@@ -0,0 +1,207 @@
+// Compares WARC record codecs: compression ratio, compress MB/s and decompress MB/s.
+//
+// Usage: bench_record_codec [warc.gz] [num_records] [zstd_level]
+//
+// Pass a real crawl segment (e.g. /shared_data/crawled_00001.warc.gz); its pages are inflated and
+// re-written under each codec. Without one, num_records synthetic pages are used. The first
+// quarter of the pages trains the dictionary and the rest are measured, as when a segment's
+// dictionary was trained on the one before it. Every record stays its own gzip member or zstd
+// frame, so all rows keep per-record random access:
+//   gzip       - zlib at Z_DEFAULT_COMPRESSION, the crawler's default
+//   zstd       - zstd frames without a dictionary
+//   zstd+dict  - zstd frames referencing a dictionary trained on the sample
+
+#include "../src/warc_writer.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <zstd.h>
+
+namespace {
+
+const char* BENCH_FILE = "bench_record_codec.warc";
+
+// Inflates every gzip member of a WARC file and returns the record payloads.
+std::vector<std::string> read_pages(const std::string& path, size_t limit) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open " + path);
+    std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::vector<std::string> pages;
+    z_stream zs{};
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) throw std::runtime_error("inflateInit2 failed");
+    zs.next_in = reinterpret_cast<Bytef*>(&file[0]);
+    zs.avail_in = static_cast<uInt>(file.size());
+    std::string record;
+    char buffer[1 << 16];
+    while (zs.avail_in > 0 && pages.size() < limit) {
+        zs.next_out = reinterpret_cast<Bytef*>(buffer);
+        zs.avail_out = sizeof(buffer);
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) break;  // Truncated tail
+        record.append(buffer, sizeof(buffer) - zs.avail_out);
+        if (ret == Z_STREAM_END) {
+            size_t header_end = record.find("\r\n\r\n");
+            if (header_end != std::string::npos && record.size() >= header_end + 8) {
+                pages.push_back(record.substr(header_end + 4, record.size() - header_end - 8));
+            }
+            record.clear();
+            inflateReset(&zs);
+        }
+    }
+    inflateEnd(&zs);
+    return pages;
+}
+
+// Pages with shared site chrome around skewed vocabulary text, roughly like one wiki's articles.
+std::vector<std::string> synthetic_pages(size_t count) {
+    std::mt19937 rng(11);
+    std::lognormal_distribution<double> page_size(10.0, 0.7);
+    std::uniform_int_distribution<int> word_len(2, 10);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> vocabulary(5000);
+    for (auto& word : vocabulary) {
+        for (int n = word_len(rng); n > 0; --n) word += static_cast<char>(letter(rng));
+    }
+    std::geometric_distribution<size_t> word_rank(0.01);
+
+    const std::string head = "<!DOCTYPE html><html lang=\"en\"><head><meta charset=\"UTF-8\">"
+                             "<link rel=\"stylesheet\" href=\"/w/load.php?modules=site.styles\">"
+                             "<script src=\"/w/load.php?modules=startup\"></script>";
+    const std::string nav = "<div id=\"mw-navigation\"><ul><li><a href=\"/wiki/Main_Page\">Main page</a></li>"
+                            "<li><a href=\"/wiki/Portal:Contents\">Contents</a></li>"
+                            "<li><a href=\"/wiki/Special:Random\">Random article</a></li></ul></div>";
+    std::vector<std::string> pages;
+    for (size_t i = 0; i < count; ++i) {
+        size_t target = static_cast<size_t>(page_size(rng));
+        std::string html = head + "<title>Article " + std::to_string(i) + "</title></head><body>" + nav;
+        while (html.size() < target) {
+            html += "<p>";
+            for (int w = 0; w < 40; ++w) {
+                html += vocabulary[word_rank(rng) % vocabulary.size()];
+                html += ' ';
+            }
+            html += "</p>\n";
+        }
+        pages.push_back(html + "<footer>Text is available under CC BY-SA.</footer></body></html>");
+    }
+    return pages;
+}
+
+struct Result {
+    size_t compressed_bytes = 0;
+    double compress_seconds = 0;
+    double decompress_seconds = 0;
+};
+
+Result run(const std::vector<std::string>& pages, const crawler::WarcWriterOptions& options) {
+    std::filesystem::remove(BENCH_FILE);
+    Result result;
+    std::vector<crawler::WarcRecordInfo> infos;
+    infos.reserve(pages.size());
+    {
+        crawler::WarcWriter writer(BENCH_FILE, options);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < pages.size(); ++i) {
+            infos.push_back(writer.write_record("http://example.com/" + std::to_string(i), pages[i]));
+        }
+        result.compress_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::ifstream in(BENCH_FILE, std::ios::binary);
+    std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::filesystem::remove(BENCH_FILE);
+    for (const auto& info : infos) result.compressed_bytes += info.length;
+
+    // Decompress each record on its own from its offset, as the indexer does
+    std::string out(64 * 1024 * 1024, '\0');
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    if (options.codec == crawler::RecordCodec::Gzip) {
+        z_stream zs{};
+        inflateInit2(&zs, 15 + 16);
+        for (const auto& info : infos) {
+            inflateReset(&zs);
+            zs.next_in = reinterpret_cast<Bytef*>(&file[info.offset]);
+            zs.avail_in = static_cast<uInt>(info.length);
+            zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+            zs.avail_out = static_cast<uInt>(out.size());
+            if (inflate(&zs, Z_FINISH) != Z_STREAM_END) throw std::runtime_error("inflate failed");
+            sink += zs.total_out;
+        }
+        inflateEnd(&zs);
+    } else {
+        ZSTD_DCtx* dctx = ZSTD_createDCtx();
+        ZSTD_DDict* ddict = options.zstd_dictionary.empty()
+            ? nullptr
+            : ZSTD_createDDict(options.zstd_dictionary.data(), options.zstd_dictionary.size());
+        for (const auto& info : infos) {
+            size_t got = ZSTD_decompress_usingDDict(dctx, &out[0], out.size(), &file[info.offset], info.length, ddict);
+            if (ZSTD_isError(got)) throw std::runtime_error(ZSTD_getErrorName(got));
+            sink += got;
+        }
+        ZSTD_freeDDict(ddict);
+        ZSTD_freeDCtx(dctx);
+    }
+    result.decompress_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 0) std::cout << "(nothing decompressed)" << std::endl;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "";
+    size_t num_records = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4000;
+    int zstd_level = argc > 3 ? std::atoi(argv[3]) : 3;
+
+    std::vector<std::string> pages = path.empty() ? synthetic_pages(num_records) : read_pages(path, num_records);
+    if (pages.size() < 16) {
+        std::cerr << "Need at least 16 pages, got " << pages.size() << std::endl;
+        return 1;
+    }
+    std::vector<std::string> training(pages.begin(), pages.begin() + pages.size() / 4);
+    std::vector<std::string> measured(pages.begin() + pages.size() / 4, pages.end());
+    size_t raw_bytes = 0;
+    for (const auto& page : measured) raw_bytes += page.size();
+
+    auto train_start = std::chrono::steady_clock::now();
+    std::string dictionary = crawler::train_zstd_dictionary(training);
+    double train_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - train_start).count();
+
+    std::cout << (path.empty() ? "synthetic" : path) << ": " << measured.size() << " records measured, "
+              << raw_bytes / 1024 << " KB of pages; dictionary " << dictionary.size() / 1024 << " KB trained on "
+              << training.size() << " pages in " << std::fixed << std::setprecision(2) << train_seconds << " s"
+              << std::endl;
+
+    crawler::WarcWriterOptions gzip;
+    crawler::WarcWriterOptions zstd;
+    zstd.codec = crawler::RecordCodec::Zstd;
+    zstd.zstd_level = zstd_level;
+    crawler::WarcWriterOptions zstd_dict = zstd;
+    zstd_dict.zstd_dictionary = dictionary;
+
+    double mb = raw_bytes / (1024.0 * 1024.0);
+    std::cout << std::left << std::setw(12) << "codec" << std::right << std::setw(10) << "ratio" << std::setw(14)
+              << "B/record" << std::setw(14) << "compress" << std::setw(14) << "decompress" << std::endl;
+    auto report = [&](const std::string& name, const crawler::WarcWriterOptions& options) {
+        Result r = run(measured, options);
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << static_cast<double>(raw_bytes) / r.compressed_bytes << std::setw(14)
+                  << r.compressed_bytes / measured.size() << std::setw(9) << mb / r.compress_seconds << " MB/s"
+                  << std::setw(9) << mb / r.decompress_seconds << " MB/s" << std::endl;
+    };
+    report("gzip", gzip);
+    report("zstd", zstd);
+    if (!dictionary.empty()) report("zstd+dict", zstd_dict);
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Measures robots.txt match throughput on large rule sets: the compiled trie matcher against a
+// linear scan that tries every rule on every path (what a straightforward parser would do).
+//
+// Usage: bench_robots [num_rules] [num_paths]
+//
+// Rule sets are shaped like those of large sites: mostly literal directory prefixes, a share of
+// '*' patterns for query parameters and file types, and a few '$' anchors.
+
+#include "../src/robots.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct Rule {
+    std::string pattern;
+    bool allow;
+};
+
+std::vector<Rule> build_rules(size_t count, std::mt19937& rng) {
+    std::uniform_int_distribution<int> form(0, 9);
+    std::uniform_int_distribution<int> id(1, 100000);
+    std::vector<Rule> rules;
+    for (size_t i = 0; i < count; ++i) {
+        std::string n = std::to_string(id(rng));
+        switch (form(rng)) {
+            case 0: case 1: case 2: case 3: case 4:
+                rules.push_back({"/section" + n.substr(0, 2) + "/dir" + n + "/", false}); break;
+            case 5:
+                rules.push_back({"/section" + n.substr(0, 2) + "/dir" + n + "/public", true}); break;
+            case 6:
+                rules.push_back({"/*?param" + n + "=", false}); break;
+            case 7:
+                rules.push_back({"/section" + n.substr(0, 2) + "/*.ext" + n.substr(0, 3) + "$", false}); break;
+            case 8:
+                rules.push_back({"/page" + n + "$", false}); break;
+            default:
+                rules.push_back({"/section" + n.substr(0, 2) + "/*/print" + n.substr(0, 3), false}); break;
+        }
+    }
+    return rules;
+}
+
+std::vector<std::string> build_paths(size_t count, std::mt19937& rng) {
+    std::uniform_int_distribution<int> id(1, 100000);
+    std::uniform_int_distribution<int> form(0, 3);
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < count; ++i) {
+        std::string n = std::to_string(id(rng));
+        std::string path = "/section" + n.substr(0, 2) + "/dir" + n + "/article_" + std::to_string(id(rng));
+        switch (form(rng)) {
+            case 0: path += "?param" + std::to_string(id(rng)) + "=1"; break;
+            case 1: path += ".ext" + n.substr(0, 3); break;
+            case 2: path += "/print" + n.substr(0, 3); break;
+            default: break;
+        }
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+// Reference matcher: recursive glob per rule, longest match wins, Allow wins ties.
+bool glob(std::string_view pattern, std::string_view path) {
+    if (pattern.empty()) return true;
+    if (pattern == "$") return path.empty();
+    if (pattern[0] == '*') {
+        for (size_t skip = 0; skip <= path.size(); ++skip) {
+            if (glob(pattern.substr(1), path.substr(skip))) return true;
+        }
+        return false;
+    }
+    return !path.empty() && pattern[0] == path[0] && glob(pattern.substr(1), path.substr(1));
+}
+
+bool linear_allowed(const std::vector<Rule>& rules, std::string_view path) {
+    size_t best = 0;
+    bool allowed = true;
+    for (const Rule& rule : rules) {
+        if (!glob(rule.pattern, path)) continue;
+        if (rule.pattern.size() > best || (rule.pattern.size() == best && rule.allow)) {
+            best = rule.pattern.size();
+            allowed = rule.allow;
+        }
+    }
+    return allowed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t num_rules = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    size_t num_paths = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+
+    std::mt19937 rng(11);
+    std::vector<Rule> rules = build_rules(num_rules, rng);
+    std::vector<std::string> paths = build_paths(num_paths, rng);
+
+    std::string text = "User-agent: *\n";
+    for (const Rule& rule : rules) text += (rule.allow ? "Allow: " : "Disallow: ") + rule.pattern + "\n";
+
+    auto start = std::chrono::steady_clock::now();
+    crawler::RobotsRules compiled = crawler::RobotsRules::parse(text, "MaxSearchEngineBot/1.0");
+    double parse_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t compiled_allowed = 0, linear_allowed_count = 0, mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    const int repetitions = 10;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        for (const auto& path : paths) compiled_allowed += compiled.allowed(path);
+    }
+    double compiled_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (const auto& path : paths) linear_allowed_count += linear_allowed(rules, path);
+    double linear_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const auto& path : paths) mismatches += compiled.allowed(path) != linear_allowed(rules, path);
+
+    double compiled_rate = num_paths * repetitions / compiled_s;
+    double linear_rate = num_paths / linear_s;
+    std::cout << num_rules << " rules (" << text.size() / 1024 << " KiB), parsed and compiled in "
+              << std::fixed << std::setprecision(2) << parse_ms << " ms" << std::endl;
+    std::cout << std::setprecision(0)
+              << "compiled: " << std::setw(12) << compiled_rate << " matches/s  ("
+              << compiled_allowed / repetitions << " allowed)" << std::endl
+              << "linear:   " << std::setw(12) << linear_rate << " matches/s  ("
+              << linear_allowed_count << " allowed)" << std::endl
+              << std::setprecision(1) << "speedup:  " << compiled_rate / linear_rate << "x, "
+              << mismatches << " disagreements" << std::endl;
+    return 0;
+}
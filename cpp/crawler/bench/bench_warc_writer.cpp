@@ -0,0 +1,93 @@
+// Measures WarcWriter throughput (records/s) against the number of writing threads.
+//
+// Usage: bench_warc_writer [records_per_thread] [max_threads] [sync_every_records]
+//
+// "serialized" wraps every write_record() in one global mutex, reproducing the old writer that
+// compressed under its lock; "parallel" calls the writer directly, so deflate runs on every
+// thread and only the offset reservation and pwritev() are serialized.
+
+#include "../src/warc_writer.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// ~60 KB pages of loosely repetitive markup, so deflate does realistic work.
+std::vector<std::string> build_pages(size_t count) {
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> word(0, 999);
+    std::vector<std::string> pages;
+    for (size_t i = 0; i < count; ++i) {
+        std::string page = "<html><head><title>Page " + std::to_string(i) + "</title></head><body>";
+        while (page.size() < 60000) {
+            page += "<p class=\"para\">";
+            for (int w = 0; w < 40; ++w) page += "word" + std::to_string(word(rng)) + " ";
+            page += "<a href=\"/wiki/Article_" + std::to_string(word(rng)) + "\">link</a></p>\n";
+        }
+        pages.push_back(page + "</body></html>");
+    }
+    return pages;
+}
+
+double run(const std::vector<std::string>& pages, size_t threads, size_t per_thread, bool serialized,
+           const crawler::WarcWriterOptions& options) {
+    const std::string filename = "bench_warc_writer.warc.gz";
+    std::filesystem::remove(filename);
+    double seconds;
+    {
+        crawler::WarcWriter writer(filename, options);
+        std::mutex global;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (size_t i = 0; i < per_thread; ++i) {
+                    const std::string& page = pages[(t * per_thread + i) % pages.size()];
+                    std::string url = "http://example.com/" + std::to_string(t) + "/" + std::to_string(i);
+                    if (serialized) {
+                        std::lock_guard<std::mutex> lock(global);
+                        writer.write_record(url, page);
+                    } else {
+                        writer.write_record(url, page);
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::filesystem::remove(filename);
+    return threads * per_thread / seconds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t per_thread = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    size_t max_threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+    crawler::WarcWriterOptions options;
+    options.sync_every_records = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+
+    std::vector<std::string> pages = build_pages(64);
+    std::cout << "cores: " << std::thread::hardware_concurrency()
+              << ", sync every " << options.sync_every_records << " records (0 = never)" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "serialized/s" << std::setw(16) << "parallel/s"
+              << std::setw(10) << "speedup" << std::endl;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double serialized = run(pages, threads, per_thread, true, options);
+        double parallel = run(pages, threads, per_thread, false, options);
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(0)
+                  << std::setw(16) << serialized << std::setw(16) << parallel
+                  << std::setw(9) << std::setprecision(2) << parallel / serialized << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "archive_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace crawler {
+
+ArchivePool::ArchivePool(const Options& options, WriteFn write) : options_(options), write_(std::move(write)) {
+    for (size_t i = 0; i < std::max<size_t>(1, options_.threads); ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ArchivePool::~ArchivePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+void ArchivePool::submit(int doc_id, std::string url, std::string content) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_space_.wait(lock, [this] { return queue_.size() < std::max<size_t>(1, options_.max_queued); });
+    queue_.push_back({doc_id, std::move(url), std::move(content)});
+    ++outstanding_;
+    work_ready_.notify_one();
+}
+
+std::vector<ArchivedPage> ArchivePool::poll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ArchivedPage> done;
+    done.swap(done_);
+    outstanding_ -= done.size();
+    return done;
+}
+
+size_t ArchivePool::outstanding() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outstanding_;
+}
+
+void ArchivePool::worker_loop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;  // Stopping, and every submitted page is written
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        queue_space_.notify_one();
+
+        ArchivedPage page{job.doc_id, std::move(job.url), {}, {}};
+        try {
+            page.info = write_(page.url, job.content);  // Compression and I/O, outside the lock
+        } catch (const std::exception& e) {
+            page.error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_.push_back(std::move(page));
+    }
+}
+
+} // namespace crawler
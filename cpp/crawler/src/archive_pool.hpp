@@ -0,0 +1,91 @@
+#ifndef ARCHIVE_POOL_HPP
+#define ARCHIVE_POOL_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "warc_writer.hpp"
+
+namespace crawler {
+
+// A page the pool has finished with, written or not.
+struct ArchivedPage {
+    int doc_id;
+    std::string url;
+    WarcRecordInfo info;  // Set when error is empty
+    std::string error;    // Why the write failed
+};
+
+/**
+ * @brief Writes fetched pages to the WARC archive on a small pool of threads.
+ *
+ * Compressing a page costs more than fetching it, so the crawl loop hands pages over with
+ * submit() and picks up the finished records with poll(), like DnsResolver lookups. The writer
+ * compresses outside its lock, so the pool's threads compress in parallel and share its batched
+ * writes.
+ *
+ * @note Thread-safe.
+ */
+class ArchivePool {
+public:
+    // Writes one record; throws on failure. SegmentedWarcWriter::write_record() in the crawler.
+    using WriteFn = std::function<WarcRecordInfo(const std::string& url, const std::string& content)>;
+
+    struct Options {
+        size_t threads = 4;
+        size_t max_queued = 256;  // submit() blocks while this many pages wait for a thread
+    };
+
+    ArchivePool(const Options& options, WriteFn write);
+
+    // Finishes every page already submitted, then stops the threads.
+    ~ArchivePool();
+
+    ArchivePool(const ArchivePool&) = delete;
+    ArchivePool& operator=(const ArchivePool&) = delete;
+
+    /**
+     * @brief Queues a page for writing.
+     *
+     * Returns at once unless max_queued pages are already waiting, in which case it waits for a
+     * thread to take one: the crawl slows down rather than buffering pages without bound.
+     */
+    void submit(int doc_id, std::string url, std::string content);
+
+    // Pages written (or failed) since the last call, in completion order.
+    std::vector<ArchivedPage> poll();
+
+    // Pages submitted and not yet returned by poll().
+    size_t outstanding() const;
+
+private:
+    struct Job {
+        int doc_id;
+        std::string url;
+        std::string content;
+    };
+
+    void worker_loop();
+
+    const Options options_;
+    const WriteFn write_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable queue_space_;
+    std::deque<Job> queue_;
+    std::vector<ArchivedPage> done_;
+    size_t outstanding_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace crawler
+
+#endif // ARCHIVE_POOL_HPP
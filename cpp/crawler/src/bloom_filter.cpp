@@ -0,0 +1,182 @@
+#include "bloom_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace crawler {
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'I', 'G', 'I', 'B', 'L', 'O', 'O', 'M'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t k;
+    uint64_t num_blocks;
+    uint64_t inserted;
+    uint32_t crc;  // Over the block data
+    uint32_t reserved;
+};
+
+// FNV-1a, then a splitmix64 finalizer to spread the bits. Stable across builds and platforms.
+uint64_t hash_key(std::string_view key) {
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+// Expected false-positive rate of a 512-bit-blocked filter: the number of keys landing in a block
+// is Poisson distributed, and overloaded blocks dominate the error.
+double blocked_false_positive_rate(double bits_per_key, uint32_t k) {
+    double lambda = 512.0 / bits_per_key;  // Mean keys per block
+    double rate = 0.0;
+    double p = std::exp(-lambda);          // Poisson(0)
+    for (int j = 0; j < static_cast<int>(lambda * 4) + 64; ++j) {
+        double bit_set = 1.0 - std::pow(1.0 - 1.0 / 512.0, static_cast<double>(k) * j);
+        rate += p * std::pow(bit_set, k);
+        p *= lambda / (j + 1);
+    }
+    return rate;
+}
+
+uint32_t crc_of(const void* data, size_t size) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    const Bytef* bytes = static_cast<const Bytef*>(data);
+    while (size > 0) {
+        uInt chunk = static_cast<uInt>(std::min<size_t>(size, 1u << 30));
+        crc = crc32(crc, bytes, chunk);
+        bytes += chunk;
+        size -= chunk;
+    }
+    return static_cast<uint32_t>(crc);
+}
+
+} // namespace
+
+BloomFilter::BloomFilter(uint64_t capacity, double false_positive_rate) {
+    if (capacity == 0 || !(false_positive_rate > 0.0 && false_positive_rate < 1.0)) {
+        throw std::invalid_argument("Bloom filter needs a capacity > 0 and a false-positive rate in (0, 1)");
+    }
+    // Start from the classic sizing and grow until the blocked layout meets the target, since
+    // uneven load across blocks costs more bits the lower the rate
+    const double ln2 = std::log(2.0);
+    double bits_per_key = -std::log(false_positive_rate) / (ln2 * ln2);
+    k_ = static_cast<uint32_t>(std::clamp(std::lround(bits_per_key * ln2), 1l, 16l));
+    while (blocked_false_positive_rate(bits_per_key, k_) > false_positive_rate && bits_per_key < 64) {
+        bits_per_key *= 1.02;
+    }
+    uint64_t bits = static_cast<uint64_t>(std::ceil(bits_per_key * static_cast<double>(capacity)));
+    blocks_.resize(std::max<uint64_t>(1, (bits + 511) / 512), Block{});
+}
+
+BloomFilter::BloomFilter(uint32_t k, uint64_t num_blocks) : k_(k), blocks_(num_blocks, Block{}) {}
+
+size_t BloomFilter::block_index(uint64_t hash) const {
+    // Upper 32 bits pick the block (multiply-shift instead of a modulo); the lower 32 pick bits
+    return static_cast<size_t>(((hash >> 32) * blocks_.size()) >> 32);
+}
+
+namespace {
+
+// Calls fn with each of the k bit positions (0-511) of a key within its block, taken 9 bits at a
+// time from the lower half of the hash and then from further remixes of it.
+template <typename Fn>
+void for_each_probe(uint64_t hash, uint32_t k, Fn&& fn) {
+    uint64_t bits = hash & 0xffffffffull;
+    uint32_t available = 32;
+    for (uint32_t i = 0; i < k; ++i) {
+        if (available < 9) {
+            hash = hash * 0x9e3779b97f4a7c15ull + 0x632be59bd9b4e019ull;
+            bits = hash ^ (hash >> 29);
+            available = 64;
+        }
+        fn(static_cast<uint32_t>(bits & 511));
+        bits >>= 9;
+        available -= 9;
+    }
+}
+
+} // namespace
+
+void BloomFilter::insert(std::string_view key) {
+    uint64_t hash = hash_key(key);
+    Block& block = blocks_[block_index(hash)];
+    for_each_probe(hash, k_, [&](uint32_t bit) { block.words[bit >> 6] |= 1ull << (bit & 63); });
+    ++inserted_;
+}
+
+bool BloomFilter::possibly_contains(std::string_view key) const {
+    uint64_t hash = hash_key(key);
+    const Block& block = blocks_[block_index(hash)];
+    bool found = true;
+    for_each_probe(hash, k_, [&](uint32_t bit) { found &= (block.words[bit >> 6] >> (bit & 63)) & 1; });
+    return found;
+}
+
+void BloomFilter::save(const std::string& path) const {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.k = k_;
+    header.num_blocks = blocks_.size();
+    header.inserted = inserted_;
+    header.crc = crc_of(blocks_.data(), memory_bytes());
+
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(blocks_.data()), static_cast<std::streamsize>(memory_bytes()));
+        out.flush();
+        if (!out) {
+            std::remove(tmp_path.c_str());
+            throw std::runtime_error("Failed to write Bloom filter snapshot: " + tmp_path);
+        }
+    }
+    // Readers see either the old snapshot or the complete new one
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("Failed to replace Bloom filter snapshot: " + path);
+    }
+}
+
+std::unique_ptr<BloomFilter> BloomFilter::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return nullptr;
+
+    SnapshotHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return nullptr;
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION ||
+        header.k < 1 || header.k > 16 || header.num_blocks == 0) {
+        return nullptr;
+    }
+
+    // Check the size before allocating, so a corrupt header cannot ask for terabytes
+    in.seekg(0, std::ios::end);
+    uint64_t data_bytes = static_cast<uint64_t>(in.tellg()) - sizeof(header);
+    if (data_bytes != header.num_blocks * sizeof(Block)) return nullptr;
+    in.seekg(sizeof(header));
+
+    std::unique_ptr<BloomFilter> filter(new BloomFilter(header.k, header.num_blocks));
+    if (!in.read(reinterpret_cast<char*>(filter->blocks_.data()), static_cast<std::streamsize>(data_bytes))) return nullptr;
+    if (crc_of(filter->blocks_.data(), data_bytes) != header.crc) return nullptr;
+    filter->inserted_ = header.inserted;
+    return filter;
+}
+
+} // namespace crawler
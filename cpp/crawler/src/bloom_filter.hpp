@@ -0,0 +1,68 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace crawler {
+
+/**
+ * @brief Cache-line-blocked Bloom filter for the crawler's visited-URL check.
+ *
+ * Each key maps to one 64-byte block and sets all of its k bits inside it, so a lookup touches a
+ * single cache line. Sized from the expected number of keys and the target false-positive rate;
+ * blocking costs a little accuracy, which the sizing compensates for.
+ *
+ * The hash is fixed (not std::hash), so a snapshot written by one build can be loaded by another.
+ *
+ * @note Not thread-safe.
+ */
+class BloomFilter {
+public:
+    /**
+     * @param capacity Number of keys the filter is sized for.
+     * @param false_positive_rate Target rate at capacity, in (0, 1).
+     * @throws std::invalid_argument for a zero capacity or a rate outside (0, 1).
+     */
+    BloomFilter(uint64_t capacity, double false_positive_rate);
+
+    void insert(std::string_view key);
+    bool possibly_contains(std::string_view key) const;
+
+    uint64_t size() const { return inserted_; }   // Inserts performed, duplicates included
+    size_t memory_bytes() const { return blocks_.size() * sizeof(Block); }
+    uint32_t hash_count() const { return k_; }
+
+    /**
+     * @brief Writes the filter to path atomically (temporary file + rename).
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Loads a snapshot written by save().
+     * @return nullptr if the file is missing, truncated or corrupt.
+     */
+    static std::unique_ptr<BloomFilter> load(const std::string& path);
+
+private:
+    struct alignas(64) Block {
+        uint64_t words[8];
+    };
+
+    BloomFilter(uint32_t k, uint64_t num_blocks);
+
+    size_t block_index(uint64_t hash) const;
+
+    uint32_t k_;
+    std::vector<Block> blocks_;
+    uint64_t inserted_ = 0;
+};
+
+} // namespace crawler
+
+#endif // BLOOM_FILTER_HPP
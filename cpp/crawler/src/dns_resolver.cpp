@@ -0,0 +1,171 @@
+#include "dns_resolver.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include "host_scheduler.hpp"
+
+namespace crawler {
+
+DnsResolver::DnsResolver(const Options& options) : DnsResolver(options, system_lookup) {}
+
+DnsResolver::DnsResolver(const Options& options, LookupFn lookup)
+    : options_(options), lookup_(std::move(lookup)) {
+    for (size_t i = 0; i < std::max<size_t>(1, options_.threads); ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+DnsResolver::~DnsResolver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+DnsResolver::Result DnsResolver::resolve(const std::string& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(host);
+    if (it != cache_.end() && it->second.expires > Clock::now()) {
+        ++stats_.hits;
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+        if (it->second.addresses.empty()) return {Status::Failed, {}};
+        return {Status::Ready, it->second.addresses};
+    }
+
+    if (in_flight_.insert(host).second) {
+        ++stats_.misses;
+        work_.push_back(host);
+        work_ready_.notify_one();
+    }
+    return {Status::Pending, {}};
+}
+
+DnsResolver::Stats DnsResolver::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::vector<std::string> DnsResolver::expire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> dropped;
+    dropped.swap(dropped_);
+    Clock::time_point now = Clock::now();
+    while (!expiry_queue_.empty() && expiry_queue_.front().first <= now) {
+        auto it = cache_.find(expiry_queue_.front().second);
+        if (it != cache_.end() && it->second.expires == expiry_queue_.front().first) {
+            dropped.push_back(it->first);
+            lru_.erase(it->second.lru_position);
+            cache_.erase(it);
+        }
+        expiry_queue_.pop_front();
+    }
+    return dropped;
+}
+
+void DnsResolver::worker_loop() {
+    while (true) {
+        std::string host;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_ready_.wait(lock, [this] { return stopping_ || !work_.empty(); });
+            if (stopping_) return;
+            host = std::move(work_.front());
+            work_.pop_front();
+        }
+
+        std::vector<std::string> addresses = lookup_(host);  // Blocking, outside the lock
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.lookups;
+        if (addresses.empty()) ++stats_.failures;
+        store_locked(host, std::move(addresses));
+        in_flight_.erase(host);
+    }
+}
+
+void DnsResolver::store_locked(const std::string& host, std::vector<std::string> addresses) {
+    auto ttl = addresses.empty() ? options_.negative_ttl : options_.ttl;
+    auto it = cache_.find(host);
+    if (it != cache_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+    } else {
+        lru_.push_front(host);
+        it = cache_.emplace(host, Entry{}).first;
+        it->second.lru_position = lru_.begin();
+    }
+    it->second.addresses = std::move(addresses);
+    it->second.expires = Clock::now() + ttl;
+    if (!it->second.addresses.empty()) expiry_queue_.emplace_back(it->second.expires, host);
+
+    while (cache_.size() > std::max<size_t>(1, options_.max_entries)) {
+        auto evicted = cache_.find(lru_.back());
+        if (!evicted->second.addresses.empty()) dropped_.push_back(evicted->first);
+        cache_.erase(evicted);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+}
+
+std::vector<std::string> DnsResolver::system_lookup(const std::string& host) {
+    std::vector<std::string> addresses;
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0) return addresses;
+
+    for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        char buffer[INET6_ADDRSTRLEN];
+        const void* addr = ai->ai_family == AF_INET
+            ? static_cast<const void*>(&reinterpret_cast<sockaddr_in*>(ai->ai_addr)->sin_addr)
+            : static_cast<const void*>(&reinterpret_cast<sockaddr_in6*>(ai->ai_addr)->sin6_addr);
+        if ((ai->ai_family == AF_INET || ai->ai_family == AF_INET6) &&
+            inet_ntop(ai->ai_family, addr, buffer, sizeof(buffer))) {
+            std::string address = buffer;
+            if (std::find(addresses.begin(), addresses.end(), address) == addresses.end()) {
+                addresses.push_back(address);
+            }
+        }
+    }
+    freeaddrinfo(result);
+    return addresses;
+}
+
+namespace {
+
+// Splits url's authority into host and port, filling in the scheme's default port.
+std::pair<std::string, std::string> host_and_port(const std::string& url) {
+    std::string authority = extract_host(url);
+    std::string port = url.compare(0, 8, "https://") == 0 ? "443" : "80";
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos && authority.find(']', colon) == std::string::npos) {
+        port = authority.substr(colon + 1);
+        authority.erase(colon);
+    }
+    return {authority, port};
+}
+
+} // namespace
+
+std::string host_name(const std::string& url) {
+    return host_and_port(url).first;
+}
+
+std::vector<std::string> curl_resolve_entries(const std::string& url, const std::vector<std::string>& addresses) {
+    if (addresses.empty()) return {};
+    auto [host, port] = host_and_port(url);
+    std::string entry = host + ":" + port + ":";
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        if (i > 0) entry += ",";
+        // IPv6 addresses are bracketed in CURLOPT_RESOLVE
+        entry += addresses[i].find(':') != std::string::npos ? "[" + addresses[i] + "]" : addresses[i];
+    }
+    return {entry};
+}
+
+} // namespace crawler
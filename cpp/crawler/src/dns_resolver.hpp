@@ -0,0 +1,129 @@
+#ifndef DNS_RESOLVER_HPP
+#define DNS_RESOLVER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace crawler {
+
+/**
+ * @brief Caching, non-blocking DNS resolver for the crawl loop.
+ *
+ * Lookups run on a small pool of resolver threads, so a slow name server never stalls the thread
+ * driving the fetcher. Answers are kept in an LRU with a TTL (failures with a shorter one) and
+ * handed to curl through CURLOPT_RESOLVE, so curl never resolves the crawled URLs on its own.
+ * The TTL is the configured one for every answer: getaddrinfo() does not report the records'
+ * TTLs, so they are not honored.
+ *
+ * curl keeps CURLOPT_RESOLVE pins until they are removed, so the crawl loop passes the hosts
+ * expire() returns to Fetcher::unpin(), keeping curl's addresses no older than the cache's.
+ *
+ * @note Thread-safe.
+ */
+class DnsResolver {
+public:
+    // Resolves a host name to IP address strings; an empty result means failure.
+    using LookupFn = std::function<std::vector<std::string>(const std::string& host)>;
+
+    struct Options {
+        size_t threads = 4;
+        size_t max_entries = 10000;
+        std::chrono::seconds ttl{300};
+        std::chrono::seconds negative_ttl{30};
+    };
+
+    struct Stats {
+        uint64_t hits = 0;      // Answered from a fresh cache entry (including cached failures)
+        uint64_t misses = 0;    // Started a lookup (asking again while it runs is not counted)
+        uint64_t lookups = 0;   // Lookups performed by the pool
+        uint64_t failures = 0;  // Lookups that found no address
+        uint64_t evictions = 0;
+        double hit_rate() const { return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+    };
+
+    enum class Status { Ready, Pending, Failed };
+
+    struct Result {
+        Status status;
+        std::vector<std::string> addresses;  // Set when status == Ready
+    };
+
+    explicit DnsResolver(const Options& options);
+    DnsResolver(const Options& options, LookupFn lookup);
+    ~DnsResolver();
+
+    DnsResolver(const DnsResolver&) = delete;
+    DnsResolver& operator=(const DnsResolver&) = delete;
+
+    /**
+     * @brief Returns the cached answer for host, or starts resolving it in the background.
+     *
+     * Never blocks on the network. A Pending host should be asked again later; concurrent
+     * requests for the same host share one lookup.
+     */
+    Result resolve(const std::string& host);
+
+    Stats stats() const;
+
+    /**
+     * @brief Drops answers past their TTL and returns the hosts whose addresses left the cache
+     *        since the last call, by expiry or LRU eviction.
+     *
+     * Cheap enough to call on every pass of the crawl loop: it only looks at expired answers.
+     */
+    std::vector<std::string> expire();
+
+    // getaddrinfo(), which also honors /etc/hosts.
+    static std::vector<std::string> system_lookup(const std::string& host);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::vector<std::string> addresses;
+        Clock::time_point expires;
+        std::list<std::string>::iterator lru_position;
+    };
+
+    void worker_loop();
+    void store_locked(const std::string& host, std::vector<std::string> addresses);
+
+    const Options options_;
+    const LookupFn lookup_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::unordered_map<std::string, Entry> cache_;
+    std::list<std::string> lru_;  // Most recently used first
+    std::unordered_set<std::string> in_flight_;
+    // Successful answers in the order they expire (one TTL for all); entries refreshed or
+    // evicted since are skipped when they come up
+    std::deque<std::pair<Clock::time_point, std::string>> expiry_queue_;
+    std::vector<std::string> dropped_;  // Hosts with addresses evicted since the last expire()
+    std::deque<std::string> work_;
+    Stats stats_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+// Host name of an absolute URL without the port, lowercased (what resolve() expects).
+std::string host_name(const std::string& url);
+
+/**
+ * @brief Builds CURLOPT_RESOLVE entries ("host:port:addr,addr") pinning url's host to addresses.
+ */
+std::vector<std::string> curl_resolve_entries(const std::string& url, const std::vector<std::string>& addresses);
+
+} // namespace crawler
+
+#endif // DNS_RESOLVER_HPP
@@ -0,0 +1,188 @@
+#include "fetcher.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace crawler {
+
+namespace {
+
+// Host and port of a CURLOPT_RESOLVE entry ("host:port:addr,..."); the host may be a bracketed
+// IPv6 literal.
+std::pair<std::string, std::string> pinned_host_and_port(const std::string& entry) {
+    size_t host_end = entry[0] == '[' ? entry.find(']') + 1 : entry.find(':');
+    if (host_end == 0 || host_end >= entry.size()) return {};
+    size_t port_end = entry.find(':', host_end + 1);
+    if (port_end == std::string::npos) return {};
+    return {entry.substr(0, host_end), entry.substr(host_end + 1, port_end - host_end - 1)};
+}
+
+} // namespace
+
+Fetcher::Fetcher(const FetcherOptions& options) : options_(options) {
+    if (options_.max_concurrency == 0) options_.max_concurrency = 1;
+
+    share_ = curl_share_init();
+    if (!share_) {
+        throw std::runtime_error("curl_share_init failed");
+    }
+    // Lock callbacks make the share safe even if another thread's handles ever join it
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lock_callback);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlock_callback);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        curl_share_cleanup(share_);
+        throw std::runtime_error("curl_multi_init failed");
+    }
+    curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(options_.max_concurrency));
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(options_.max_host_connections));
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+}
+
+Fetcher::~Fetcher() {
+    for (auto& [handle, transfer] : active_) {
+        curl_multi_remove_handle(multi_, handle);
+        curl_easy_cleanup(handle);
+        curl_slist_free_all(transfer.resolve);
+    }
+    for (CURL* handle : idle_handles_) {
+        curl_easy_cleanup(handle);
+    }
+    curl_multi_cleanup(multi_);
+    curl_share_cleanup(share_);  // Only valid once no easy handle uses it
+}
+
+void Fetcher::add(const std::string& url, int64_t tag, std::vector<std::string> resolve) {
+    queue_.push_back({url, tag, std::move(resolve)});
+    start_queued();
+}
+
+void Fetcher::unpin(const std::string& host) {
+    auto it = pinned_ports_.find(host);
+    if (it == pinned_ports_.end()) return;
+    for (const auto& port : it->second) unpins_.push_back("-" + host + ":" + port);
+    pinned_ports_.erase(it);
+}
+
+CURL* Fetcher::acquire_handle() {
+    CURL* handle;
+    if (!idle_handles_.empty()) {
+        handle = idle_handles_.back();
+        idle_handles_.pop_back();
+        curl_easy_reset(handle);  // Clears options; the shared caches are untouched
+    } else {
+        handle = curl_easy_init();
+        if (!handle) return nullptr;
+    }
+
+    curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT, options_.timeout_seconds);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, options_.connect_timeout_seconds);
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, options_.user_agent.c_str());
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2L);
+    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");  // Any encoding curl can decode
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    return handle;
+}
+
+void Fetcher::start_queued() {
+    while (!queue_.empty() && active_.size() < options_.max_concurrency) {
+        CURL* handle = acquire_handle();
+        if (!handle) return;  // Retry on the next poll
+        Request request = std::move(queue_.front());
+        queue_.pop_front();
+
+        Transfer& transfer = active_[handle];
+        transfer.tag = request.tag;
+        transfer.url = std::move(request.url);
+        transfer.body.clear();
+        transfer.error[0] = '\0';
+        transfer.resolve = nullptr;
+        // Removals first, so a fresh pin for the same host in this request survives them
+        for (const auto& entry : unpins_) {
+            transfer.resolve = curl_slist_append(transfer.resolve, entry.c_str());
+        }
+        unpins_.clear();
+        for (const auto& entry : request.resolve) {
+            transfer.resolve = curl_slist_append(transfer.resolve, entry.c_str());
+            auto [host, port] = pinned_host_and_port(entry);
+            if (!host.empty()) pinned_ports_[host].insert(port);
+        }
+        if (transfer.resolve) curl_easy_setopt(handle, CURLOPT_RESOLVE, transfer.resolve);
+        // The map never moves its elements, so these pointers stay valid for the transfer
+        curl_easy_setopt(handle, CURLOPT_URL, transfer.url.c_str());
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer.body);
+        curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, transfer.error);
+        curl_multi_add_handle(multi_, handle);
+    }
+}
+
+std::vector<FetchResult> Fetcher::poll(std::chrono::milliseconds timeout) {
+    std::vector<FetchResult> results;
+    start_queued();
+
+    int running = 0;
+    curl_multi_perform(multi_, &running);
+    if (!active_.empty()) {
+        curl_multi_poll(multi_, nullptr, 0, static_cast<int>(timeout.count()), nullptr);
+        curl_multi_perform(multi_, &running);
+    }
+
+    int remaining = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi_, &remaining)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        CURL* handle = msg->easy_handle;
+        CURLcode code = msg->data.result;  // msg is invalid once the handle is removed
+        auto it = active_.find(handle);
+        if (it == active_.end()) continue;
+
+        FetchResult result;
+        result.tag = it->second.tag;
+        result.url = std::move(it->second.url);
+        result.code = code;
+        result.status = 0;
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &result.status);
+        char* effective_url = nullptr;
+        curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &effective_url);
+        result.effective_url = effective_url ? effective_url : result.url;
+        result.body = std::move(it->second.body);
+        if (code != CURLE_OK) {
+            result.error = it->second.error[0] ? it->second.error : curl_easy_strerror(code);
+        }
+        results.push_back(std::move(result));
+
+        curl_multi_remove_handle(multi_, handle);
+        curl_slist_free_all(it->second.resolve);
+        active_.erase(it);
+        idle_handles_.push_back(handle);
+    }
+
+    start_queued();
+    if (!queue_.empty() || !results.empty()) {
+        curl_multi_perform(multi_, &running);  // Get the newly added transfers going
+    }
+    return results;
+}
+
+size_t Fetcher::write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<const char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+void Fetcher::lock_callback(CURL*, curl_lock_data data, curl_lock_access, void* userp) {
+    static_cast<Fetcher*>(userp)->share_locks_[data].lock();
+}
+
+void Fetcher::unlock_callback(CURL*, curl_lock_data data, void* userp) {
+    static_cast<Fetcher*>(userp)->share_locks_[data].unlock();
+}
+
+} // namespace crawler
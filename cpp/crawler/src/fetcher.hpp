@@ -0,0 +1,119 @@
+#ifndef FETCHER_HPP
+#define FETCHER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <curl/curl.h>
+
+namespace crawler {
+
+struct FetchResult {
+    int64_t tag;           // Caller's ID for the request (the crawler uses the doc ID)
+    std::string url;
+    std::string effective_url;  // After redirects; the base for resolving the page's links
+    CURLcode code;         // CURLE_OK unless the transfer itself failed
+    long status;           // HTTP status, 0 if no response was received
+    std::string body;
+    std::string error;     // Human-readable reason when code != CURLE_OK
+
+    bool ok() const { return code == CURLE_OK; }
+};
+
+struct FetcherOptions {
+    size_t max_concurrency = 64;    // Transfers in flight at once
+    size_t max_host_connections = 4; // Open connections per host
+    long timeout_seconds = 10;
+    long connect_timeout_seconds = 5;
+    std::string user_agent = "MaxSearchEngineBot/1.0 (Open source search engine)";
+};
+
+/**
+ * @brief Concurrent HTTP fetch engine built on the libcurl multi interface.
+ *
+ * Keeps up to max_concurrency transfers in flight on one thread. URLs beyond that wait in a
+ * FIFO until a slot frees up. DNS results, connections (keep-alive) and TLS sessions are shared
+ * across transfers through a CURLSH, and easy handles are recycled, so repeat fetches from a host
+ * skip the lookup and the handshakes.
+ *
+ * Typical use: add() URLs, then call poll() in a loop and handle the completed results.
+ *
+ * @note Not thread-safe. Drive each Fetcher from a single thread.
+ */
+class Fetcher {
+public:
+    /**
+     * @throws std::runtime_error if the curl multi or share handle cannot be created.
+     * @note curl_global_init() must have been called.
+     */
+    explicit Fetcher(const FetcherOptions& options = FetcherOptions());
+    ~Fetcher();
+
+    Fetcher(const Fetcher&) = delete;
+    Fetcher& operator=(const Fetcher&) = delete;
+
+    // Queues a URL; it starts as soon as fewer than max_concurrency transfers are in flight.
+    // resolve holds CURLOPT_RESOLVE entries ("host:port:addr") pinning the host's addresses.
+    void add(const std::string& url, int64_t tag, std::vector<std::string> resolve = {});
+
+    /**
+     * @brief Drops the addresses pinned for host on every port, so curl resolves it again.
+     *
+     * A pin stays in the shared DNS cache for good, also answering for redirects to the host.
+     * The removal takes effect when the next transfer starts.
+     */
+    void unpin(const std::string& host);
+
+    /**
+     * @brief Drives the transfers, waiting up to timeout for network activity.
+     * @return The transfers that finished during this call, successful or not.
+     */
+    std::vector<FetchResult> poll(std::chrono::milliseconds timeout);
+
+    size_t in_flight() const { return active_.size(); }
+    size_t queued() const { return queue_.size(); }
+    // Transfers started or waiting; 0 means the fetcher is idle.
+    size_t outstanding() const { return in_flight() + queued(); }
+
+private:
+    struct Request {
+        std::string url;
+        int64_t tag;
+        std::vector<std::string> resolve;
+    };
+
+    struct Transfer {
+        int64_t tag;
+        std::string url;
+        std::string body;
+        curl_slist* resolve = nullptr;
+        char error[CURL_ERROR_SIZE];
+    };
+
+    static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp);
+    static void lock_callback(CURL* handle, curl_lock_data data, curl_lock_access access, void* userp);
+    static void unlock_callback(CURL* handle, curl_lock_data data, void* userp);
+
+    void start_queued();
+    CURL* acquire_handle();
+
+    FetcherOptions options_;
+    CURLM* multi_;
+    CURLSH* share_;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks_;
+    std::deque<Request> queue_;
+    std::unordered_map<CURL*, Transfer> active_;
+    std::vector<CURL*> idle_handles_;  // Finished handles kept for reuse
+    std::unordered_map<std::string, std::unordered_set<std::string>> pinned_ports_;  // Host -> ports
+    std::vector<std::string> unpins_;  // "-host:port" entries for the next transfer to start
+};
+
+} // namespace crawler
+
+#endif // FETCHER_HPP
@@ -0,0 +1,81 @@
+#include "host_scheduler.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace crawler {
+
+std::string extract_host(const std::string& url) {
+    size_t scheme_end = url.find("://");
+    if (scheme_end == std::string::npos) return "";
+    size_t start = scheme_end + 3;
+    size_t end = url.find_first_of("/?#", start);
+    std::string authority = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+    // Drop any user:password@ prefix
+    size_t at = authority.rfind('@');
+    if (at != std::string::npos) authority.erase(0, at + 1);
+
+    std::transform(authority.begin(), authority.end(), authority.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return authority;
+}
+
+HostScheduler::HostScheduler(Clock::duration default_delay) : default_delay_(default_delay) {}
+
+void HostScheduler::push(const std::string& url) {
+    std::string host = extract_host(url);
+    HostState& state = hosts_[host];
+    if (state.urls.empty()) {
+        // A new host is ready right away; a known one keeps its cool-down
+        ready_heap_.emplace(state.next_allowed, host);
+    }
+    state.urls.push_back(url);
+    ++pending_;
+}
+
+std::optional<std::string> HostScheduler::pop_ready(Clock::time_point now) {
+    discard_idle_hosts(now);
+    if (ready_heap_.empty() || ready_heap_.top().first > now) return std::nullopt;
+
+    std::string host = ready_heap_.top().second;
+    ready_heap_.pop();
+    HostState& state = hosts_[host];
+
+    std::string url = std::move(state.urls.front());
+    state.urls.pop_front();
+    --pending_;
+
+    state.next_allowed = now + state.delay.value_or(default_delay_);
+    if (!state.urls.empty()) {
+        ready_heap_.emplace(state.next_allowed, host);
+    } else {
+        // Remember the host until its delay has passed, so a URL pushed meanwhile still waits
+        cooldown_heap_.emplace(state.next_allowed, host);
+    }
+    return url;
+}
+
+std::optional<HostScheduler::Clock::time_point> HostScheduler::next_ready_time() const {
+    if (ready_heap_.empty()) return std::nullopt;
+    return ready_heap_.top().first;
+}
+
+void HostScheduler::set_host_delay(const std::string& host, Clock::duration delay) {
+    auto [it, inserted] = hosts_.try_emplace(host);
+    it->second.delay = delay;
+    if (inserted) cooldown_heap_.emplace(Clock::time_point{}, host);
+}
+
+void HostScheduler::discard_idle_hosts(Clock::time_point now) {
+    while (!cooldown_heap_.empty() && cooldown_heap_.top().first <= now) {
+        auto it = hosts_.find(cooldown_heap_.top().second);
+        // Entries go stale when the host got URLs again or was fetched since
+        if (it != hosts_.end() && it->second.urls.empty() && it->second.next_allowed <= now) {
+            hosts_.erase(it);
+        }
+        cooldown_heap_.pop();
+    }
+}
+
+} // namespace crawler
@@ -0,0 +1,82 @@
+#ifndef HOST_SCHEDULER_HPP
+#define HOST_SCHEDULER_HPP
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace crawler {
+
+/**
+ * @brief Returns the lowercased host[:port] of an absolute http(s) URL, or "" if there is none.
+ */
+std::string extract_host(const std::string& url);
+
+/**
+ * @brief Per-host politeness scheduler for the URL frontier.
+ *
+ * Shards pending URLs into one FIFO per host and keeps a min-heap of the next allowed fetch time
+ * of every host that has URLs queued. pop_ready() always returns a URL whose host may be fetched now, so a slow or
+ * throttled host never holds up the others, while no host is hit more often than once per its
+ * delay.
+ *
+ * Time is passed in rather than read from the clock, which keeps the scheduler deterministic for
+ * tests and simulations.
+ *
+ * @note Not thread-safe.
+ */
+class HostScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit HostScheduler(Clock::duration default_delay);
+
+    // Queues a URL behind any others for the same host.
+    void push(const std::string& url);
+
+    /**
+     * @brief Takes the next URL whose host is ready at now, and charges that host one delay.
+     * @return std::nullopt if every host with pending URLs is still cooling down.
+     */
+    std::optional<std::string> pop_ready(Clock::time_point now);
+
+    // Earliest time pop_ready() can return a URL, or std::nullopt if nothing is queued.
+    std::optional<Clock::time_point> next_ready_time() const;
+
+    // Overrides the delay for one host, e.g. from a robots.txt Crawl-delay. The override is kept
+    // while the host is tracked, so set it before or while the host's URLs are queued.
+    void set_host_delay(const std::string& host, Clock::duration delay);
+
+    size_t size() const { return pending_; }
+    bool empty() const { return pending_ == 0; }
+    // Hosts currently tracked: those with queued URLs or still inside their delay window.
+    size_t host_count() const { return hosts_.size(); }
+
+private:
+    struct HostState {
+        std::deque<std::string> urls;
+        Clock::time_point next_allowed{};
+        std::optional<Clock::duration> delay;  // Falls back to default_delay_
+    };
+    using HeapEntry = std::pair<Clock::time_point, std::string>;
+
+    void discard_idle_hosts(Clock::time_point now);
+
+    using MinHeap = std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>>;
+
+    const Clock::duration default_delay_;
+    std::unordered_map<std::string, HostState> hosts_;
+    MinHeap ready_heap_;     // Exactly one entry per host with queued URLs, at its next allowed time
+    MinHeap cooldown_heap_;  // Hosts that ran dry, to forget once their delay has passed
+    size_t pending_ = 0;
+};
+
+} // namespace crawler
+
+#endif // HOST_SCHEDULER_HPP
@@ -0,0 +1,265 @@
+#include "link_extractor.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <unordered_set>
+
+namespace crawler {
+
+namespace {
+
+struct UrlParts {
+    std::string scheme;
+    std::optional<std::string> authority;
+    std::string path;
+    std::optional<std::string> query;
+};
+
+char lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && is_space(s.front())) s.remove_prefix(1);
+    while (!s.empty() && is_space(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+// Splits a URI reference into its components (RFC 3986, appendix B). The fragment is dropped.
+UrlParts split_url(std::string_view url) {
+    UrlParts parts;
+    size_t fragment = url.find('#');
+    if (fragment != std::string_view::npos) url = url.substr(0, fragment);
+
+    size_t scheme_end = url.find_first_of(":/?");
+    if (scheme_end != std::string_view::npos && scheme_end > 0 && url[scheme_end] == ':' &&
+        std::isalpha(static_cast<unsigned char>(url[0]))) {
+        for (char c : url.substr(0, scheme_end)) parts.scheme += lower(c);
+        url.remove_prefix(scheme_end + 1);
+    }
+    if (url.size() >= 2 && url[0] == '/' && url[1] == '/') {
+        size_t end = url.find_first_of("/?", 2);
+        parts.authority = std::string(url.substr(2, end == std::string_view::npos ? std::string_view::npos : end - 2));
+        url.remove_prefix(end == std::string_view::npos ? url.size() : end);
+    }
+    size_t query = url.find('?');
+    if (query != std::string_view::npos) {
+        parts.query = std::string(url.substr(query + 1));
+        url = url.substr(0, query);
+    }
+    parts.path = std::string(url);
+    return parts;
+}
+
+// RFC 3986, section 5.2.4.
+std::string remove_dot_segments(std::string_view input) {
+    std::string output;
+    while (!input.empty()) {
+        if (input.substr(0, 3) == "../") {
+            input.remove_prefix(3);
+        } else if (input.substr(0, 2) == "./") {
+            input.remove_prefix(2);
+        } else if (input.substr(0, 3) == "/./") {
+            input.remove_prefix(2);
+        } else if (input == "/.") {
+            input = "/";
+        } else if (input.substr(0, 4) == "/../" || input == "/..") {
+            input = input.size() == 3 ? std::string_view("/") : input.substr(3);
+            size_t last = output.rfind('/');
+            output.erase(last == std::string::npos ? 0 : last);
+        } else if (input == "." || input == "..") {
+            input = {};
+        } else {
+            size_t next = input.find('/', input[0] == '/' ? 1 : 0);
+            size_t len = next == std::string_view::npos ? input.size() : next;
+            output.append(input.substr(0, len));
+            input.remove_prefix(len);
+        }
+    }
+    return output;
+}
+
+std::string merge_paths(const UrlParts& base, const std::string& ref_path) {
+    if (base.authority && base.path.empty()) return "/" + ref_path;
+    size_t last = base.path.rfind('/');
+    return last == std::string::npos ? ref_path : base.path.substr(0, last + 1) + ref_path;
+}
+
+std::optional<std::string> normalize_parts(UrlParts parts) {
+    if ((parts.scheme != "http" && parts.scheme != "https") || !parts.authority) return std::nullopt;
+
+    std::string_view authority = *parts.authority;
+    size_t at = authority.rfind('@');
+    if (at != std::string_view::npos) authority.remove_prefix(at + 1);
+
+    std::string host;
+    host.reserve(authority.size());
+    for (char c : authority) host += lower(c);
+    // Drop a trailing empty or default port; brackets keep IPv6 colons out of the way
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos && host.find(']', colon) == std::string::npos) {
+        std::string port = host.substr(colon + 1);
+        if (port.empty() || (parts.scheme == "http" && port == "80") || (parts.scheme == "https" && port == "443")) {
+            host.erase(colon);
+        }
+    }
+    if (host.empty()) return std::nullopt;
+
+    std::string url = parts.scheme + "://" + host;
+    url += parts.path.empty() ? "/" : remove_dot_segments(parts.path);
+    if (parts.query) url += "?" + *parts.query;
+    return url;
+}
+
+// Decodes the entities that show up in real-world hrefs; others are left as they are.
+std::string decode_entities(std::string_view value) {
+    if (value.find('&') == std::string_view::npos) return std::string(value);
+    static const std::pair<const char*, char> entities[] = {
+        {"&amp;", '&'}, {"&#38;", '&'}, {"&quot;", '"'}, {"&#39;", '\''}, {"&apos;", '\''}, {"&lt;", '<'}, {"&gt;", '>'},
+    };
+    std::string out;
+    out.reserve(value.size());
+    for (size_t i = 0; i < value.size();) {
+        bool replaced = false;
+        if (value[i] == '&') {
+            for (const auto& [entity, c] : entities) {
+                size_t len = std::strlen(entity);
+                if (value.compare(i, len, entity) == 0) {
+                    out += c;
+                    i += len;
+                    replaced = true;
+                    break;
+                }
+            }
+        }
+        if (!replaced) out += value[i++];
+    }
+    return out;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (lower(a[i]) != lower(b[i])) return false;
+    }
+    return true;
+}
+
+// Position of the next "</tag" (any case) at or after pos.
+size_t find_end_tag(std::string_view html, std::string_view tag, size_t pos) {
+    while ((pos = html.find("</", pos)) != std::string_view::npos) {
+        if (iequals(html.substr(pos + 2, tag.size()), tag)) return pos;
+        pos += 2;
+    }
+    return std::string_view::npos;
+}
+
+} // namespace
+
+std::optional<std::string> normalize_url(std::string_view url) {
+    return normalize_parts(split_url(trim(url)));
+}
+
+std::optional<std::string> resolve_url(std::string_view base, std::string_view ref) {
+    ref = trim(ref);
+    UrlParts r = split_url(ref);
+    if (!r.scheme.empty()) return normalize_parts(std::move(r));
+
+    UrlParts b = split_url(base);
+    UrlParts target;
+    target.scheme = b.scheme;
+    if (r.authority) {
+        target.authority = r.authority;
+        target.path = r.path;
+        target.query = r.query;
+    } else {
+        target.authority = b.authority;
+        if (r.path.empty()) {
+            target.path = b.path;
+            target.query = r.query ? r.query : b.query;
+        } else {
+            target.path = r.path[0] == '/' ? r.path : merge_paths(b, r.path);
+            target.query = r.query;
+        }
+    }
+    return normalize_parts(std::move(target));
+}
+
+std::vector<std::string> extract_links(std::string_view html, const std::string& page_url) {
+    std::vector<std::string> links;
+    std::unordered_set<std::string> seen;
+    std::string base = page_url;
+
+    size_t pos = 0;
+    while ((pos = html.find('<', pos)) != std::string_view::npos) {
+        ++pos;
+        if (html.compare(pos, 3, "!--") == 0) {
+            size_t end = html.find("-->", pos + 3);
+            if (end == std::string_view::npos) break;
+            pos = end + 3;
+            continue;
+        }
+
+        // Tag name
+        size_t name_start = pos;
+        while (pos < html.size() && std::isalnum(static_cast<unsigned char>(html[pos]))) ++pos;
+        std::string_view name = html.substr(name_start, pos - name_start);
+        if (name.empty()) continue;  // Closing tag, doctype, stray '<'
+
+        bool wants_href = iequals(name, "a") || iequals(name, "area") || iequals(name, "base");
+        bool raw_text = iequals(name, "script") || iequals(name, "style");
+
+        // Attributes, up to the closing '>'
+        std::optional<std::string_view> href;
+        while (pos < html.size() && html[pos] != '>') {
+            if (is_space(html[pos]) || html[pos] == '/') {
+                ++pos;
+                continue;
+            }
+            size_t attr_start = pos;
+            while (pos < html.size() && !is_space(html[pos]) && html[pos] != '=' && html[pos] != '>') ++pos;
+            std::string_view attr = html.substr(attr_start, pos - attr_start);
+            while (pos < html.size() && is_space(html[pos])) ++pos;
+            if (pos >= html.size() || html[pos] != '=') continue;  // Attribute without a value
+            ++pos;
+            while (pos < html.size() && is_space(html[pos])) ++pos;
+
+            std::string_view value;
+            if (pos < html.size() && (html[pos] == '"' || html[pos] == '\'')) {
+                char quote = html[pos++];
+                size_t end = html.find(quote, pos);
+                if (end == std::string_view::npos) end = html.size();
+                value = html.substr(pos, end - pos);
+                pos = end + 1;
+            } else {
+                size_t value_start = pos;
+                while (pos < html.size() && !is_space(html[pos]) && html[pos] != '>') ++pos;
+                value = html.substr(value_start, pos - value_start);
+            }
+            if (wants_href && !href && iequals(attr, "href")) href = value;
+        }
+
+        if (href) {
+            std::string ref = decode_entities(*href);
+            if (iequals(name, "base")) {
+                if (auto resolved = resolve_url(page_url, ref)) base = *resolved;
+            } else if (auto resolved = resolve_url(base, ref)) {
+                if (seen.insert(*resolved).second) links.push_back(std::move(*resolved));
+            }
+        }
+
+        if (raw_text && pos < html.size()) {
+            // Skip to the matching end tag; markup inside scripts is not markup
+            size_t end = find_end_tag(html, iequals(name, "script") ? "script" : "style", pos);
+            if (end == std::string_view::npos) break;
+            pos = end;
+        }
+    }
+    return links;
+}
+
+} // namespace crawler
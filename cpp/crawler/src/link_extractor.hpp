@@ -0,0 +1,38 @@
+#ifndef LINK_EXTRACTOR_HPP
+#define LINK_EXTRACTOR_HPP
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace crawler {
+
+/**
+ * @brief Normalizes an absolute http(s) URL.
+ *
+ * Lowercases the scheme and host, drops the fragment, default ports (80/443) and any userinfo,
+ * removes dot-segments and turns an empty path into "/".
+ *
+ * @return std::nullopt if url is not an absolute http(s) URL.
+ */
+std::optional<std::string> normalize_url(std::string_view url);
+
+/**
+ * @brief Resolves ref against base (RFC 3986, section 5.2) and normalizes the result.
+ * @return std::nullopt for non-http(s) targets (mailto:, javascript:, ...) or unusable input.
+ */
+std::optional<std::string> resolve_url(std::string_view base, std::string_view ref);
+
+/**
+ * @brief Extracts the outlinks of an HTML page in one forward pass.
+ *
+ * Scans tags without building a DOM: collects href values of <a> and <area>, honors <base href>,
+ * and skips comments and the contents of <script> and <style>. Links are resolved against
+ * page_url, normalized and de-duplicated, in document order.
+ */
+std::vector<std::string> extract_links(std::string_view html, const std::string& page_url);
+
+} // namespace crawler
+
+#endif // LINK_EXTRACTOR_HPP
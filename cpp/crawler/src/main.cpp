@@ -2,57 +2,84 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <optional>
+#include <memory>
+#include <vector>
 #include <curl/curl.h>
 #include <pqxx/pqxx>
 #include <hiredis/hiredis.h>
-#include "warc_writer.hpp"
+#include "archive_pool.hpp"
+#include "segmented_warc_writer.hpp"
+#include "fetcher.hpp"
+#include "host_scheduler.hpp"
+#include "link_extractor.hpp"
+#include "bloom_filter.hpp"
+#include "dns_resolver.hpp"
+#include "robots.hpp"
+
+// --- Helpers: Read settings from the environment ---
+std::string get_env_or_default(const char* var, const std::string& def) {
+    const char* env = std::getenv(var);
+    return env ? std::string(env) : def;
+}
+
+size_t get_env_size(const char* var, size_t def) {
+    const char* env = std::getenv(var);
+    return env ? std::stoul(env) : def;
+}
 
 // --- Config ---
 const std::string REDIS_HOST = "redis_service";
 const std::string DB_CONN_STR = "dbname=search_engine user=admin password=password123 host=postgres_service port=5432";
 const std::string SEED_URL = "https://en.wikipedia.org/wiki/Main_Page";
-const std::string WARC_FILENAME = "/shared_data/crawled.warc.gz";
+// WARC segments are <prefix>_NNNNN.warc.gz (.warc.zst), each rotated at a size or record limit
+const std::string WARC_SEGMENT_PREFIX = get_env_or_default("WARC_SEGMENT_PREFIX", "/shared_data/crawled");
+const size_t WARC_SEGMENT_MAX_MB = get_env_size("WARC_SEGMENT_MAX_MB", 1024);
+const size_t WARC_SEGMENT_MAX_RECORDS = get_env_size("WARC_SEGMENT_MAX_RECORDS", 0);
+// fdatasync() the WARC file every N records and/or every interval (0 leaves flushing to the OS)
+const size_t WARC_SYNC_EVERY_RECORDS = get_env_size("WARC_SYNC_EVERY_RECORDS", 0);
+const std::chrono::milliseconds WARC_SYNC_INTERVAL(get_env_size("WARC_SYNC_INTERVAL_MS", 0));
+// "gzip" or "zstd"; zstd segments carry a dictionary trained on the pages of the one before
+const std::string WARC_CODEC = get_env_or_default("WARC_CODEC", "gzip");
+const size_t WARC_ZSTD_LEVEL = get_env_size("WARC_ZSTD_LEVEL", 3);
+const size_t WARC_DICTIONARY_SAMPLE_MB = get_env_size("WARC_DICTIONARY_SAMPLE_MB", 8);
+const size_t WARC_WRITER_THREADS = get_env_size("WARC_WRITER_THREADS", 4);
 const long CURL_TIMEOUT_SECONDS = 10;
 const int DB_MAX_RETRIES = 10;
 const int DB_RETRY_DELAY_SECONDS = 5;
 const int QUEUE_POLL_INTERVAL_SECONDS = 5;
-const int CRAWL_DELAY_SECONDS = 1;
+// Transfers in flight at once, and open connections allowed per host (politeness cap)
+const size_t CRAWL_CONCURRENCY = get_env_size("CRAWL_CONCURRENCY", 64);
+const size_t CRAWL_HOST_CONNECTIONS = get_env_size("CRAWL_HOST_CONNECTIONS", 2);
+// Minimum time between two fetches from the same host
+const std::chrono::milliseconds CRAWL_HOST_DELAY(get_env_size("CRAWL_HOST_DELAY_MS", 1000));
+// URLs held in the in-process frontier; the rest stay in Redis
+const size_t FRONTIER_MAX_PENDING = get_env_size("FRONTIER_MAX_PENDING", 10000);
+const size_t FRONTIER_REFILL_BATCH = 1000;
+// Outlinks per RPUSH; all batches of a loop iteration go out in one pipelined round trip
+const size_t LINK_PUSH_BATCH = 500;
+const std::chrono::milliseconds FETCH_POLL_INTERVAL(100);
+// Visited-URL Bloom filter in front of Postgres: sizing, and where/how often it is snapshotted
+const size_t BLOOM_CAPACITY = get_env_size("BLOOM_CAPACITY", 10000000);
+const double BLOOM_FP_RATE = std::stod(get_env_or_default("BLOOM_FP_RATE", "0.01"));
+const std::string BLOOM_SNAPSHOT_PATH = get_env_or_default("BLOOM_SNAPSHOT_PATH", "/shared_data/visited.bloom");
+const std::chrono::seconds BLOOM_SNAPSHOT_INTERVAL(get_env_size("BLOOM_SNAPSHOT_INTERVAL_SECONDS", 300));
+// Resolver threads and the DNS cache; getaddrinfo() reports no TTL, so one is configured here
+const size_t DNS_RESOLVER_THREADS = get_env_size("DNS_RESOLVER_THREADS", 8);
+const size_t DNS_CACHE_SIZE = get_env_size("DNS_CACHE_SIZE", 100000);
+const std::chrono::seconds DNS_CACHE_TTL(get_env_size("DNS_CACHE_TTL_SECONDS", 300));
+const std::chrono::seconds DNS_STATS_INTERVAL(60);
+// Hosts whose robots.txt rules are kept, and the longest Crawl-delay honored
+const size_t ROBOTS_CACHE_SIZE = get_env_size("ROBOTS_CACHE_SIZE", 100000);
+const std::chrono::milliseconds ROBOTS_MAX_CRAWL_DELAY(60000);
+// Delay for a host whose robots.txt is unreachable; its URLs cycle through the frontier at this pace
+const std::chrono::milliseconds ROBOTS_UNREACHABLE_DELAY(60000);
+// Fetcher tag for robots.txt transfers; page transfers are tagged with their doc_id
+const int ROBOTS_TAG = -1;
 const size_t MIN_URL_LENGTH = 10;
 
-// --- CURL Callback ---
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
-    userp->append(static_cast<const char*>(contents), size * nmemb);
-    return size * nmemb;
-}
-
-// --- Helper: Download URL ---
-std::string download_url(const std::string& url) {
-    CURL* curl;
-    CURLcode res;
-    std::string readBuffer;
-
-    curl = curl_easy_init();
-    if(curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, CURL_TIMEOUT_SECONDS);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, "MaxSearchEngineBot/1.0 (Open source search engine)");
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-
-        res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
-
-        if(res != CURLE_OK) {
-            std::cerr << "CURL failed: " << curl_easy_strerror(res) << std::endl;
-            return "";
-        }
-    }
-    return readBuffer;
-}
-
 // --- Helper: Validate URL ---
 bool is_valid_url(const std::string& url) {
     if (url.length() < MIN_URL_LENGTH) return false;
@@ -70,6 +97,127 @@ std::string get_filename_from_path(const std::string& path) {
     return path;
 }
 
+// --- Helper: Move URLs from the Redis crawl_queue into the frontier ---
+// Pops up to max_count URLs per round trip; returns how many were queued.
+size_t refill_frontier(redisContext* redis, crawler::HostScheduler& frontier, size_t max_count) {
+    size_t queued = 0;
+    while (queued < max_count) {
+        size_t count = std::min(FRONTIER_REFILL_BATCH, max_count - queued);
+        redisReply* reply = (redisReply*)redisCommand(redis, "LPOP crawl_queue %zu", count);
+        if (reply == NULL) return queued;
+        if (reply->type != REDIS_REPLY_ARRAY) {
+            // Nil once the queue is empty
+            if (reply->type == REDIS_REPLY_ERROR) std::cerr << "LPOP failed: " << reply->str << std::endl;
+            freeReplyObject(reply);
+            return queued;
+        }
+        for (size_t i = 0; i < reply->elements; ++i) {
+            redisReply* element = reply->element[i];
+            if (element->type != REDIS_REPLY_STRING) continue;
+            std::string url(element->str, element->len);
+            if (!is_valid_url(url)) continue;
+            frontier.push(url);
+            ++queued;
+        }
+        size_t popped = reply->elements;
+        freeReplyObject(reply);
+        if (popped < count) return queued;  // Drained the queue
+    }
+    return queued;
+}
+
+// --- Helper: Queue discovered outlinks for crawling ---
+// Sends RPUSH crawl_queue in batches of LINK_PUSH_BATCH, pipelined, then collects the replies.
+void enqueue_links(redisContext* redis, const std::vector<std::string>& links) {
+    size_t batches = 0;
+    std::vector<const char*> argv;
+    std::vector<size_t> argv_len;
+    for (size_t start = 0; start < links.size(); start += LINK_PUSH_BATCH) {
+        argv = {"RPUSH", "crawl_queue"};
+        argv_len = {5, 11};
+        for (size_t i = start; i < std::min(links.size(), start + LINK_PUSH_BATCH); ++i) {
+            argv.push_back(links[i].data());
+            argv_len.push_back(links[i].size());
+        }
+        if (redisAppendCommandArgv(redis, static_cast<int>(argv.size()), argv.data(), argv_len.data()) != REDIS_OK) {
+            std::cerr << "Failed to buffer RPUSH of outlinks" << std::endl;
+            break;
+        }
+        ++batches;
+    }
+
+    for (size_t i = 0; i < batches; ++i) {
+        redisReply* reply = nullptr;
+        if (redisGetReply(redis, reinterpret_cast<void**>(&reply)) != REDIS_OK || reply == NULL) {
+            std::cerr << "Redis RPUSH of outlinks failed: " << (redis->err ? redis->errstr : "NULL reply") << std::endl;
+            return;
+        }
+        if (reply->type == REDIS_REPLY_ERROR) {
+            std::cerr << "Redis RPUSH of outlinks failed: " << reply->str << std::endl;
+        }
+        freeReplyObject(reply);
+    }
+}
+
+// --- Helper: Record a page the archive pool has saved to WARC and hand it to the indexer ---
+void record_page(pqxx::connection& C, redisContext* redis, const crawler::ArchivedPage& page) {
+    if (!page.error.empty()) {
+        std::cerr << "Error saving WARC for " << page.url << ": " << page.error << std::endl;
+        return;
+    }
+    const crawler::WarcRecordInfo& info = page.info;
+    int doc_id = page.doc_id;
+    try {
+        // E. Update DB
+        pqxx::work W(C);
+        W.exec_params(
+            "UPDATE documents SET status = 'crawled', file_path = $1, \"offset\" = $2, length = $3 WHERE id = $4",
+            get_filename_from_path(info.filename), info.offset, info.length, doc_id
+        );
+        W.commit();
+        std::cout << "Saved to " << get_filename_from_path(info.filename) << " at offset " << info.offset << " (" << info.length << " bytes)" << std::endl;
+
+        // F. Push to Indexing Queue with error handling and retries
+        const int MAX_RETRIES = 3;
+        bool push_success = false;
+        for (int attempt = 0; attempt < MAX_RETRIES; ++attempt) {
+            redisReply* reply = (redisReply*)redisCommand(redis, "RPUSH indexing_queue %d", doc_id);
+            if (reply == NULL) {
+                std::cerr << "Redis RPUSH failed for doc_id " << doc_id << " (attempt " << (attempt + 1) << "): NULL reply";
+                if (redis->err) {
+                    std::cerr << ", Redis error: " << redis->errstr;
+                }
+                std::cerr << std::endl;
+                // No reply to free
+                continue;
+            }
+            if (reply->type == REDIS_REPLY_ERROR) {
+                std::cerr << "Redis RPUSH error for doc_id " << doc_id << " (attempt " << (attempt + 1) << "): " << reply->str << std::endl;
+                freeReplyObject(reply);
+                continue;
+            }
+            // Success
+            freeReplyObject(reply);
+            push_success = true;
+            break;
+        }
+        if (!push_success) {
+            // Handle failure: update DB status to indicate not queued
+            try {
+                pqxx::work W_fail(C);
+                W_fail.exec_params("UPDATE documents SET status = 'crawled_not_queued' WHERE id = $1", doc_id);
+                W_fail.commit();
+                std::cerr << "Failed to queue doc_id " << doc_id << " for indexing after " << MAX_RETRIES << " attempts, marked as crawled_not_queued" << std::endl;
+            } catch (const std::exception &e) {
+                std::cerr << "Failed to update DB status for failed queue: " << e.what() << std::endl;
+            }
+        }
+
+    } catch (const std::exception &e) {
+        std::cerr << "Error saving WARC/DB: " << e.what() << std::endl;
+    }
+}
+
 int main() {
     std::cout << "--- Crawler Service Started (WARC Mode) ---" << std::endl;
 
@@ -138,116 +286,215 @@ int main() {
     }
 
     // 4. Initialize WarcWriter
-    crawler::WarcWriter warc_writer(WARC_FILENAME);
-    std::string warc_db_filename = get_filename_from_path(WARC_FILENAME);
+    crawler::SegmentOptions warc_options;
+    warc_options.max_segment_bytes = static_cast<int64_t>(WARC_SEGMENT_MAX_MB) * 1024 * 1024;
+    warc_options.max_segment_records = WARC_SEGMENT_MAX_RECORDS;
+    warc_options.writer.sync_every_records = WARC_SYNC_EVERY_RECORDS;
+    warc_options.writer.sync_interval = WARC_SYNC_INTERVAL;
+    if (WARC_CODEC == "zstd") {
+        warc_options.writer.codec = crawler::RecordCodec::Zstd;
+        warc_options.writer.zstd_level = static_cast<int>(WARC_ZSTD_LEVEL);
+        warc_options.dictionary_sample_bytes = WARC_DICTIONARY_SAMPLE_MB * 1024 * 1024;
+    } else if (WARC_CODEC != "gzip") {
+        std::cerr << "Unknown WARC_CODEC " << WARC_CODEC << ", using gzip" << std::endl;
+    }
+    crawler::SegmentedWarcWriter warc_writer(WARC_SEGMENT_PREFIX, warc_options);
+    std::cout << "Writing WARC segment " << warc_writer.current_segment() << std::endl;
 
-    // 5. The Infinite Crawl Loop
-    while (true) {
-        reply = (redisReply*)redisCommand(redis, "LPOP crawl_queue");
-        
-        if (reply == NULL || reply->type == REDIS_REPLY_NIL) {
-            if (reply) freeReplyObject(reply);
-            std::this_thread::sleep_for(std::chrono::seconds(QUEUE_POLL_INTERVAL_SECONDS));
-            continue;
-        }
+    // Pages are compressed and written on their own threads, off the fetch loop
+    crawler::ArchivePool::Options archive_options;
+    archive_options.threads = WARC_WRITER_THREADS;
+    archive_options.max_queued = CRAWL_CONCURRENCY;
+    crawler::ArchivePool archiver(archive_options, [&warc_writer](const std::string& url, const std::string& content) {
+        return warc_writer.write_record(url, content);
+    });
 
-        if (reply->type != REDIS_REPLY_STRING) {
-            std::cerr << "Unexpected Redis reply type: " << reply->type << std::endl;
-            freeReplyObject(reply);
-            continue;
+    // 5. Start the fetch engine
+    crawler::FetcherOptions fetch_options;
+    fetch_options.max_concurrency = CRAWL_CONCURRENCY;
+    fetch_options.max_host_connections = CRAWL_HOST_CONNECTIONS;
+    fetch_options.timeout_seconds = CURL_TIMEOUT_SECONDS;
+    crawler::Fetcher fetcher(fetch_options);
+    std::cout << "Fetching with up to " << CRAWL_CONCURRENCY << " concurrent transfers" << std::endl;
+
+    crawler::DnsResolver::Options dns_options;
+    dns_options.threads = DNS_RESOLVER_THREADS;
+    dns_options.max_entries = DNS_CACHE_SIZE;
+    dns_options.ttl = DNS_CACHE_TTL;
+    crawler::DnsResolver resolver(dns_options);
+    auto last_dns_report = std::chrono::steady_clock::now();
+
+    // 6. Load the visited-URL filter. Postgres stays the source of truth: URLs added after the
+    // last snapshot are simply caught again by ON CONFLICT.
+    std::unique_ptr<crawler::BloomFilter> visited = crawler::BloomFilter::load(BLOOM_SNAPSHOT_PATH);
+    if (visited) {
+        std::cout << "Loaded visited filter with " << visited->size() << " URLs from " << BLOOM_SNAPSHOT_PATH << std::endl;
+    } else {
+        visited = std::make_unique<crawler::BloomFilter>(BLOOM_CAPACITY, BLOOM_FP_RATE);
+        std::cout << "Created visited filter for " << BLOOM_CAPACITY << " URLs ("
+                  << visited->memory_bytes() / (1024 * 1024) << " MB)" << std::endl;
+    }
+    auto last_snapshot = std::chrono::steady_clock::now();
+
+    // 7. The Infinite Crawl Loop
+    crawler::HostScheduler frontier(CRAWL_HOST_DELAY);
+    crawler::RobotsCache::Options robots_options;
+    robots_options.max_hosts = ROBOTS_CACHE_SIZE;
+    crawler::RobotsCache robots(fetch_options.user_agent, robots_options);
+    // Documents already inserted whose host is still being resolved
+    std::vector<std::pair<std::string, int>> awaiting_dns;
+
+    // Records a robots.txt response (status 0 for a failed fetch) and paces the host to match.
+    auto store_robots = [&](const std::string& host, long status, std::string_view body) {
+        const crawler::RobotsRules* rules = robots.store(host, status, body, crawler::RobotsCache::Clock::now());
+        if (!rules) {
+            // The host's URLs stay in the frontier until robots.txt is fetched again
+            std::cerr << "robots.txt unreachable for " << host << ", deferring its URLs" << std::endl;
+            frontier.set_host_delay(host, std::max(CRAWL_HOST_DELAY, ROBOTS_UNREACHABLE_DELAY));
+        } else if (auto delay = rules->crawl_delay()) {
+            // Never below our own delay, which may itself exceed the robots.txt cap
+            auto max_delay = std::max(CRAWL_HOST_DELAY, ROBOTS_MAX_CRAWL_DELAY);
+            frontier.set_host_delay(host, std::clamp(*delay, CRAWL_HOST_DELAY, max_delay));
+        } else {
+            frontier.set_host_delay(host, CRAWL_HOST_DELAY);  // Undoes an earlier deferral
         }
+    };
 
-        std::string url = reply->str;
-        freeReplyObject(reply);
-        
-        if (!is_valid_url(url)) continue;
-        
+    // Hands a document to the fetcher once its host resolves. Returns false while it is pending.
+    auto start_fetch = [&](const std::string& url, int doc_id) {
+        crawler::DnsResolver::Result dns = resolver.resolve(crawler::host_name(url));
+        if (dns.status == crawler::DnsResolver::Status::Pending) return false;
+        if (dns.status == crawler::DnsResolver::Status::Failed) {
+            std::cerr << "Failed to download: " << url << " (could not resolve host)" << std::endl;
+            if (doc_id == ROBOTS_TAG) store_robots(crawler::extract_host(url), 0, {});
+            return true;
+        }
         std::cout << "Fetching: " << url << std::endl;
+        fetcher.add(url, doc_id, crawler::curl_resolve_entries(url, dns.addresses));
+        return true;
+    };
 
-        // B. Insert into DB "Pending"
-        int doc_id = -1;
-        try {
-            pqxx::work W(*C);
-            
-            pqxx::result R = W.exec_params(
-                "INSERT INTO documents (url, status) VALUES ($1, 'processing') ON CONFLICT (url) DO NOTHING RETURNING id",
-                url
-            );
-            
-            if (R.empty()) {
-                std::cout << "Skipping duplicate: " << url << std::endl;
-                W.commit();
+    while (true) {
+        // A. Top up the per-host frontier from Redis
+        if (frontier.size() < FRONTIER_MAX_PENDING) {
+            refill_frontier(redis, frontier, FRONTIER_MAX_PENDING - frontier.size());
+        }
+
+        // Addresses the DNS cache has dropped must not live on in curl's
+        for (const auto& host : resolver.expire()) fetcher.unpin(host);
+
+        // B. Hand the fetcher URLs whose host is ready, inserting them into the DB as "Pending".
+        // Lookups started on earlier iterations go first.
+        awaiting_dns.erase(std::remove_if(awaiting_dns.begin(), awaiting_dns.end(),
+                                          [&](const auto& doc) { return start_fetch(doc.first, doc.second); }),
+                           awaiting_dns.end());
+
+        auto now = crawler::HostScheduler::Clock::now();
+        // URLs whose host's robots.txt is still on its way or unreachable. They rejoin the frontier
+        // after this pass: pushed back right away, a host without a delay would be popped again forever.
+        std::vector<std::string> awaiting_robots;
+        while (fetcher.outstanding() + awaiting_dns.size() < CRAWL_CONCURRENCY) {
+            std::optional<std::string> url = frontier.pop_ready(now);
+            if (!url) break;
+            // Seen before (or, at BLOOM_FP_RATE, a false positive): skip the DB round trip
+            if (visited->possibly_contains(*url)) continue;
+
+            // Check robots.txt before the URL is recorded. Until the host's rules arrive the URL
+            // waits; the host's delay already covers the robots.txt fetch.
+            std::string host = crawler::extract_host(*url);
+            crawler::RobotsCache::Lookup rules = robots.lookup(host, now);
+            if (rules.fetch_needed) {
+                std::string robots_url = url->substr(0, url->find("://") + 3) + host + "/robots.txt";
+                if (!start_fetch(robots_url, ROBOTS_TAG)) awaiting_dns.emplace_back(robots_url, ROBOTS_TAG);
+            }
+            if (!rules.rules) {
+                awaiting_robots.push_back(std::move(*url));
                 continue;
             }
-            
-            doc_id = R[0][0].as<int>();
-            W.commit();
-        } catch (const std::exception &e) {
-            std::cerr << "DB Error: " << e.what() << std::endl;
-            continue;
+            if (!rules.rules->allowed(crawler::robots_path(*url))) {
+                std::cout << "Blocked by robots.txt: " << *url << std::endl;
+                continue;
+            }
+
+            try {
+                pqxx::work W(*C);
+
+                pqxx::result R = W.exec_params(
+                    "INSERT INTO documents (url, status) VALUES ($1, 'processing') ON CONFLICT (url) DO NOTHING RETURNING id",
+                    *url
+                );
+
+                W.commit();
+                visited->insert(*url);
+
+                if (R.empty()) {
+                    std::cout << "Skipping duplicate: " << *url << std::endl;
+                    continue;
+                }
+
+                int doc_id = R[0][0].as<int>();
+                if (!start_fetch(*url, doc_id)) awaiting_dns.emplace_back(*url, doc_id);
+            } catch (const std::exception &e) {
+                std::cerr << "DB Error: " << e.what() << std::endl;
+            }
         }
+        for (auto& url : awaiting_robots) frontier.push(url);
+
+        // D. Pages the archive pool has saved to WARC since the last pass: record them and queue them for indexing
+        for (const auto& page : archiver.poll()) record_page(*C, redis, page);
 
-        // C. Download HTML
-        std::string html = download_url(url);
-        if (html.empty()) {
-            std::cerr << "Failed to download: " << url << std::endl;
+        if (fetcher.outstanding() == 0) {
+            if (!awaiting_dns.empty() || archiver.outstanding() > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            } else if (frontier.empty()) {
+                std::this_thread::sleep_for(std::chrono::seconds(QUEUE_POLL_INTERVAL_SECONDS));
+            } else {
+                // Every queued host is cooling down: wait for the first one, but keep refilling
+                auto wait = *frontier.next_ready_time() - crawler::HostScheduler::Clock::now();
+                std::this_thread::sleep_for(std::min<crawler::HostScheduler::Clock::duration>(wait, FETCH_POLL_INTERVAL));
+            }
             continue;
         }
 
-        // D. Save to WARC
-        try {
-            crawler::WarcRecordInfo info = warc_writer.write_record(url, html);
-
-            // E. Update DB
-            pqxx::work W(*C);
-            W.exec_params(
-                "UPDATE documents SET status = 'crawled', file_path = $1, \"offset\" = $2, length = $3 WHERE id = $4",
-                warc_db_filename, info.offset, info.length, doc_id
-            );
-            W.commit();
-            std::cout << "Saved to WARC at offset " << info.offset << " (" << info.length << " bytes)" << std::endl;
-
-            // F. Push to Indexing Queue with error handling and retries
-            const int MAX_RETRIES = 3;
-            bool push_success = false;
-            for (int attempt = 0; attempt < MAX_RETRIES; ++attempt) {
-                reply = (redisReply*)redisCommand(redis, "RPUSH indexing_queue %d", doc_id);
-                if (reply == NULL) {
-                    std::cerr << "Redis RPUSH failed for doc_id " << doc_id << " (attempt " << (attempt + 1) << "): NULL reply";
-                    if (redis->err) {
-                        std::cerr << ", Redis error: " << redis->errstr;
-                    }
-                    std::cerr << std::endl;
-                    // No reply to free
-                    continue;
-                }
-                if (reply->type == REDIS_REPLY_ERROR) {
-                    std::cerr << "Redis RPUSH error for doc_id " << doc_id << " (attempt " << (attempt + 1) << "): " << reply->str << std::endl;
-                    freeReplyObject(reply);
-                    continue;
-                }
-                // Success
-                freeReplyObject(reply);
-                push_success = true;
-                break;
+        // C. Collect finished downloads and their outlinks
+        std::vector<std::string> outlinks;
+        for (auto& result : fetcher.poll(FETCH_POLL_INTERVAL)) {
+            if (result.tag == ROBOTS_TAG) {
+                store_robots(crawler::extract_host(result.url), result.ok() ? result.status : 0, result.body);
+                continue;
             }
-            if (!push_success) {
-                // Handle failure: update DB status to indicate not queued
-                try {
-                    pqxx::work W_fail(*C);
-                    W_fail.exec_params("UPDATE documents SET status = 'crawled_not_queued' WHERE id = $1", doc_id);
-                    W_fail.commit();
-                    std::cerr << "Failed to queue doc_id " << doc_id << " for indexing after " << MAX_RETRIES << " attempts, marked as crawled_not_queued" << std::endl;
-                } catch (const std::exception &e) {
-                    std::cerr << "Failed to update DB status for failed queue: " << e.what() << std::endl;
-                }
+            if (!result.ok() || result.body.empty()) {
+                std::cerr << "Failed to download: " << result.url
+                          << (result.ok() ? "" : " (" + result.error + ")") << std::endl;
+                continue;
+            }
+            for (auto& link : crawler::extract_links(result.body, result.effective_url)) {
+                if (!visited->possibly_contains(link)) outlinks.push_back(std::move(link));
             }
+            archiver.submit(static_cast<int>(result.tag), result.url, std::move(result.body));
+        }
 
-        } catch (const std::exception &e) {
-            std::cerr << "Error saving WARC/DB: " << e.what() << std::endl;
+        // G. Queue the outlinks to grow the frontier
+        if (!outlinks.empty()) enqueue_links(redis, outlinks);
+
+        // H. Snapshot the visited filter for fast restarts
+        if (std::chrono::steady_clock::now() - last_snapshot >= BLOOM_SNAPSHOT_INTERVAL) {
+            try {
+                visited->save(BLOOM_SNAPSHOT_PATH);
+            } catch (const std::exception &e) {
+                std::cerr << "Visited filter snapshot failed: " << e.what() << std::endl;
+            }
+            last_snapshot = std::chrono::steady_clock::now();
+        }
+
+        // I. Report how well the DNS cache is doing
+        if (std::chrono::steady_clock::now() - last_dns_report >= DNS_STATS_INTERVAL) {
+            crawler::DnsResolver::Stats dns = resolver.stats();
+            std::cout << "DNS cache: " << dns.hits << " hits, " << dns.misses << " misses ("
+                      << static_cast<int>(dns.hit_rate() * 100) << "% hit rate), "
+                      << dns.failures << " failed lookups" << std::endl;
+            last_dns_report = std::chrono::steady_clock::now();
         }
-        
-        std::this_thread::sleep_for(std::chrono::seconds(CRAWL_DELAY_SECONDS));
     }
 
     return 0;
@@ -0,0 +1,73 @@
+#include "record_codec.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <zdict.h>
+
+namespace crawler {
+
+namespace {
+
+const uint32_t SKIPPABLE_MAGIC = 0x184D2A50;
+const uint32_t DICTIONARY_MAGIC = 0xEC30A437;
+const size_t MIN_SAMPLES = 8;
+const uint32_t MAX_DICTIONARY_FRAME = 16 * 1024 * 1024;
+
+uint32_t read_le32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return uint32_t(u[0]) | (uint32_t(u[1]) << 8) | (uint32_t(u[2]) << 16) | (uint32_t(u[3]) << 24);
+}
+
+void append_le32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+} // namespace
+
+std::string train_zstd_dictionary(const std::vector<std::string>& samples, size_t max_size) {
+    if (samples.size() < MIN_SAMPLES) return "";
+
+    std::string concatenated;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        concatenated += sample;
+        sizes.push_back(sample.size());
+    }
+
+    std::string dictionary(max_size, '\0');
+    size_t size = ZDICT_trainFromBuffer(&dictionary[0], dictionary.size(), concatenated.data(), sizes.data(),
+                                        static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(size)) return "";  // Typically too little or too uniform data
+    dictionary.resize(size);
+    return dictionary;
+}
+
+std::string zstd_dictionary_frame(const std::string& dictionary) {
+    std::string frame;
+    frame.reserve(dictionary.size() + 8);
+    append_le32(frame, SKIPPABLE_MAGIC);
+    append_le32(frame, static_cast<uint32_t>(dictionary.size()));
+    frame += dictionary;
+    return frame;
+}
+
+std::string read_zstd_dictionary(std::string_view head) {
+    if (head.size() < 12 || read_le32(head.data()) != SKIPPABLE_MAGIC) return "";
+    size_t size = read_le32(head.data() + 4);
+    if (head.size() - 8 < size || size < 4 || read_le32(head.data() + 8) != DICTIONARY_MAGIC) return "";
+    return std::string(head.substr(8, size));
+}
+
+std::string read_zstd_dictionary_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char header[8];
+    if (!in.read(header, sizeof(header)) || read_le32(header) != SKIPPABLE_MAGIC) return "";
+    if (read_le32(header + 4) > MAX_DICTIONARY_FRAME) return "";
+    std::string head(header, sizeof(header));
+    head.resize(sizeof(header) + read_le32(header + 4));
+    if (!in.read(&head[sizeof(header)], head.size() - sizeof(header))) return "";
+    return read_zstd_dictionary(head);
+}
+
+} // namespace crawler
@@ -0,0 +1,43 @@
+#ifndef RECORD_CODEC_HPP
+#define RECORD_CODEC_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace crawler {
+
+/**
+ * @brief How each WARC record is compressed. Either way every record is its own frame, so a
+ * record can still be read on its own from its offset and length.
+ *
+ * Zstd segments may start with a dictionary stored in a zstd skippable frame (magic 0x184D2A50,
+ * 4-byte little-endian length, then the raw dictionary). Records reference it by dictionary ID,
+ * and readers tell the codecs apart by the first bytes of a record.
+ */
+enum class RecordCodec { Gzip, Zstd };
+
+// Size zstd recommends for dictionaries; larger ones rarely help on HTML.
+constexpr size_t ZSTD_DICTIONARY_SIZE = 112 * 1024;
+
+/**
+ * @brief Trains a zstd dictionary on sample records.
+ * @return The dictionary, or "" if there are too few samples to train on.
+ */
+std::string train_zstd_dictionary(const std::vector<std::string>& samples, size_t max_size = ZSTD_DICTIONARY_SIZE);
+
+// Wraps a dictionary in the skippable frame that heads a zstd segment.
+std::string zstd_dictionary_frame(const std::string& dictionary);
+
+/**
+ * @brief Returns the dictionary stored at the start of a segment, or "" if it has none.
+ * @param head The first bytes of the segment file (at least the whole frame).
+ */
+std::string read_zstd_dictionary(std::string_view head);
+
+// Reads the dictionary from the start of a segment file on disk, or "" if it has none.
+std::string read_zstd_dictionary_file(const std::string& path);
+
+} // namespace crawler
+
+#endif // RECORD_CODEC_HPP
@@ -0,0 +1,272 @@
+#include "robots.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace crawler {
+
+namespace {
+
+const size_t MAX_ROBOTS_BYTES = 500 * 1024;
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+// "%2f" and "%2F" must compare equal; uppercase the hex digits of every escape.
+std::string normalize_escapes(std::string_view s) {
+    std::string out(s);
+    for (size_t i = 0; i + 2 < out.size(); ++i) {
+        if (out[i] == '%' && std::isxdigit(static_cast<unsigned char>(out[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(out[i + 2]))) {
+            out[i + 1] = static_cast<char>(std::toupper(static_cast<unsigned char>(out[i + 1])));
+            out[i + 2] = static_cast<char>(std::toupper(static_cast<unsigned char>(out[i + 2])));
+            i += 2;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+RobotsRules::RobotsRules() : nodes_(1) {}
+
+RobotsRules RobotsRules::parse(std::string_view text, std::string_view user_agent) {
+    std::string_view token = user_agent.substr(0, user_agent.find_first_of("/ "));
+    text = text.substr(0, MAX_ROBOTS_BYTES);
+    if (text.substr(0, 3) == "\xEF\xBB\xBF") text.remove_prefix(3);  // UTF-8 BOM
+
+    struct Line {
+        bool allow;
+        std::string_view value;
+    };
+    std::vector<Line> ours, star;
+    std::optional<double> our_delay, star_delay;
+
+    // A group is a run of user-agent lines followed by rules; a user-agent line after a rule starts the next one.
+    bool group_is_ours = false, group_is_star = false, in_agents = false;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find_first_of("\r\n", pos);
+        if (end == std::string_view::npos) end = text.size();
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        line = line.substr(0, line.find('#'));
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        std::string_view key = trim(line.substr(0, colon));
+        std::string_view value = trim(line.substr(colon + 1));
+
+        if (iequals(key, "user-agent")) {
+            if (!in_agents) group_is_ours = group_is_star = false;
+            in_agents = true;
+            if (value == "*") {
+                group_is_star = true;
+            } else if (!token.empty() && iequals(value.substr(0, value.find_first_of("/ ")), token)) {
+                group_is_ours = true;
+            }
+            continue;
+        }
+
+        bool allow = iequals(key, "allow");
+        if (allow || iequals(key, "disallow")) {
+            in_agents = false;
+            if (group_is_ours) ours.push_back({allow, value});
+            if (group_is_star) star.push_back({allow, value});
+        } else if (iequals(key, "crawl-delay")) {
+            in_agents = false;
+            char* parsed_end = nullptr;
+            std::string number(value);
+            double seconds = std::strtod(number.c_str(), &parsed_end);
+            if (parsed_end == number.c_str() || seconds < 0) continue;
+            if (group_is_ours) our_delay = seconds;
+            if (group_is_star) star_delay = seconds;
+        }
+        // Sitemap and unknown keys neither belong to nor end a group
+    }
+
+    bool use_ours = !ours.empty() || our_delay;
+    RobotsRules rules;
+    for (const Line& line : use_ours ? ours : star) {
+        if (!line.value.empty()) rules.add_rule(line.value, line.allow);
+    }
+    if (std::optional<double> delay = use_ours ? our_delay : star_delay) {
+        rules.crawl_delay_ = std::chrono::milliseconds(static_cast<int64_t>(*delay * 1000));
+    }
+    return rules;
+}
+
+uint32_t RobotsRules::insert_path(std::string_view literal) {
+    uint32_t node = 0;
+    for (char c : literal) {
+        auto& children = nodes_[node].children;
+        auto it = std::find_if(children.begin(), children.end(), [c](const auto& child) { return child.first == c; });
+        if (it != children.end()) {
+            node = it->second;
+            continue;
+        }
+        uint32_t child = static_cast<uint32_t>(nodes_.size());
+        nodes_[node].children.emplace_back(c, child);  // May reallocate nodes_; don't hold references across it
+        nodes_.emplace_back();
+        node = child;
+    }
+    return node;
+}
+
+void RobotsRules::add_rule(std::string_view raw_pattern, bool allow) {
+    std::string pattern = normalize_escapes(raw_pattern);
+    if (pattern[0] != '/' && pattern[0] != '*') pattern.insert(pattern.begin(), '/');
+    ++rule_count_;
+
+    size_t length = pattern.size();
+    bool anchored = pattern.back() == '$';
+    if (anchored) pattern.pop_back();
+    uint8_t kind = allow ? 2 : 1;
+
+    size_t star = pattern.find('*');
+    if (star == std::string::npos) {
+        Node& node = nodes_[insert_path(pattern)];
+        uint8_t& slot = anchored ? node.end_rule : node.rule;
+        slot = std::max(slot, kind);  // The same path as both Allow and Disallow is allowed
+        return;
+    }
+
+    WildcardRule rule{{}, anchored, length, allow};
+    size_t start = 0;
+    while (true) {
+        size_t next = pattern.find('*', start);
+        rule.segments.push_back(pattern.substr(start, next - start));
+        if (next == std::string::npos) break;
+        start = next + 1;
+    }
+    uint32_t node = insert_path(rule.segments[0]);
+    nodes_[node].wildcards.push_back(static_cast<uint32_t>(wildcards_.size()));
+    wildcards_.push_back(std::move(rule));
+}
+
+bool RobotsRules::match_wildcard(const WildcardRule& rule, std::string_view rest) {
+    // segments[0] has already been matched by the trie walk; each '*' takes the leftmost fit
+    size_t pos = 0;
+    size_t last = rule.segments.size() - 1;
+    for (size_t i = 1; i < last; ++i) {
+        size_t found = rest.find(rule.segments[i], pos);
+        if (found == std::string_view::npos) return false;
+        pos = found + rule.segments[i].size();
+    }
+    const std::string& tail = rule.segments[last];
+    if (rule.anchored) {
+        return rest.size() >= pos + tail.size() && rest.compare(rest.size() - tail.size(), tail.size(), tail) == 0;
+    }
+    return rest.find(tail, pos) != std::string_view::npos;
+}
+
+void RobotsRules::consider(Verdict& best, size_t length, bool allow) {
+    if (length > best.length || (length == best.length && allow && best.kind != 2)) {
+        best.length = length;
+        best.kind = allow ? 2 : 1;
+    }
+}
+
+bool RobotsRules::allowed(std::string_view path) const {
+    if (rule_count_ == 0) return true;
+    if (path == "/robots.txt") return true;
+
+    std::string normalized;
+    if (path.find('%') != std::string_view::npos) {
+        normalized = normalize_escapes(path);
+        path = normalized;
+    }
+
+    Verdict best;
+    uint32_t node = 0;
+    for (size_t depth = 0;; ++depth) {
+        const Node& current = nodes_[node];
+        if (current.rule) consider(best, depth, current.rule == 2);
+        if (current.end_rule && depth == path.size()) consider(best, depth + 1, current.end_rule == 2);
+        for (uint32_t index : current.wildcards) {
+            const WildcardRule& rule = wildcards_[index];
+            if (rule.length >= best.length && match_wildcard(rule, path.substr(depth))) {
+                consider(best, rule.length, rule.allow);
+            }
+        }
+
+        if (depth == path.size()) break;
+        char c = path[depth];
+        auto it = std::find_if(current.children.begin(), current.children.end(),
+                               [c](const auto& child) { return child.first == c; });
+        if (it == current.children.end()) break;
+        node = it->second;
+    }
+    return best.kind != 1;
+}
+
+std::string robots_path(const std::string& url) {
+    size_t scheme = url.find("://");
+    if (scheme == std::string::npos) return "/";
+    size_t start = url.find_first_of("/?#", scheme + 3);
+    if (start == std::string::npos || url[start] == '#') return "/";
+    size_t end = url.find('#', start);
+    std::string path = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    if (path[0] == '?') path.insert(path.begin(), '/');
+    return path;
+}
+
+RobotsCache::RobotsCache(std::string user_agent, const Options& options)
+    : user_agent_(std::move(user_agent)), options_(options) {}
+
+RobotsCache::Entry& RobotsCache::touch(const std::string& host) {
+    auto it = entries_.find(host);
+    if (it != entries_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+        return it->second;
+    }
+
+    while (!lru_.empty() && entries_.size() >= std::max<size_t>(1, options_.max_hosts)) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(host);
+    Entry& entry = entries_[host];
+    entry.lru_position = lru_.begin();
+    return entry;
+}
+
+RobotsCache::Lookup RobotsCache::lookup(const std::string& host, Clock::time_point now) {
+    Entry& entry = touch(host);
+    if (entry.expires > now) return {entry.rules.get(), false, !entry.rules};
+
+    bool fetching = entry.fetch_started && now - *entry.fetch_started < options_.fetch_timeout;
+    if (!fetching) entry.fetch_started = now;
+    bool unreachable = !entry.rules && entry.expires != Clock::time_point{};
+    return {entry.rules.get(), !fetching, unreachable};
+}
+
+const RobotsRules* RobotsCache::store(const std::string& host, long status, std::string_view body,
+                                      Clock::time_point now) {
+    Entry& entry = touch(host);
+    entry.fetch_started.reset();
+    if (status >= 200 && status < 300) {
+        entry.rules = std::make_unique<RobotsRules>(RobotsRules::parse(body, user_agent_));
+        entry.expires = now + options_.ttl;
+    } else if (status >= 300 && status < 500 && status != 429) {
+        entry.rules = std::make_unique<RobotsRules>();  // No robots.txt: everything is allowed
+        entry.expires = now + options_.ttl;
+    } else {
+        entry.rules.reset();  // Unreachable, not disallowed: the host's URLs wait for a retry
+        entry.expires = now + options_.error_ttl;
+    }
+    return entry.rules.get();
+}
+
+} // namespace crawler
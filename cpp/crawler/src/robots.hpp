@@ -0,0 +1,146 @@
+#ifndef ROBOTS_HPP
+#define ROBOTS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace crawler {
+
+/**
+ * @brief One host's robots.txt rules for our user agent, compiled for fast matching (RFC 9309).
+ *
+ * Rule paths go into a byte trie, so a lookup walks the URL path once and sees every literal rule
+ * that prefixes it. Rules with '*' hang off the trie node of their literal prefix and are only
+ * tried when the walk reaches that node. The longest matching rule wins; on a tie Allow wins.
+ * A default-constructed RobotsRules allows everything.
+ */
+class RobotsRules {
+public:
+    RobotsRules();
+
+    /**
+     * @brief Parses robots.txt text, keeping the groups that apply to user_agent.
+     *
+     * Groups naming our product token (the user agent up to the first '/', case-insensitive) are
+     * merged; without one the '*' groups are used. Only the first 500 KiB are read.
+     */
+    static RobotsRules parse(std::string_view text, std::string_view user_agent);
+
+    // path is the URL path plus query, e.g. "/wiki/Main_Page?action=edit".
+    bool allowed(std::string_view path) const;
+
+    // Crawl-delay from the selected groups, if any.
+    std::optional<std::chrono::milliseconds> crawl_delay() const { return crawl_delay_; }
+
+    size_t rule_count() const { return rule_count_; }
+
+private:
+    // A rule outcome; kind is 0 for none, otherwise 1 + allow.
+    struct Verdict {
+        size_t length = 0;
+        uint8_t kind = 0;
+    };
+
+    struct WildcardRule {
+        std::vector<std::string> segments;  // Literal pieces between '*'; segments[0] is the trie prefix
+        bool anchored;                      // Pattern ended with '$'
+        size_t length;                      // Length of the pattern as written
+        bool allow;
+    };
+
+    struct Node {
+        std::vector<std::pair<char, uint32_t>> children;
+        uint8_t rule = 0;       // Literal rule ending here (1 + allow)
+        uint8_t end_rule = 0;   // Literal rule ending here with '$'
+        std::vector<uint32_t> wildcards;  // Indexes into wildcards_
+    };
+
+    void add_rule(std::string_view pattern, bool allow);
+    uint32_t insert_path(std::string_view literal);
+    static bool match_wildcard(const WildcardRule& rule, std::string_view rest);
+    static void consider(Verdict& best, size_t length, bool allow);
+
+    std::vector<Node> nodes_;
+    std::vector<WildcardRule> wildcards_;
+    std::optional<std::chrono::milliseconds> crawl_delay_;
+    size_t rule_count_ = 0;
+};
+
+/**
+ * @brief Returns the path and query of an absolute URL ("/" if it has none), as matched by robots.txt.
+ */
+std::string robots_path(const std::string& url);
+
+/**
+ * @brief Per-host cache of compiled robots.txt rules with a TTL and an LRU bound.
+ *
+ * The crawl loop asks lookup() before fetching a URL. A host is reported as needing a fetch
+ * exactly once until store() records the response (or the fetch is presumed lost after
+ * fetch_timeout), so every host's robots.txt is downloaded once per TTL.
+ *
+ * A host whose robots.txt could not be fetched is unreachable, not disallowed: its URLs should
+ * wait and be tried again once error_ttl has passed and robots.txt has been fetched again.
+ *
+ * @note Not thread-safe.
+ */
+class RobotsCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        size_t max_hosts = 100000;
+        Clock::duration ttl = std::chrono::hours(24);
+        Clock::duration error_ttl = std::chrono::hours(1);  // Before an unreachable robots.txt is retried
+        Clock::duration fetch_timeout = std::chrono::minutes(5);
+    };
+
+    struct Lookup {
+        const RobotsRules* rules;  // Current (or, while refreshing, stale) rules; nullptr if none yet
+                                   // or the host is unreachable
+        bool fetch_needed;         // The caller should fetch robots.txt and store() the response
+        bool unreachable;          // The last fetch failed: hold the host's URLs back
+    };
+
+    RobotsCache(std::string user_agent, const Options& options);
+
+    Lookup lookup(const std::string& host, Clock::time_point now);
+
+    /**
+     * @brief Records a robots.txt response for host and returns the rules now in effect.
+     * @param status HTTP status after redirects, or 0 if the transfer (or the host lookup) failed.
+     * @return nullptr if the host is now unreachable.
+     *
+     * 2xx bodies are parsed. 3xx (redirects curl gave up on) and 4xx other than 429 mean there
+     * are no rules. 429, 5xx and failures make the host unreachable until error_ttl passes and a
+     * new fetch succeeds.
+     */
+    const RobotsRules* store(const std::string& host, long status, std::string_view body, Clock::time_point now);
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        std::unique_ptr<RobotsRules> rules;  // Null until a fetch succeeds, and while unreachable
+        Clock::time_point expires{};
+        std::optional<Clock::time_point> fetch_started;
+        std::list<std::string>::iterator lru_position;
+    };
+
+    Entry& touch(const std::string& host);
+
+    const std::string user_agent_;
+    const Options options_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;  // Most recently used first
+};
+
+} // namespace crawler
+
+#endif // ROBOTS_HPP
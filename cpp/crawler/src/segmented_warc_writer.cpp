@@ -0,0 +1,349 @@
+#include "segmented_warc_writer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <zlib.h>
+#include <zstd.h>
+
+namespace crawler {
+
+namespace {
+
+const char* const SEGMENT_SUFFIXES[] = {".warc.gz", ".warc.zst"};
+const size_t MAX_HEADER_BYTES = 64 * 1024;
+const size_t MAX_SAMPLE_BYTES = 16 * 1024;  // Page starts carry most of the shared markup
+
+const char* segment_suffix(const std::string& path) {
+    for (const char* suffix : SEGMENT_SUFFIXES) {
+        size_t size = std::strlen(suffix);
+        if (path.size() > size && path.compare(path.size() - size, size, suffix) == 0) return suffix;
+    }
+    return nullptr;
+}
+
+// CDX timestamp of a record from its WARC-Date: 2024-01-31T23:59:59Z becomes 20240131235959.
+std::string cdx_timestamp(std::string warc_date) {
+    warc_date.erase(std::remove_if(warc_date.begin(), warc_date.end(), [](char c) { return c < '0' || c > '9'; }),
+                    warc_date.end());
+    return warc_date;
+}
+
+// CDX fields are space separated, so spaces (and stray line breaks) in URLs are escaped.
+std::string cdx_escape(const std::string& url) {
+    std::string out;
+    out.reserve(url.size());
+    for (char c : url) {
+        if (c == ' ') out += "%20";
+        else if (c == '\n') out += "%0A";
+        else if (c == '\r') out += "%0D";
+        else out += c;
+    }
+    return out;
+}
+
+std::string header_field(const std::string& header, const std::string& name) {
+    size_t pos = header.find("\r\n" + name + ":");
+    if (pos == std::string::npos) return "";
+    pos += name.size() + 3;
+    size_t end = header.find("\r\n", pos);
+    std::string value = header.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    size_t first = value.find_first_not_of(' ');
+    return first == std::string::npos ? "" : value.substr(first);
+}
+
+std::string filename_of(const std::string& path) {
+    return std::filesystem::path(path).filename().string();
+}
+
+// Collects a record's index entry once the start of its header has been decompressed.
+class RecordCollector {
+public:
+    void append(const char* data, size_t size) {
+        if (header_.size() < MAX_HEADER_BYTES && header_.find("\r\n\r\n") == std::string::npos) {
+            header_.append(data, std::min(size, MAX_HEADER_BYTES - header_.size()));
+        }
+    }
+
+    void finish(int64_t end) {
+        std::string date = cdx_timestamp(header_field(header_, "WARC-Date"));
+        std::string digest = header_field(header_, "WARC-Payload-Digest");
+        if (digest.compare(0, 5, "sha1:") == 0) digest.erase(0, 5);
+        entries.push_back({header_field(header_, "WARC-Target-URI"), date, digest, start_, end - start_});
+        start_ = end;
+        header_.clear();
+    }
+
+    void set_start(int64_t start) { start_ = start; }
+
+    std::vector<CdxEntry> entries;
+
+private:
+    std::string header_;  // Start of the current record, up to the end of its WARC header
+    int64_t start_ = 0;
+};
+
+void scan_gzip_members(std::ifstream& in, RecordCollector& records) {
+    z_stream zs{};
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) throw std::runtime_error("inflateInit2 failed while indexing.");
+    struct ZStreamGuard {
+        z_stream* zs_ptr;
+        ~ZStreamGuard() { inflateEnd(zs_ptr); }
+    } guard{&zs};
+
+    std::vector<char> input(1 << 16);
+    char output[1 << 16];
+    int64_t bytes_read = 0;
+    bool output_full = false;  // inflate may hold more output even with no input left
+
+    while (true) {
+        if (zs.avail_in == 0 && !output_full) {
+            in.read(input.data(), input.size());
+            std::streamsize got = in.gcount();
+            if (got <= 0) break;
+            bytes_read += got;
+            zs.next_in = reinterpret_cast<Bytef*>(input.data());
+            zs.avail_in = static_cast<uInt>(got);
+        }
+
+        zs.next_out = reinterpret_cast<Bytef*>(output);
+        zs.avail_out = sizeof(output);
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) break;  // Corrupt tail: index what came before
+        output_full = zs.avail_out == 0;
+        records.append(output, sizeof(output) - zs.avail_out);
+
+        if (ret == Z_STREAM_END) {
+            records.finish(bytes_read - zs.avail_in);
+            inflateReset(&zs);
+        }
+    }
+}
+
+void scan_zstd_frames(std::ifstream& in, const std::string& dictionary, int64_t start, RecordCollector& records) {
+    struct DCtxGuard {
+        ZSTD_DCtx* dctx = ZSTD_createDCtx();
+        ~DCtxGuard() { ZSTD_freeDCtx(dctx); }
+    } guard;
+    if (!guard.dctx) throw std::runtime_error("ZSTD_createDCtx failed while indexing.");
+    if (!dictionary.empty()) ZSTD_DCtx_loadDictionary(guard.dctx, dictionary.data(), dictionary.size());
+
+    in.seekg(start);
+    records.set_start(start);
+    std::vector<char> input(1 << 16);
+    char output[1 << 16];
+    int64_t bytes_read = start;
+    ZSTD_inBuffer in_buf{input.data(), 0, 0};
+    bool output_full = false;
+
+    while (true) {
+        if (in_buf.pos == in_buf.size && !output_full) {
+            in.read(input.data(), input.size());
+            std::streamsize got = in.gcount();
+            if (got <= 0) break;
+            bytes_read += got;
+            in_buf = {input.data(), static_cast<size_t>(got), 0};
+        }
+
+        ZSTD_outBuffer out_buf{output, sizeof(output), 0};
+        size_t ret = ZSTD_decompressStream(guard.dctx, &out_buf, &in_buf);
+        if (ZSTD_isError(ret)) break;  // Corrupt tail: index what came before
+        output_full = out_buf.pos == out_buf.size;
+        records.append(output, out_buf.pos);
+
+        if (ret == 0) records.finish(bytes_read - static_cast<int64_t>(in_buf.size - in_buf.pos));
+    }
+}
+
+} // namespace
+
+SegmentedWarcWriter::Segment::~Segment() {
+    try {
+        writer.reset();  // Syncs per the writer's policy and closes the file
+        if (entries.empty()) {
+            std::filesystem::remove(path);  // Don't leave empty segments behind on every restart
+        } else {
+            write_cdx(path, std::move(entries));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to close WARC segment " << path << ": " << e.what() << std::endl;
+    }
+}
+
+SegmentedWarcWriter::SegmentedWarcWriter(std::string prefix, const SegmentOptions& options)
+    : prefix_(std::move(prefix)), options_(options) {
+    std::filesystem::path base(prefix_);
+    std::filesystem::path dir = base.has_parent_path() ? base.parent_path() : std::filesystem::path(".");
+    std::string stem = base.filename().string() + "_";
+
+    dictionary_ = options_.writer.zstd_dictionary;
+    std::string latest_zstd_segment;
+
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(dir, ec)) {
+        std::string name = file.path().filename().string();
+        const char* suffix = segment_suffix(name);
+        if (!suffix || name.size() <= stem.size() + std::strlen(suffix) || name.compare(0, stem.size(), stem) != 0) {
+            continue;
+        }
+        std::string digits = name.substr(stem.size(), name.size() - stem.size() - std::strlen(suffix));
+        if (digits.find_first_not_of("0123456789") != std::string::npos) continue;
+
+        uint32_t number = static_cast<uint32_t>(std::stoul(digits));
+        if (number + 1 > next_number_) {
+            next_number_ = number + 1;
+            if (std::strcmp(suffix, ".warc.zst") == 0) latest_zstd_segment = file.path().string();
+        }
+        if (!std::filesystem::exists(cdx_path(file.path().string()))) {
+            index_segment(file.path().string());  // Left open by a run that did not shut down cleanly
+        }
+    }
+
+    // Carry on with the newest dictionary rather than starting over without one
+    if (options_.writer.codec == RecordCodec::Zstd && !latest_zstd_segment.empty()) {
+        std::string dictionary = read_zstd_dictionary_file(latest_zstd_segment);
+        if (!dictionary.empty()) dictionary_ = std::move(dictionary);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_ = open_segment_locked();
+}
+
+SegmentedWarcWriter::~SegmentedWarcWriter() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_.reset();
+}
+
+std::shared_ptr<SegmentedWarcWriter::Segment> SegmentedWarcWriter::open_segment_locked() {
+    auto segment = std::make_shared<Segment>();
+    segment->path = segment_path(prefix_, next_number_, options_.writer.codec);
+    WarcWriterOptions writer_options = options_.writer;
+    writer_options.zstd_dictionary = dictionary_;
+    segment->writer = std::make_unique<WarcWriter>(segment->path, writer_options);
+    ++next_number_;
+    current_records_ = 0;
+    return segment;
+}
+
+WarcRecordInfo SegmentedWarcWriter::write_record(const std::string& url, const std::string& content) {
+    std::shared_ptr<Segment> segment;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        segment = current_;
+        if (options_.max_segment_records > 0 && ++current_records_ >= options_.max_segment_records) {
+            current_ = open_segment_locked();  // This record still goes to the segment it was counted in
+        }
+    }
+
+    WarcRecordInfo info = segment->writer->write_record(url, content);
+
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(segment->entries_mutex);
+        segment->entries.push_back({url, cdx_timestamp(info.warc_date), info.payload_digest, info.offset, info.length});
+        segment->bytes += info.length;
+        full = segment->bytes >= options_.max_segment_bytes;
+    }
+    if (options_.writer.codec == RecordCodec::Zstd && options_.dictionary_sample_bytes > 0) {
+        sample_record(*segment, content);
+    }
+    if (full) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_ == segment) current_ = open_segment_locked();
+    }
+    return info;
+}
+
+void SegmentedWarcWriter::sample_record(Segment& segment, const std::string& content) {
+    std::vector<std::string> samples;
+    {
+        std::lock_guard<std::mutex> lock(segment.entries_mutex);
+        if (segment.sampled) return;
+        segment.samples.push_back(content.substr(0, MAX_SAMPLE_BYTES));
+        segment.sample_bytes += segment.samples.back().size();
+        if (segment.sample_bytes < options_.dictionary_sample_bytes) return;
+        segment.sampled = true;
+        samples.swap(segment.samples);
+    }
+
+    // Training takes a while, so only the one thread that filled the sample does it, outside every lock
+    std::string dictionary = train_zstd_dictionary(samples);
+    if (dictionary.empty()) return;  // Keep the dictionary in use
+    std::lock_guard<std::mutex> lock(mutex_);
+    dictionary_ = std::move(dictionary);
+}
+
+void SegmentedWarcWriter::rotate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_ = open_segment_locked();
+}
+
+std::string SegmentedWarcWriter::current_segment() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_->path;
+}
+
+std::string SegmentedWarcWriter::segment_path(const std::string& prefix, uint32_t number, RecordCodec codec) {
+    char digits[16];
+    std::snprintf(digits, sizeof(digits), "_%05u", number);
+    return prefix + digits + SEGMENT_SUFFIXES[codec == RecordCodec::Zstd ? 1 : 0];
+}
+
+std::string SegmentedWarcWriter::cdx_path(const std::string& segment_path) {
+    if (const char* suffix = segment_suffix(segment_path)) {
+        return segment_path.substr(0, segment_path.size() - std::strlen(suffix)) + ".cdx";
+    }
+    return segment_path + ".cdx";
+}
+
+void SegmentedWarcWriter::write_cdx(const std::string& segment_path, std::vector<CdxEntry> entries) {
+    std::sort(entries.begin(), entries.end(),
+              [](const CdxEntry& a, const CdxEntry& b) { return a.offset < b.offset; });
+
+    std::string path = cdx_path(segment_path);
+    std::string tmp_path = path + ".tmp";
+    std::string segment_name = filename_of(segment_path);
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Failed to open CDX file: " + tmp_path);
+        out << " CDX a b k S V g\n";
+        for (const CdxEntry& entry : entries) {
+            out << cdx_escape(entry.url) << ' ' << entry.timestamp << ' '
+                << (entry.digest.empty() ? "-" : entry.digest) << ' '
+                << entry.length << ' ' << entry.offset << ' ' << segment_name << '\n';
+        }
+        out.flush();
+        if (!out) throw std::runtime_error("Failed to write CDX file: " + tmp_path);
+    }
+    std::filesystem::rename(tmp_path, path);  // Readers never see a half-written index
+}
+
+size_t SegmentedWarcWriter::index_segment(const std::string& segment_path) {
+    std::ifstream in(segment_path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open WARC segment: " + segment_path);
+
+    unsigned char magic[4] = {};
+    in.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    in.clear();
+    in.seekg(0);
+
+    RecordCollector records;
+    if (magic[0] == 0x1f && magic[1] == 0x8b) {
+        scan_gzip_members(in, records);
+    } else {
+        // Zstd: records start after the dictionary frame, if there is one
+        std::string dictionary = read_zstd_dictionary_file(segment_path);
+        int64_t start = dictionary.empty() ? 0 : static_cast<int64_t>(zstd_dictionary_frame(dictionary).size());
+        scan_zstd_frames(in, dictionary, start, records);
+    }
+
+    size_t count = records.entries.size();
+    write_cdx(segment_path, std::move(records.entries));
+    return count;
+}
+
+} // namespace crawler
@@ -0,0 +1,125 @@
+#ifndef SEGMENTED_WARC_WRITER_HPP
+#define SEGMENTED_WARC_WRITER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "warc_writer.hpp"
+
+namespace crawler {
+
+// One line of a segment's CDX index.
+struct CdxEntry {
+    std::string url;
+    std::string timestamp;  // 14-digit UTC, e.g. 20240131235959
+    std::string digest;     // Base32 SHA-1 of the payload
+    int64_t offset;
+    int64_t length;
+};
+
+struct SegmentOptions {
+    int64_t max_segment_bytes = int64_t(1) << 30;
+    size_t max_segment_records = 0;  // 0 means no record limit
+    // With the zstd codec, page bytes sampled from a segment to train the next segment's
+    // dictionary; 0 keeps whatever dictionary the writer options start with.
+    size_t dictionary_sample_bytes = 8 * 1024 * 1024;
+    WarcWriterOptions writer;
+};
+
+/**
+ * @brief Writes WARC records into size-bounded segments, each with a CDX sidecar index.
+ *
+ * Segments are named <prefix>_NNNNN.warc.gz (.warc.zst with the zstd codec) and numbered after the highest one already on disk, so
+ * a restart never appends to a file another run left open. Once a segment passes either limit
+ * the next record starts a new one. When the last record of a closed segment is written, its index
+ * is written next to it as <prefix>_NNNNN.cdx:
+ *
+ *     CDX a b k S V g
+ *     <url> <timestamp> <digest> <length> <offset> <segment file name>
+ *
+ * Lines are in file (offset) order, so a reader can split a segment into byte ranges or find a
+ * record without touching Postgres.
+ *
+ * With the zstd codec, the first pages of each segment are sampled and, once enough are in, a
+ * dictionary is trained from them for the segments that follow. Each segment stores the dictionary
+ * its records were compressed with at its start, so it stays readable on its own.
+ *
+ * @note Thread-safe. Records are written through WarcWriter, so compression stays parallel.
+ */
+class SegmentedWarcWriter {
+public:
+    /**
+     * @brief Opens a new segment after any existing ones, indexing segments that have no CDX yet.
+     * @throws std::runtime_error if the segment cannot be created.
+     */
+    explicit SegmentedWarcWriter(std::string prefix, const SegmentOptions& options = {});
+
+    // Closes the open segment and writes its index.
+    ~SegmentedWarcWriter();
+
+    SegmentedWarcWriter(const SegmentedWarcWriter&) = delete;
+    SegmentedWarcWriter& operator=(const SegmentedWarcWriter&) = delete;
+
+    /**
+     * @brief Writes a record to the open segment; WarcRecordInfo::filename names that segment.
+     * @throws std::runtime_error if writing fails.
+     */
+    WarcRecordInfo write_record(const std::string& url, const std::string& content);
+
+    // Closes the open segment (its index is written once in-flight records finish) and starts the next.
+    void rotate();
+
+    // Path of the segment currently receiving records.
+    std::string current_segment() const;
+
+    static std::string segment_path(const std::string& prefix, uint32_t number,
+                                    RecordCodec codec = RecordCodec::Gzip);
+
+    // Sidecar index path for a segment: the .warc.gz or .warc.zst suffix replaced by .cdx.
+    static std::string cdx_path(const std::string& segment_path);
+
+    /**
+     * @brief Rebuilds a segment's index by scanning its gzip members or zstd frames.
+     *
+     * Used for segments a crash left without an index. A truncated final member (a write cut
+     * short) is left out.
+     * @return The number of records indexed.
+     */
+    static size_t index_segment(const std::string& segment_path);
+
+    static void write_cdx(const std::string& segment_path, std::vector<CdxEntry> entries);
+
+private:
+    // Shared by every write in flight on it; the last owner closes the file and writes the index.
+    struct Segment {
+        std::string path;
+        std::unique_ptr<WarcWriter> writer;
+        std::mutex entries_mutex;
+        std::vector<CdxEntry> entries;
+        int64_t bytes = 0;  // Guarded by entries_mutex
+        std::vector<std::string> samples;  // Guarded by entries_mutex, as are the two below
+        size_t sample_bytes = 0;
+        bool sampled = false;  // Samples were handed off for training
+
+        ~Segment();
+    };
+
+    std::shared_ptr<Segment> open_segment_locked();
+    void sample_record(Segment& segment, const std::string& content);
+
+    const std::string prefix_;
+    const SegmentOptions options_;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<Segment> current_;
+    uint32_t next_number_ = 1;
+    size_t current_records_ = 0;  // Records handed to current_, counted before they are written
+    std::string dictionary_;  // zstd dictionary for the next segment opened
+};
+
+} // namespace crawler
+
+#endif // SEGMENTED_WARC_WRITER_HPP
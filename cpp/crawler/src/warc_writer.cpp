@@ -1,54 +1,142 @@
 #include "warc_writer.hpp"
-#include <sstream>
-#include <iomanip>
-#include <ctime>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
 #include <cstring>
+#include <ctime>
 #include <stdexcept>
 #include <random>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include <zlib.h>
+#include <zstd.h>
 
 namespace crawler {
 
-WarcWriter::WarcWriter(const std::string& filename) : filename(filename) {
-    file_stream.open(filename, std::ios::binary | std::ios::app);
-    if (!file_stream.is_open()) {
-        throw std::runtime_error("Failed to open WARC file: " + filename);
-    }
+namespace {
+
+const char RECORD_TRAILER[] = "\r\n\r\n";
+
+uint32_t rotl(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
 }
 
-WarcWriter::~WarcWriter() {
-    if (file_stream.is_open()) {
-        file_stream.close();
+// FIPS 180-4 SHA-1. Only used for content digests, never for security.
+std::array<uint8_t, 20> sha1(std::string_view data) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    auto process = [&h](const uint8_t* block) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (uint32_t(block[4 * i]) << 24) | (uint32_t(block[4 * i + 1]) << 16) |
+                   (uint32_t(block[4 * i + 2]) << 8) | uint32_t(block[4 * i + 3]);
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    };
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    size_t full_blocks = data.size() / 64;
+    for (size_t i = 0; i < full_blocks; ++i) process(bytes + 64 * i);
+
+    // Padding: 0x80, zeros, then the bit length big-endian, in one or two final blocks
+    uint8_t tail[128] = {};
+    size_t rest = data.size() - full_blocks * 64;
+    std::memcpy(tail, bytes + full_blocks * 64, rest);
+    tail[rest] = 0x80;
+    size_t tail_size = rest < 56 ? 64 : 128;
+    uint64_t bit_length = static_cast<uint64_t>(data.size()) * 8;
+    for (int i = 0; i < 8; ++i) tail[tail_size - 1 - i] = static_cast<uint8_t>(bit_length >> (8 * i));
+    process(tail);
+    if (tail_size == 128) process(tail + 64);
+
+    std::array<uint8_t, 20> digest;
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 4; ++j) digest[4 * i + j] = static_cast<uint8_t>(h[i] >> (24 - 8 * j));
     }
+    return digest;
 }
 
-WarcRecordInfo WarcWriter::write_record(const std::string& url, const std::string& content) {
-    std::lock_guard<std::mutex> lock(write_mutex);
-    
-    std::string warc_header = create_warc_header(url, content.size());
-    std::string full_record = warc_header + content + "\r\n\r\n";
-    std::string compressed_record = compress_string(full_record);
+// One deflate stream per thread, reset between records instead of reallocated.
+struct Deflater {
+    z_stream zs;
+    int level = 0;
+    bool initialized = false;
 
-    file_stream.seekp(0, std::ios::end);
-    int64_t offset = file_stream.tellp();
-    
-    file_stream.write(compressed_record.data(), compressed_record.size());
-    
-    if (!file_stream.good()) {
-        throw std::runtime_error("Failed to write WARC record to file: write error");
+    ~Deflater() {
+        if (initialized) deflateEnd(&zs);
     }
-    
-    // Ensure data is written to disk
-    file_stream.flush();
-    
-    if (!file_stream.good()) {
-        throw std::runtime_error("Failed to write WARC record to file: flush error");
+
+    void start(int new_level) {
+        if (initialized && level == new_level) {
+            deflateReset(&zs);
+            return;
+        }
+        if (initialized) deflateEnd(&zs);
+        memset(&zs, 0, sizeof(zs));
+        initialized = false;
+        if (deflateInit2(&zs, new_level, Z_DEFLATED, 15 | 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("deflateInit2 failed while compressing.");
+        }
+        initialized = true;
+        level = new_level;
     }
+};
 
-    return {offset, static_cast<int64_t>(compressed_record.size())};
+// Feeds one piece of input to deflate, growing out as needed.
+void deflate_piece(z_stream& zs, std::string& out, const char* data, size_t size, int flush) {
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = static_cast<uInt>(size);
+    while (true) {
+        if (zs.avail_out == 0) {
+            size_t used = out.size();
+            out.resize(used * 2);
+            zs.next_out = reinterpret_cast<Bytef*>(&out[used]);
+            zs.avail_out = static_cast<uInt>(out.size() - used);
+        }
+        int ret = deflate(&zs, flush);
+        if (ret == Z_STREAM_END) return;
+        if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            std::string msg = zs.msg ? zs.msg : "unknown error";
+            throw std::runtime_error("Exception during zlib compression: (" + std::to_string(ret) + ") " + msg);
+        }
+        if (flush == Z_NO_FLUSH && zs.avail_in == 0) return;
+    }
 }
 
-std::string WarcWriter::create_warc_header(const std::string& url, size_t content_length) {
+// The current time as a WARC-Date, e.g. 2024-01-31T23:59:59Z.
+std::string warc_date_now() {
     std::time_t now = std::time(nullptr);
     char buf[100];
     struct tm tm_buf;
@@ -59,17 +147,208 @@ std::string WarcWriter::create_warc_header(const std::string& url, size_t conten
         gmtime_r(&now, &tm_buf);
     #endif
     std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm_buf);
-    
-    std::stringstream ss;
-    ss << "WARC/1.0\r\n";
-    ss << "WARC-Type: response\r\n";
-    ss << "WARC-Target-URI: " << url << "\r\n";
-    ss << "WARC-Date: " << buf << "\r\n";
-    ss << "WARC-Record-ID: <urn:uuid:" << generate_uuid() << ">\r\n";
-    ss << "Content-Type: application/http; msgtype=response\r\n";
-    ss << "Content-Length: " << content_length << "\r\n";
-    ss << "\r\n";
-    return ss.str();
+    return buf;
+}
+
+// Writes every record with as few pwritev() calls as IOV_MAX allows, resuming after short writes.
+void write_records(int fd, const std::vector<const std::string*>& records, int64_t offset) {
+    std::vector<iovec> iov;
+    iov.reserve(records.size());
+    for (const std::string* record : records) {
+        iov.push_back({const_cast<char*>(record->data()), record->size()});
+    }
+
+    size_t first = 0;
+    while (first < iov.size()) {
+        int count = static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX));
+        ssize_t written = pwritev(fd, &iov[first], count, offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("pwritev failed: ") + std::strerror(errno));
+        }
+        offset += written;
+        size_t remaining = static_cast<size_t>(written);
+        while (first < iov.size() && remaining >= iov[first].iov_len) {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+}
+
+// One zstd context per thread; contexts keep their workspace between records.
+struct ZstdContext {
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    ~ZstdContext() { ZSTD_freeCCtx(cctx); }
+};
+
+void checked_fdatasync(int fd) {
+    if (fdatasync(fd) != 0) {
+        throw std::runtime_error(std::string("fdatasync failed: ") + std::strerror(errno));
+    }
+}
+
+} // namespace
+
+std::string warc_payload_digest(std::string_view payload) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+    std::array<uint8_t, 20> digest = sha1(payload);
+    // 160 bits are exactly 32 base32 characters, so there is no padding
+    std::string out;
+    out.reserve(32);
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (uint8_t byte : digest) {
+        buffer = (buffer << 8) | byte;
+        bits += 8;
+        while (bits >= 5) {
+            out += ALPHABET[(buffer >> (bits - 5)) & 31];
+            bits -= 5;
+        }
+    }
+    return out;
+}
+
+WarcWriter::WarcWriter(const std::string& filename, const WarcWriterOptions& options)
+    : filename(filename), options(options), last_sync(std::chrono::steady_clock::now()) {
+    // No O_APPEND: on Linux it makes pwrite() ignore the offset
+    fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open WARC file: " + filename);
+    }
+    end_offset = lseek(fd, 0, SEEK_END);
+    if (end_offset < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to seek WARC file: " + filename);
+    }
+
+    if (options.codec == RecordCodec::Zstd && !options.zstd_dictionary.empty()) {
+        try {
+            if (end_offset == 0) {
+                // The dictionary heads the file, so records start right after it
+                std::string frame = zstd_dictionary_frame(options.zstd_dictionary);
+                write_records(fd, {&frame}, 0);
+                end_offset = static_cast<int64_t>(frame.size());
+            } else if (read_zstd_dictionary_file(filename) != options.zstd_dictionary) {
+                throw std::runtime_error("WARC file was started with a different zstd dictionary: " + filename);
+            }
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+        zstd_dictionary = ZSTD_createCDict(options.zstd_dictionary.data(), options.zstd_dictionary.size(),
+                                           options.zstd_level);
+        if (!zstd_dictionary) {
+            close(fd);
+            throw std::runtime_error("Failed to load zstd dictionary for: " + filename);
+        }
+    }
+}
+
+WarcWriter::~WarcWriter() {
+    if (write_error.empty() && (options.sync_every_records > 0 || options.sync_interval.count() > 0)) {
+        fdatasync(fd);
+    }
+    close(fd);
+    ZSTD_freeCDict(zstd_dictionary);
+}
+
+WarcRecordInfo WarcWriter::write_record(const std::string& url, const std::string& content) {
+    // Digest and compression are the expensive parts and run on the calling thread, outside the lock
+    std::string digest = warc_payload_digest(content);
+    std::string warc_date = warc_date_now();
+    std::string compressed_record =
+        compress_record(create_warc_header(url, content.size(), digest, warc_date), content);
+
+    std::unique_lock<std::mutex> lock(write_mutex);
+    if (!write_error.empty()) {
+        throw std::runtime_error(write_error);
+    }
+    int64_t offset = end_offset;
+    end_offset += static_cast<int64_t>(compressed_record.size());
+    uint64_t sequence = next_sequence++;
+    pending.push_back({&compressed_record, offset, sequence});
+
+    while (written_sequence < sequence && write_error.empty()) {
+        if (leader_active) {
+            batch_done.wait(lock);
+        } else {
+            write_batch(lock);
+        }
+    }
+    if (written_sequence < sequence) {
+        throw std::runtime_error(write_error);
+    }
+
+    return {offset, static_cast<int64_t>(compressed_record.size()), filename, std::move(digest), std::move(warc_date)};
+}
+
+void WarcWriter::write_batch(std::unique_lock<std::mutex>& lock) {
+    leader_active = true;
+    std::vector<PendingRecord> batch;
+    batch.swap(pending);
+    records_since_sync += batch.size();
+    bool sync_now = sync_due();
+
+    std::vector<const std::string*> records;
+    records.reserve(batch.size());
+    for (const auto& record : batch) records.push_back(record.data);
+
+    // Later callers queue up behind this batch while it is written
+    lock.unlock();
+    std::string error;
+    try {
+        write_records(fd, records, batch.front().offset);
+        if (sync_now) checked_fdatasync(fd);
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    lock.lock();
+
+    leader_active = false;
+    if (error.empty()) {
+        written_sequence = batch.back().sequence;
+        if (sync_now) {
+            records_since_sync = 0;
+            last_sync = std::chrono::steady_clock::now();
+        }
+    } else {
+        write_error = "Failed to write WARC record to file: " + error;
+        pending.clear();  // Their callers see write_error and give up
+    }
+    batch_done.notify_all();
+}
+
+bool WarcWriter::sync_due() const {
+    if (options.sync_every_records > 0 && records_since_sync >= options.sync_every_records) return true;
+    return options.sync_interval.count() > 0 &&
+           std::chrono::steady_clock::now() - last_sync >= options.sync_interval;
+}
+
+void WarcWriter::sync() {
+    checked_fdatasync(fd);
+    std::lock_guard<std::mutex> lock(write_mutex);
+    records_since_sync = 0;
+    last_sync = std::chrono::steady_clock::now();
+}
+
+std::string WarcWriter::create_warc_header(const std::string& url, size_t content_length, const std::string& digest,
+                                           const std::string& warc_date) {
+    std::string header;
+    header.reserve(256 + url.size());
+    header += "WARC/1.0\r\n";
+    header += "WARC-Type: response\r\n";
+    header += "WARC-Target-URI: " + url + "\r\n";
+    header += "WARC-Date: " + warc_date + "\r\n";
+    header += "WARC-Record-ID: <urn:uuid:" + generate_uuid() + ">\r\n";
+    header += "WARC-Payload-Digest: sha1:" + digest + "\r\n";
+    header += "Content-Type: application/http; msgtype=response\r\n";
+    header += "Content-Length: " + std::to_string(content_length) + "\r\n";
+    header += "\r\n";
+    return header;
 }
 
 std::string WarcWriter::generate_uuid() {
@@ -85,55 +364,70 @@ std::string WarcWriter::generate_uuid() {
     part1 = (part1 & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;
     part2 = (part2 & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
 
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0') 
-       << std::setw(8) << (part1 >> 32) << "-"
-       << std::setw(4) << ((part1 >> 16) & 0xFFFF) << "-"
-       << std::setw(4) << (part1 & 0xFFFF) << "-"
-       << std::setw(4) << (part2 >> 48) << "-"
-       << std::setw(12) << (part2 & 0xFFFFFFFFFFFFULL);
-    
-    return ss.str();
+    char uuid[37];
+    std::snprintf(uuid, sizeof(uuid), "%08llx-%04llx-%04llx-%04llx-%012llx",
+                  static_cast<unsigned long long>(part1 >> 32),
+                  static_cast<unsigned long long>((part1 >> 16) & 0xFFFF),
+                  static_cast<unsigned long long>(part1 & 0xFFFF),
+                  static_cast<unsigned long long>(part2 >> 48),
+                  static_cast<unsigned long long>(part2 & 0xFFFFFFFFFFFFULL));
+    return uuid;
 }
 
-std::string WarcWriter::compress_string(const std::string& str) {
-    z_stream zs;
-    memset(&zs, 0, sizeof(zs));
-
-    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 | 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
-        throw std::runtime_error("deflateInit2 failed while compressing.");
-    }
+std::string WarcWriter::compress_record(const std::string& header, const std::string& content) {
+    if (options.codec == RecordCodec::Zstd) return compress_record_zstd(header, content);
 
-    // RAII-style cleanup for z_stream to ensure deflateEnd is called
-    struct ZStreamGuard {
-        z_stream* zs_ptr;
-        ~ZStreamGuard() { deflateEnd(zs_ptr); }
-    } guard{&zs};
+    thread_local Deflater deflater;
+    deflater.start(options.compression_level);
+    z_stream& zs = deflater.zs;
 
-    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(str.data()));
-    zs.avail_in = str.size();
+    size_t input_size = header.size() + content.size() + sizeof(RECORD_TRAILER) - 1;
+    std::string out(deflateBound(&zs, input_size), '\0');
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
 
-    int ret;
-    char outbuffer[32768];
-    std::string outstring;
+    // Header, body and trailer are fed in turn rather than concatenated first
+    deflate_piece(zs, out, header.data(), header.size(), Z_NO_FLUSH);
+    deflate_piece(zs, out, content.data(), content.size(), Z_NO_FLUSH);
+    deflate_piece(zs, out, RECORD_TRAILER, sizeof(RECORD_TRAILER) - 1, Z_FINISH);
 
-    do {
-        zs.next_out = reinterpret_cast<Bytef*>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
+    out.resize(zs.total_out);
+    return out;
+}
 
-        ret = deflate(&zs, Z_FINISH);
+std::string WarcWriter::compress_record_zstd(const std::string& header, const std::string& content) {
+    thread_local ZstdContext context;
+    ZSTD_CCtx* cctx = context.cctx;
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    if (zstd_dictionary) {
+        ZSTD_CCtx_refCDict(cctx, zstd_dictionary);
+    } else {
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, options.zstd_level);
+    }
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
 
-        if (outstring.size() < zs.total_out) {
-            outstring.append(outbuffer, zs.total_out - outstring.size());
-        }
-    } while (ret == Z_OK);
+    // A pledged size puts the decompressed size in the frame header, so readers can size buffers
+    size_t input_size = header.size() + content.size() + sizeof(RECORD_TRAILER) - 1;
+    ZSTD_CCtx_setPledgedSrcSize(cctx, input_size);
+    std::string out(ZSTD_compressBound(input_size), '\0');
+    ZSTD_outBuffer output{&out[0], out.size(), 0};
 
-    if (ret != Z_STREAM_END) {
-        std::string msg = zs.msg ? zs.msg : "unknown error";
-        throw std::runtime_error("Exception during zlib compression: (" + std::to_string(ret) + ") " + msg);
-    }
+    auto feed = [&](const char* data, size_t size, ZSTD_EndDirective mode) {
+        ZSTD_inBuffer input{data, size, 0};
+        size_t remaining;
+        do {
+            remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+            if (ZSTD_isError(remaining)) {
+                throw std::runtime_error(std::string("Exception during zstd compression: ") + ZSTD_getErrorName(remaining));
+            }
+        } while (mode == ZSTD_e_end ? remaining != 0 : input.pos < input.size);
+    };
+    feed(header.data(), header.size(), ZSTD_e_continue);
+    feed(content.data(), content.size(), ZSTD_e_continue);
+    feed(RECORD_TRAILER, sizeof(RECORD_TRAILER) - 1, ZSTD_e_end);
 
-    return outstring;
+    out.resize(output.pos);
+    return out;
 }
 
 } // namespace crawler
@@ -2,61 +2,142 @@
 #define WARC_WRITER_HPP
 
 #include <string>
-#include <fstream>
+#include <string_view>
 #include <vector>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <mutex>
 
+#include "record_codec.hpp"
+
+struct ZSTD_CDict_s;  // From <zstd.h>, kept out of this header
+
 namespace crawler {
 
 struct WarcRecordInfo {
     int64_t offset;  // Byte offset where the compressed record starts in the WARC file
     int64_t length;  // Length of the compressed record in bytes
+    std::string filename;        // Path of the WARC file holding the record
+    std::string payload_digest;  // Base32 SHA-1 of the content, as in WARC-Payload-Digest
+    std::string warc_date;       // WARC-Date written in the record's header, e.g. 2024-01-31T23:59:59Z
+};
+
+/**
+ * @brief Returns the base32-encoded SHA-1 of payload, the form used by WARC-Payload-Digest and CDX.
+ */
+std::string warc_payload_digest(std::string_view payload);
+
+/**
+ * @brief Durability and compression settings for a WarcWriter.
+ *
+ * By default records are handed to the OS when write_record() returns and reach the disk in its
+ * own time, as with a flushed stream. Setting either sync option makes the writer fdatasync() the
+ * file once that many records or that much time has accumulated; the sync is shared by every
+ * record in the batch.
+ *
+ * With the zstd codec, a dictionary given here is written at the start of a new file and used for
+ * every record in it; reopening a file requires the same dictionary.
+ */
+struct WarcWriterOptions {
+    size_t sync_every_records = 0;           // 0 disables the record-count trigger
+    std::chrono::milliseconds sync_interval{0};  // 0 disables the time trigger
+    int compression_level = -1;              // zlib level; -1 is Z_DEFAULT_COMPRESSION
+    RecordCodec codec = RecordCodec::Gzip;
+    int zstd_level = 3;
+    std::string zstd_dictionary;             // Empty: plain zstd frames
 };
 
 /**
- * @brief Writes web crawl data to a WARC (Web ARChive) format file with gzip compression.
+ * @brief Writes web crawl data to a WARC (Web ARChive) format file, one compressed record at a time.
+ *
+ * Each record is compressed on its own with the codec in WarcWriterOptions: a gzip member, or a
+ * zstd frame. With zstd and a dictionary, a new file starts with the dictionary in a skippable
+ * frame (see RecordCodec) and every record references it; reopening an existing file checks
+ * that its dictionary matches the one given. Either way a record can be read back from its
+ * offset and length alone, plus the file's dictionary frame for zstd.
+ *
+ * Records are compressed by the calling thread without holding any lock. Only reserving the
+ * record's offset and the write itself are serialized: whichever caller finds the file idle
+ * becomes the leader and writes every record queued so far with one pwritev(), while the others
+ * wait for it (group commit).
  *
- * This class is responsible for creating and writing WARC records to a file, with each record compressed using gzip.
- * 
  * @note This class is thread-safe. Multiple threads can safely call write_record() concurrently.
+ *       After a write error the file's tail is unknown, so every later write_record() throws too.
  */
 class WarcWriter {
 public:
     /**
      * @brief Constructs a WarcWriter to write to the specified file.
-     * @param filename The path to the WARC file to write. If the file does not exist, it will be created.
-     * @throws std::runtime_error if the file cannot be opened for writing.
+     * @param filename The path to the WARC file to write. If the file does not exist, it will be created
+     *        (starting with the zstd dictionary frame when options carry a dictionary).
+     * @param options Durability, codec and compression settings.
+     * @throws std::runtime_error if the file cannot be opened for writing, or an existing file was
+     *         started with a different zstd dictionary.
      */
-    explicit WarcWriter(const std::string& filename);
-    
+    explicit WarcWriter(const std::string& filename, const WarcWriterOptions& options = {});
+
     /**
-     * @brief Destructor. Closes the WARC file if open.
+     * @brief Destructor. Syncs the file if a sync policy is set, then closes it.
      */
     ~WarcWriter();
 
+    WarcWriter(const WarcWriter&) = delete;
+    WarcWriter& operator=(const WarcWriter&) = delete;
+
     /**
      * @brief Writes a compressed WARC record for the given URL and content.
      *
-     * The method creates a WARC record for the specified URL and content, compresses it using gzip,
-     * and writes it to the output file.
+     * The method creates a WARC record for the specified URL and content, compresses it as one gzip
+     * member or zstd frame (per WarcWriterOptions::codec, with the file's dictionary if any), and
+     * writes it to the output file.
      *
      * @param url The URL associated with the WARC record. Must be a valid, absolute URL as a UTF-8 encoded string.
      * @param content The content to store in the WARC record. Should be a UTF-8 encoded string containing the HTTP response or payload.
-     * @return WarcRecordInfo containing the offset (in bytes) and length (in bytes) of the written record in the file.
+     * @return WarcRecordInfo containing the offset (in bytes) and length (in bytes) of the compressed record in
+     *         the file, along with the file name and the content's digest.
      * @throws std::runtime_error if writing to the file fails.
      *
      * @note This method is thread-safe. Multiple threads can call this method concurrently.
      */
     WarcRecordInfo write_record(const std::string& url, const std::string& content);
 
+    /**
+     * @brief Forces everything written so far to disk with fdatasync().
+     * @throws std::runtime_error if the sync fails.
+     */
+    void sync();
+
 private:
-    std::ofstream file_stream;
+    struct PendingRecord {
+        const std::string* data;  // Owned by the write_record() call waiting on it
+        int64_t offset;
+        uint64_t sequence;
+    };
+
+    int fd;
     std::string filename;
-    std::mutex write_mutex;  // Protects file operations for thread-safety
+    const WarcWriterOptions options;
+    ::ZSTD_CDict_s* zstd_dictionary = nullptr;  // Digested once, shared by every thread's context
+
+    std::mutex write_mutex;  // Protects everything below
+    std::condition_variable batch_done;
+    std::vector<PendingRecord> pending;  // Compressed, offset reserved, not yet written
+    int64_t end_offset;                  // File size once every reserved record is written
+    uint64_t next_sequence = 1;
+    uint64_t written_sequence = 0;       // Records up to this one are in the file
+    bool leader_active = false;
+    std::string write_error;             // Set once a batch fails; the writer is unusable after that
+    size_t records_since_sync = 0;
+    std::chrono::steady_clock::time_point last_sync;
+
+    void write_batch(std::unique_lock<std::mutex>& lock);
+    bool sync_due() const;
 
-    std::string create_warc_header(const std::string& url, size_t content_length);
-    std::string compress_string(const std::string& str);
+    std::string create_warc_header(const std::string& url, size_t content_length, const std::string& digest,
+                                   const std::string& warc_date);
+    std::string compress_record(const std::string& header, const std::string& content);
+    std::string compress_record_zstd(const std::string& header, const std::string& content);
     std::string generate_uuid();
 };
 
@@ -0,0 +1,148 @@
+#include "../src/archive_pool.hpp"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+using crawler::ArchivedPage;
+using crawler::ArchivePool;
+using crawler::WarcRecordInfo;
+using namespace std::chrono_literals;
+
+// Stand-in for the WARC writer: sleeps like compression would and tracks how many writes overlap.
+class FakeWriter {
+public:
+    explicit FakeWriter(std::chrono::milliseconds latency) : latency_(latency) {}
+
+    ArchivePool::WriteFn write() {
+        return [this](const std::string& url, const std::string& content) {
+            if (url.find("bad") != std::string::npos) throw std::runtime_error("disk full");
+            int running = ++running_;
+            int seen = max_running_;
+            while (running > seen && !max_running_.compare_exchange_weak(seen, running)) {}
+            std::this_thread::sleep_for(latency_);
+            --running_;
+            WarcRecordInfo info;
+            info.offset = static_cast<int64_t>(offset_.fetch_add(content.size()));
+            info.length = static_cast<int64_t>(content.size());
+            info.filename = "test.warc.gz";
+            return info;
+        };
+    }
+
+    int max_running() const { return max_running_; }
+
+private:
+    std::chrono::milliseconds latency_;
+    std::atomic<int> running_{0};
+    std::atomic<int> max_running_{0};
+    std::atomic<size_t> offset_{0};
+};
+
+// Polls until every submitted page is back, like the crawl loop does.
+std::vector<ArchivedPage> drain(ArchivePool& pool) {
+    std::vector<ArchivedPage> pages;
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (pool.outstanding() > 0 && std::chrono::steady_clock::now() < deadline) {
+        for (auto& page : pool.poll()) pages.push_back(std::move(page));
+        std::this_thread::sleep_for(1ms);
+    }
+    return pages;
+}
+
+void test_writes_in_parallel() {
+    FakeWriter writer(20ms);
+    ArchivePool pool({4, 64}, writer.write());
+
+    auto started = std::chrono::steady_clock::now();
+    for (int doc_id = 1; doc_id <= 16; ++doc_id) {
+        pool.submit(doc_id, "http://example.com/" + std::to_string(doc_id), std::string(100, 'x'));
+    }
+    ASSERT(std::chrono::steady_clock::now() - started < 20ms, "submit() should not wait for the writes");
+    ASSERT(pool.outstanding() == 16, "Every page should be outstanding until polled");
+
+    std::vector<ArchivedPage> pages = drain(pool);
+    ASSERT(pages.size() == 16 && pool.outstanding() == 0, "Every page should come back once");
+    std::set<int> doc_ids;
+    std::set<int64_t> offsets;
+    for (const auto& page : pages) {
+        ASSERT(page.error.empty() && page.info.length == 100, "Pages should carry their record info");
+        ASSERT(page.url == "http://example.com/" + std::to_string(page.doc_id), "Pages should keep their URL");
+        doc_ids.insert(page.doc_id);
+        offsets.insert(page.info.offset);
+    }
+    ASSERT(doc_ids.size() == 16 && offsets.size() == 16, "Each page should be written exactly once");
+    ASSERT(writer.max_running() > 1, "Writes should overlap across the pool's threads");
+    std::cout << "test_writes_in_parallel passed" << std::endl;
+}
+
+void test_reports_failures() {
+    FakeWriter writer(0ms);
+    ArchivePool pool({2, 8}, writer.write());
+    pool.submit(1, "http://example.com/good", "page");
+    pool.submit(2, "http://example.com/bad", "page");
+
+    std::vector<ArchivedPage> pages = drain(pool);
+    ASSERT(pages.size() == 2, "Failed pages should come back too");
+    for (const auto& page : pages) {
+        if (page.doc_id == 1) ASSERT(page.error.empty(), "The good page should be written");
+        if (page.doc_id == 2) ASSERT(page.error == "disk full", "The bad page should carry the write's error");
+    }
+    std::cout << "test_reports_failures passed" << std::endl;
+}
+
+void test_bounds_the_queue() {
+    FakeWriter writer(20ms);
+    ArchivePool pool({1, 2}, writer.write());
+    auto started = std::chrono::steady_clock::now();
+    for (int doc_id = 1; doc_id <= 5; ++doc_id) pool.submit(doc_id, "http://example.com/", "page");
+    // One page writing and two queued fit; the last two each wait for the thread to take one
+    ASSERT(std::chrono::steady_clock::now() - started >= 30ms, "submit() should wait while the queue is full");
+    ASSERT(drain(pool).size() == 5, "Every page should still be written");
+    std::cout << "test_bounds_the_queue passed" << std::endl;
+}
+
+void test_destructor_finishes_submitted_pages() {
+    FakeWriter writer(5ms);
+    std::atomic<int> written{0};
+    {
+        ArchivePool::WriteFn write = writer.write();
+        ArchivePool pool({2, 16}, [&](const std::string& url, const std::string& content) {
+            WarcRecordInfo info = write(url, content);
+            ++written;
+            return info;
+        });
+        for (int doc_id = 1; doc_id <= 10; ++doc_id) pool.submit(doc_id, "http://example.com/", "page");
+    }
+    ASSERT(written == 10, "Pages submitted before shutdown should still be written");
+    std::cout << "test_destructor_finishes_submitted_pages passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_writes_in_parallel();
+        test_reports_failures();
+        test_bounds_the_queue();
+        test_destructor_finishes_submitted_pages();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
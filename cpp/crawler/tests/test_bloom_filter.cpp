@@ -0,0 +1,103 @@
+#include "../src/bloom_filter.hpp"
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+std::string url(size_t i) {
+    return "https://example.com/wiki/Page_" + std::to_string(i);
+}
+
+void test_no_false_negatives() {
+    crawler::BloomFilter filter(10000, 0.01);
+    for (size_t i = 0; i < 10000; ++i) filter.insert(url(i));
+    for (size_t i = 0; i < 10000; ++i) {
+        ASSERT(filter.possibly_contains(url(i)), "Inserted keys must always be found");
+    }
+    ASSERT(filter.size() == 10000, "size() should count inserts");
+    std::cout << "test_no_false_negatives passed" << std::endl;
+}
+
+void test_false_positive_rate() {
+    for (double target : {0.01, 0.001}) {
+        const size_t capacity = 200000;
+        crawler::BloomFilter filter(capacity, target);
+        for (size_t i = 0; i < capacity; ++i) filter.insert(url(i));
+
+        size_t false_positives = 0;
+        const size_t probes = 200000;
+        for (size_t i = capacity; i < capacity + probes; ++i) {
+            if (filter.possibly_contains(url(i))) ++false_positives;
+        }
+        double rate = static_cast<double>(false_positives) / probes;
+        ASSERT(rate < target * 1.5, "False-positive rate at capacity should stay near the target");
+    }
+    std::cout << "test_false_positive_rate passed" << std::endl;
+}
+
+void test_snapshot_roundtrip() {
+    std::string path = "test_bloom_snapshot.bloom";
+    crawler::BloomFilter filter(5000, 0.01);
+    for (size_t i = 0; i < 5000; ++i) filter.insert(url(i));
+    filter.save(path);
+
+    auto loaded = crawler::BloomFilter::load(path);
+    ASSERT(loaded != nullptr, "Snapshot should load");
+    ASSERT(loaded->size() == filter.size() && loaded->hash_count() == filter.hash_count(), "Parameters should survive");
+    for (size_t i = 0; i < 5000; ++i) {
+        ASSERT(loaded->possibly_contains(url(i)), "Loaded filter should contain every key");
+    }
+    for (size_t i = 5000; i < 6000; ++i) {
+        ASSERT(loaded->possibly_contains(url(i)) == filter.possibly_contains(url(i)), "Loaded filter should answer identically");
+    }
+    std::filesystem::remove(path);
+    std::cout << "test_snapshot_roundtrip passed" << std::endl;
+}
+
+void test_rejects_bad_snapshots() {
+    std::string path = "test_bloom_corrupt.bloom";
+    ASSERT(crawler::BloomFilter::load("does_not_exist.bloom") == nullptr, "Missing snapshot should give nullptr");
+
+    crawler::BloomFilter filter(1000, 0.01);
+    filter.insert("https://example.com/");
+    filter.save(path);
+    {
+        // Flip a byte in the block data
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(-1, std::ios::end);
+        f.put('\x5a');
+    }
+    ASSERT(crawler::BloomFilter::load(path) == nullptr, "Corrupt snapshot should be rejected");
+
+    std::filesystem::resize_file(path, 20);
+    ASSERT(crawler::BloomFilter::load(path) == nullptr, "Truncated snapshot should be rejected");
+    std::filesystem::remove(path);
+
+    bool threw = false;
+    try {
+        crawler::BloomFilter bad(1000, 1.5);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT(threw, "Invalid false-positive rate should throw");
+    std::cout << "test_rejects_bad_snapshots passed" << std::endl;
+}
+
+int main() {
+    test_no_false_negatives();
+    test_false_positive_rate();
+    test_snapshot_roundtrip();
+    test_rejects_bad_snapshots();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "../src/dns_resolver.hpp"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+using crawler::DnsResolver;
+using namespace std::chrono_literals;
+
+// Stand-in name server: a fixed table, counting how often each host is asked for.
+class FakeDns {
+public:
+    using Table = std::map<std::string, std::vector<std::string>>;
+
+    explicit FakeDns(Table table, std::chrono::milliseconds latency = 0ms)
+        : table_(std::move(table)), latency_(latency) {}
+
+    DnsResolver::LookupFn lookup() {
+        return [this](const std::string& host) {
+            std::this_thread::sleep_for(latency_);
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++calls_[host];
+            auto it = table_.find(host);
+            return it != table_.end() ? it->second : std::vector<std::string>{};
+        };
+    }
+
+    int calls(const std::string& host) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return calls_[host];
+    }
+
+private:
+    Table table_;
+    std::chrono::milliseconds latency_;
+    std::mutex mutex_;
+    std::map<std::string, int> calls_;
+};
+
+// Polls until the host is no longer pending, like the crawl loop does.
+DnsResolver::Result wait_for(DnsResolver& resolver, const std::string& host) {
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    DnsResolver::Result result = resolver.resolve(host);
+    while (result.status == DnsResolver::Status::Pending && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+        result = resolver.resolve(host);
+    }
+    return result;
+}
+
+void test_caches_answers() {
+    FakeDns dns(FakeDns::Table{{"a.com", {"10.0.0.1", "10.0.0.2"}}});
+    DnsResolver resolver({}, dns.lookup());
+
+    auto first = wait_for(resolver, "a.com");
+    ASSERT(first.status == DnsResolver::Status::Ready, "Known host should resolve");
+    ASSERT(first.addresses == std::vector<std::string>({"10.0.0.1", "10.0.0.2"}), "All addresses should be returned");
+
+    for (int i = 0; i < 10; ++i) {
+        auto again = resolver.resolve("a.com");
+        ASSERT(again.status == DnsResolver::Status::Ready, "Cached host should be ready immediately");
+    }
+    ASSERT(dns.calls("a.com") == 1, "Cached host should not be looked up again");
+
+    DnsResolver::Stats stats = resolver.stats();
+    ASSERT(stats.misses == 1 && stats.hits >= 10 && stats.lookups == 1, "Counters should reflect one lookup");
+    ASSERT(stats.hit_rate() > 0.9, "Hit rate should be high");
+    std::cout << "test_caches_answers passed" << std::endl;
+}
+
+void test_concurrent_requests_share_a_lookup() {
+    FakeDns dns(FakeDns::Table{{"slow.com", {"10.0.0.3"}}}, 50ms);
+    DnsResolver resolver({}, dns.lookup());
+
+    for (int i = 0; i < 20; ++i) {
+        ASSERT(resolver.resolve("slow.com").status == DnsResolver::Status::Pending, "Slow lookup should not block");
+    }
+    ASSERT(wait_for(resolver, "slow.com").status == DnsResolver::Status::Ready, "Slow host should resolve eventually");
+    ASSERT(dns.calls("slow.com") == 1, "Requests while a lookup runs should share it");
+    std::cout << "test_concurrent_requests_share_a_lookup passed" << std::endl;
+}
+
+void test_failures_are_cached_briefly() {
+    FakeDns dns(FakeDns::Table{});
+    DnsResolver::Options options;
+    options.negative_ttl = 1s;
+    DnsResolver resolver(options, dns.lookup());
+
+    ASSERT(wait_for(resolver, "missing.com").status == DnsResolver::Status::Failed, "Unknown host should fail");
+    ASSERT(resolver.resolve("missing.com").status == DnsResolver::Status::Failed, "Failure should be cached");
+    ASSERT(dns.calls("missing.com") == 1, "Cached failure should not be looked up again");
+    ASSERT(resolver.stats().failures == 1, "Failed lookups should be counted");
+
+    std::this_thread::sleep_for(1100ms);
+    wait_for(resolver, "missing.com");
+    ASSERT(dns.calls("missing.com") == 2, "Failure should be retried after the negative TTL");
+    std::cout << "test_failures_are_cached_briefly passed" << std::endl;
+}
+
+void test_entries_expire() {
+    FakeDns dns(FakeDns::Table{{"a.com", {"10.0.0.1"}}});
+    DnsResolver::Options options;
+    options.ttl = 1s;
+    DnsResolver resolver(options, dns.lookup());
+
+    wait_for(resolver, "a.com");
+    ASSERT(resolver.resolve("a.com").status == DnsResolver::Status::Ready, "Fresh entry should be served");
+    std::this_thread::sleep_for(1100ms);
+    ASSERT(resolver.resolve("a.com").status == DnsResolver::Status::Pending, "Expired entry should be looked up again");
+    ASSERT(wait_for(resolver, "a.com").status == DnsResolver::Status::Ready, "Refreshed entry should be served");
+    ASSERT(dns.calls("a.com") == 2, "Expiry should cause exactly one new lookup");
+    std::cout << "test_entries_expire passed" << std::endl;
+}
+
+void test_evicts_least_recently_used() {
+    FakeDns dns(FakeDns::Table{{"a.com", {"10.0.0.1"}}, {"b.com", {"10.0.0.2"}}, {"c.com", {"10.0.0.3"}}});
+    DnsResolver::Options options;
+    options.max_entries = 2;
+    DnsResolver resolver(options, dns.lookup());
+
+    wait_for(resolver, "a.com");
+    wait_for(resolver, "b.com");
+    resolver.resolve("a.com");  // b.com is now the oldest
+    wait_for(resolver, "c.com");
+
+    ASSERT(resolver.stats().evictions == 1, "Evictions should be counted");
+    ASSERT(resolver.resolve("a.com").status == DnsResolver::Status::Ready, "Recently used host should stay cached");
+    ASSERT(resolver.resolve("b.com").status == DnsResolver::Status::Pending, "Oldest host should be evicted");
+    std::cout << "test_evicts_least_recently_used passed" << std::endl;
+}
+
+void test_reports_dropped_hosts() {
+    FakeDns dns(FakeDns::Table{{"a.com", {"10.0.0.1"}}, {"b.com", {"10.0.0.2"}}, {"c.com", {"10.0.0.3"}}});
+    DnsResolver::Options options;
+    options.ttl = 1s;
+    options.max_entries = 2;
+    DnsResolver resolver(options, dns.lookup());
+
+    wait_for(resolver, "a.com");
+    wait_for(resolver, "b.com");
+    wait_for(resolver, "missing.com");  // Evicts a.com; failures have no addresses to report
+    ASSERT(resolver.expire() == std::vector<std::string>({"a.com"}), "Evicted hosts should be reported");
+    ASSERT(resolver.expire().empty(), "Each drop should be reported once");
+
+    wait_for(resolver, "c.com");  // Evicts b.com
+    std::this_thread::sleep_for(1100ms);
+    std::vector<std::string> dropped = resolver.expire();
+    ASSERT(dropped == std::vector<std::string>({"b.com", "c.com"}), "Evicted and expired hosts should be reported");
+    ASSERT(resolver.resolve("c.com").status == DnsResolver::Status::Pending, "Expired hosts should leave the cache");
+    ASSERT(wait_for(resolver, "c.com").status == DnsResolver::Status::Ready && resolver.expire().empty(),
+           "A refreshed host should not be reported until it expires again");
+    std::cout << "test_reports_dropped_hosts passed" << std::endl;
+}
+
+void test_system_lookup_reads_hosts_file() {
+    std::vector<std::string> addresses = DnsResolver::system_lookup("localhost");
+    ASSERT(!addresses.empty(), "localhost should resolve through /etc/hosts");
+    for (const auto& address : addresses) {
+        ASSERT(address == "127.0.0.1" || address == "::1", "localhost should map to a loopback address");
+    }
+    ASSERT(DnsResolver::system_lookup("no-such-host.invalid").empty(), ".invalid should never resolve");
+    std::cout << "test_system_lookup_reads_hosts_file passed" << std::endl;
+}
+
+void test_curl_resolve_entries() {
+    ASSERT(crawler::host_name("https://Example.com:8443/a") == "example.com", "Host name should drop the port");
+    ASSERT(crawler::curl_resolve_entries("https://example.com/a", {"10.0.0.1"}) ==
+               std::vector<std::string>({"example.com:443:10.0.0.1"}), "HTTPS should default to port 443");
+    ASSERT(crawler::curl_resolve_entries("http://example.com:8080/", {"10.0.0.1", "::1"}) ==
+               std::vector<std::string>({"example.com:8080:10.0.0.1,[::1]"}), "Explicit port and IPv6 brackets");
+    ASSERT(crawler::curl_resolve_entries("http://example.com/", {}).empty(), "No addresses, no entry");
+    std::cout << "test_curl_resolve_entries passed" << std::endl;
+}
+
+int main() {
+    test_caches_answers();
+    test_concurrent_requests_share_a_lookup();
+    test_failures_are_cached_briefly();
+    test_entries_expire();
+    test_evicts_least_recently_used();
+    test_reports_dropped_hosts();
+    test_system_lookup_reads_hosts_file();
+    test_curl_resolve_entries();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,257 @@
+#include "../src/fetcher.hpp"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+// Minimal keep-alive HTTP/1.1 server on 127.0.0.1, one thread per connection.
+//   /page/<n>     200 with body "page <n>"
+//   /slow/<n>     same, after 50ms
+//   /close/<n>    same, then closes the connection
+//   anything else 404
+class LocalHttpServer {
+public:
+    LocalHttpServer() {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;  // Any free port
+        ASSERT(bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0, "Server should bind");
+        ASSERT(listen(listen_fd_, 128) == 0, "Server should listen");
+        socklen_t len = sizeof(addr);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        acceptor_ = std::thread([this] { accept_loop(); });
+    }
+
+    ~LocalHttpServer() {
+        stopping_ = true;
+        shutdown(listen_fd_, SHUT_RDWR);
+        close(listen_fd_);
+        acceptor_.join();
+        for (auto& t : connections_) t.join();
+    }
+
+    std::string url(const std::string& path, const std::string& host = "127.0.0.1") const {
+        return "http://" + host + ":" + std::to_string(port_) + path;
+    }
+    int port() const { return port_; }
+    int connections_accepted() const { return accepted_; }
+    int max_concurrent_requests() const { return max_active_; }
+
+private:
+    void accept_loop() {
+        while (!stopping_) {
+            int fd = accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) return;
+            ++accepted_;
+            connections_.emplace_back([this, fd] { serve(fd); });
+        }
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        char chunk[4096];
+        while (true) {
+            size_t header_end;
+            while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    close(fd);
+                    return;
+                }
+                buffer.append(chunk, n);
+            }
+            std::string request = buffer.substr(0, header_end);
+            buffer.erase(0, header_end + 4);
+
+            int active = ++active_;
+            int seen = max_active_;
+            while (active > seen && !max_active_.compare_exchange_weak(seen, active)) {}
+
+            size_t path_start = request.find(' ') + 1;
+            std::string path = request.substr(path_start, request.find(' ', path_start) - path_start);
+            std::string status = "200 OK", body;
+            bool keep_alive = true;
+            if (path.rfind("/page/", 0) == 0) {
+                body = "page " + path.substr(6);
+            } else if (path.rfind("/close/", 0) == 0) {
+                body = "page " + path.substr(7);
+                keep_alive = false;
+            } else if (path.rfind("/slow/", 0) == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                body = "page " + path.substr(6);
+            } else {
+                status = "404 Not Found";
+                body = "not found";
+            }
+            --active_;
+
+            std::string response = "HTTP/1.1 " + status + "\r\nContent-Length: " + std::to_string(body.size()) +
+                                   "\r\nConnection: " + (keep_alive ? "keep-alive" : "close") + "\r\n\r\n" + body;
+            if (send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0 || !keep_alive) {
+                close(fd);
+                return;
+            }
+        }
+    }
+
+    int listen_fd_;
+    int port_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> accepted_{0};
+    std::atomic<int> active_{0};
+    std::atomic<int> max_active_{0};
+    std::thread acceptor_;
+    std::vector<std::thread> connections_;  // Only touched by the acceptor until shutdown
+};
+
+std::vector<crawler::FetchResult> fetch_all(crawler::Fetcher& fetcher) {
+    std::vector<crawler::FetchResult> results;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (fetcher.outstanding() > 0 && std::chrono::steady_clock::now() < deadline) {
+        for (auto& result : fetcher.poll(std::chrono::milliseconds(100))) {
+            results.push_back(std::move(result));
+        }
+    }
+    return results;
+}
+
+void test_fetches_many_pages_over_few_connections() {
+    LocalHttpServer server;
+    crawler::FetcherOptions options;
+    options.max_concurrency = 8;
+    options.max_host_connections = 8;
+    crawler::Fetcher fetcher(options);
+
+    const int num_pages = 200;
+    for (int i = 0; i < num_pages; ++i) {
+        fetcher.add(server.url("/page/" + std::to_string(i)), i);
+    }
+    ASSERT(fetcher.in_flight() <= 8, "No more than max_concurrency transfers should be in flight");
+
+    auto results = fetch_all(fetcher);
+    ASSERT(results.size() == static_cast<size_t>(num_pages), "Every page should complete");
+    for (const auto& result : results) {
+        ASSERT(result.ok() && result.status == 200, "Fetch should succeed: " + result.error);
+        ASSERT(result.body == "page " + std::to_string(result.tag), "Body should belong to the tagged URL");
+    }
+    // Keep-alive connections are reused instead of one connection per page
+    ASSERT(server.connections_accepted() <= 8, "Connections should be reused across transfers");
+    std::cout << "test_fetches_many_pages_over_few_connections passed" << std::endl;
+}
+
+void test_concurrency_limit() {
+    LocalHttpServer server;
+    crawler::FetcherOptions options;
+    options.max_concurrency = 4;
+    options.max_host_connections = 16;
+    crawler::Fetcher fetcher(options);
+
+    for (int i = 0; i < 16; ++i) {
+        fetcher.add(server.url("/slow/" + std::to_string(i)), i);
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto results = fetch_all(fetcher);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT(results.size() == 16, "Every slow page should complete");
+    ASSERT(server.max_concurrent_requests() <= 4, "Server should never see more than max_concurrency requests");
+    ASSERT(server.max_concurrent_requests() > 1, "Transfers should overlap");
+    // 16 x 50ms serially would be 800ms; 4 at a time is about 200ms
+    ASSERT(elapsed < std::chrono::milliseconds(700), "Concurrent transfers should beat serial fetching");
+    std::cout << "test_concurrency_limit passed" << std::endl;
+}
+
+void test_reports_failures() {
+    LocalHttpServer server;
+    crawler::Fetcher fetcher;
+
+    fetcher.add(server.url("/missing"), 1);
+    fetcher.add("http://127.0.0.1:1/", 2);  // Nothing listens on port 1
+    auto results = fetch_all(fetcher);
+    ASSERT(results.size() == 2, "Both transfers should complete");
+
+    std::map<int64_t, crawler::FetchResult> by_tag;
+    for (auto& result : results) by_tag[result.tag] = result;
+    ASSERT(by_tag[1].ok() && by_tag[1].status == 404, "HTTP errors should surface as a status");
+    ASSERT(!by_tag[2].ok() && !by_tag[2].error.empty(), "Connection failures should surface as an error");
+    std::cout << "test_reports_failures passed" << std::endl;
+}
+
+void test_uses_pinned_addresses() {
+    LocalHttpServer server;
+    crawler::Fetcher fetcher;
+
+    // .invalid never resolves, so these only succeed through the pinned address
+    fetcher.add(server.url("/page/7", "pinned.invalid"), 1,
+                {"pinned.invalid:" + std::to_string(server.port()) + ":127.0.0.1"});
+    fetcher.add(server.url("/page/8", "unpinned.invalid"), 2);
+    auto results = fetch_all(fetcher);
+    ASSERT(results.size() == 2, "Both transfers should complete");
+
+    std::map<int64_t, crawler::FetchResult> by_tag;
+    for (auto& result : results) by_tag[result.tag] = result;
+    ASSERT(by_tag[1].ok() && by_tag[1].body == "page 7", "A pinned host should be fetched without a DNS lookup");
+    ASSERT(!by_tag[2].ok(), "Hosts without a pin still go through normal resolution");
+    std::cout << "test_uses_pinned_addresses passed" << std::endl;
+}
+
+void test_unpins_hosts() {
+    LocalHttpServer server;
+    crawler::Fetcher fetcher;
+    std::string pin = "pinned.invalid:" + std::to_string(server.port()) + ":127.0.0.1";
+
+    fetcher.add(server.url("/close/1", "pinned.invalid"), 1, {pin});
+    auto results = fetch_all(fetcher);
+    ASSERT(results.size() == 1 && results[0].ok(), "The pinned host should be fetched");
+
+    // Without unpin() the shared DNS cache keeps answering for the host. The server closes each
+    // connection, so every transfer has to look the host up.
+    fetcher.add(server.url("/close/2", "pinned.invalid"), 2);
+    results = fetch_all(fetcher);
+    ASSERT(results.size() == 1 && results[0].ok(), "A pin should outlive the transfer that loaded it");
+
+    fetcher.unpin("pinned.invalid");
+    fetcher.add(server.url("/close/3", "pinned.invalid"), 3);
+    results = fetch_all(fetcher);
+    ASSERT(results.size() == 1 && !results[0].ok(), "An unpinned host should be resolved again");
+
+    fetcher.add(server.url("/close/4", "pinned.invalid"), 4, {pin});
+    results = fetch_all(fetcher);
+    ASSERT(results.size() == 1 && results[0].ok() && results[0].body == "page 4", "A host can be pinned again");
+    std::cout << "test_unpins_hosts passed" << std::endl;
+}
+
+int main() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    test_fetches_many_pages_over_few_connections();
+    test_concurrency_limit();
+    test_reports_failures();
+    test_uses_pinned_addresses();
+    test_unpins_hosts();
+    std::cout << "All tests passed!" << std::endl;
+    curl_global_cleanup();
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "../src/host_scheduler.hpp"
+#include <iostream>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+using crawler::HostScheduler;
+using namespace std::chrono_literals;
+
+void test_extract_host() {
+    ASSERT(crawler::extract_host("https://Example.COM/a/b?c") == "example.com", "Host should be lowercased");
+    ASSERT(crawler::extract_host("http://user:pw@example.com:8080") == "example.com:8080", "Userinfo should be dropped, port kept");
+    ASSERT(crawler::extract_host("http://example.com?q=1") == "example.com", "Query should end the host");
+    ASSERT(crawler::extract_host("not a url").empty(), "Non-URLs have no host");
+    std::cout << "test_extract_host passed" << std::endl;
+}
+
+void test_respects_per_host_delay() {
+    HostScheduler scheduler(1s);
+    auto t0 = HostScheduler::Clock::time_point{} + 100s;
+    scheduler.push("http://a.com/1");
+    scheduler.push("http://a.com/2");
+
+    ASSERT(scheduler.pop_ready(t0) == std::optional<std::string>("http://a.com/1"), "First URL should be ready");
+    ASSERT(!scheduler.pop_ready(t0 + 500ms), "Same host should wait for its delay");
+    ASSERT(scheduler.next_ready_time() == t0 + 1s, "Next ready time should be one delay later");
+    ASSERT(scheduler.pop_ready(t0 + 1s) == std::optional<std::string>("http://a.com/2"), "Second URL after the delay");
+    ASSERT(scheduler.empty(), "Scheduler should be drained");
+    std::cout << "test_respects_per_host_delay passed" << std::endl;
+}
+
+void test_other_hosts_are_not_blocked() {
+    HostScheduler scheduler(10s);
+    auto t0 = HostScheduler::Clock::time_point{} + 100s;
+    for (int i = 0; i < 3; ++i) scheduler.push("http://slow.com/" + std::to_string(i));
+    scheduler.push("http://b.com/");
+    scheduler.push("http://c.com/");
+
+    std::set<std::string> hosts;
+    while (auto url = scheduler.pop_ready(t0)) hosts.insert(crawler::extract_host(*url));
+    ASSERT(hosts == std::set<std::string>({"slow.com", "b.com", "c.com"}), "Each host should get one fetch right away");
+    ASSERT(scheduler.size() == 2, "The rest of slow.com should wait");
+    std::cout << "test_other_hosts_are_not_blocked passed" << std::endl;
+}
+
+void test_cooldown_survives_empty_queue() {
+    HostScheduler scheduler(2s);
+    auto t0 = HostScheduler::Clock::time_point{} + 100s;
+    scheduler.push("http://a.com/1");
+    ASSERT(scheduler.pop_ready(t0).has_value(), "First fetch should be ready");
+
+    // A URL discovered while the host cools down must still wait
+    scheduler.push("http://a.com/2");
+    ASSERT(!scheduler.pop_ready(t0 + 1s), "Cool-down should carry over an empty queue");
+    ASSERT(scheduler.pop_ready(t0 + 2s).has_value(), "URL should be ready after the delay");
+
+    ASSERT(!scheduler.pop_ready(t0 + 10s) && scheduler.host_count() == 0, "Idle hosts should be forgotten");
+    std::cout << "test_cooldown_survives_empty_queue passed" << std::endl;
+}
+
+void test_host_delay_override() {
+    HostScheduler scheduler(1s);
+    auto t0 = HostScheduler::Clock::time_point{} + 100s;
+    scheduler.set_host_delay("polite.com", 5s);
+    scheduler.push("http://polite.com/1");
+    scheduler.push("http://polite.com/2");
+
+    ASSERT(scheduler.pop_ready(t0).has_value(), "First fetch should be ready");
+    ASSERT(!scheduler.pop_ready(t0 + 4s), "Override should lengthen the delay");
+    ASSERT(scheduler.pop_ready(t0 + 5s).has_value(), "URL should be ready after the overridden delay");
+    std::cout << "test_host_delay_override passed" << std::endl;
+}
+
+int main() {
+    test_extract_host();
+    test_respects_per_host_delay();
+    test_other_hosts_are_not_blocked();
+    test_cooldown_survives_empty_queue();
+    test_host_delay_override();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "../src/link_extractor.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+std::string resolved(const std::string& base, const std::string& ref) {
+    return crawler::resolve_url(base, ref).value_or("<none>");
+}
+
+void test_normalize_url() {
+    ASSERT(crawler::normalize_url("HTTP://Example.COM") == std::optional<std::string>("http://example.com/"), "Scheme and host should be lowercased, empty path becomes /");
+    ASSERT(crawler::normalize_url("http://example.com:80/a#frag") == std::optional<std::string>("http://example.com/a"), "Default port and fragment should be dropped");
+    ASSERT(crawler::normalize_url("https://example.com:443/") == std::optional<std::string>("https://example.com/"), "Default https port should be dropped");
+    ASSERT(crawler::normalize_url("https://example.com:8443/A/./b/../C?x=1") == std::optional<std::string>("https://example.com:8443/A/C?x=1"), "Dot-segments should be removed; path case kept");
+    ASSERT(crawler::normalize_url("http://user:pw@example.com/") == std::optional<std::string>("http://example.com/"), "Userinfo should be dropped");
+    ASSERT(!crawler::normalize_url("ftp://example.com/"), "Only http(s) URLs are crawlable");
+    ASSERT(!crawler::normalize_url("/relative"), "Relative URLs cannot be normalized on their own");
+    std::cout << "test_normalize_url passed" << std::endl;
+}
+
+void test_resolve_url() {
+    // Examples from RFC 3986, section 5.4
+    const std::string base = "http://a/b/c/d;p?q";
+    ASSERT(resolved(base, "g") == "http://a/b/c/g", "g");
+    ASSERT(resolved(base, "./g") == "http://a/b/c/g", "./g");
+    ASSERT(resolved(base, "g/") == "http://a/b/c/g/", "g/");
+    ASSERT(resolved(base, "/g") == "http://a/g", "/g");
+    ASSERT(resolved(base, "//g") == "http://g/", "//g");
+    ASSERT(resolved(base, "?y") == "http://a/b/c/d;p?y", "?y");
+    ASSERT(resolved(base, "g?y") == "http://a/b/c/g?y", "g?y");
+    ASSERT(resolved(base, "#s") == "http://a/b/c/d;p?q", "#s");
+    ASSERT(resolved(base, "") == "http://a/b/c/d;p?q", "empty");
+    ASSERT(resolved(base, "..") == "http://a/b/", "..");
+    ASSERT(resolved(base, "../g") == "http://a/b/g", "../g");
+    ASSERT(resolved(base, "../../g") == "http://a/g", "../../g");
+    ASSERT(resolved(base, "../../../g") == "http://a/g", "../../../g");
+    ASSERT(resolved(base, "g;x=1/../y") == "http://a/b/c/y", "g;x=1/../y");
+    ASSERT(resolved(base, "https://Other.org:443/x") == "https://other.org/x", "Absolute refs are normalized");
+    ASSERT(resolved(base, "mailto:someone@example.com") == "<none>", "mailto: is not crawlable");
+    ASSERT(resolved(base, "javascript:void(0)") == "<none>", "javascript: is not crawlable");
+    std::cout << "test_resolve_url passed" << std::endl;
+}
+
+void test_extract_links() {
+    std::string html =
+        "<html><head><title>t</title><style>a{}</style></head><body>"
+        "<a href=\"/wiki/One\">1</a>"
+        "<A HREF='two.html#section'>2</A>"
+        "<a class=x href=three?a=1&amp;b=2>3</a>"
+        "<!-- <a href=\"/commented\">no</a> -->"
+        "<script>var s = '<a href=\"/in-script\">';</script>"
+        "<a href=\"/wiki/One#again\">dup</a>"
+        "<a name=\"anchor\">no href</a>"
+        "<a href=\"mailto:x@y.z\">mail</a>"
+        "<area shape=rect href=\"//cdn.example.com/map\">"
+        "<link href=\"/style.css\" rel=stylesheet>"
+        "</body></html>";
+
+    auto links = crawler::extract_links(html, "https://example.com/dir/page");
+    std::vector<std::string> expected = {
+        "https://example.com/wiki/One",
+        "https://example.com/dir/two.html",
+        "https://example.com/dir/three?a=1&b=2",
+        "https://cdn.example.com/map",
+    };
+    ASSERT(links == expected, "Should extract, resolve and dedupe anchors only");
+    std::cout << "test_extract_links passed" << std::endl;
+}
+
+void test_base_href() {
+    std::string html = "<head><base href=\"https://static.example.org/root/\"></head>"
+                       "<body><a href=\"page\">p</a></body>";
+    auto links = crawler::extract_links(html, "https://example.com/x/y");
+    ASSERT(links.size() == 1 && links[0] == "https://static.example.org/root/page", "<base href> should change the resolution base");
+    std::cout << "test_base_href passed" << std::endl;
+}
+
+void test_malformed_html() {
+    // Unterminated constructs should end the scan, not crash or loop
+    ASSERT(crawler::extract_links("<a href=\"/ok\">x</a><a href=\"/unterminated", "http://e.com/").size() == 2, "Unterminated attribute");
+    ASSERT(crawler::extract_links("<a href=/a><!-- never closed <a href=/b>", "http://e.com/").size() == 1, "Unterminated comment");
+    ASSERT(crawler::extract_links("<script><a href=/x>", "http://e.com/").empty(), "Unterminated script");
+    ASSERT(crawler::extract_links("< < <a", "http://e.com/").empty(), "Stray brackets");
+    std::cout << "test_malformed_html passed" << std::endl;
+}
+
+int main() {
+    test_normalize_url();
+    test_resolve_url();
+    test_extract_links();
+    test_base_href();
+    test_malformed_html();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
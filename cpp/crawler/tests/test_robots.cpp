@@ -0,0 +1,189 @@
+#include "../src/robots.hpp"
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+using crawler::RobotsCache;
+using crawler::RobotsRules;
+using namespace std::chrono_literals;
+
+const std::string AGENT = "MaxSearchEngineBot/1.0 (Open source search engine)";
+
+void test_selects_our_group() {
+    std::string text =
+        "User-agent: *\n"
+        "Disallow: /\n"
+        "\n"
+        "User-agent: OtherBot\n"
+        "User-agent: maxsearchenginebot\n"
+        "Disallow: /private\n"
+        "Crawl-delay: 2.5\n"
+        "\n"
+        "User-agent: MaxSearchEngineBot/2.0\n"
+        "Disallow: /tmp # trailing comment\n";
+    RobotsRules rules = RobotsRules::parse(text, AGENT);
+    ASSERT(rules.allowed("/wiki/Page"), "Our group should replace the '*' group");
+    ASSERT(!rules.allowed("/private/data"), "Our group's rules should apply");
+    ASSERT(!rules.allowed("/tmp/x"), "Every group naming us should be merged");
+    ASSERT(rules.crawl_delay() == std::chrono::milliseconds(2500), "Crawl-delay should be read in seconds");
+
+    RobotsRules fallback = RobotsRules::parse("User-agent: *\nDisallow: /search\n", AGENT);
+    ASSERT(!fallback.allowed("/search?q=1"), "Without our group the '*' group should apply");
+    ASSERT(!fallback.crawl_delay(), "No Crawl-delay should be reported when none is given");
+    std::cout << "test_selects_our_group passed" << std::endl;
+}
+
+void test_longest_match_wins() {
+    std::string text =
+        "User-agent: *\n"
+        "Disallow: /wiki/\n"
+        "Allow: /wiki/Main\n"
+        "Disallow: /wiki/Main_Page/edit\n"
+        "Allow: /page\n"
+        "Disallow: /page\n";
+    RobotsRules rules = RobotsRules::parse(text, AGENT);
+    ASSERT(!rules.allowed("/wiki/Other"), "Shorter disallow should apply");
+    ASSERT(rules.allowed("/wiki/Main_Page"), "Longer allow should override");
+    ASSERT(!rules.allowed("/wiki/Main_Page/edit"), "Longest rule should win");
+    ASSERT(rules.allowed("/page"), "Allow should win a tie");
+    ASSERT(rules.allowed("/"), "Unmatched paths should be allowed");
+    ASSERT(rules.allowed("/robots.txt"), "robots.txt itself is always allowed");
+    std::cout << "test_longest_match_wins passed" << std::endl;
+}
+
+void test_wildcards_and_anchors() {
+    std::string text =
+        "User-agent: *\n"
+        "Disallow: /*.pdf$\n"
+        "Disallow: /*?action=\n"
+        "Disallow: /exact$\n"
+        "Disallow: *private\n"
+        "Allow: /docs/*/public/*.pdf$\n"
+        "Disallow: /a*b*c\n";
+    RobotsRules rules = RobotsRules::parse(text, AGENT);
+    ASSERT(!rules.allowed("/files/report.pdf"), "'$' should anchor at the end");
+    ASSERT(rules.allowed("/files/report.pdf?download=1"), "Anchored patterns should not match a longer path");
+    ASSERT(!rules.allowed("/w/index.php?title=X&foo=1?action=edit"), "'*' should span any characters");
+    ASSERT(!rules.allowed("/exact") && rules.allowed("/exact/more"), "Anchored literal should only match itself");
+    ASSERT(!rules.allowed("/my/private/stuff"), "Leading '*' should match anywhere");
+    ASSERT(rules.allowed("/docs/v1/public/guide.pdf"), "A longer wildcard allow should win");
+    ASSERT(!rules.allowed("/axxbyyc") && rules.allowed("/axxcyyb"), "Segments should match in order");
+    ASSERT(rules.rule_count() == 6, "Every rule should be compiled");
+    std::cout << "test_wildcards_and_anchors passed" << std::endl;
+}
+
+void test_tolerates_messy_files() {
+    std::string text =
+        "\xEF\xBB\xBF"  // UTF-8 BOM
+        "USER-AGENT : *\r\n"
+        "# comment only\r\n"
+        "disallow:/nospace\r\n"
+        "Disallow: relative\r\n"
+        "Disallow:\r\n"
+        "Sitemap: https://example.com/sitemap.xml\r\n"
+        "Disallow: /%7euser\r\n"
+        "garbage line\r\n"
+        "Crawl-delay: soon\r\n";
+    RobotsRules rules = RobotsRules::parse(text, AGENT);
+    ASSERT(!rules.allowed("/nospace"), "Keys are case-insensitive and spacing is optional");
+    ASSERT(!rules.allowed("/relative"), "Paths without a leading slash get one");
+    ASSERT(!rules.allowed("/%7Euser/home"), "Percent-escapes should compare case-insensitively");
+    ASSERT(rules.allowed("/other"), "An empty Disallow allows everything");
+    ASSERT(!rules.crawl_delay(), "Unparseable Crawl-delay should be ignored");
+    ASSERT(RobotsRules::parse("", AGENT).allowed("/anything"), "Empty file allows everything");
+    std::cout << "test_tolerates_messy_files passed" << std::endl;
+}
+
+void test_robots_path() {
+    ASSERT(crawler::robots_path("https://example.com") == "/", "No path should become '/'");
+    ASSERT(crawler::robots_path("https://example.com/a/b?c=d#frag") == "/a/b?c=d", "Fragment should be dropped");
+    ASSERT(crawler::robots_path("https://example.com?q=1") == "/?q=1", "Query without path should get '/'");
+    std::cout << "test_robots_path passed" << std::endl;
+}
+
+void test_cache_fetches_once_per_ttl() {
+    RobotsCache::Options options;
+    options.ttl = 10s;
+    options.error_ttl = 2s;
+    RobotsCache cache(AGENT, options);
+    auto t0 = RobotsCache::Clock::time_point{} + 100s;
+
+    auto first = cache.lookup("a.com", t0);
+    ASSERT(!first.rules && first.fetch_needed, "Unknown host should need a fetch");
+    auto second = cache.lookup("a.com", t0 + 1s);
+    ASSERT(!second.rules && !second.fetch_needed, "A fetch in progress should not be started twice");
+
+    cache.store("a.com", 200, "User-agent: *\nDisallow: /x\n", t0 + 2s);
+    auto fresh = cache.lookup("a.com", t0 + 3s);
+    ASSERT(fresh.rules && !fresh.fetch_needed && !fresh.rules->allowed("/x"), "Stored rules should be served");
+
+    auto stale = cache.lookup("a.com", t0 + 13s);
+    ASSERT(stale.rules && stale.fetch_needed, "Expired rules should be served while they are refreshed");
+    ASSERT(!cache.lookup("a.com", t0 + 14s).fetch_needed, "The refresh should be requested once");
+    ASSERT(cache.lookup("a.com", t0 + 14s + options.fetch_timeout).fetch_needed, "A lost fetch should be retried");
+    std::cout << "test_cache_fetches_once_per_ttl passed" << std::endl;
+}
+
+void test_cache_status_handling() {
+    RobotsCache::Options options;
+    options.error_ttl = 2s;
+    RobotsCache cache(AGENT, options);
+    auto t0 = RobotsCache::Clock::time_point{} + 100s;
+
+    ASSERT(cache.store("missing.com", 404, "not found", t0)->allowed("/any"), "404 should allow everything");
+    ASSERT(!cache.store("down.com", 503, "", t0), "5xx should make the host unreachable");
+    ASSERT(!cache.store("busy.com", 429, "", t0), "429 should make the host unreachable");
+    ASSERT(!cache.store("unreachable.com", 0, "", t0), "Transfer failures should make the host unreachable");
+
+    auto waiting = cache.lookup("down.com", t0 + 1s);
+    ASSERT(!waiting.rules && waiting.unreachable && !waiting.fetch_needed,
+           "An unreachable host should defer its URLs, not block them, until error_ttl");
+    auto retry = cache.lookup("down.com", t0 + 3s);
+    ASSERT(!retry.rules && retry.unreachable && retry.fetch_needed, "Errors should be retried after error_ttl");
+    ASSERT(!cache.lookup("missing.com", t0).unreachable, "A host with rules is reachable");
+
+    cache.store("down.com", 200, "User-agent: *\nDisallow: /x\n", t0 + 4s);
+    auto recovered = cache.lookup("down.com", t0 + 5s);
+    ASSERT(recovered.rules && !recovered.unreachable && recovered.rules->allowed("/any"),
+           "A successful retry should bring the host back");
+    std::cout << "test_cache_status_handling passed" << std::endl;
+}
+
+void test_cache_evicts_least_recently_used() {
+    RobotsCache::Options options;
+    options.max_hosts = 2;
+    RobotsCache cache(AGENT, options);
+    auto t0 = RobotsCache::Clock::time_point{} + 100s;
+
+    cache.store("a.com", 404, "", t0);
+    cache.store("b.com", 404, "", t0);
+    cache.lookup("a.com", t0);  // b.com is now the oldest
+    cache.store("c.com", 404, "", t0);
+    ASSERT(cache.size() == 2, "Cache should stay within max_hosts");
+    ASSERT(cache.lookup("a.com", t0).rules, "Recently used host should stay cached");
+    ASSERT(cache.lookup("b.com", t0).fetch_needed, "Oldest host should be evicted");
+    std::cout << "test_cache_evicts_least_recently_used passed" << std::endl;
+}
+
+int main() {
+    test_selects_our_group();
+    test_longest_match_wins();
+    test_wildcards_and_anchors();
+    test_tolerates_messy_files();
+    test_robots_path();
+    test_cache_fetches_once_per_ttl();
+    test_cache_status_handling();
+    test_cache_evicts_least_recently_used();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "../src/segmented_warc_writer.hpp"
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+using crawler::SegmentedWarcWriter;
+namespace fs = std::filesystem;
+
+// RAII guard for a scratch directory
+class TempDir {
+public:
+    explicit TempDir(const std::string& name) : path_(fs::temp_directory_path() / name) {
+        fs::remove_all(path_);
+        fs::create_directories(path_);
+    }
+    ~TempDir() { fs::remove_all(path_); }
+    std::string prefix() const { return (path_ / "crawled").string(); }
+
+private:
+    fs::path path_;
+};
+
+// Index lines without the header, split into fields.
+std::vector<std::vector<std::string>> read_cdx(const std::string& path) {
+    std::ifstream in(path);
+    ASSERT(in.is_open(), "CDX file should exist: " + path);
+    std::string line;
+    std::getline(in, line);
+    ASSERT(line == " CDX a b k S V g", "CDX should start with its field header");
+    std::vector<std::vector<std::string>> rows;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::vector<std::string> row;
+        std::string field;
+        while (fields >> field) row.push_back(field);
+        ASSERT(row.size() == 6, "Every CDX line should have six fields");
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+void test_rotates_by_record_count() {
+    TempDir dir("igi_segments_count");
+    crawler::SegmentOptions options;
+    options.max_segment_records = 3;
+    std::vector<crawler::WarcRecordInfo> infos;
+    {
+        SegmentedWarcWriter writer(dir.prefix(), options);
+        for (int i = 0; i < 7; ++i) {
+            infos.push_back(writer.write_record("http://example.com/" + std::to_string(i), "page " + std::to_string(i)));
+        }
+    }
+
+    std::string first = SegmentedWarcWriter::segment_path(dir.prefix(), 1);
+    ASSERT(first == dir.prefix() + "_00001.warc.gz", "Segments should be numbered with five digits");
+    ASSERT(infos[0].filename == first && infos[2].filename == first, "First three records share a segment");
+    ASSERT(infos[3].filename == SegmentedWarcWriter::segment_path(dir.prefix(), 2), "Fourth record starts a segment");
+    ASSERT(infos[6].filename == SegmentedWarcWriter::segment_path(dir.prefix(), 3), "Seventh record starts a segment");
+    ASSERT(infos[3].offset == 0, "A new segment starts at offset 0");
+    ASSERT(!fs::exists(SegmentedWarcWriter::segment_path(dir.prefix(), 4)), "An unused segment should be removed");
+
+    auto rows = read_cdx(SegmentedWarcWriter::cdx_path(first));
+    ASSERT(rows.size() == 3, "Index should list every record of its segment");
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ASSERT(rows[i][0] == "http://example.com/" + std::to_string(i), "Index should hold the URL");
+        ASSERT(rows[i][1].size() == 14, "Index should hold a 14-digit timestamp");
+        ASSERT(rows[i][1] == infos[i].warc_date.substr(0, 4) + infos[i].warc_date.substr(5, 2) +
+                                 infos[i].warc_date.substr(8, 2) + infos[i].warc_date.substr(11, 2) +
+                                 infos[i].warc_date.substr(14, 2) + infos[i].warc_date.substr(17, 2),
+               "Index timestamps should be the records' WARC-Date");
+        ASSERT(rows[i][2] == infos[i].payload_digest, "Index should hold the payload digest");
+        ASSERT(rows[i][3] == std::to_string(infos[i].length), "Index should hold the length");
+        ASSERT(rows[i][4] == std::to_string(infos[i].offset), "Index should hold the offset");
+        ASSERT(rows[i][5] == "crawled_00001.warc.gz", "Index should name the segment");
+    }
+    ASSERT(read_cdx(SegmentedWarcWriter::cdx_path(infos[6].filename)).size() == 1, "Last segment is indexed on close");
+
+    // Rebuilt by scanning, as after a crash, the index should match the one written on close
+    fs::remove(SegmentedWarcWriter::cdx_path(first));
+    ASSERT(SegmentedWarcWriter::index_segment(first) == 3, "The segment should be indexable by scanning");
+    ASSERT(read_cdx(SegmentedWarcWriter::cdx_path(first)) == rows, "A rebuilt index should match the live one");
+    std::cout << "test_rotates_by_record_count passed" << std::endl;
+}
+
+void test_rotates_by_size_under_concurrency() {
+    TempDir dir("igi_segments_size");
+    crawler::SegmentOptions options;
+    options.max_segment_bytes = 20000;
+    const int threads = 4, per_thread = 50;
+    {
+        SegmentedWarcWriter writer(dir.prefix(), options);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    std::string body(2000 + i * 37, static_cast<char>('a' + t));
+                    for (size_t j = 0; j < body.size(); j += 7) body[j] = static_cast<char>('0' + (i + j) % 10);
+                    writer.write_record("http://example.com/" + std::to_string(t) + "/" + std::to_string(i), body);
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+
+    size_t indexed = 0, segments = 0;
+    for (uint32_t n = 1; fs::exists(SegmentedWarcWriter::segment_path(dir.prefix(), n)); ++n) {
+        std::string segment = SegmentedWarcWriter::segment_path(dir.prefix(), n);
+        auto rows = read_cdx(SegmentedWarcWriter::cdx_path(segment));
+        int64_t expected_offset = 0;
+        for (const auto& row : rows) {
+            ASSERT(std::stoll(row[4]) == expected_offset, "Index should cover its segment without gaps");
+            expected_offset += std::stoll(row[3]);
+        }
+        ASSERT(expected_offset == static_cast<int64_t>(fs::file_size(segment)), "Index should cover the whole segment");
+        indexed += rows.size();
+        ++segments;
+    }
+    ASSERT(indexed == threads * per_thread, "Every record should be indexed exactly once");
+    ASSERT(segments > 1, "Segments should rotate once they pass the size limit");
+    std::cout << "test_rotates_by_size_under_concurrency passed" << std::endl;
+}
+
+void test_restart_continues_numbering_and_recovers_index() {
+    TempDir dir("igi_segments_restart");
+    std::vector<crawler::WarcRecordInfo> infos;
+    {
+        SegmentedWarcWriter writer(dir.prefix());
+        infos.push_back(writer.write_record("http://example.com/a", "first"));
+        infos.push_back(writer.write_record("http://example.com/b", "second"));
+    }
+
+    // Simulate a crash: the index is gone and the last record was cut short
+    std::string first = infos[0].filename;
+    fs::remove(SegmentedWarcWriter::cdx_path(first));
+    fs::resize_file(first, fs::file_size(first) - 5);
+
+    {
+        SegmentedWarcWriter writer(dir.prefix());
+        ASSERT(writer.current_segment() == SegmentedWarcWriter::segment_path(dir.prefix(), 2),
+               "A restart should open the next segment number");
+        writer.write_record("http://example.com/c", "third");
+    }
+
+    auto rows = read_cdx(SegmentedWarcWriter::cdx_path(first));
+    ASSERT(rows.size() == 1, "Recovered index should skip the truncated record");
+    ASSERT(rows[0][0] == "http://example.com/a" && rows[0][2] == infos[0].payload_digest,
+           "Recovered index should read URL and digest from the record");
+    ASSERT(rows[0][3] == std::to_string(infos[0].length) && rows[0][4] == "0", "Recovered extents should match");
+    ASSERT(SegmentedWarcWriter::index_segment(first) == 1, "Indexing can be run by hand");
+    std::cout << "test_restart_continues_numbering_and_recovers_index passed" << std::endl;
+}
+
+void test_zstd_segments_carry_trained_dictionary() {
+    TempDir dir("igi_segments_zstd");
+    crawler::SegmentOptions options;
+    options.max_segment_records = 60;
+    options.dictionary_sample_bytes = 32 * 1024;
+    options.writer.codec = crawler::RecordCodec::Zstd;
+    std::vector<crawler::WarcRecordInfo> infos;
+    {
+        SegmentedWarcWriter writer(dir.prefix(), options);
+        for (int i = 0; i < 90; ++i) {
+            std::string page = "<html><head><title>Page " + std::to_string(i) + "</title></head><body>";
+            for (int p = 0; p < 12; ++p) {
+                page += "<p class=\"text\">Paragraph " + std::to_string(p) + " about subject " +
+                        std::to_string((i * 17 + p) % 53) + " of the example wiki.</p>";
+            }
+            infos.push_back(writer.write_record("http://example.com/" + std::to_string(i), page + "</body></html>"));
+        }
+    }
+
+    std::string first = SegmentedWarcWriter::segment_path(dir.prefix(), 1, crawler::RecordCodec::Zstd);
+    std::string second = SegmentedWarcWriter::segment_path(dir.prefix(), 2, crawler::RecordCodec::Zstd);
+    ASSERT(first == dir.prefix() + "_00001.warc.zst", "Zstd segments should use the .warc.zst suffix");
+    ASSERT(infos[0].filename == first && infos[60].filename == second, "Zstd segments should rotate too");
+    ASSERT(crawler::read_zstd_dictionary_file(first).empty(), "The first segment has no sample to train on yet");
+    std::string dictionary = crawler::read_zstd_dictionary_file(second);
+    ASSERT(!dictionary.empty(), "The next segment should store the dictionary trained on the first");
+    ASSERT(infos[60].offset == static_cast<long>(crawler::zstd_dictionary_frame(dictionary).size()),
+           "Records should start after the dictionary frame");
+
+    auto rows = read_cdx(SegmentedWarcWriter::cdx_path(second));
+    ASSERT(rows.size() == 30, "Index should list every record of the zstd segment");
+    ASSERT(rows[0][4] == std::to_string(infos[60].offset), "Index offsets should skip the dictionary frame");
+    fs::remove(SegmentedWarcWriter::cdx_path(second));
+    ASSERT(SegmentedWarcWriter::index_segment(second) == 30, "A zstd segment should be indexable by scanning");
+    auto scanned = read_cdx(SegmentedWarcWriter::cdx_path(second));
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ASSERT(scanned[i][0] == rows[i][0] && scanned[i][3] == rows[i][3] && scanned[i][4] == rows[i][4],
+               "Scanned index should match the written one");
+    }
+    std::cout << "test_zstd_segments_carry_trained_dictionary passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_rotates_by_record_count();
+        test_rotates_by_size_under_concurrency();
+        test_restart_continues_numbering_and_recovers_index();
+        test_zstd_segments_carry_trained_dictionary();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -3,7 +3,12 @@
 #include <fstream>
 #include <cassert>
 #include <filesystem>
+#include <set>
+#include <string>
+#include <thread>
 #include <vector>
+#include <zlib.h>
+#include <zstd.h>
 
 // Simple assertion macro
 #define ASSERT(condition, message) \
@@ -53,10 +58,248 @@ void test_write_record() {
     std::cout << "test_write_record passed" << std::endl;
 }
 
+// Reads one record back the way the indexer does: slice by offset/length, then gunzip.
+std::string read_record(const std::string& filename, const crawler::WarcRecordInfo& info) {
+    std::ifstream in(filename, std::ios::binary);
+    in.seekg(info.offset);
+    std::string compressed(info.length, '\0');
+    in.read(&compressed[0], info.length);
+    ASSERT(in.gcount() == info.length, "Record should be fully on disk");
+
+    z_stream zs{};
+    ASSERT(inflateInit2(&zs, 15 + 32) == Z_OK, "inflateInit2 should succeed");
+    zs.next_in = reinterpret_cast<Bytef*>(&compressed[0]);
+    zs.avail_in = static_cast<uInt>(compressed.size());
+    std::string out;
+    char buffer[16384];
+    int ret;
+    do {
+        zs.next_out = reinterpret_cast<Bytef*>(buffer);
+        zs.avail_out = sizeof(buffer);
+        ret = inflate(&zs, Z_NO_FLUSH);
+        out.append(buffer, sizeof(buffer) - zs.avail_out);
+    } while (ret == Z_OK);
+    inflateEnd(&zs);
+    ASSERT(ret == Z_STREAM_END, "Record should be one complete gzip member");
+    ASSERT(zs.avail_in == 0, "Record length should end exactly at the member end");
+    return out;
+}
+
+void test_records_round_trip() {
+    std::string filename = "test_warc_round_trip.warc.gz";
+    std::filesystem::remove(filename);
+
+    std::string big(200000, 'x');  // Larger than the initial deflate output estimate for most inputs
+    std::vector<crawler::WarcRecordInfo> infos;
+    {
+        crawler::WarcWriter writer(filename);
+        infos.push_back(writer.write_record("http://example.com/a", "<html>first</html>"));
+        infos.push_back(writer.write_record("http://example.com/b", big));
+    }
+    {
+        crawler::WarcWriter writer(filename);  // Reopening appends
+        infos.push_back(writer.write_record("http://example.com/c", ""));
+    }
+
+    ASSERT(infos[1].offset == infos[0].offset + infos[0].length, "Records should be contiguous");
+    ASSERT(infos[2].offset == infos[1].offset + infos[1].length, "A reopened writer should append");
+    ASSERT(static_cast<int64_t>(std::filesystem::file_size(filename)) == infos[2].offset + infos[2].length,
+           "File should end after the last record");
+
+    std::string first = read_record(filename, infos[0]);
+    ASSERT(first.rfind("WARC/1.0\r\n", 0) == 0, "Record should start with the WARC version");
+    ASSERT(first.find("WARC-Target-URI: http://example.com/a\r\n") != std::string::npos, "URI header should be set");
+    ASSERT(first.find("Content-Length: 18\r\n") != std::string::npos, "Content length should be set");
+    ASSERT(first.size() >= 22 && first.compare(first.size() - 22, 22, "<html>first</html>\r\n\r\n") == 0,
+           "Body and trailer should end the record");
+    ASSERT(read_record(filename, infos[1]).find(big) != std::string::npos, "Large bodies should survive");
+
+    std::filesystem::remove(filename);
+    std::cout << "test_records_round_trip passed" << std::endl;
+}
+
+void test_concurrent_writers() {
+    std::string filename = "test_warc_concurrent.warc.gz";
+    std::filesystem::remove(filename);
+
+    const int threads = 8, per_thread = 100;
+    std::vector<std::vector<crawler::WarcRecordInfo>> infos(threads);
+    {
+        crawler::WarcWriterOptions options;
+        options.sync_every_records = 50;
+        crawler::WarcWriter writer(filename, options);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    std::string body = "<html>thread " + std::to_string(t) + " page " + std::to_string(i) + "</html>";
+                    infos[t].push_back(writer.write_record("http://example.com/" + std::to_string(t * 1000 + i), body));
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        writer.sync();
+    }
+
+    // Every byte of the file should belong to exactly one record
+    std::set<std::pair<int64_t, int64_t>> extents;
+    for (const auto& list : infos) {
+        for (const auto& info : list) extents.insert({info.offset, info.length});
+    }
+    ASSERT(extents.size() == threads * per_thread, "Every record should get its own offset");
+    int64_t expected = 0;
+    for (const auto& [offset, length] : extents) {
+        ASSERT(offset == expected, "Records should neither overlap nor leave gaps");
+        expected = offset + length;
+    }
+    ASSERT(static_cast<int64_t>(std::filesystem::file_size(filename)) == expected, "File should hold exactly the records");
+
+    for (int t = 0; t < threads; ++t) {
+        for (int i = 0; i < per_thread; i += 17) {
+            std::string record = read_record(filename, infos[t][i]);
+            ASSERT(record.find("thread " + std::to_string(t) + " page " + std::to_string(i) + "<") != std::string::npos,
+                   "Each offset should point at its own record");
+        }
+    }
+
+    std::filesystem::remove(filename);
+    std::cout << "test_concurrent_writers passed" << std::endl;
+}
+
+void test_payload_digest() {
+    // SHA-1 test vectors (FIPS 180), base32-encoded as in WARC-Payload-Digest
+    ASSERT(crawler::warc_payload_digest("") == "3I42H3S6NNFQ2MSVX7XZKYAYSCX5QBYJ", "Empty input digest");
+    ASSERT(crawler::warc_payload_digest("abc") == "VGMT4NSHA2AWVOR6EVYXQUGCNSONBWE5", "'abc' digest");
+    ASSERT(crawler::warc_payload_digest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+               "QSMD4RA4HPJG5OVOJKQ7SUJJ4XSUM4HR", "Two-block digest");
+    ASSERT(crawler::warc_payload_digest(std::string(1000000, 'a')) == "GSVJOPGUYTNKJ5Q65MV5XLJHGFSTIALP",
+           "Million 'a' digest");
+
+    std::string filename = "test_warc_digest.warc.gz";
+    std::filesystem::remove(filename);
+    crawler::WarcRecordInfo info;
+    {
+        crawler::WarcWriter writer(filename);
+        info = writer.write_record("http://example.com/", "abc");
+    }
+    ASSERT(info.filename == filename, "Record info should name the file");
+    ASSERT(info.payload_digest == "VGMT4NSHA2AWVOR6EVYXQUGCNSONBWE5", "Record info should carry the digest");
+    ASSERT(info.warc_date.size() == 20 && read_record(filename, info).find("WARC-Date: " + info.warc_date + "\r\n") !=
+               std::string::npos, "Record info should carry the WARC-Date it wrote");
+    ASSERT(read_record(filename, info).find("WARC-Payload-Digest: sha1:VGMT4NSHA2AWVOR6EVYXQUGCNSONBWE5\r\n") !=
+               std::string::npos, "Record should carry a payload digest header");
+    std::filesystem::remove(filename);
+    std::cout << "test_payload_digest passed" << std::endl;
+}
+
+// Pages sharing boilerplate with varying text, enough for the dictionary trainer to work with.
+std::vector<std::string> sample_pages(size_t count) {
+    std::vector<std::string> pages;
+    for (size_t i = 0; i < count; ++i) {
+        std::string page = "<!DOCTYPE html><html><head><title>Article " + std::to_string(i) +
+                           "</title><link rel=\"stylesheet\" href=\"/static/site.css\"></head><body><nav>"
+                           "<a href=\"/\">Home</a> <a href=\"/about\">About</a></nav><main>";
+        for (size_t p = 0; p < 20; ++p) {
+            page += "<p class=\"body-text\">Paragraph " + std::to_string(p * 7 + i) + " of article " +
+                    std::to_string(i) + " talks about topic " + std::to_string((i * 31 + p) % 97) + ".</p>";
+        }
+        pages.push_back(page + "</main><footer>Copyright Example Wiki</footer></body></html>");
+    }
+    return pages;
+}
+
+std::string read_zstd_record(const std::string& filename, const crawler::WarcRecordInfo& info,
+                             const std::string& dictionary) {
+    std::ifstream in(filename, std::ios::binary);
+    in.seekg(info.offset);
+    std::string compressed(info.length, '\0');
+    in.read(&compressed[0], info.length);
+    ASSERT(in.gcount() == info.length, "Record should be fully on disk");
+
+    unsigned long long size = ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+    ASSERT(size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR, "Frame should carry its size");
+    ASSERT(ZSTD_findFrameCompressedSize(compressed.data(), compressed.size()) == compressed.size(),
+           "A record should be exactly one zstd frame");
+    std::string out(size, '\0');
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    size_t got = ZSTD_decompress_usingDict(dctx, &out[0], out.size(), compressed.data(), compressed.size(),
+                                           dictionary.data(), dictionary.size());
+    ZSTD_freeDCtx(dctx);
+    ASSERT(!ZSTD_isError(got) && got == size, "Record should decompress on its own");
+    return out;
+}
+
+void test_zstd_records() {
+    std::string filename = "test_warc_zstd.warc.zst";
+    std::filesystem::remove(filename);
+
+    std::vector<std::string> pages = sample_pages(200);
+    std::string dictionary = crawler::train_zstd_dictionary(pages, 16 * 1024);
+    ASSERT(!dictionary.empty(), "Dictionary should train on 200 pages");
+    ASSERT(crawler::train_zstd_dictionary({"a", "b"}).empty(), "Too few samples should give no dictionary");
+
+    crawler::WarcWriterOptions options;
+    options.codec = crawler::RecordCodec::Zstd;
+    options.zstd_dictionary = dictionary;
+    std::vector<crawler::WarcRecordInfo> infos;
+    {
+        crawler::WarcWriter writer(filename, options);
+        for (size_t i = 0; i < 3; ++i) {
+            infos.push_back(writer.write_record("http://example.com/" + std::to_string(i), pages[i]));
+        }
+    }
+
+    ASSERT(crawler::read_zstd_dictionary_file(filename) == dictionary, "Dictionary should head the file");
+    ASSERT(infos[0].offset == static_cast<long>(crawler::zstd_dictionary_frame(dictionary).size()),
+           "Records should start after the dictionary frame");
+    for (size_t i = 0; i < infos.size(); ++i) {
+        std::string record = read_zstd_record(filename, infos[i], dictionary);
+        ASSERT(record.find("WARC-Target-URI: http://example.com/" + std::to_string(i)) != std::string::npos,
+               "Record should hold its own header");
+        ASSERT(record.find(pages[i]) != std::string::npos, "Record should hold its own page");
+        ASSERT(record.compare(record.size() - 4, 4, "\r\n\r\n") == 0, "Record should end with the trailer");
+    }
+
+    {
+        crawler::WarcWriter writer(filename, options);  // Same dictionary: appends
+        auto info = writer.write_record("http://example.com/again", pages[3]);
+        ASSERT(read_zstd_record(filename, info, dictionary).find(pages[3]) != std::string::npos,
+               "Appended record should decompress");
+    }
+
+    bool threw = false;
+    try {
+        crawler::WarcWriterOptions other = options;
+        other.zstd_dictionary = crawler::train_zstd_dictionary(sample_pages(100), 8 * 1024);
+        crawler::WarcWriter writer(filename, other);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Reopening with a different dictionary should fail");
+
+    std::filesystem::remove(filename);
+
+    // Without a dictionary there is no frame to skip
+    options.zstd_dictionary.clear();
+    {
+        crawler::WarcWriter writer(filename, options);
+        auto info = writer.write_record("http://example.com/plain", pages[0]);
+        ASSERT(info.offset == 0, "Plain zstd records should start at 0");
+        ASSERT(read_zstd_record(filename, info, "").find(pages[0]) != std::string::npos,
+               "Plain zstd record should decompress");
+    }
+    std::filesystem::remove(filename);
+    std::cout << "test_zstd_records passed" << std::endl;
+}
+
 int main() {
     try {
         test_file_creation();
         test_write_record();
+        test_records_round_trip();
+        test_concurrent_writers();
+        test_payload_digest();
+        test_zstd_records();
         std::cout << "All tests passed!" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Test failed with exception: " << e.what() << std::endl;
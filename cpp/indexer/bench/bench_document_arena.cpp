@@ -0,0 +1,164 @@
+// Measures what the per-document Arena saves in index_html: heap allocations per page and pages/s.
+//
+// Usage: bench_document_arena [warc.gz] [num_pages]
+//
+// Pass a real crawl segment to measure on its pages; without one, num_pages synthetic pages are
+// generated. Each strategy extracts text, builds the snippet and counts terms for every page:
+//   heap           - Gumbo on malloc, destroyed node by node, term counts in a heap-allocated map
+//                    (index_html before the arena)
+//   arena          - index_html with HtmlParser::Gumbo: tree and term counts bump-allocated
+//   arena+stream   - index_html with HtmlParser::Streaming
+// Allocations are counted through operator new and Gumbo's allocator hook; run under `perf record`
+// to see the allocator's share of the profile drop alongside.
+
+#include "../src/arena.hpp"
+#include "../src/document_processor.hpp"
+#include "../src/gzip_decompressor.hpp"
+#include "../src/tokenizer.hpp"
+#include "../src/utils.hpp"
+#include "../src/warc_reader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <gumbo.h>
+
+namespace {
+
+std::atomic<size_t> heap_allocations{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+std::vector<std::string> read_pages(const std::string& path, size_t limit) {
+    indexer::WarcReader reader(1, indexer::WarcReader::AccessPattern::Sequential);
+    std::string_view file = reader.open(path)->data();
+    std::vector<std::string> pages;
+    indexer::GzipDecompressor decompressor;
+    for (size_t pos = 0; pos < file.size() && pages.size() < limit; pos += decompressor.consumed()) {
+        std::string_view record = decompressor.decompress(file.substr(pos));
+        size_t header_end = record.find("\r\n\r\n");
+        if (header_end != std::string_view::npos) pages.emplace_back(record.substr(header_end + 4));
+    }
+    return pages;
+}
+
+std::vector<std::string> synthetic_pages(size_t count) {
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> word(0, 4999);
+    std::lognormal_distribution<double> page_size(10.5, 0.6);  // ~36KB median
+    std::vector<std::string> pages;
+    for (size_t i = 0; i < count; ++i) {
+        size_t target = static_cast<size_t>(page_size(rng));
+        std::string html = "<!DOCTYPE html><html><head><title>Page " + std::to_string(i) +
+                           "</title><script>var x = 1;</script></head><body><div class=\"content\">";
+        while (html.size() < target) {
+            html += "<p class=\"para\">";
+            for (int w = 0; w < 30; ++w) html += "word" + std::to_string(word(rng)) + " ";
+            html += "<a href=\"/wiki/Article_" + std::to_string(word(rng)) + "\">link <b>text</b></a></p>\n";
+        }
+        pages.push_back(html + "</div></body></html>");
+    }
+    return pages;
+}
+
+void* counting_malloc(void*, size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size);
+}
+
+void counting_free(void*, void* p) {
+    std::free(p);
+}
+
+// index_html as it was before the arena.
+indexer::IndexedDocument heap_index_html(int doc_id, std::string_view html) {
+    GumboOptions options = kGumboDefaultOptions;
+    options.allocator = counting_malloc;
+    options.deallocator = counting_free;
+    GumboOutput* output = gumbo_parse_with_options(&options, html.data(), html.size());
+    indexer::ExtractedContent content = indexer::extract_content(output->root);
+    gumbo_destroy_output(&options, output);
+
+    indexer::IndexedDocument doc;
+    doc.doc_id = doc_id;
+    doc.title = content.title;
+    doc.snippet = content.text.substr(0, 200);
+    std::replace(doc.snippet.begin(), doc.snippet.end(), '\n', ' ');
+    std::replace(doc.snippet.begin(), doc.snippet.end(), '\r', ' ');
+
+    thread_local indexer::Tokenizer tokenizer;
+    thread_local std::unordered_map<std::string_view, uint32_t> term_freqs;
+    const auto& tokens = tokenizer.tokenize(content.text);
+    doc.doc_length = static_cast<uint32_t>(tokens.size());
+    term_freqs.clear();
+    for (std::string_view token : tokens) term_freqs[token]++;
+    doc.term_freqs.reserve(term_freqs.size());
+    for (const auto& [term, tf] : term_freqs) doc.term_freqs.emplace_back(std::string(term), tf);
+    std::sort(doc.term_freqs.begin(), doc.term_freqs.end());
+    return doc;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "";
+    size_t num_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    const int repetitions = 3;
+
+    std::vector<std::string> pages = path.empty() ? synthetic_pages(num_pages) : read_pages(path, num_pages);
+    size_t bytes = 0;
+    for (const auto& page : pages) bytes += page.size();
+    std::cout << (path.empty() ? "synthetic" : path) << ": " << pages.size() << " pages, " << bytes / 1024
+              << " KB of HTML" << std::endl;
+
+    indexer::Arena arena;
+    size_t sink = 0;
+    auto run = [&](const std::string& name, auto&& index) {
+        index(pages.front());  // Warm up pooled buffers so only steady-state allocations are counted
+        size_t allocations_before = heap_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < repetitions; ++rep) {
+            for (const auto& page : pages) sink += index(page).term_freqs.size();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double per_page = static_cast<double>(heap_allocations.load() - allocations_before) / (pages.size() * repetitions);
+        std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << pages.size() * repetitions / seconds << std::setw(16) << per_page << std::endl;
+    };
+
+    std::cout << std::left << std::setw(14) << "strategy" << std::right << std::setw(12) << "pages/s" << std::setw(16)
+              << "allocs/page" << std::endl;
+    run("heap", [&](const std::string& page) { return heap_index_html(1, page); });
+    run("arena", [&](const std::string& page) {
+        return indexer::index_html(1, page, indexer::HtmlParser::Gumbo, arena);
+    });
+    run("arena+stream", [&](const std::string& page) {
+        return indexer::index_html(1, page, indexer::HtmlParser::Streaming, arena);
+    });
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
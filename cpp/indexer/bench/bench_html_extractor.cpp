@@ -0,0 +1,154 @@
+// Compares HTML-to-text extraction through a full Gumbo parse against HtmlTextExtractor.
+//
+// Usage: bench_html_extractor <gumbo|streaming|diff> [warc.gz] [num_pages]
+//
+// Pass a real crawl segment to measure on its pages; without one, num_pages synthetic pages
+// (~200KB of nested markup each, where DOM construction costs the most) are generated. Pages are
+// loaded into memory first, then extracted repeatedly:
+//   gumbo      - gumbo_parse + extract_content + gumbo_destroy_output, as process_document did
+//   streaming  - one HtmlTextExtractor reused across pages
+//   diff       - runs both and counts pages whose whitespace-normalized text or title differ
+//
+// Peak RSS is a per-process high-water mark, so run each mode in its own process; the reported
+// figure is how far extraction pushed it past the loaded pages.
+
+#include "../src/gzip_decompressor.hpp"
+#include "../src/html_extractor.hpp"
+#include "../src/utils.hpp"
+#include "../src/warc_reader.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+#include <gumbo.h>
+
+namespace {
+
+long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+std::vector<std::string> read_pages(const std::string& path, size_t limit) {
+    indexer::WarcReader reader(1, indexer::WarcReader::AccessPattern::Sequential);
+    std::string_view file = reader.open(path)->data();
+    std::vector<std::string> pages;
+    indexer::GzipDecompressor decompressor;
+    for (size_t pos = 0; pos < file.size() && pages.size() < limit; pos += decompressor.consumed()) {
+        std::string_view record = decompressor.decompress(file.substr(pos));
+        size_t header_end = record.find("\r\n\r\n");
+        if (header_end != std::string_view::npos) pages.emplace_back(record.substr(header_end + 4));
+    }
+    return pages;
+}
+
+std::vector<std::string> synthetic_pages(size_t count) {
+    std::mt19937 rng(19);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<std::string> pages;
+    for (size_t i = 0; i < count; ++i) {
+        std::string html = "<!DOCTYPE html><html><head><title>Article " + std::to_string(i) +
+                           " &mdash; Example Wiki</title><script>var config = {\"a\": 1};</script>"
+                           "<style>.nav > li { float: left }</style></head><body><div id=\"content\">";
+        while (html.size() < 200000) {
+            int p = percent(rng);
+            if (p < 50) {
+                html += "<p>Some <b>bold</b> text about <a href=\"/wiki/Topic_" + std::to_string(p) +
+                        "\" title=\"Topic\">topic " + std::to_string(p) + "</a> with &amp; entities &#8212; and "
+                        "<span class=\"ref\"><sup>[" + std::to_string(p) + "]</sup></span> references.</p>\n";
+            } else if (p < 65) {
+                html += "<h2><span class=\"mw-headline\">Section " + std::to_string(p) + "</span></h2>\n";
+            } else if (p < 85) {
+                html += "<table class=\"infobox\"><tr><th>Key</th><td>Value " + std::to_string(p) +
+                        "</td></tr><tr><th>Other</th><td><a href=\"/x\">x</a></td></tr></table>\n";
+            } else {
+                html += "<ul><li><a href=\"/a\">One</a></li><li><a href=\"/b\">Two</a></li><li>Three</li></ul>"
+                        "<!-- navigation -->\n";
+            }
+        }
+        pages.push_back(html + "</div></body></html>");
+    }
+    return pages;
+}
+
+std::string normalize_space(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        bool space = c == ' ' || c == '\t' || c == '\n' || c == '\f' || c == '\r';
+        if (!space) {
+            out += c;
+        } else if (!out.empty() && out.back() != ' ') {
+            out += ' ';
+        }
+    }
+    if (!out.empty() && out.back() == ' ') out.pop_back();
+    return out;
+}
+
+indexer::ExtractedContent gumbo_extract(const std::string& html) {
+    GumboOutput* output = gumbo_parse_with_options(&kGumboDefaultOptions, html.data(), html.size());
+    indexer::ExtractedContent content = indexer::extract_content(output->root);
+    gumbo_destroy_output(&kGumboDefaultOptions, output);
+    return content;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    std::string path = argc > 2 ? argv[2] : "";
+    size_t num_pages = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 300;
+    const int repetitions = 3;
+    if (mode != "gumbo" && mode != "streaming" && mode != "diff") {
+        std::cerr << "Usage: bench_html_extractor <gumbo|streaming|diff> [warc.gz] [num_pages]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> pages = path.empty() ? synthetic_pages(num_pages) : read_pages(path, num_pages);
+    size_t bytes = 0;
+    for (const auto& page : pages) bytes += page.size();
+    std::cout << (path.empty() ? "synthetic" : path) << ": " << pages.size() << " pages, " << bytes / 1024
+              << " KB of HTML" << std::endl;
+
+    if (mode == "diff") {
+        indexer::HtmlTextExtractor extractor;
+        size_t text_diffs = 0, title_diffs = 0;
+        for (const auto& page : pages) {
+            indexer::ExtractedContent expected = gumbo_extract(page);
+            const indexer::ExtractedContent& actual = extractor.extract(page);
+            if (normalize_space(actual.text) != normalize_space(expected.text)) ++text_diffs;
+            if (actual.title != expected.title) ++title_diffs;
+        }
+        std::cout << "text differs on " << text_diffs << ", title on " << title_diffs << " of " << pages.size()
+                  << " pages" << std::endl;
+        return 0;
+    }
+
+    long baseline_kb = peak_rss_kb();
+    size_t sink = 0;
+    indexer::HtmlTextExtractor extractor;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+        for (const auto& page : pages) {
+            if (mode == "gumbo") {
+                sink += gumbo_extract(page).text.size();
+            } else {
+                sink += extractor.extract(page).text.size();
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(12) << mode << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << pages.size() * repetitions / seconds << " pages/s" << std::setw(10)
+              << bytes * repetitions / seconds / (1024 * 1024) << " MB/s" << std::setw(10)
+              << (peak_rss_kb() - baseline_kb) / 1024.0 << " MB peak RSS over baseline" << std::endl;
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Compares exhaustive DAAT BM25 against Block-Max WAND on a synthetic Zipfian corpus.
+//
+// Usage: bench_query_engine [num_docs] [k]
+//
+// Both paths start from the same encoded posting lists (what RocksDB hands the ranker), so the
+// exhaustive timing includes decoding every posting while BMW only decodes blocks it lands in.
+
+#include "../src/query_engine.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Corpus {
+    std::vector<uint32_t> doc_lengths;          // Indexed by doc ID
+    std::vector<std::string> encoded_postings;  // Indexed by term rank (0 = most common)
+};
+
+// Each document draws its length, then its tokens from a Zipf(1.0) vocabulary.
+Corpus build_corpus(uint32_t num_docs, uint32_t vocab_size, std::mt19937& rng) {
+    std::vector<double> cumulative(vocab_size);
+    double total = 0.0;
+    for (uint32_t rank = 0; rank < vocab_size; ++rank) {
+        total += 1.0 / (rank + 1);
+        cumulative[rank] = total;
+    }
+
+    Corpus corpus;
+    corpus.doc_lengths.resize(num_docs + 1, 0);
+    std::vector<std::vector<indexer::Posting>> postings(vocab_size);
+    std::lognormal_distribution<double> length_dist(5.5, 0.8);
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    std::vector<uint32_t> tf(vocab_size, 0);
+    std::vector<uint32_t> touched;
+
+    for (uint32_t doc = 1; doc <= num_docs; ++doc) {
+        uint32_t length = std::max<uint32_t>(10, static_cast<uint32_t>(length_dist(rng)));
+        corpus.doc_lengths[doc] = length;
+        for (uint32_t i = 0; i < length; ++i) {
+            uint32_t rank = static_cast<uint32_t>(
+                std::lower_bound(cumulative.begin(), cumulative.end(), uniform(rng)) - cumulative.begin());
+            rank = std::min(rank, vocab_size - 1);
+            if (tf[rank]++ == 0) touched.push_back(rank);
+        }
+        for (uint32_t rank : touched) {
+            postings[rank].push_back({doc, tf[rank], length});
+            tf[rank] = 0;
+        }
+        touched.clear();
+    }
+
+    for (const auto& list : postings) {
+        corpus.encoded_postings.push_back(indexer::encode_postings(list));
+    }
+    return corpus;
+}
+
+struct RunResult {
+    double millis;
+    size_t docs_scored;
+    std::vector<indexer::ScoredDoc> top;
+};
+
+RunResult run_exhaustive(const Corpus& corpus, const std::vector<uint32_t>& query,
+                         const indexer::CollectionStats& stats, size_t k, const indexer::DocLengthLookup& lookup) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<indexer::Posting>> decoded(query.size());
+    std::vector<const std::vector<indexer::Posting>*> term_postings;
+    for (size_t i = 0; i < query.size(); ++i) {
+        indexer::decode_postings(corpus.encoded_postings[query[i]], decoded[i]);
+        term_postings.push_back(&decoded[i]);
+    }
+    indexer::SearchStats search_stats;
+    auto top = indexer::bm25_search(term_postings, lookup, stats, k, {}, &search_stats);
+    auto end = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double, std::milli>(end - start).count(), search_stats.docs_scored, top};
+}
+
+RunResult run_block_max_wand(const Corpus& corpus, const std::vector<uint32_t>& query,
+                             const indexer::CollectionStats& stats, size_t k, const indexer::DocLengthLookup& lookup) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<indexer::PostingCursor> cursors;
+    for (uint32_t term : query) {
+        cursors.emplace_back(corpus.encoded_postings[term]);
+    }
+    indexer::SearchStats search_stats;
+    auto top = indexer::bm25_search_block_max_wand(cursors, lookup, stats, k, {}, &search_stats);
+    auto end = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double, std::milli>(end - start).count(), search_stats.docs_scored, top};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t num_docs = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 200000;
+    size_t k = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    const uint32_t vocab_size = 50000;
+    const int repetitions = 5;
+
+    std::mt19937 rng(7);
+    std::cout << "Building corpus: " << num_docs << " docs, " << vocab_size << " terms..." << std::endl;
+    Corpus corpus = build_corpus(num_docs, vocab_size, rng);
+
+    double total_length = 0;
+    for (uint32_t len : corpus.doc_lengths) total_length += len;
+    indexer::CollectionStats stats{num_docs, total_length / num_docs};
+    indexer::DocLengthLookup lookup = [&](uint32_t doc) { return corpus.doc_lengths[doc]; };
+
+    // Term ranks: 0-2 are "the"-like, hundreds are common, thousands are rare
+    const std::vector<std::pair<std::string, std::vector<uint32_t>>> queries = {
+        {"common+common", {0, 1}},
+        {"common+rare", {0, 4000}},
+        {"mid+rare", {150, 9000}},
+        {"3 common+rare", {0, 2, 5, 20000}},
+        {"mid+mid", {120, 300}},
+        {"5 mixed", {1, 40, 400, 4000, 40000}},
+    };
+
+    std::cout << std::left << std::setw(16) << "query" << std::right
+              << std::setw(14) << "exh_scored" << std::setw(12) << "exh_ms"
+              << std::setw(14) << "bmw_scored" << std::setw(12) << "bmw_ms"
+              << std::setw(10) << "speedup" << std::setw(8) << "same" << std::endl;
+
+    for (const auto& [name, query] : queries) {
+        RunResult exhaustive{}, wand{};
+        double exhaustive_ms = 0, wand_ms = 0;
+        for (int rep = 0; rep < repetitions; ++rep) {
+            exhaustive = run_exhaustive(corpus, query, stats, k, lookup);
+            wand = run_block_max_wand(corpus, query, stats, k, lookup);
+            exhaustive_ms += exhaustive.millis;
+            wand_ms += wand.millis;
+        }
+        exhaustive_ms /= repetitions;
+        wand_ms /= repetitions;
+
+        bool same = exhaustive.top.size() == wand.top.size();
+        for (size_t i = 0; same && i < wand.top.size(); ++i) {
+            same = exhaustive.top[i].doc_id == wand.top[i].doc_id;
+        }
+
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << exhaustive.docs_scored << std::setw(12) << exhaustive_ms
+                  << std::setw(14) << wand.docs_scored << std::setw(12) << wand_ms
+                  << std::setw(9) << std::setprecision(1) << (wand_ms > 0 ? exhaustive_ms / wand_ms : 0.0) << "x"
+                  << std::setw(8) << (same ? "yes" : "NO") << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Measures indexing through SegmentBuilder and IndexWriter: docs/s, and how many bytes flushes and
+// background merges write per byte of final index (write amplification).
+//
+// Usage: bench_segment_writer [num_docs] [docs_per_segment] [merge_factor]
+//
+// Synthetic documents draw ~300 terms each from a Zipf-like 200k-term vocabulary. Every
+// docs_per_segment documents are flushed as a segment, as the commit stage does at its limits;
+// the index is written to ./bench_segment_index and removed afterwards.
+
+#include "../src/segment_writer.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    size_t num_docs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    size_t docs_per_segment = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    size_t merge_factor = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10;
+    const std::string dir = "bench_segment_index";
+    std::filesystem::remove_all(dir);
+
+    std::mt19937 rng(22);
+    std::geometric_distribution<uint32_t> term_rank(0.0005);
+    std::uniform_int_distribution<int> doc_terms(100, 500);
+    auto make_doc = [&](std::vector<std::pair<std::string, uint32_t>>& term_freqs) {
+        std::map<uint32_t, uint32_t> counts;
+        int n = doc_terms(rng);
+        for (int i = 0; i < n; ++i) counts[term_rank(rng) % 200000]++;
+        term_freqs.clear();
+        uint32_t length = 0;
+        for (const auto& [rank, tf] : counts) {
+            term_freqs.emplace_back("t" + std::to_string(rank), tf);
+            length += tf;
+        }
+        return length;
+    };
+
+    double generate_seconds = 0;
+    auto started = std::chrono::steady_clock::now();
+    {
+        indexer::IndexWriter writer(dir, {merge_factor, 1 << 20});
+        indexer::SegmentBuilder builder;
+        std::vector<std::pair<std::string, uint32_t>> term_freqs;
+        size_t peak_ram = 0;
+        for (size_t doc = 0; doc < num_docs; ++doc) {
+            auto generate_start = std::chrono::steady_clock::now();
+            uint32_t length = make_doc(term_freqs);
+            generate_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - generate_start).count();
+            builder.add_document(static_cast<uint32_t>(doc + 1), length, term_freqs);
+            if (builder.doc_count() >= docs_per_segment) {
+                peak_ram = std::max(peak_ram, builder.ram_bytes());
+                writer.flush(builder);
+            }
+        }
+        writer.flush(builder);
+        double index_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() - generate_seconds;
+        writer.maybe_merge();  // Catch up on whatever the background merger had not reached yet
+        double total_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() - generate_seconds;
+
+        indexer::IndexSnapshot snapshot = writer.snapshot();
+        uint64_t index_bytes = 0;
+        for (const auto& segment : snapshot.segments()) index_bytes += segment->size_bytes();
+
+        std::cout << num_docs << " docs, " << docs_per_segment << " per segment, merge factor " << merge_factor
+                  << std::endl;
+        std::cout << std::fixed << std::setprecision(1) << std::setw(12) << num_docs / index_seconds
+                  << " docs/s indexed (" << num_docs / total_seconds << " docs/s including final merges)" << std::endl;
+        std::cout << std::setw(12) << peak_ram / (1024.0 * 1024.0) << " MB peak in-memory segment" << std::endl;
+        std::cout << std::setw(12) << index_bytes / (1024.0 * 1024.0) << " MB index in "
+                  << snapshot.segments().size() << " segments" << std::endl;
+        std::cout << std::setprecision(2) << std::setw(12)
+                  << static_cast<double>(writer.bytes_written()) / std::max<uint64_t>(index_bytes, 1)
+                  << "x write amplification" << std::endl;
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Measures the front-coded term dictionary: bytes per term against the version 1 segment
+// dictionary (varint-prefixed terms, plus a 32-byte entry per term built in memory at open),
+// and exact lookups and prefix scans per second.
+//
+// Usage: bench_term_dictionary [num_terms] [num_lookups]
+//
+// The vocabulary is random lowercase words with a Zipf-ish length mix, sorted, as a segment holds it.
+
+#include "../src/term_dictionary.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    size_t num_terms = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t num_lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::geometric_distribution<int> extra_length(0.25);
+    std::set<std::string> unique;
+    while (unique.size() < num_terms) {
+        std::string word;
+        for (int i = 3 + extra_length(rng); i > 0; --i) word.push_back(static_cast<char>(letter(rng)));
+        unique.insert(word);
+    }
+    std::vector<std::string> terms(unique.begin(), unique.end());
+    unique.clear();
+
+    indexer::TermDictionaryBuilder builder;
+    size_t v1_bytes = 0;
+    for (const auto& term : terms) {
+        builder.add(term);
+        v1_bytes += term.size() + 3;  // Size, doc freq and postings size varints, at ~1 byte each
+    }
+    indexer::TermDictionary dict(builder.blocks(), builder.block_index(), builder.size());
+    // The front-coded dictionary also needs the fixed-width postings offset and doc freq tables
+    size_t v2_bytes = builder.blocks().size() + builder.block_index().size() + terms.size() * 12;
+    size_t v1_resident = v1_bytes + terms.size() * 32;
+
+    std::vector<std::string> probes;
+    std::uniform_int_distribution<size_t> pick(0, terms.size() - 1);
+    for (size_t i = 0; i < num_lookups; ++i) probes.push_back(terms[pick(rng)]);
+
+    auto started = std::chrono::steady_clock::now();
+    uint64_t checksum = 0;
+    for (const auto& probe : probes) checksum += dict.find(probe);
+    double lookup_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    size_t scans = std::max<size_t>(num_lookups / 100, 1);
+    started = std::chrono::steady_clock::now();
+    uint64_t scanned = 0;
+    for (size_t i = 0; i < scans; ++i) {
+        auto [first, last] = dict.prefix_range(std::string_view(probes[i]).substr(0, 2));
+        for (auto it = dict.seek(first); it.valid() && it.id() < last; it.next()) ++scanned;
+    }
+    double scan_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << terms.size() << " terms (checksum " << checksum << ")" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(12) << static_cast<double>(v1_bytes) / terms.size() << " bytes/term version 1 on disk ("
+              << static_cast<double>(v1_resident) / terms.size() << " with its in-memory index)" << std::endl;
+    std::cout << std::setw(12) << static_cast<double>(v2_bytes) / terms.size()
+              << " bytes/term front-coded, offset and doc freq tables included, nothing built at open ("
+              << static_cast<double>(builder.blocks().size()) / terms.size() << " for the term bytes)" << std::endl;
+    std::cout << std::setw(12) << num_lookups / lookup_seconds << " exact lookups/s" << std::endl;
+    std::cout << std::setw(12) << scans / scan_seconds << " two-letter prefix scans/s (" << scanned / scans
+              << " terms each)" << std::endl;
+    return 0;
+}
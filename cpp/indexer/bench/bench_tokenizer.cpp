@@ -0,0 +1,151 @@
+// Measures tokenizer throughput (MB/s) against the byte-at-a-time tokenizer it replaced.
+//
+// Usage: bench_tokenizer [text_file] [num_docs]
+//
+// Pass extracted page text (e.g. a dump of ExtractedContent::text); without one, num_docs
+// synthetic documents of mixed-case words, digits, punctuation and some UTF-8 are generated.
+//   legacy            - isalnum/tolower per byte, one std::string per token
+//   tokenizer         - Tokenizer views into one lowercased buffer
+//   legacy+count      - legacy plus the std::map<std::string> term counts process_document kept
+//   tokenizer+count   - Tokenizer plus the unordered_map<string_view> counts it keeps now
+
+#include "../src/tokenizer.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// The tokenizer process_document used before Tokenizer.
+std::vector<std::string> legacy_tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string token;
+    for (char c : text) {
+        if (isalnum(static_cast<unsigned char>(c))) {
+            token += tolower(static_cast<unsigned char>(c));
+        } else if (!token.empty()) {
+            if (token.length() > 2) tokens.push_back(token);
+            token = "";
+        }
+    }
+    if (!token.empty() && token.length() > 2) tokens.push_back(token);
+    return tokens;
+}
+
+std::vector<std::string> synthetic_docs(size_t count) {
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> word_len(1, 12);
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<std::string> vocabulary(20000);
+    for (auto& word : vocabulary) {
+        int n = word_len(rng);
+        for (int i = 0; i < n; ++i) word += static_cast<char>((i == 0 && percent(rng) < 15 ? 'A' : 'a') + letter(rng));
+    }
+    std::geometric_distribution<size_t> word_rank(0.002);
+    std::lognormal_distribution<double> doc_size(9.5, 0.7);  // ~13KB median of text
+
+    std::vector<std::string> docs;
+    for (size_t d = 0; d < count; ++d) {
+        size_t target = static_cast<size_t>(doc_size(rng));
+        std::string text;
+        while (text.size() < target) {
+            int p = percent(rng);
+            if (p < 3) {
+                text += std::to_string(rng() % 10000);
+            } else if (p < 4) {
+                text += "caf\xc3\xa9";
+            } else {
+                text += vocabulary[word_rank(rng) % vocabulary.size()];
+            }
+            text += p < 10 ? ", " : (p < 13 ? ".\n" : " ");
+        }
+        docs.push_back(text);
+    }
+    return docs;
+}
+
+template <typename Fn>
+double time_seconds(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "";
+    size_t num_docs = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    const int repetitions = 3;
+
+    std::vector<std::string> docs;
+    if (path.empty()) {
+        docs = synthetic_docs(num_docs);
+    } else {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << "Failed to open " << path << std::endl;
+            return 1;
+        }
+        std::stringstream contents;
+        contents << in.rdbuf();
+        docs.push_back(contents.str());
+    }
+    size_t bytes = 0;
+    for (const auto& doc : docs) bytes += doc.size();
+
+    size_t sink = 0;
+    double legacy = 0, views = 0, legacy_count = 0, views_count = 0;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        legacy += time_seconds([&] {
+            for (const auto& doc : docs) sink += legacy_tokenize(doc).size();
+        });
+        views += time_seconds([&] {
+            indexer::Tokenizer tokenizer;
+            for (const auto& doc : docs) sink += tokenizer.tokenize(doc).size();
+        });
+        legacy_count += time_seconds([&] {
+            for (const auto& doc : docs) {
+                std::map<std::string, uint32_t> term_freqs;
+                for (const auto& token : legacy_tokenize(doc)) term_freqs[token]++;
+                sink += term_freqs.size();
+            }
+        });
+        views_count += time_seconds([&] {
+            indexer::Tokenizer tokenizer;
+            std::unordered_map<std::string_view, uint32_t> term_freqs;
+            for (const auto& doc : docs) {
+                term_freqs.clear();
+                for (std::string_view token : tokenizer.tokenize(doc)) term_freqs[token]++;
+                sink += term_freqs.size();
+            }
+        });
+    }
+
+    double mb = bytes / (1024.0 * 1024.0);
+    std::cout << (path.empty() ? "synthetic" : path) << ": " << docs.size() << " documents, " << bytes / 1024
+              << " KB of text" << std::endl;
+    std::cout << std::left << std::setw(18) << "strategy" << std::right << std::setw(12) << "MB/s" << std::setw(10)
+              << "speedup" << std::endl;
+    auto report = [&](const std::string& name, double total, double baseline) {
+        std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << mb * repetitions / total << std::setw(9) << baseline / total << "x" << std::endl;
+    };
+    report("legacy", legacy, legacy);
+    report("tokenizer", views, legacy);
+    report("legacy+count", legacy_count, legacy_count);
+    report("tokenizer+count", views_count, legacy_count);
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
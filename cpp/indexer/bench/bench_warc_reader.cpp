@@ -0,0 +1,116 @@
+// Compares reading WARC records through WarcReader's mmap cache against the old ifstream path
+// (open, seekg, read into a vector, copy into a string) that process_document used to take.
+//
+// Usage: bench_warc_reader [num_records] [page_bytes]
+//
+// Records are read in a shuffled order, like doc IDs popped from the indexing queue. Each path is
+// timed for the read alone and for read + decompress; the file is in the page cache for both.
+
+#include "../src/utils.hpp"
+#include "../src/warc_reader.hpp"
+#include "../../crawler/src/warc_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* BENCH_FILE = "bench_warc_reader.warc.gz";
+
+std::string read_with_ifstream(const std::string& path, int64_t offset, int64_t length) {
+    std::ifstream infile(path, std::ios::binary);
+    if (!infile) throw std::runtime_error("Could not open file: " + path);
+    infile.seekg(offset);
+    std::vector<char> buffer(length);
+    infile.read(buffer.data(), length);
+    if (infile.gcount() != length) throw std::runtime_error("Short read");
+    return std::string(buffer.begin(), buffer.end());
+}
+
+template <typename Fn>
+double time_millis(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t num_records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t page_bytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 30000;
+    const int repetitions = 3;
+
+    std::filesystem::remove(BENCH_FILE);
+    std::mt19937 rng(7);
+    std::vector<crawler::WarcRecordInfo> records;
+    {
+        std::cout << "Writing " << num_records << " records of ~" << page_bytes << " bytes..." << std::endl;
+        std::uniform_int_distribution<int> word_len(3, 9);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        crawler::WarcWriter writer(BENCH_FILE);
+        for (size_t i = 0; i < num_records; ++i) {
+            std::string html = "<html><body><p>";
+            while (html.size() < page_bytes) {
+                for (int n = word_len(rng); n > 0; --n) html += static_cast<char>(letter(rng));
+                html += ' ';
+            }
+            html += "</p></body></html>";
+            records.push_back(writer.write_record("http://example.com/" + std::to_string(i), html));
+        }
+    }
+
+    std::vector<size_t> order(num_records);
+    for (size_t i = 0; i < num_records; ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+
+    size_t sink = 0;  // Keeps the reads from being optimized away
+    double ifstream_read = 0, mmap_read = 0, ifstream_full = 0, mmap_full = 0;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        indexer::WarcReader reader;
+        ifstream_read += time_millis([&] {
+            for (size_t i : order) sink += read_with_ifstream(BENCH_FILE, records[i].offset, records[i].length).size();
+        });
+        mmap_read += time_millis([&] {
+            for (size_t i : order) {
+                indexer::WarcSpan span = reader.read(BENCH_FILE, records[i].offset, records[i].length);
+                sink += static_cast<unsigned char>(span.data.back());  // Touch the last page
+            }
+        });
+        ifstream_full += time_millis([&] {
+            for (size_t i : order) {
+                sink += indexer::decompress_gzip(read_with_ifstream(BENCH_FILE, records[i].offset, records[i].length)).size();
+            }
+        });
+        mmap_full += time_millis([&] {
+            for (size_t i : order) {
+                sink += indexer::decompress_gzip(reader.read(BENCH_FILE, records[i].offset, records[i].length).data).size();
+            }
+        });
+    }
+    std::filesystem::remove(BENCH_FILE);
+
+    auto report = [&](const std::string& name, double ifstream_ms, double mmap_ms) {
+        double ifstream_us = ifstream_ms * 1000 / repetitions / num_records;
+        double mmap_us = mmap_ms * 1000 / repetitions / num_records;
+        std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << ifstream_us << std::setw(12) << mmap_us
+                  << std::setw(9) << std::setprecision(1) << (mmap_us > 0 ? ifstream_us / mmap_us : 0.0) << "x" << std::endl;
+    };
+    std::cout << std::left << std::setw(20) << "us/record" << std::right
+              << std::setw(14) << "ifstream" << std::setw(12) << "mmap" << std::setw(10) << "speedup" << std::endl;
+    report("read", ifstream_read, mmap_read);
+    report("read+decompress", ifstream_full, mmap_full);
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace indexer {
+
+namespace {
+
+// Past this, a reset drops back to one default block instead of keeping an outlier's memory
+const size_t MAX_RETAINED_BYTES = 16 * 1024 * 1024;
+
+char* align_up(char* p, size_t alignment) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char*>((address + alignment - 1) & ~(uintptr_t(alignment) - 1));
+}
+
+} // namespace
+
+Arena::Arena(size_t block_size) : block_size_(block_size) {
+    add_block(block_size_);
+}
+
+Arena::~Arena() {
+    free_blocks();
+}
+
+void Arena::reset() {
+    if (blocks_.size() > 1) {
+        size_t total = capacity();
+        free_blocks();
+        add_block(total <= MAX_RETAINED_BYTES ? total : block_size_);
+    } else if (blocks_.front().size > MAX_RETAINED_BYTES) {
+        free_blocks();
+        add_block(block_size_);
+    }
+    cursor_ = blocks_.front().data;
+    end_ = cursor_ + blocks_.front().size;
+    used_ = 0;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks_) total += block.size;
+    return total;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    char* p = align_up(cursor_, alignment);
+    if (p > end_ || static_cast<size_t>(end_ - p) < bytes) return allocate_slow(bytes, alignment);
+    cursor_ = p + bytes;
+    used_ += bytes;
+    return p;
+}
+
+void* Arena::allocate_slow(size_t bytes, size_t alignment) {
+    // Grow geometrically so a large document needs few blocks before reset() merges them
+    add_block(std::max({block_size_, bytes + alignment, blocks_.back().size * 2}));
+    char* p = align_up(cursor_, alignment);
+    cursor_ = p + bytes;
+    used_ += bytes;
+    return p;
+}
+
+void Arena::add_block(size_t size) {
+    char* data = static_cast<char*>(::operator new(size));
+    blocks_.push_back({data, size});
+    cursor_ = data;
+    end_ = data + size;
+}
+
+void Arena::free_blocks() {
+    for (const Block& block : blocks_) ::operator delete(block.data);
+    blocks_.clear();
+}
+
+} // namespace indexer
@@ -0,0 +1,58 @@
+#ifndef INDEXER_ARENA_HPP
+#define INDEXER_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace indexer {
+
+/**
+ * @brief Monotonic bump allocator for per-document scratch memory.
+ *
+ * Allocation moves a pointer through a block and deallocation does nothing; reset() releases
+ * everything at once. Blocks are kept across resets, and if a document needed more than one they
+ * are merged into a single block of their combined size, so after the first few documents a
+ * worker allocates nothing from the heap. Plugs into std::pmr containers and, through the
+ * allocator hooks in GumboOptions, into Gumbo.
+ *
+ * @note Not thread-safe; give each worker thread its own instance.
+ */
+class Arena : public std::pmr::memory_resource {
+public:
+    explicit Arena(size_t block_size = 256 * 1024);
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Invalidates every allocation made since the last reset.
+    void reset();
+
+    // Bytes handed out since the last reset, and bytes held in blocks.
+    size_t used() const { return used_; }
+    size_t capacity() const;
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    void* allocate_slow(size_t bytes, size_t alignment);
+    void add_block(size_t size);
+    void free_blocks();
+
+    const size_t block_size_;
+    std::vector<Block> blocks_;
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    size_t used_ = 0;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_ARENA_HPP
@@ -0,0 +1,157 @@
+#ifndef INDEXER_DOC_LENGTH_TABLE_HPP
+#define INDEXER_DOC_LENGTH_TABLE_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace indexer {
+
+/*
+ * Document length table format
+ *
+ *   table  := header length:u32{capacity}
+ *   header := "IGIDLN" version:u8 0:u8 generation:u64 doc_count:u64 total_doc_length:u64
+ *
+ * One file per index directory ("doc_lengths"), next to the segment manifest. lengths[doc_id] is
+ * the document's length in tokens, 0 for IDs never indexed, so a BM25 scorer pays one array
+ * load per candidate; doc_count and total_doc_length give N and avgdl. Integers are in host
+ * order: the indexer updates the file in place through a shared mapping and the ranker on the
+ * same host maps it read-only, both with plain aligned loads and stores, so readers see each
+ * length either before or after an update, never torn. capacity is whatever the file size
+ * allows; the indexer grows the file as doc IDs grow.
+ *
+ * The table is derived from the segments' doc tables. generation is the manifest generation it
+ * matches; IndexWriter rebuilds the table when they differ (a crash between publishing a segment
+ * and recording the generation, or an index written before the table existed). IndexWriter
+ * publishes the manifest first and updates the table after, storing the new generation last, so
+ * the table lags the manifest: a reader whose snapshot is newer than generation() must take the
+ * newest documents' lengths (and N) from the segments instead.
+ *
+ * generation also works as a sequence lock. Before changing anything the indexer sets it to
+ * NO_GENERATION, so the table holds exactly generation G's lengths while it reads G. A reader
+ * checks generation() before reading and unchanged_since() after. If either misses its own
+ * generation, it must not use what it read.
+ *
+ * Header-only so the rocksdb_client Python module can map the table without linking the indexer.
+ */
+
+constexpr char DOC_LENGTH_TABLE_MAGIC[] = "IGIDLN";
+constexpr uint8_t DOC_LENGTH_TABLE_VERSION = 1;
+constexpr size_t DOC_LENGTH_TABLE_HEADER_SIZE = 8 + 3 * 8;
+constexpr char DOC_LENGTH_TABLE_NAME[] = "doc_lengths";
+constexpr uint64_t NO_GENERATION = UINT64_MAX;
+
+// Field offsets in the header, all 8-byte aligned.
+constexpr size_t DOC_LENGTH_GENERATION_OFFSET = 8;
+constexpr size_t DOC_LENGTH_COUNT_OFFSET = 16;
+constexpr size_t DOC_LENGTH_TOTAL_OFFSET = 24;
+
+inline bool is_doc_length_table_header(const char* data) {
+    return std::memcmp(data, DOC_LENGTH_TABLE_MAGIC, sizeof(DOC_LENGTH_TABLE_MAGIC) - 1) == 0 &&
+           static_cast<uint8_t>(data[6]) == DOC_LENGTH_TABLE_VERSION && data[7] == '\0';
+}
+
+/**
+ * @brief Read-only mapping of a document length table.
+ *
+ * Sees the indexer's in-place updates as they happen, up to the capacity the file had when it
+ * was opened; documents past that read as length 0 until the table is opened again.
+ *
+ * @note Thread-safe: all accessors are const.
+ */
+class DocLengthTable {
+public:
+    // @throws std::runtime_error if the file cannot be mapped or is not a length table.
+    explicit DocLengthTable(const std::string& path) : path_(path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open doc length table: " + path + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < DOC_LENGTH_TABLE_HEADER_SIZE) {
+            ::close(fd);
+            throw std::runtime_error("Doc length table too short: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        inode_ = st.st_ino;
+        addr_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (addr_ == MAP_FAILED) {
+            addr_ = nullptr;
+            throw std::runtime_error("Could not mmap doc length table: " + path + ": " + std::strerror(err));
+        }
+        if (!is_doc_length_table_header(static_cast<const char*>(addr_))) {
+            munmap(addr_, size_);
+            throw std::runtime_error("Not a doc length table, or an unsupported version: " + path);
+        }
+        madvise(addr_, size_, MADV_RANDOM);
+    }
+
+    ~DocLengthTable() {
+        if (addr_) munmap(addr_, size_);
+    }
+
+    DocLengthTable(const DocLengthTable&) = delete;
+    DocLengthTable& operator=(const DocLengthTable&) = delete;
+
+    const std::string& path() const { return path_; }
+    // Acquire, so the lengths read after it are no older than the generation it returns.
+    uint64_t generation() const {
+        return __atomic_load_n(reinterpret_cast<const uint64_t*>(static_cast<const char*>(addr_) +
+                                                                DOC_LENGTH_GENERATION_OFFSET),
+                               __ATOMIC_ACQUIRE);
+    }
+
+    // Whether the table still reads generation, so everything read since generation() returned it
+    // belongs to that generation.
+    bool unchanged_since(uint64_t generation) const {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return load_header(DOC_LENGTH_GENERATION_OFFSET) == generation;
+    }
+
+    uint64_t doc_count() const { return load_header(DOC_LENGTH_COUNT_OFFSET); }
+    uint64_t total_doc_length() const { return load_header(DOC_LENGTH_TOTAL_OFFSET); }
+
+    // False once the file at path() was replaced (rebuilt) or grew past this mapping, so
+    // opening it again would see more.
+    bool is_current() const {
+        struct stat st;
+        return ::stat(path_.c_str(), &st) == 0 && st.st_ino == inode_ && static_cast<size_t>(st.st_size) == size_;
+    }
+
+    // Number of doc IDs the mapping covers.
+    size_t capacity() const { return (size_ - DOC_LENGTH_TABLE_HEADER_SIZE) / 4; }
+
+    // Length of doc_id, or 0 if it was never indexed (or lies past the mapped capacity).
+    uint32_t length(uint32_t doc_id) const {
+        return doc_id < capacity() ? __atomic_load_n(lengths() + doc_id, __ATOMIC_RELAXED) : 0;
+    }
+
+    // The mapped lengths, capacity() of them, for zero-copy views.
+    const uint32_t* lengths() const {
+        return reinterpret_cast<const uint32_t*>(static_cast<const char*>(addr_) + DOC_LENGTH_TABLE_HEADER_SIZE);
+    }
+
+private:
+    uint64_t load_header(size_t offset) const {
+        return __atomic_load_n(reinterpret_cast<const uint64_t*>(static_cast<const char*>(addr_) + offset),
+                               __ATOMIC_RELAXED);
+    }
+
+    std::string path_;
+    void* addr_ = nullptr;
+    size_t size_ = 0;
+    ino_t inode_ = 0;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_DOC_LENGTH_TABLE_HPP
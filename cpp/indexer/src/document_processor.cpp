@@ -0,0 +1,84 @@
+#include "document_processor.hpp"
+#include "utils.hpp"
+#include "html_extractor.hpp"
+#include "record_decompressor.hpp"
+#include "tokenizer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <unordered_map>
+#include <stdexcept>
+#include <gumbo.h>
+
+namespace indexer {
+
+IndexedDocument process_document(const IndexTask& task, WarcReader& reader, HtmlParser parser) {
+    // Read WARC Record straight out of the mapped file and decompress it (gzip or zstd) into this
+    // thread's reusable buffer; the record is only valid until the next document on this thread
+    thread_local RecordDecompressor decompressor;
+    WarcSpan record = reader.read(task.file_path, task.offset, task.length);
+    std::string_view full_warc_record = decompressor.decompress(record.data, record.file->data());
+    // Skip WARC headers (find first double newline)
+    size_t header_end = full_warc_record.find("\r\n\r\n");
+    if (header_end == std::string_view::npos) {
+        throw std::runtime_error("WARC record has no header terminator");
+    }
+
+    // Parse in place: both parsers take a pointer and length, so no copy of the body is needed
+    thread_local Arena arena;
+    return index_html(task.doc_id, full_warc_record.substr(header_end + 4), parser, arena);
+}
+
+IndexedDocument index_html(int doc_id, std::string_view html, HtmlParser parser, Arena& arena) {
+    arena.reset();
+    thread_local HtmlTextExtractor extractor;
+    ExtractedContent gumbo_content;
+    const ExtractedContent* extracted;
+    if (parser == HtmlParser::Gumbo) {
+        // The whole tree is bump-allocated in the arena, so it is dropped by the next reset()
+        // instead of node by node in gumbo_destroy_output
+        GumboOptions options = kGumboDefaultOptions;
+        options.allocator = [](void* userdata, size_t size) {
+            return static_cast<Arena*>(userdata)->allocate(size, alignof(std::max_align_t));
+        };
+        options.deallocator = [](void*, void*) {};
+        options.userdata = &arena;
+        GumboOutput* output = gumbo_parse_with_options(&options, html.data(), html.size());
+        gumbo_content = extract_content(output->root);
+        extracted = &gumbo_content;
+    } else {
+        extracted = &extractor.extract(html);
+    }
+    const ExtractedContent& content = *extracted;
+
+    IndexedDocument doc;
+    doc.doc_id = doc_id;
+    doc.title = content.title;
+
+    // Generate Snippet (first 200 chars)
+    doc.snippet = content.text.substr(0, 200);
+    // Basic cleanup of snippet (remove newlines)
+    std::replace(doc.snippet.begin(), doc.snippet.end(), '\n', ' ');
+    std::replace(doc.snippet.begin(), doc.snippet.end(), '\r', ' ');
+
+    // Tokenize & count term frequencies on views into the tokenizer's buffer, with the map's nodes
+    // and buckets in the arena; only the distinct terms are copied out, once each
+    thread_local Tokenizer tokenizer;
+    const auto& tokens = tokenizer.tokenize(content.text);
+    doc.doc_length = static_cast<uint32_t>(tokens.size());
+
+    std::pmr::unordered_map<std::string_view, uint32_t> term_freqs(&arena);
+    term_freqs.reserve(tokens.size() / 2);
+    for (std::string_view token : tokens) {
+        term_freqs[token]++;
+    }
+    doc.term_freqs.reserve(term_freqs.size());
+    for (const auto& [term, tf] : term_freqs) {
+        doc.term_freqs.emplace_back(std::string(term), tf);
+    }
+    std::sort(doc.term_freqs.begin(), doc.term_freqs.end());
+    return doc;
+}
+
+} // namespace indexer
@@ -0,0 +1,61 @@
+#ifndef INDEXER_DOCUMENT_PROCESSOR_HPP
+#define INDEXER_DOCUMENT_PROCESSOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "arena.hpp"
+#include "warc_reader.hpp"
+
+namespace indexer {
+
+// Where a crawled page lives, as recorded by the crawler in Postgres.
+struct IndexTask {
+    int doc_id;
+    std::string file_path;  // Full path to the WARC file
+    int64_t offset;         // Byte offset of the gzip member holding the record
+    int64_t length;         // Compressed length of that member
+};
+
+// Everything the commit stage needs to index one document.
+struct IndexedDocument {
+    int doc_id;
+    uint32_t doc_length;  // Number of tokens
+    std::string title;
+    std::string snippet;
+    std::vector<std::pair<std::string, uint32_t>> term_freqs;  // Sorted by term
+};
+
+// How process_document turns HTML into text.
+enum class HtmlParser {
+    Streaming,  // HtmlTextExtractor: one forward pass, no DOM
+    Gumbo,      // Full Gumbo parse walked by extract_content()
+};
+
+/**
+ * @brief Reads a document's WARC record and turns it into index-ready data.
+ *
+ * Covers the CPU-heavy part of indexing: read, decompress, strip WARC headers, parse the HTML,
+ * build the snippet and count term frequencies. The record is read through reader's mmap cache;
+ * since WarcReader is thread-safe, pipeline workers can share one and call this concurrently.
+ * Per-document scratch memory comes from a per-thread Arena.
+ *
+ * @throws std::runtime_error if the record cannot be read or decoded.
+ */
+IndexedDocument process_document(const IndexTask& task, WarcReader& reader,
+                                 HtmlParser parser = HtmlParser::Streaming);
+
+/**
+ * @brief The part of process_document after the record is read: extract, snippet, term counts.
+ *
+ * arena is reset first and then holds the scratch memory (the Gumbo tree, the term-count map);
+ * nothing in the result points into it.
+ */
+IndexedDocument index_html(int doc_id, std::string_view html, HtmlParser parser, Arena& arena);
+
+} // namespace indexer
+
+#endif // INDEXER_DOCUMENT_PROCESSOR_HPP
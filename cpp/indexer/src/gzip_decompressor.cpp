@@ -0,0 +1,104 @@
+#include "gzip_decompressor.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+namespace indexer {
+
+namespace {
+
+const size_t INITIAL_BUFFER_SIZE = 256 * 1024;  // Covers a typical page without growing
+const size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+} // namespace
+
+GzipDecompressor::GzipDecompressor() : chunk_(STREAM_CHUNK_SIZE, '\0') {
+    zs_.zalloc = Z_NULL;
+    zs_.zfree = Z_NULL;
+    zs_.opaque = Z_NULL;
+    zs_.avail_in = 0;
+    zs_.next_in = Z_NULL;
+    if (inflateInit2(&zs_, 16 + MAX_WBITS) != Z_OK) {
+        throw std::runtime_error("inflateInit2 failed");
+    }
+}
+
+GzipDecompressor::~GzipDecompressor() {
+    inflateEnd(&zs_);
+}
+
+void GzipDecompressor::reset(std::string_view compressed_data) {
+    if (compressed_data.size() > UINT_MAX) {
+        throw std::runtime_error("Compressed data too large (> 4GB)");
+    }
+    if (inflateReset(&zs_) != Z_OK) {
+        throw std::runtime_error("inflateReset failed");
+    }
+    zs_.avail_in = static_cast<uInt>(compressed_data.size());
+    zs_.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(compressed_data.data()));
+    consumed_ = 0;
+}
+
+void GzipDecompressor::finish() {
+    consumed_ = zs_.total_in;
+    // Don't keep pointers into the caller's buffer
+    zs_.avail_in = 0;
+    zs_.next_in = Z_NULL;
+}
+
+std::string_view GzipDecompressor::decompress(std::string_view compressed_data) {
+    reset(compressed_data);
+    if (buffer_.empty()) buffer_.resize(INITIAL_BUFFER_SIZE);
+
+    size_t produced = 0;
+    int ret;
+    do {
+        if (produced == buffer_.size()) {
+            if (buffer_.size() > MAX_DECOMPRESSED_SIZE) {
+                throw std::runtime_error("Decompressed data exceeds maximum allowed size");
+            }
+            // One byte over the limit is enough to detect an oversized record
+            buffer_.resize(std::min(buffer_.size() * 2, MAX_DECOMPRESSED_SIZE + 1));
+        }
+        size_t space = std::min<size_t>(buffer_.size() - produced, UINT_MAX);
+        zs_.avail_out = static_cast<uInt>(space);
+        zs_.next_out = reinterpret_cast<Bytef*>(&buffer_[produced]);
+        ret = inflate(&zs_, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            throw std::runtime_error("inflate failed with code: " + std::to_string(ret));
+        }
+        produced += space - zs_.avail_out;
+        if (produced > MAX_DECOMPRESSED_SIZE) {
+            throw std::runtime_error("Decompressed data exceeds maximum allowed size");
+        }
+    } while (ret != Z_STREAM_END);
+
+    finish();
+    return {buffer_.data(), produced};
+}
+
+void GzipDecompressor::decompress(std::string_view compressed_data, const Sink& sink) {
+    reset(compressed_data);
+
+    size_t total = 0;
+    int ret;
+    do {
+        zs_.avail_out = static_cast<uInt>(chunk_.size());
+        zs_.next_out = reinterpret_cast<Bytef*>(&chunk_[0]);
+        ret = inflate(&zs_, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            throw std::runtime_error("inflate failed with code: " + std::to_string(ret));
+        }
+        size_t produced = chunk_.size() - zs_.avail_out;
+        total += produced;
+        if (total > MAX_DECOMPRESSED_SIZE) {
+            throw std::runtime_error("Decompressed data exceeds maximum allowed size");
+        }
+        if (produced > 0) sink(std::string_view(chunk_.data(), produced));
+    } while (ret != Z_STREAM_END);
+
+    finish();
+}
+
+} // namespace indexer
@@ -0,0 +1,65 @@
+#ifndef INDEXER_GZIP_DECOMPRESSOR_HPP
+#define INDEXER_GZIP_DECOMPRESSOR_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <zlib.h>
+
+namespace indexer {
+
+// Largest record we are willing to inflate; guards against gzip bombs in crawled data.
+constexpr size_t MAX_DECOMPRESSED_SIZE = 100 * 1024 * 1024; // 100MB limit
+
+/**
+ * @brief Reusable gzip inflater for WARC records.
+ *
+ * Initializes zlib once and only resets it (inflateReset) between records, and inflates into an
+ * output buffer that is kept and grown across calls, so steady-state decompression allocates
+ * nothing. Each call decodes exactly one gzip member; consumed() tells how far into the input
+ * that member went, which lets a caller walk a whole .warc.gz member by member.
+ *
+ * @note Not thread-safe; give each thread its own instance.
+ */
+class GzipDecompressor {
+public:
+    using Sink = std::function<void(std::string_view)>;
+
+    GzipDecompressor();
+    ~GzipDecompressor();
+
+    GzipDecompressor(const GzipDecompressor&) = delete;
+    GzipDecompressor& operator=(const GzipDecompressor&) = delete;
+
+    /**
+     * @brief Inflates one gzip member into the internal buffer.
+     * @return A view of the inflated bytes, valid until the next call on this object.
+     * @throws std::runtime_error on corrupt or truncated input, or past MAX_DECOMPRESSED_SIZE.
+     */
+    std::string_view decompress(std::string_view compressed_data);
+
+    /**
+     * @brief Inflates one gzip member and hands it to sink in chunks as it is produced.
+     *
+     * Never holds more than one chunk of output, so large records can be fed to an incremental
+     * consumer without materializing them. Same errors and size limit as decompress().
+     */
+    void decompress(std::string_view compressed_data, const Sink& sink);
+
+    // Compressed bytes the last call consumed (the member's length).
+    size_t consumed() const { return consumed_; }
+
+private:
+    void reset(std::string_view compressed_data);
+    void finish();
+
+    z_stream zs_;
+    std::string buffer_;  // Pooled output for decompress(); only ever grows
+    std::string chunk_;   // Fixed-size staging area for the streaming overload
+    size_t consumed_ = 0;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_GZIP_DECOMPRESSOR_HPP
@@ -0,0 +1,406 @@
+#include "html_extractor.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+namespace indexer {
+
+namespace {
+
+struct NamedEntity {
+    const char* name;
+    uint32_t code_point;
+};
+
+// HTML 4 named character references plus &apos;, sorted by name for binary search.
+const NamedEntity NAMED_ENTITIES[] = {
+    {"AElig", 0xC6}, {"Aacute", 0xC1}, {"Acirc", 0xC2}, {"Agrave", 0xC0}, {"Alpha", 0x391}, {"Aring", 0xC5},
+    {"Atilde", 0xC3}, {"Auml", 0xC4}, {"Beta", 0x392}, {"Ccedil", 0xC7}, {"Chi", 0x3A7}, {"Dagger", 0x2021},
+    {"Delta", 0x394}, {"ETH", 0xD0}, {"Eacute", 0xC9}, {"Ecirc", 0xCA}, {"Egrave", 0xC8}, {"Epsilon", 0x395},
+    {"Eta", 0x397}, {"Euml", 0xCB}, {"Gamma", 0x393}, {"Iacute", 0xCD}, {"Icirc", 0xCE}, {"Igrave", 0xCC},
+    {"Iota", 0x399}, {"Iuml", 0xCF}, {"Kappa", 0x39A}, {"Lambda", 0x39B}, {"Mu", 0x39C}, {"Ntilde", 0xD1},
+    {"Nu", 0x39D}, {"OElig", 0x152}, {"Oacute", 0xD3}, {"Ocirc", 0xD4}, {"Ograve", 0xD2}, {"Omega", 0x3A9},
+    {"Omicron", 0x39F}, {"Oslash", 0xD8}, {"Otilde", 0xD5}, {"Ouml", 0xD6}, {"Phi", 0x3A6}, {"Pi", 0x3A0},
+    {"Prime", 0x2033}, {"Psi", 0x3A8}, {"Rho", 0x3A1}, {"Scaron", 0x160}, {"Sigma", 0x3A3}, {"THORN", 0xDE},
+    {"Tau", 0x3A4}, {"Theta", 0x398}, {"Uacute", 0xDA}, {"Ucirc", 0xDB}, {"Ugrave", 0xD9}, {"Upsilon", 0x3A5},
+    {"Uuml", 0xDC}, {"Xi", 0x39E}, {"Yacute", 0xDD}, {"Yuml", 0x178}, {"Zeta", 0x396}, {"aacute", 0xE1},
+    {"acirc", 0xE2}, {"acute", 0xB4}, {"aelig", 0xE6}, {"agrave", 0xE0}, {"alefsym", 0x2135},
+    {"alpha", 0x3B1}, {"amp", 0x26}, {"and", 0x2227}, {"ang", 0x2220}, {"apos", 0x27}, {"aring", 0xE5},
+    {"asymp", 0x2248}, {"atilde", 0xE3}, {"auml", 0xE4}, {"bdquo", 0x201E}, {"beta", 0x3B2}, {"brvbar", 0xA6},
+    {"bull", 0x2022}, {"cap", 0x2229}, {"ccedil", 0xE7}, {"cedil", 0xB8}, {"cent", 0xA2}, {"chi", 0x3C7},
+    {"circ", 0x2C6}, {"clubs", 0x2663}, {"cong", 0x2245}, {"copy", 0xA9}, {"crarr", 0x21B5}, {"cup", 0x222A},
+    {"curren", 0xA4}, {"dArr", 0x21D3}, {"dagger", 0x2020}, {"darr", 0x2193}, {"deg", 0xB0}, {"delta", 0x3B4},
+    {"diams", 0x2666}, {"divide", 0xF7}, {"eacute", 0xE9}, {"ecirc", 0xEA}, {"egrave", 0xE8},
+    {"empty", 0x2205}, {"emsp", 0x2003}, {"ensp", 0x2002}, {"epsilon", 0x3B5}, {"equiv", 0x2261},
+    {"eta", 0x3B7}, {"eth", 0xF0}, {"euml", 0xEB}, {"euro", 0x20AC}, {"exist", 0x2203}, {"fnof", 0x192},
+    {"forall", 0x2200}, {"frac12", 0xBD}, {"frac14", 0xBC}, {"frac34", 0xBE}, {"frasl", 0x2044},
+    {"gamma", 0x3B3}, {"ge", 0x2265}, {"gt", 0x3E}, {"hArr", 0x21D4}, {"harr", 0x2194}, {"hearts", 0x2665},
+    {"hellip", 0x2026}, {"iacute", 0xED}, {"icirc", 0xEE}, {"iexcl", 0xA1}, {"igrave", 0xEC},
+    {"image", 0x2111}, {"infin", 0x221E}, {"int", 0x222B}, {"iota", 0x3B9}, {"iquest", 0xBF},
+    {"isin", 0x2208}, {"iuml", 0xEF}, {"kappa", 0x3BA}, {"lArr", 0x21D0}, {"lambda", 0x3BB}, {"lang", 0x2329},
+    {"laquo", 0xAB}, {"larr", 0x2190}, {"lceil", 0x2308}, {"ldquo", 0x201C}, {"le", 0x2264},
+    {"lfloor", 0x230A}, {"lowast", 0x2217}, {"loz", 0x25CA}, {"lrm", 0x200E}, {"lsaquo", 0x2039},
+    {"lsquo", 0x2018}, {"lt", 0x3C}, {"macr", 0xAF}, {"mdash", 0x2014}, {"micro", 0xB5}, {"middot", 0xB7},
+    {"minus", 0x2212}, {"mu", 0x3BC}, {"nabla", 0x2207}, {"nbsp", 0xA0}, {"ndash", 0x2013}, {"ne", 0x2260},
+    {"ni", 0x220B}, {"not", 0xAC}, {"notin", 0x2209}, {"nsub", 0x2284}, {"ntilde", 0xF1}, {"nu", 0x3BD},
+    {"oacute", 0xF3}, {"ocirc", 0xF4}, {"oelig", 0x153}, {"ograve", 0xF2}, {"oline", 0x203E},
+    {"omega", 0x3C9}, {"omicron", 0x3BF}, {"oplus", 0x2295}, {"or", 0x2228}, {"ordf", 0xAA}, {"ordm", 0xBA},
+    {"oslash", 0xF8}, {"otilde", 0xF5}, {"otimes", 0x2297}, {"ouml", 0xF6}, {"para", 0xB6}, {"part", 0x2202},
+    {"permil", 0x2030}, {"perp", 0x22A5}, {"phi", 0x3C6}, {"pi", 0x3C0}, {"piv", 0x3D6}, {"plusmn", 0xB1},
+    {"pound", 0xA3}, {"prime", 0x2032}, {"prod", 0x220F}, {"prop", 0x221D}, {"psi", 0x3C8}, {"quot", 0x22},
+    {"rArr", 0x21D2}, {"radic", 0x221A}, {"rang", 0x232A}, {"raquo", 0xBB}, {"rarr", 0x2192},
+    {"rceil", 0x2309}, {"rdquo", 0x201D}, {"real", 0x211C}, {"reg", 0xAE}, {"rfloor", 0x230B}, {"rho", 0x3C1},
+    {"rlm", 0x200F}, {"rsaquo", 0x203A}, {"rsquo", 0x2019}, {"sbquo", 0x201A}, {"scaron", 0x161},
+    {"sdot", 0x22C5}, {"sect", 0xA7}, {"shy", 0xAD}, {"sigma", 0x3C3}, {"sigmaf", 0x3C2}, {"sim", 0x223C},
+    {"spades", 0x2660}, {"sub", 0x2282}, {"sube", 0x2286}, {"sum", 0x2211}, {"sup", 0x2283}, {"sup1", 0xB9},
+    {"sup2", 0xB2}, {"sup3", 0xB3}, {"supe", 0x2287}, {"szlig", 0xDF}, {"tau", 0x3C4}, {"there4", 0x2234},
+    {"theta", 0x3B8}, {"thetasym", 0x3D1}, {"thinsp", 0x2009}, {"thorn", 0xFE}, {"tilde", 0x2DC},
+    {"times", 0xD7}, {"trade", 0x2122}, {"uArr", 0x21D1}, {"uacute", 0xFA}, {"uarr", 0x2191}, {"ucirc", 0xFB},
+    {"ugrave", 0xF9}, {"uml", 0xA8}, {"upsih", 0x3D2}, {"upsilon", 0x3C5}, {"uuml", 0xFC}, {"weierp", 0x2118},
+    {"xi", 0x3BE}, {"yacute", 0xFD}, {"yen", 0xA5}, {"yuml", 0xFF}, {"zeta", 0x3B6}, {"zwj", 0x200D},
+    {"zwnj", 0x200C},
+};
+const size_t MAX_ENTITY_NAME = 8;  // "thetasym"
+
+// What numeric references to 0x80-0x9F mean: browsers read them as windows-1252.
+const uint16_t WINDOWS_1252[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\f' || c == '\r';
+}
+
+bool is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool is_alnum(char c) {
+    return is_alpha(c) || is_digit(c);
+}
+
+char to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+bool is_heading(const std::string& tag) {
+    return tag.size() == 2 && tag[0] == 'h' && tag[1] >= '1' && tag[1] <= '6';
+}
+
+// Case-insensitive match of html at pos against a lowercase name.
+bool matches_at(std::string_view html, size_t pos, std::string_view name) {
+    if (html.size() - pos < name.size()) return false;
+    for (size_t i = 0; i < name.size(); ++i) {
+        if (to_lower(html[pos + i]) != name[i]) return false;
+    }
+    return true;
+}
+
+// Start of the end tag closing a raw text element, or npos if the element runs to the end.
+size_t find_end_tag(std::string_view html, size_t from, const std::string& name) {
+    for (size_t lt = html.find("</", from); lt != std::string_view::npos; lt = html.find("</", lt + 2)) {
+        size_t after = lt + 2 + name.size();
+        if (matches_at(html, lt + 2, name) &&
+            (after == html.size() || is_space(html[after]) || html[after] == '/' || html[after] == '>')) {
+            return lt;
+        }
+    }
+    return std::string_view::npos;
+}
+
+const NamedEntity* find_entity(std::string_view name) {
+    auto it = std::lower_bound(std::begin(NAMED_ENTITIES), std::end(NAMED_ENTITIES), name,
+                               [](const NamedEntity& entity, std::string_view n) { return entity.name < n; });
+    return it != std::end(NAMED_ENTITIES) && name == it->name ? it : nullptr;
+}
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Decodes the character reference starting at text[0] == '&' into out. Returns the bytes it
+// spans, or 0 if there is none and the '&' stands for itself.
+size_t decode_reference(std::string_view text, bool in_attribute, std::string& out) {
+    if (text.size() < 2) return 0;
+
+    if (text[1] == '#') {
+        size_t pos = 2;
+        bool hex = pos < text.size() && (text[pos] == 'x' || text[pos] == 'X');
+        if (hex) ++pos;
+        size_t digits = pos;
+        uint32_t value = 0;
+        for (; pos < text.size(); ++pos) {
+            char c = to_lower(text[pos]);
+            uint32_t digit;
+            if (is_digit(c)) {
+                digit = c - '0';
+            } else if (hex && c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else {
+                break;
+            }
+            value = std::min<uint32_t>(value * (hex ? 16 : 10) + digit, 0x110000);  // Saturate past the range
+        }
+        if (pos == digits) return 0;
+        if (pos < text.size() && text[pos] == ';') ++pos;
+
+        if (value == 0 || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) {
+            value = 0xFFFD;
+        } else if (value >= 0x80 && value <= 0x9F) {
+            value = WINDOWS_1252[value - 0x80];
+        }
+        append_utf8(out, value);
+        return pos;
+    }
+
+    size_t end = 1;
+    while (end < text.size() && end <= MAX_ENTITY_NAME && is_alnum(text[end])) ++end;
+    std::string_view name = text.substr(1, end - 1);
+    if (end < text.size() && text[end] == ';') {
+        if (const NamedEntity* entity = find_entity(name)) {
+            append_utf8(out, entity->code_point);
+            return end + 1;
+        }
+    }
+
+    // Legacy references: the Latin-1 names also count without a semicolon, longest match first
+    for (size_t length = name.size(); length >= 2; --length) {
+        const NamedEntity* entity = find_entity(name.substr(0, length));
+        if (!entity || entity->code_point > 0xFF || std::strcmp(entity->name, "apos") == 0) continue;
+        char after = 1 + length < text.size() ? text[1 + length] : '\0';
+        if (in_attribute && (is_alnum(after) || after == '=')) return 0;  // e.g. ?a=1&copy=2
+        append_utf8(out, entity->code_point);
+        return 1 + length;
+    }
+    return 0;
+}
+
+// Appends raw with its character references decoded and NULs dropped.
+void append_decoded(std::string& out, std::string_view raw, bool in_attribute) {
+    static const std::string_view SPECIAL("&\0", 2);
+    size_t pos = 0;
+    while (pos < raw.size()) {
+        size_t next = raw.find_first_of(SPECIAL, pos);
+        if (next == std::string_view::npos) {
+            out.append(raw.data() + pos, raw.size() - pos);
+            return;
+        }
+        out.append(raw.data() + pos, next - pos);
+        if (raw[next] == '\0') {
+            pos = next + 1;
+            continue;
+        }
+        size_t used = decode_reference(raw.substr(next), in_attribute, out);
+        if (used == 0) {
+            out += '&';
+            used = 1;
+        }
+        pos = next + used;
+    }
+}
+
+void pad(std::string& out) {
+    if (!out.empty() && out.back() != ' ') out += ' ';
+}
+
+} // namespace
+
+const ExtractedContent& HtmlTextExtractor::extract(std::string_view html) {
+    content_.text.clear();
+    content_.title.clear();
+    content_.links.clear();
+    content_.headings.clear();
+    content_.anchor_text.clear();
+    in_anchor_ = false;
+    in_heading_ = false;
+
+    size_t pos = 0;
+    while (pos < html.size()) {
+        size_t lt = html.find('<', pos);
+        if (lt == std::string_view::npos) {
+            append_text(html.substr(pos), true);
+            break;
+        }
+        if (lt > pos) append_text(html.substr(pos, lt - pos), true);
+        pos = parse_markup(html, lt);
+    }
+    return content_;
+}
+
+size_t HtmlTextExtractor::parse_markup(std::string_view html, size_t lt) {
+    const size_t size = html.size();
+    char next = lt + 1 < size ? html[lt + 1] : '\0';
+    if (is_alpha(next)) return parse_start_tag(html, lt + 1);
+
+    if (next == '/') {
+        char first = lt + 2 < size ? html[lt + 2] : '\0';
+        if (first == '>') return lt + 3;  // "</>" is dropped outright
+        size_t gt = html.find('>', lt + 2);
+        if (is_alpha(first)) {
+            if (gt == std::string_view::npos) return size;  // Cut off inside the tag: dropped
+            size_t name_end = lt + 2;
+            while (name_end < gt && !is_space(html[name_end]) && html[name_end] != '/') ++name_end;
+            tag_.assign(html.data() + lt + 2, name_end - lt - 2);
+            std::transform(tag_.begin(), tag_.end(), tag_.begin(), to_lower);
+            separate();
+            close_element();
+            return gt + 1;
+        }
+        separate();  // Anything else after "</" is a bogus comment
+        return gt == std::string_view::npos ? size : gt + 1;
+    }
+
+    if (next == '!' || next == '?') {
+        separate();
+        if (next == '!' && html.compare(lt + 2, 2, "--") == 0) {
+            size_t body = lt + 4;
+            if (html.compare(body, 1, ">") == 0) return body + 1;  // "<!-->" and "<!--->" close at once
+            if (html.compare(body, 2, "->") == 0) return body + 2;
+            size_t close = html.find("-->", body);
+            return close == std::string_view::npos ? size : close + 3;
+        }
+        size_t gt = html.find('>', lt + 2);  // Doctype, CDATA outside foreign content, or bogus comment
+        return gt == std::string_view::npos ? size : gt + 1;
+    }
+
+    append_text("<", false);  // Not markup
+    return lt + 1;
+}
+
+size_t HtmlTextExtractor::parse_start_tag(std::string_view html, size_t pos) {
+    const size_t size = html.size();
+    size_t p = pos;
+    while (p < size && !is_space(html[p]) && html[p] != '/' && html[p] != '>') ++p;
+    tag_.assign(html.data() + pos, p - pos);
+    std::transform(tag_.begin(), tag_.end(), tag_.begin(), to_lower);
+
+    const bool is_anchor = tag_ == "a";
+    bool has_href = false;
+    href_.clear();
+    while (true) {
+        while (p < size && (is_space(html[p]) || html[p] == '/')) ++p;
+        if (p >= size) return size;  // Cut off inside the tag: dropped
+        if (html[p] == '>') break;
+
+        size_t name_start = p++;  // A name may start with '='
+        while (p < size && !is_space(html[p]) && html[p] != '/' && html[p] != '>' && html[p] != '=') ++p;
+        std::string_view name = html.substr(name_start, p - name_start);
+        while (p < size && is_space(html[p])) ++p;
+        if (p >= size || html[p] != '=') continue;
+
+        ++p;
+        while (p < size && is_space(html[p])) ++p;
+        std::string_view value;
+        if (p < size && (html[p] == '"' || html[p] == '\'')) {
+            size_t close = html.find(html[p], p + 1);
+            if (close == std::string_view::npos) return size;
+            value = html.substr(p + 1, close - p - 1);
+            p = close + 1;
+        } else {
+            size_t value_start = p;
+            while (p < size && !is_space(html[p]) && html[p] != '>') ++p;
+            value = html.substr(value_start, p - value_start);
+        }
+        if (is_anchor && !has_href && name.size() == 4 && matches_at(name, 0, "href")) {
+            has_href = true;  // The first of duplicate attributes wins
+            append_decoded(href_, value, true);
+        }
+    }
+
+    separate();
+    return open_element(html, p + 1);
+}
+
+size_t HtmlTextExtractor::open_element(std::string_view html, size_t pos) {
+    const size_t size = html.size();
+    if (tag_ == "script" || tag_ == "style" || tag_ == "noscript") {
+        size_t end = find_end_tag(html, pos, tag_);
+        return end == std::string_view::npos ? size : end;
+    }
+    if (tag_ == "title" || tag_ == "textarea") {
+        size_t end = std::min(find_end_tag(html, pos, tag_), size);
+        std::string_view raw = html.substr(pos, end - pos);
+        if (tag_ == "textarea") {
+            append_text(raw, true);
+            return end;
+        }
+        // A title of only whitespace is not a text node to Gumbo, so it is neither title nor text
+        scratch_.clear();
+        append_decoded(scratch_, raw, false);
+        if (scratch_.find_first_not_of(" \t\n\f\r") != std::string::npos) {
+            content_.title = scratch_;
+            content_.text += scratch_;
+        }
+        return end;
+    }
+    if (tag_ == "xmp" || tag_ == "iframe" || tag_ == "noembed" || tag_ == "noframes") {
+        size_t end = std::min(find_end_tag(html, pos, tag_), size);
+        append_text(html.substr(pos, end - pos), false);
+        return end;
+    }
+    if (tag_ == "plaintext") {
+        append_text(html.substr(pos), false);
+        return size;
+    }
+
+    if (tag_ == "a") {
+        in_anchor_ = true;  // A nested <a> closes the open one, so a flag is enough
+        pad(content_.anchor_text);
+        if (!href_.empty()) content_.links.push_back(href_);
+    } else if (is_heading(tag_)) {
+        in_heading_ = true;
+        pad(content_.headings);
+    }
+    return pos;
+}
+
+void HtmlTextExtractor::close_element() {
+    if (tag_ == "a") {
+        in_anchor_ = false;
+    } else if (is_heading(tag_)) {
+        in_heading_ = false;
+    }
+}
+
+void HtmlTextExtractor::append_text(std::string_view raw, bool decode) {
+    size_t start = content_.text.size();
+    if (decode) {
+        append_decoded(content_.text, raw, false);
+    } else {
+        content_.text.append(raw.data(), raw.size());
+    }
+    if (!in_anchor_ && !in_heading_) return;
+
+    std::string_view added(content_.text.data() + start, content_.text.size() - start);
+    if (in_anchor_) content_.anchor_text.append(added.data(), added.size());
+    if (in_heading_) content_.headings.append(added.data(), added.size());
+}
+
+void HtmlTextExtractor::separate() {
+    pad(content_.text);
+    if (in_anchor_) pad(content_.anchor_text);
+    if (in_heading_) pad(content_.headings);
+}
+
+} // namespace indexer
@@ -0,0 +1,57 @@
+#ifndef INDEXER_HTML_EXTRACTOR_HPP
+#define INDEXER_HTML_EXTRACTOR_HPP
+
+#include <string>
+#include <string_view>
+
+#include "utils.hpp"
+
+namespace indexer {
+
+/**
+ * @brief Single-pass HTML-to-text extractor that never builds a DOM.
+ *
+ * Walks the page once at the tokenizer level: text runs go straight into the output, tags only
+ * insert a separating space (as extract_content does between sibling nodes), and <title>, <a href>
+ * and <h1>..<h6> are tracked with a few flags instead of a tree. script, style and noscript bodies
+ * are skipped; title and textarea are read as RCDATA and xmp, iframe, noembed, noframes and
+ * plaintext as raw text, as an HTML5 tokenizer would. Character references are decoded: numeric
+ * ones fully, named ones from the HTML 4 set plus &apos; (the Latin-1 ones also without their
+ * semicolon, as browsers accept); rarer HTML5-only names are kept as written.
+ *
+ * Up to whitespace, text and title match extract_content() on the Gumbo tree for well-formed
+ * pages. Tree construction fix-ups are not replayed, so text a parser would move (e.g. stray text
+ * foster-parented out of a table) stays in source order, and noscript text, which Gumbo keeps, is
+ * dropped.
+ *
+ * The output buffers are kept across calls, so steady-state extraction allocates only for links.
+ *
+ * @note Not thread-safe; give each thread its own instance.
+ */
+class HtmlTextExtractor {
+public:
+    /**
+     * @brief Extracts text, title, links, headings and anchor text from one page.
+     * @return The extracted content, valid until the next call on this object.
+     */
+    const ExtractedContent& extract(std::string_view html);
+
+private:
+    size_t parse_markup(std::string_view html, size_t lt);
+    size_t parse_start_tag(std::string_view html, size_t pos);
+    size_t open_element(std::string_view html, size_t pos);
+    void close_element();
+    void append_text(std::string_view raw, bool decode);
+    void separate();
+
+    ExtractedContent content_;
+    std::string tag_;   // Lowercased name of the tag being parsed
+    std::string href_;  // Its href, when it is an <a>
+    std::string scratch_;
+    bool in_anchor_ = false;
+    bool in_heading_ = false;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_HTML_EXTRACTOR_HPP
@@ -0,0 +1,255 @@
+#ifndef INDEXER_LIVE_INDEX_HPP
+#define INDEXER_LIVE_INDEX_HPP
+
+#include "doc_length_table.hpp"
+#include "segment.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace indexer {
+
+/**
+ * @brief Everything one query reads: a snapshot of the segments plus the doc length table.
+ *
+ * Immutable once built, so a query that holds one sees the same generation from start to end,
+ * whatever refreshes happen meanwhile. The doc length table is the exception: the indexer
+ * updates it in place, so lengths and collection stats go through with_doc_lengths(), which only
+ * lets the table answer for the view's own generation.
+ */
+struct IndexView {
+    using DocLengthFn = std::function<uint32_t(uint32_t doc_id)>;
+
+    IndexSnapshot snapshot;
+    std::shared_ptr<const DocLengthTable> doc_lengths;  // Null until the indexer has written one
+
+    /**
+     * @brief Returns fn(doc_length, total_docs, total_doc_length), called with lengths and
+     *        collection stats that all belong to the snapshot's generation.
+     *
+     * While the table holds that generation, they come from it: one array load per document.
+     * Otherwise, or if the indexer started updating the table while fn ran, fn runs (again)
+     * against the segments' doc tables, so fn must not have side effects beyond its result.
+     */
+    template <typename Fn>
+    auto with_doc_lengths(Fn&& fn) const {
+        uint64_t generation = snapshot.generation();
+        if (doc_lengths && doc_lengths->generation() == generation) {
+            const DocLengthTable& table = *doc_lengths;
+            DocLengthFn from_table = [this, &table](uint32_t doc_id) {
+                uint32_t length = table.length(doc_id);
+                return length ? length : snapshot.doc_length(doc_id);  // Past this mapping's capacity
+            };
+            auto result = fn(from_table, table.doc_count(), table.total_doc_length());
+            if (table.unchanged_since(generation)) return result;
+        }
+        DocLengthFn from_segments = [this](uint32_t doc_id) { return snapshot.doc_length(doc_id); };
+        return fn(from_segments, snapshot.doc_count(), snapshot.total_doc_length());
+    }
+
+    // Length of doc_id in this generation. Queries scoring many documents use with_doc_lengths().
+    uint32_t doc_length(uint32_t doc_id) const {
+        return with_doc_lengths([doc_id](const DocLengthFn& length, uint64_t, uint64_t) { return length(doc_id); });
+    }
+
+    // (N, total doc length) for BM25 in this generation.
+    std::pair<uint64_t, uint64_t> collection_stats() const {
+        return with_doc_lengths([](const DocLengthFn&, uint64_t total_docs, uint64_t total_length) {
+            return std::make_pair(total_docs, total_length);
+        });
+    }
+};
+
+// How current a LiveIndex is. The lag compares the view new queries get with the manifest on disk.
+struct RefreshStats {
+    uint64_t generation = 0;            // Served to new queries
+    uint64_t published_generation = 0;  // Newest the indexer has published
+    uint64_t lag_docs = 0;              // Documents flushed into generations not served yet
+    double lag_seconds = 0;             // Since the newest generation was published, if not served
+    uint64_t refreshes = 0;             // Views swapped in since opening
+    uint64_t refresh_failures = 0;
+    double last_refresh_seconds = 0;    // Time to open and swap in the last new view
+    double max_refresh_seconds = 0;
+};
+
+/**
+ * @brief A read-only index directory that follows the indexer's manifest.
+ *
+ * Queries acquire() the current view and hold it while they run. refresh() (called directly, or
+ * by a background thread every refresh_interval) opens the newest manifest's generation next to
+ * the current one, sharing every segment that is already mapped, and swaps it in under a lock
+ * held only for the pointer swap. Queries in flight keep their old view; it is unmapped when the
+ * last of them releases it.
+ *
+ * @note Thread-safe.
+ */
+class LiveIndex {
+public:
+    /**
+     * A directory the indexer has not published to yet opens as an empty generation 0, which a
+     * refresh replaces once the first manifest appears.
+     *
+     * @param refresh_interval How often a background thread refreshes; zero for none.
+     * @throws std::runtime_error if the index cannot be opened.
+     */
+    explicit LiveIndex(std::string dir, std::chrono::milliseconds refresh_interval = std::chrono::milliseconds(0))
+        : dir_(std::move(dir)), refresh_interval_(refresh_interval) {
+        auto view = std::make_shared<IndexView>();
+        view->snapshot = open_index_snapshot(dir_);
+        view->doc_lengths = open_doc_lengths(nullptr);
+        current_ = view;
+        if (refresh_interval_.count() > 0) refresh_thread_ = std::thread(&LiveIndex::refresh_loop, this);
+    }
+
+    ~LiveIndex() {
+        close();
+    }
+
+    LiveIndex(const LiveIndex&) = delete;
+    LiveIndex& operator=(const LiveIndex&) = delete;
+
+    // The view new queries should read, or null once closed.
+    std::shared_ptr<const IndexView> acquire() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return current_;
+    }
+
+    /**
+     * @brief Swaps in the manifest's newest generation if it is not the one being served.
+     * @return Whether a new view was swapped in.
+     * @throws std::runtime_error if the new generation cannot be opened; the current view stays.
+     */
+    bool refresh() {
+        std::lock_guard<std::mutex> refreshing(refresh_mutex_);  // One refresh at a time
+        std::shared_ptr<const IndexView> current = acquire();
+        if (!current) return false;
+
+        auto started = std::chrono::steady_clock::now();
+        SegmentManifest manifest;
+        try {
+            manifest = read_manifest(dir_);
+        } catch (...) {
+            record_failure();
+            throw;
+        }
+        auto view = std::make_shared<IndexView>();
+        try {
+            // The doc length table can be replaced or grown without a new generation
+            view->doc_lengths = open_doc_lengths(current->doc_lengths);
+            if (manifest.generation == current->snapshot.generation()) {
+                if (view->doc_lengths == current->doc_lengths) return false;
+                view->snapshot = current->snapshot;
+            } else {
+                view->snapshot = open_index_snapshot(dir_, &current->snapshot);
+            }
+        } catch (...) {
+            record_failure();
+            throw;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!current_) return false;  // Closed meanwhile
+        current_ = view;
+        ++stats_.refreshes;
+        stats_.last_refresh_seconds = seconds;
+        stats_.max_refresh_seconds = std::max(stats_.max_refresh_seconds, seconds);
+        return true;
+    }
+
+    // Refresh counters, plus the current lag (which reads the manifest).
+    RefreshStats stats() const {
+        RefreshStats stats;
+        std::shared_ptr<const IndexView> view;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats = stats_;
+            view = current_;
+        }
+        if (!view) return stats;
+        const IndexSnapshot& served = view->snapshot;
+        stats.generation = stats.published_generation = served.generation();
+        SegmentManifest newest;
+        try {
+            newest = read_manifest(dir_);
+        } catch (const std::runtime_error&) {
+            return stats;  // Mid-write or unreadable: report no lag rather than fail
+        }
+        if (newest.generation <= served.generation()) return stats;
+        stats.published_generation = newest.generation;
+        stats.lag_docs = newest.docs_flushed > served.docs_flushed() ? newest.docs_flushed - served.docs_flushed() : 0;
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        uint64_t now_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+        if (newest.published_ms > 0 && now_ms > newest.published_ms) {
+            stats.lag_seconds = (now_ms - newest.published_ms) / 1000.0;
+        }
+        return stats;
+    }
+
+    // Stops refreshing and drops the current view; queries still holding it finish normally.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            current_.reset();
+        }
+        stop_.notify_all();
+        if (refresh_thread_.joinable()) refresh_thread_.join();
+    }
+
+private:
+    // The table to serve next to current: current itself while the file is unchanged, the
+    // reopened file otherwise, or null if there is none (yet).
+    std::shared_ptr<const DocLengthTable> open_doc_lengths(const std::shared_ptr<const DocLengthTable>& current) const {
+        if (current && current->is_current()) return current;
+        try {
+            return std::make_shared<const DocLengthTable>(dir_ + "/" + DOC_LENGTH_TABLE_NAME);
+        } catch (const std::runtime_error&) {
+            return current;  // Missing or mid-rebuild: keep what there was, the next refresh retries
+        }
+    }
+
+    void refresh_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            stop_.wait_for(lock, refresh_interval_);
+            if (stopping_) break;
+            lock.unlock();
+            try {
+                refresh();
+            } catch (const std::exception& e) {
+                std::cerr << "Index refresh failed: " << e.what() << std::endl;
+            }
+            lock.lock();
+        }
+    }
+
+    void record_failure() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.refresh_failures;
+    }
+
+    const std::string dir_;
+    const std::chrono::milliseconds refresh_interval_;
+    mutable std::mutex mutex_;  // Guards current_, stats_ and stopping_; never held while opening files
+    std::mutex refresh_mutex_;
+    std::condition_variable stop_;
+    std::shared_ptr<const IndexView> current_;
+    RefreshStats stats_;
+    bool stopping_ = false;
+    std::thread refresh_thread_;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_LIVE_INDEX_HPP
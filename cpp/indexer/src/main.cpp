@@ -1,188 +1,517 @@
 #include "utils.hpp"
+#include "bounded_queue.hpp"
+#include "document_processor.hpp"
+#include "segment_writer.hpp"
 
 #include <iostream>
 #include <string>
 #include <vector>
-#include <sstream>
-#include <fstream>
 #include <algorithm>
-#include <set>
+#include <cstdint>
 #include <thread>
 #include <chrono>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <filesystem>
+#include <cstring>
 #include <pqxx/pqxx>
 #include <hiredis/hiredis.h>
-#include <rocksdb/db.h>
-#include <gumbo.h>
 
 using namespace indexer;
 
 // --- Config ---
 const std::string REDIS_HOST = get_env_or_default("REDIS_HOST", "redis_service");
 const std::string DB_CONN_STR = build_db_conn_str();
-const std::string ROCKSDB_PATH = get_env_or_default("ROCKSDB_PATH", "/shared_data/search_index.db");
+// Directory of immutable index segments (see segment.hpp)
+const std::string INDEX_PATH = get_env_or_default("INDEX_PATH", "/shared_data/search_index");
 const std::string WARC_BASE_PATH = get_env_or_default("WARC_BASE_PATH", "/shared_data/");
+// Doc IDs popped from Redis per round trip, and documents per Postgres metadata UPDATE
+const size_t INDEX_BATCH_SIZE = std::max(1ul, std::stoul(get_env_or_default("INDEX_BATCH_SIZE", "256")));
+// The in-memory segment is flushed at whichever of these limits it reaches first
+const size_t SEGMENT_MAX_DOCS = std::max(1ul, std::stoul(get_env_or_default("SEGMENT_MAX_DOCS", "100000")));
+const size_t SEGMENT_RAM_BYTES = std::stoul(get_env_or_default("SEGMENT_RAM_MB", "64")) * 1024 * 1024;
+// Longest a processed document waits in memory before its segment is flushed anyway
+const std::chrono::milliseconds INDEX_FLUSH_INTERVAL(std::stoul(get_env_or_default("INDEX_FLUSH_INTERVAL_MS", "5000")));
+// A failed segment flush is retried after this delay, doubled on each further failure; after
+// INDEX_FLUSH_MAX_ATTEMPTS its documents are handed back (see commit_stage)
+const std::chrono::milliseconds INDEX_FLUSH_RETRY_DELAY(std::stoul(get_env_or_default("INDEX_FLUSH_RETRY_DELAY_MS", "1000")));
+const int INDEX_FLUSH_MAX_ATTEMPTS = 6;
+// Segments of one size tier merged at once by the background merger
+const size_t MERGE_FACTOR = std::stoul(get_env_or_default("MERGE_FACTOR", "10"));
+// Parse/tokenize worker threads (0 = one per core)
+const size_t INDEXER_WORKERS = std::stoul(get_env_or_default("INDEXER_WORKERS", "0"));
+// "streaming" (single pass, no DOM) or "gumbo" (full parse)
+const HtmlParser HTML_PARSER = get_env_or_default("HTML_PARSER", "streaming") == "gumbo" ? HtmlParser::Gumbo
+                                                                                           : HtmlParser::Streaming;
+// WARC files kept mmap'ed at once by the workers' shared reader
+const size_t WARC_READER_MAX_FILES = std::stoul(get_env_or_default("WARC_READER_MAX_FILES", "16"));
+// Bulk mode: where the rebuilt index goes, and the memory budget of each of its segments
+const std::string BULK_INDEX_PATH = get_env_or_default("BULK_INDEX_PATH", INDEX_PATH + ".bulk");
+const size_t BULK_SEGMENT_RAM_BYTES = std::stoul(get_env_or_default("BULK_SEGMENT_RAM_MB", "512")) * 1024 * 1024;
+const int DB_MAX_RETRIES = 10;
+const int DB_RETRY_DELAY_SECONDS = 5;
 
-int main() {
-    std::cout << "--- Indexer Service Started ---" << std::endl;
-
-    // 1. Connect to Redis
-    redisContext *redis = redisConnect(REDIS_HOST.c_str(), 6379);
-    if (redis == NULL || redis->err) {
-        std::cerr << "Redis connection failed" << std::endl;
-        return 1;
-    }
+// When the commit stage flushes its in-memory segment.
+struct CommitPolicy {
+    size_t max_docs;
+    size_t max_ram_bytes;
+    std::chrono::milliseconds flush_interval;
+};
 
-    // 2. Connect to Postgres
-    pqxx::connection* C = nullptr;
-    int retries = 10;
-    while (retries > 0) {
+// Each pipeline stage that talks to Postgres owns its connection (pqxx is not thread-safe).
+std::unique_ptr<pqxx::connection> connect_postgres() {
+    for (int retries = DB_MAX_RETRIES; retries > 0; --retries) {
         try {
-            C = new pqxx::connection(DB_CONN_STR);
+            auto C = std::make_unique<pqxx::connection>(DB_CONN_STR);
             if (C->is_open()) {
                 std::cout << "Connected to DB" << std::endl;
-                break;
+                return C;
             }
         } catch (const std::exception &e) {
             std::cerr << "Postgres connection attempt failed" << std::endl;
-            if (C) { delete C; C = nullptr; }
         }
-        std::cout << "Retrying Postgres connection in 5 seconds..." << std::endl;
-        std::this_thread::sleep_for(std::chrono::seconds(5));
-        retries--;
+        std::cout << "Retrying Postgres connection in " << DB_RETRY_DELAY_SECONDS << " seconds..." << std::endl;
+        std::this_thread::sleep_for(std::chrono::seconds(DB_RETRY_DELAY_SECONDS));
     }
+    return nullptr;
+}
 
-    if (!C || !C->is_open()) {
-        std::cerr << "Failed to connect to Postgres after retries." << std::endl;
-        redisFree(redis);
-        return 1;
+// Pops up to max_count doc IDs in one round trip, blocking until at least one is queued.
+std::vector<int> pop_doc_ids(redisContext* redis, size_t max_count) {
+    std::vector<int> doc_ids;
+    redisReply *reply = (redisReply*)redisCommand(redis, "BLMPOP 0 1 indexing_queue LEFT COUNT %zu", max_count);
+    if (reply == NULL) return doc_ids;
+
+    // Reply: [key, [id, id, ...]], or nil on timeout
+    if (reply->type == REDIS_REPLY_ARRAY && reply->elements == 2 && reply->element[1]->type == REDIS_REPLY_ARRAY) {
+        redisReply* ids = reply->element[1];
+        for (size_t i = 0; i < ids->elements; ++i) {
+            if (ids->element[i] == nullptr || ids->element[i]->str == nullptr) continue;
+            try {
+                doc_ids.push_back(std::stoi(ids->element[i]->str));
+            } catch (const std::exception&) {
+                std::cerr << "Skipping malformed doc ID: " << ids->element[i]->str << std::endl;
+            }
+        }
+    } else if (reply->type == REDIS_REPLY_ERROR) {
+        std::cerr << "BLMPOP failed: " << reply->str << std::endl;
     }
+    freeReplyObject(reply);
+    return doc_ids;
+}
 
-    // 3. Open RocksDB
-    rocksdb::DB* db;
-    rocksdb::Options options;
-    options.create_if_missing = true;
-    rocksdb::Status status = rocksdb::DB::Open(options, ROCKSDB_PATH, &db);
-    if (!status.ok()) {
-        std::cerr << "RocksDB Open failed: " << status.ToString() << std::endl;
-        delete C;
-        redisFree(redis);
-        return 1;
+// Pushes doc IDs back onto indexing_queue with command ("LPUSH" to retry them next, "RPUSH" to
+// retry them after everything queued), keeping their order. Returns false if Redis refused them.
+bool requeue_doc_ids(redisContext* redis, const char* command, const std::vector<int>& doc_ids) {
+    if (doc_ids.empty()) return true;
+    std::vector<std::string> args = {command, "indexing_queue"};
+    bool to_head = std::strcmp(command, "LPUSH") == 0;
+    for (size_t i = 0; i < doc_ids.size(); ++i) {
+        args.push_back(std::to_string(doc_ids[to_head ? doc_ids.size() - 1 - i : i]));  // LPUSH reverses
     }
+    std::vector<const char*> argv;
+    std::vector<size_t> argv_len;
+    for (const auto& arg : args) {
+        argv.push_back(arg.c_str());
+        argv_len.push_back(arg.size());
+    }
+
+    redisReply *reply = (redisReply*)redisCommandArgv(redis, static_cast<int>(argv.size()), argv.data(),
+                                                      argv_len.data());
+    bool ok = reply != NULL && reply->type != REDIS_REPLY_ERROR;
+    if (!ok) {
+        std::cerr << "Requeueing " << doc_ids.size() << " docs failed: "
+                  << (reply ? reply->str : (redis->err ? redis->errstr : "NULL reply")) << std::endl;
+    }
+    if (reply) freeReplyObject(reply);
+    return ok;
+}
+
+// Postgres array literal for a list of integer IDs, e.g. "{1,2,3}".
+std::string int_array_literal(const std::vector<int>& ids) {
+    std::string literal = "{";
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i > 0) literal += ",";
+        literal += std::to_string(ids[i]);
+    }
+    return literal + "}";
+}
+
+// Records docs the indexer will never find a WARC record for, so they are not silently lost.
+void mark_unlocatable(pqxx::connection& C, const std::vector<int>& doc_ids) {
+    if (doc_ids.empty()) return;
+    try {
+        pqxx::work W(C);
+        W.exec_params("UPDATE documents SET status = 'not_indexed' WHERE id = ANY($1::int[])",
+                      int_array_literal(doc_ids));
+        W.commit();
+    } catch (const std::exception &e) {
+        std::cerr << "Error marking " << doc_ids.size() << " docs not indexed: " << e.what() << std::endl;
+    }
+}
 
+// Stage 1: pops doc IDs from Redis in batches and resolves their WARC locations in one query.
+// A batch whose lookup fails goes back to the head of the queue, after reconnecting if the
+// connection broke.
+void intake_stage(redisContext* redis, std::unique_ptr<pqxx::connection>& C, BoundedQueue<IndexTask>& tasks) {
     while (true) {
-        // A. Pop from Queue
-        redisReply *reply = (redisReply*)redisCommand(redis, "BLPOP indexing_queue 0");
-        if (reply == NULL || reply->type != REDIS_REPLY_ARRAY) {
-            if (reply) freeReplyObject(reply);
-            continue; // Should not happen with BLPOP unless timeout/error
+        std::vector<int> doc_ids = pop_doc_ids(redis, INDEX_BATCH_SIZE);
+        if (doc_ids.empty()) {
+            if (redis->err) {
+                std::cerr << "Redis error: " << redis->errstr << std::endl;
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+            continue;
         }
 
-        if (reply->elements < 2 || reply->element[1] == nullptr || reply->element[1]->str == nullptr) {
-            freeReplyObject(reply);
+        std::vector<IndexTask> batch;
+        std::vector<int> unlocatable;
+        std::vector<int> missing;
+        try {
+            pqxx::work W(*C);
+            pqxx::result R = W.exec_params(
+                "SELECT id, file_path, \"offset\", length FROM documents WHERE id = ANY($1::int[])",
+                int_array_literal(doc_ids));
+            W.commit();
+            std::vector<int> found;
+            for (const auto& row : R) {
+                found.push_back(row[0].as<int>());
+                if (row[1].is_null() || row[2].is_null() || row[3].is_null()) {
+                    unlocatable.push_back(row[0].as<int>());
+                    continue;
+                }
+                batch.push_back({row[0].as<int>(), WARC_BASE_PATH + row[1].as<std::string>(),
+                                 row[2].as<int64_t>(), row[3].as<int64_t>()});
+            }
+            std::sort(found.begin(), found.end());
+            for (int doc_id : doc_ids) {
+                if (!std::binary_search(found.begin(), found.end(), doc_id)) missing.push_back(doc_id);
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "Error fetching metadata for " << doc_ids.size() << " docs: " << e.what() << std::endl;
+            if (!requeue_doc_ids(redis, "LPUSH", doc_ids)) {
+                std::cerr << "Lost doc IDs " << int_array_literal(doc_ids) << std::endl;
+            }
+            if (!C->is_open()) {
+                std::cerr << "Intake lost its Postgres connection, reconnecting" << std::endl;
+                do {
+                    C = connect_postgres();
+                } while (!C);
+            } else {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
             continue;
         }
 
-        std::string doc_id_str = reply->element[1]->str;
-        int doc_id;
+        // A doc is queued only once its WARC location is recorded, so these will not resolve later
+        if (!unlocatable.empty()) {
+            std::cerr << unlocatable.size() << " of " << doc_ids.size()
+                      << " popped docs have no WARC location: " << int_array_literal(unlocatable) << std::endl;
+            mark_unlocatable(*C, unlocatable);
+        }
+        if (!missing.empty()) {
+            std::cerr << missing.size() << " of " << doc_ids.size()
+                      << " popped docs have no row: " << int_array_literal(missing) << std::endl;
+        }
+        for (auto& task : batch) {
+            if (!tasks.push(std::move(task))) return;
+        }
+    }
+}
+
+// Stage 2: decompresses, parses and tokenizes; one of INDEXER_WORKERS threads.
+void worker_stage(BoundedQueue<IndexTask>& tasks, BoundedQueue<IndexedDocument>& results, WarcReader& reader) {
+    while (auto task = tasks.pop()) {
         try {
-            doc_id = std::stoi(doc_id_str);
-        } catch (const std::exception&) {
-            freeReplyObject(reply);
-            continue;
+            IndexedDocument doc = process_document(*task, reader, HTML_PARSER);
+            std::cout << "Indexed " << doc.doc_length << " words for Doc " << doc.doc_id << std::endl;
+            if (!results.push(std::move(doc))) return;
+        } catch (const std::exception &e) {
+            std::cerr << "Error indexing doc " << task->doc_id << ": " << e.what() << std::endl;
         }
-        freeReplyObject(reply);
-        
-        std::cout << "Indexing Doc ID: " << doc_id << std::endl;
+    }
+}
 
+// Updates the metadata of indexed documents, one multi-row UPDATE per INDEX_BATCH_SIZE docs.
+void update_metadata(pqxx::connection& C, const std::vector<IndexedDocument>& docs) {
+    for (size_t start = 0; start < docs.size(); start += INDEX_BATCH_SIZE) {
+        size_t end = std::min(docs.size(), start + INDEX_BATCH_SIZE);
         try {
-            // B. Get Metadata
-            pqxx::work W(*C);
-            pqxx::row row = W.exec_params1("SELECT file_path, \"offset\", length FROM documents WHERE id = $1", doc_id);
-            std::string file_path = WARC_BASE_PATH + row[0].as<std::string>();
-            long offset = row[1].as<long>();
-            long length = row[2].as<long>();
+            pqxx::work W(C);
+            std::string values;
+            for (size_t i = start; i < end; ++i) {
+                const IndexedDocument& doc = docs[i];
+                if (!values.empty()) values += ",";
+                values += "(" + std::to_string(doc.doc_id) + "," + std::to_string(doc.doc_length) + "," +
+                          W.quote(doc.title) + "," + W.quote(doc.snippet) + ")";
+            }
+            W.exec("UPDATE documents AS d SET doc_length = v.doc_length, title = v.title, snippet = v.snippet "
+                   "FROM (VALUES " + values + ") AS v(id, doc_length, title, snippet) WHERE d.id = v.id");
             W.commit();
+        } catch (const std::exception &e) {
+            std::cerr << "Error updating metadata for " << (end - start) << " docs: " << e.what() << std::endl;
+        }
+    }
+}
 
-            // C. Read WARC Record
-            std::ifstream infile(file_path, std::ios::binary);
-            if (!infile) {
-                std::cerr << "Could not open file: " << file_path << std::endl;
-                continue;
-            }
-            infile.seekg(offset);
-            std::vector<char> buffer(length);
-            infile.read(buffer.data(), length);
-            std::streamsize readBytes = infile.gcount();
-            if (readBytes != length) {
-                std::cerr << "Failed to read full record: expected " << length << " bytes, got " << readBytes << std::endl;
-                continue;
-            }
-            std::string compressed_data(buffer.begin(), buffer.end());
-            
-            // D. Decompress & Parse
-            std::string full_warc_record = decompress_gzip(compressed_data);
-            // Skip WARC headers (find first double newline)
-            size_t header_end = full_warc_record.find("\r\n\r\n");
-            if (header_end == std::string::npos) continue;
-            
-            std::string html_content = full_warc_record.substr(header_end + 4);
-            
-            GumboOutput* output = gumbo_parse(html_content.c_str());
-            ExtractedContent content = extract_content(output->root);
-            std::string plain_text = content.text;
-            std::string title = content.title;
-            gumbo_destroy_output(&kGumboDefaultOptions, output);
-
-            // Generate Snippet (first 200 chars)
-            std::string snippet = plain_text.substr(0, 200);
-            // Basic cleanup of snippet (remove newlines)
-            std::replace(snippet.begin(), snippet.end(), '\n', ' ');
-            std::replace(snippet.begin(), snippet.end(), '\r', ' ');
-
-            // E. Tokenize & Index
-            std::vector<std::string> tokens = tokenize(plain_text);
-            std::set<std::string> unique_tokens(tokens.begin(), tokens.end()); // Simple boolean index for now
-
-            for (const auto& token : unique_tokens) {
-                std::string current_list;
-                status = db->Get(rocksdb::ReadOptions(), token, &current_list);
-                
-                std::set<std::string> doc_ids;
-                if (status.ok() && !current_list.empty()) {
-                    std::stringstream ss(current_list);
-                    std::string id;
-                    while (std::getline(ss, id, ',')) {
-                        doc_ids.insert(id);
-                    }
-                }
-                
-                std::string doc_id_str = std::to_string(doc_id);
-                if (doc_ids.find(doc_id_str) == doc_ids.end()) {
-                    doc_ids.insert(doc_id_str);
-                    current_list = "";
-                    for (auto it = doc_ids.begin(); it != doc_ids.end(); ++it) {
-                        if (it != doc_ids.begin()) current_list += ",";
-                        current_list += *it;
-                    }
-                    db->Put(rocksdb::WriteOptions(), token, current_list);
-                }
+// Writes the in-memory segment and publishes it, then records the metadata of the documents in
+// it, so Postgres never describes a document the index cannot find yet. Returns false if the
+// segment could not be published; builder and pending are then left as they were.
+bool flush_segment(IndexWriter& index, SegmentBuilder& builder, pqxx::connection& C,
+                   std::vector<IndexedDocument>& pending) {
+    if (pending.empty()) return true;
+
+    try {
+        index.flush(builder);
+    } catch (const std::exception &e) {
+        std::cerr << "Segment flush failed for " << pending.size() << " docs: " << e.what() << std::endl;
+        return false;
+    }
+    update_metadata(C, pending);
+    std::cout << "Committed segment of " << pending.size() << " docs" << std::endl;
+    pending.clear();
+    return true;
+}
+
+// Called with the doc IDs of a segment that still could not be flushed after every retry.
+using GiveUpFn = std::function<void(const std::vector<int>& doc_ids)>;
+
+// Stage 3: the single writer. Adds documents to an in-memory segment and flushes it when it
+// reaches the policy's document or memory limit, or its oldest document has waited the flush
+// interval. A failed flush is retried with backoff while the pipeline behind it waits; after
+// INDEX_FLUSH_MAX_ATTEMPTS the segment's documents go to give_up. Returns once results is closed
+// and drained.
+void commit_stage(IndexWriter& index, pqxx::connection& C, BoundedQueue<IndexedDocument>& results,
+                  const CommitPolicy& policy, const GiveUpFn& give_up) {
+    SegmentBuilder builder;
+    std::vector<IndexedDocument> pending;
+    auto flush_deadline = std::chrono::steady_clock::now();
+
+    auto flush = [&] {
+        for (int attempt = 1; !flush_segment(index, builder, C, pending); ++attempt) {
+            if (attempt >= INDEX_FLUSH_MAX_ATTEMPTS) {
+                std::vector<int> doc_ids;
+                for (const auto& doc : pending) doc_ids.push_back(doc.doc_id);
+                std::cerr << "Giving up on a segment of " << doc_ids.size() << " docs after " << attempt
+                          << " attempts" << std::endl;
+                give_up(doc_ids);
+                builder.clear();
+                pending.clear();
+                return;
             }
+            auto delay = INDEX_FLUSH_RETRY_DELAY * (1 << (attempt - 1));
+            std::cerr << "Retrying the flush in " << delay.count() << " ms" << std::endl;
+            std::this_thread::sleep_for(delay);
+        }
+    };
+
+    while (true) {
+        // Only wait indefinitely when nothing is waiting to be committed
+        std::optional<IndexedDocument> doc;
+        if (pending.empty()) {
+            doc = results.pop();
+        } else {
+            auto remaining = flush_deadline - std::chrono::steady_clock::now();
+            if (remaining > std::chrono::steady_clock::duration::zero()) doc = results.pop_for(remaining);
+        }
+        if (!doc) {
+            flush(); // Flush interval elapsed: commit what we have
+            if (results.closed()) return;
+            continue;
+        }
+
+        if (pending.empty()) flush_deadline = std::chrono::steady_clock::now() + policy.flush_interval;
+
+        builder.add_document(static_cast<uint32_t>(doc->doc_id), doc->doc_length, doc->term_freqs);
+        doc->term_freqs.clear();
+        doc->term_freqs.shrink_to_fit();
+        pending.push_back(std::move(*doc));
 
-            // F. Update Doc Length, Title, and Snippet
-            pqxx::work W2(*C);
-            W2.exec_params("UPDATE documents SET doc_length = $1, title = $2, snippet = $3 WHERE id = $4", 
-                           tokens.size(), title, snippet, doc_id);
-            W2.commit();
-            
-            std::cout << "Indexed " << tokens.size() << " words for Doc " << doc_id << std::endl;
+        if (builder.doc_count() >= policy.max_docs || builder.ram_bytes() >= policy.max_ram_bytes) {
+            flush();
+        }
+    }
+}
 
+// Bulk stage 1: queues every located record of each WARC file in file order, so the shared
+// reader streams the file front to back. One query per file replaces the Redis queue and the
+// per-batch lookups. Returns the compressed bytes queued.
+int64_t bulk_intake_stage(pqxx::connection& C, const std::vector<std::string>& warc_files,
+                          BoundedQueue<IndexTask>& tasks) {
+    int64_t total_bytes = 0;
+    for (const auto& path : warc_files) {
+        // The crawler records WARC files by name, relative to WARC_BASE_PATH
+        std::string file_name = std::filesystem::path(path).filename().string();
+        pqxx::result R;
+        try {
+            pqxx::work W(C);
+            R = W.exec_params(
+                "SELECT id, \"offset\", length FROM documents "
+                "WHERE file_path = $1 AND \"offset\" IS NOT NULL AND length IS NOT NULL ORDER BY \"offset\"",
+                file_name);
+            W.commit();
         } catch (const std::exception &e) {
-            std::cerr << "Error indexing doc " << doc_id << ": " << e.what() << std::endl;
+            std::cerr << "Error locating records of " << path << ": " << e.what() << std::endl;
+            continue;
+        }
+
+        std::cout << "Bulk indexing " << R.size() << " records from " << path << std::endl;
+        for (const auto& row : R) {
+            IndexTask task{row[0].as<int>(), path, row[1].as<int64_t>(), row[2].as<int64_t>()};
+            total_bytes += task.length;
+            if (!tasks.push(std::move(task))) return total_bytes;
         }
     }
+    return total_bytes;
+}
+
+// `indexer --bulk <warc files...>`: rebuilds the index from whole WARC files into a fresh index
+// directory at BULK_INDEX_PATH, bypassing Redis. Segments are flushed at a large memory budget and
+// merged down to one at the end, so throughput is bounded by reading the files. Swap the new
+// directory in for INDEX_PATH once it completes.
+int run_bulk(const std::vector<std::string>& warc_files) {
+    std::cout << "--- Indexer Bulk Rebuild Started ---" << std::endl;
+    auto started = std::chrono::steady_clock::now();
+
+    std::unique_ptr<pqxx::connection> intake_conn = connect_postgres();
+    std::unique_ptr<pqxx::connection> commit_conn = intake_conn ? connect_postgres() : nullptr;
+    if (!intake_conn || !commit_conn) {
+        std::cerr << "Failed to connect to Postgres after retries." << std::endl;
+        return 1;
+    }
+
+    // Never merge a rebuild into a live or half-built index
+    if (std::filesystem::exists(BULK_INDEX_PATH) && !std::filesystem::is_empty(BULK_INDEX_PATH)) {
+        std::cerr << "Bulk index directory " << BULK_INDEX_PATH << " is not empty" << std::endl;
+        return 1;
+    }
+    std::unique_ptr<IndexWriter> index;
+    try {
+        index = std::make_unique<IndexWriter>(BULK_INDEX_PATH, MergePolicy{MERGE_FACTOR});
+    } catch (const std::exception &e) {
+        std::cerr << "Opening index at " << BULK_INDEX_PATH << " failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    size_t num_workers = INDEXER_WORKERS > 0 ? INDEXER_WORKERS : std::max(1u, std::thread::hardware_concurrency());
+    BoundedQueue<IndexTask> tasks(num_workers * 64);
+    BoundedQueue<IndexedDocument> results(num_workers * 64);
+    WarcReader warc_reader(WARC_READER_MAX_FILES, WarcReader::AccessPattern::Sequential);
+    std::cout << "Writing to " << BULK_INDEX_PATH << " with " << num_workers << " workers" << std::endl;
+
+    int64_t total_bytes = 0;
+    std::thread intake([&] { total_bytes = bulk_intake_stage(*intake_conn, warc_files, tasks); });
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back(worker_stage, std::ref(tasks), std::ref(results), std::ref(warc_reader));
+    }
+    // Closes each queue once its producers are done, which lets the commit stage return
+    std::thread closer([&] {
+        intake.join();
+        tasks.close();
+        for (auto& worker : workers) worker.join();
+        results.close();
+    });
+
+    // Nothing to requeue a document on: a rebuild that drops any is reported as failed
+    size_t dropped_docs = 0;
+    commit_stage(*index, *commit_conn, results, {SIZE_MAX, BULK_SEGMENT_RAM_BYTES, std::chrono::hours(1)},
+                 [&dropped_docs](const std::vector<int>& doc_ids) {
+                     std::cerr << "Dropped doc IDs " << int_array_literal(doc_ids) << std::endl;
+                     dropped_docs += doc_ids.size();
+                 });
+    closer.join();
+    if (dropped_docs > 0) {
+        std::cerr << "Bulk rebuild is missing " << dropped_docs << " docs" << std::endl;
+        return 1;
+    }
+
+    // One segment: the cheapest set for the ranker to search
+    try {
+        index->force_merge();
+    } catch (const std::exception &e) {
+        std::cerr << "Finalizing bulk index failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "Bulk rebuild done: " << total_bytes / (1024 * 1024) << " MB of WARC records in " << seconds
+              << " s (" << (seconds > 0 ? total_bytes / (1024 * 1024) / seconds : 0.0) << " MB/s)" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--bulk") == 0) {
+        std::vector<std::string> warc_files(argv + 2, argv + argc);
+        if (warc_files.empty()) {
+            std::cerr << "Usage: indexer --bulk <warc files...>" << std::endl;
+            return 1;
+        }
+        return run_bulk(warc_files);
+    }
+
+    std::cout << "--- Indexer Service Started ---" << std::endl;
+
+    // 1. Connect to Redis (one connection for intake, one for requeueing failed segments)
+    redisContext *redis = redisConnect(REDIS_HOST.c_str(), 6379);
+    redisContext *requeue_redis = redis && !redis->err ? redisConnect(REDIS_HOST.c_str(), 6379) : NULL;
+    if (redis == NULL || redis->err || requeue_redis == NULL || requeue_redis->err) {
+        std::cerr << "Redis connection failed" << std::endl;
+        if (redis) redisFree(redis);
+        if (requeue_redis) redisFree(requeue_redis);
+        return 1;
+    }
+
+    // 2. Connect to Postgres (one connection for intake, one for commits)
+    std::unique_ptr<pqxx::connection> intake_conn = connect_postgres();
+    std::unique_ptr<pqxx::connection> commit_conn = intake_conn ? connect_postgres() : nullptr;
+    if (!intake_conn || !commit_conn) {
+        std::cerr << "Failed to connect to Postgres after retries." << std::endl;
+        redisFree(redis);
+        redisFree(requeue_redis);
+        return 1;
+    }
+
+    // 3. Open the index directory (starts the background merger)
+    std::unique_ptr<IndexWriter> index;
+    try {
+        index = std::make_unique<IndexWriter>(INDEX_PATH, MergePolicy{MERGE_FACTOR});
+    } catch (const std::exception &e) {
+        std::cerr << "Opening index at " << INDEX_PATH << " failed: " << e.what() << std::endl;
+        redisFree(redis);
+        redisFree(requeue_redis);
+        return 1;
+    }
+
+    // 4. Start the pipeline: intake -> N workers -> commit
+    size_t num_workers = INDEXER_WORKERS > 0 ? INDEXER_WORKERS : std::max(1u, std::thread::hardware_concurrency());
+    BoundedQueue<IndexTask> tasks(std::max(INDEX_BATCH_SIZE, num_workers * 4));
+    BoundedQueue<IndexedDocument> results(std::max(INDEX_BATCH_SIZE, num_workers * 4));
+    WarcReader warc_reader(WARC_READER_MAX_FILES, WarcReader::AccessPattern::Random);
+    std::cout << "Starting pipeline with " << num_workers << " workers" << std::endl;
+
+    std::thread intake(intake_stage, redis, std::ref(intake_conn), std::ref(tasks));
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back(worker_stage, std::ref(tasks), std::ref(results), std::ref(warc_reader));
+    }
+
+    // Runs for the life of the service, like the single loop it replaces. Docs of a segment that
+    // cannot be flushed go to the back of the queue, to be indexed once the index is writable again.
+    commit_stage(*index, *commit_conn, results, {SEGMENT_MAX_DOCS, SEGMENT_RAM_BYTES, INDEX_FLUSH_INTERVAL},
+                 [requeue_redis](const std::vector<int>& doc_ids) {
+                     if (!requeue_doc_ids(requeue_redis, "RPUSH", doc_ids)) {
+                         std::cerr << "Lost doc IDs " << int_array_literal(doc_ids) << std::endl;
+                     }
+                 });
+
+    tasks.close();
+    intake.join();
+    for (auto& worker : workers) worker.join();
 
-    delete db;
-    delete C;
+    index.reset();
     redisFree(redis);
+    redisFree(requeue_redis);
     return 0;
 }
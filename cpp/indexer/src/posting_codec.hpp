@@ -0,0 +1,383 @@
+#ifndef INDEXER_POSTING_CODEC_HPP
+#define INDEXER_POSTING_CODEC_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace indexer {
+
+/*
+ * Binary posting list format (version 2)
+ *
+ *   value   := version:u8 block*
+ *   block   := count:varint first_doc:varint last_doc:varint max_tf:varint
+ *              min_doc_len:varint payload_size:varint payload
+ *   payload := doc_gap:varint{count - 1} tf:varint{count}
+ *
+ * Doc IDs inside a block are strictly increasing and stored as gaps from the previous doc
+ * (the first one is first_doc itself). A block holds at most POSTING_BLOCK_SIZE postings.
+ * The header fields double as skip data: a cursor can jump over a whole block by looking at
+ * last_doc and payload_size without decoding it, and max_tf / min_doc_len bound the BM25
+ * score any posting in the block can reach (see query_engine.hpp).
+ *
+ * Version 1 is identical minus min_doc_len; it is still decoded, with min_doc_len = 0.
+ *
+ * Blocks are self-contained, so two encoded lists can be concatenated (dropping the second
+ * version byte) and still decode. Concatenated runs may overlap; decode_postings() sorts and
+ * de-duplicates them, keeping the posting that appears last.
+ *
+ * Header-only so the rocksdb_client Python module can share it without linking the indexer.
+ */
+
+constexpr uint8_t POSTING_FORMAT_VERSION = 2;
+constexpr uint8_t POSTING_FORMAT_VERSION_V1 = 1;
+constexpr size_t POSTING_BLOCK_SIZE = 128;
+
+struct Posting {
+    uint32_t doc_id;
+    uint32_t tf;  // Occurrences of the term in the document
+    // Lower bound on the document's length, used only for block score bounds. Exact when the
+    // indexer builds the posting; after decoding it is the min_doc_len of the source block.
+    uint32_t doc_len_floor = 0;
+};
+
+// Summary of one encoded block, available without decoding its payload.
+struct PostingBlockHeader {
+    uint32_t count;
+    uint32_t first_doc;
+    uint32_t last_doc;
+    uint32_t max_tf;
+    uint32_t min_doc_len;  // 0 when unknown (version 1 blocks)
+    uint32_t payload_size;
+};
+
+inline void put_varint32(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Reads a varint at pos and advances it. Throws on truncated input, on more than 5 bytes and on
+// values past 32 bits.
+inline uint32_t get_varint32(std::string_view data, size_t& pos) {
+    uint32_t result = 0;
+    for (int shift = 0; shift <= 28; shift += 7) {
+        if (pos >= data.size()) {
+            throw std::runtime_error("Truncated varint in posting list");
+        }
+        uint8_t byte = static_cast<uint8_t>(data[pos++]);
+        if (shift == 28 && (byte & 0x70) != 0) {
+            throw std::runtime_error("Varint overflows 32 bits in posting list");
+        }
+        result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return result;
+    }
+    throw std::runtime_error("Malformed varint in posting list");
+}
+
+// Little-endian fixed-width integers, for segment and term dictionary tables.
+inline void put_fixed32(std::string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) out.push_back(static_cast<char>((value >> shift) & 0xFF));
+}
+
+inline void put_fixed64(std::string& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) out.push_back(static_cast<char>((value >> shift) & 0xFF));
+}
+
+inline uint32_t get_fixed32(const char* p) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) value = (value << 8) | static_cast<uint8_t>(p[i]);
+    return value;
+}
+
+inline uint64_t get_fixed64(const char* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) value = (value << 8) | static_cast<uint8_t>(p[i]);
+    return value;
+}
+
+inline PostingBlockHeader read_block_header(std::string_view data, size_t& pos,
+                                            uint8_t version = POSTING_FORMAT_VERSION) {
+    PostingBlockHeader header;
+    header.count = get_varint32(data, pos);
+    header.first_doc = get_varint32(data, pos);
+    header.last_doc = get_varint32(data, pos);
+    header.max_tf = get_varint32(data, pos);
+    header.min_doc_len = version >= 2 ? get_varint32(data, pos) : 0;
+    header.payload_size = get_varint32(data, pos);
+    if (header.count == 0 || header.count > POSTING_BLOCK_SIZE || header.last_doc < header.first_doc ||
+        header.payload_size > data.size() - pos) {
+        throw std::runtime_error("Corrupt posting block header");
+    }
+    return header;
+}
+
+// Decodes the payload that follows a block header into out (appending).
+inline void decode_block_payload(std::string_view data, size_t pos, const PostingBlockHeader& header,
+                                 std::vector<Posting>& out) {
+    std::string_view payload = data.substr(pos, header.payload_size);
+    size_t p = 0;
+    size_t base = out.size();
+    out.resize(base + header.count);
+    uint32_t doc = header.first_doc;
+    out[base].doc_id = doc;
+    for (uint32_t i = 1; i < header.count; ++i) {
+        doc += get_varint32(payload, p);
+        out[base + i].doc_id = doc;
+    }
+    for (uint32_t i = 0; i < header.count; ++i) {
+        out[base + i].tf = get_varint32(payload, p);
+        out[base + i].doc_len_floor = header.min_doc_len;
+    }
+    if (doc != header.last_doc || p != payload.size()) {
+        throw std::runtime_error("Posting block payload does not match its header");
+    }
+}
+
+/**
+ * @brief Appends the encoded blocks for postings to out (without a version byte).
+ * @param postings Must be sorted by doc_id with no duplicates.
+ * @throws std::invalid_argument if postings are not strictly increasing.
+ */
+inline void encode_posting_blocks(const std::vector<Posting>& postings, std::string& out) {
+    std::string payload;
+    for (size_t start = 0; start < postings.size(); start += POSTING_BLOCK_SIZE) {
+        size_t end = std::min(start + POSTING_BLOCK_SIZE, postings.size());
+        uint32_t max_tf = 0;
+        uint32_t min_doc_len = UINT32_MAX;
+        payload.clear();
+        for (size_t i = start; i < end; ++i) {
+            if (i > 0 && postings[i].doc_id <= postings[i - 1].doc_id) {
+                throw std::invalid_argument("Postings must be strictly increasing by doc_id");
+            }
+            if (i > start) put_varint32(payload, postings[i].doc_id - postings[i - 1].doc_id);
+            max_tf = std::max(max_tf, postings[i].tf);
+            min_doc_len = std::min(min_doc_len, postings[i].doc_len_floor);
+        }
+        for (size_t i = start; i < end; ++i) {
+            put_varint32(payload, postings[i].tf);
+        }
+        put_varint32(out, static_cast<uint32_t>(end - start));
+        put_varint32(out, postings[start].doc_id);
+        put_varint32(out, postings[end - 1].doc_id);
+        put_varint32(out, max_tf);
+        put_varint32(out, min_doc_len);
+        put_varint32(out, static_cast<uint32_t>(payload.size()));
+        out.append(payload);
+    }
+}
+
+// Encodes a sorted, duplicate-free posting list into a versioned value.
+inline std::string encode_postings(const std::vector<Posting>& postings) {
+    std::string out;
+    out.reserve(1 + postings.size() * 3);
+    out.push_back(static_cast<char>(POSTING_FORMAT_VERSION));
+    encode_posting_blocks(postings, out);
+    return out;
+}
+
+// Sorts by doc_id and drops duplicates, keeping the last occurrence of each doc.
+inline void normalize_postings(std::vector<Posting>& postings) {
+    std::stable_sort(postings.begin(), postings.end(),
+                     [](const Posting& a, const Posting& b) { return a.doc_id < b.doc_id; });
+    size_t out = 0;
+    for (size_t i = 0; i < postings.size(); ++i) {
+        if (out > 0 && postings[out - 1].doc_id == postings[i].doc_id) {
+            postings[out - 1] = postings[i];
+        } else {
+            postings[out++] = postings[i];
+        }
+    }
+    postings.resize(out);
+}
+
+/**
+ * @brief Decodes a posting list value into sorted, duplicate-free postings (appending to out).
+ *
+ * Also accepts the legacy comma-separated "1,2,3" format written before the binary format
+ * existed; those postings get tf = 1. Empty entries (a leading, doubled or trailing comma, as
+ * the old string-append merge could leave) hold no posting.
+ *
+ * @throws std::runtime_error if the value is corrupt or has an unknown version.
+ */
+inline void decode_postings(std::string_view data, std::vector<Posting>& out) {
+    if (data.empty()) return;
+
+    size_t base = out.size();
+    uint8_t version = static_cast<uint8_t>(data[0]);
+    if ((version >= '0' && version <= '9') || version == ',') {
+        uint64_t doc = 0;
+        size_t digits = 0;
+        for (size_t i = 0; i <= data.size(); ++i) {
+            if (i == data.size() || data[i] == ',') {
+                if (digits > 0) out.push_back({static_cast<uint32_t>(doc), 1});
+                doc = 0;
+                digits = 0;
+            } else if (data[i] >= '0' && data[i] <= '9') {
+                doc = doc * 10 + static_cast<uint64_t>(data[i] - '0');
+                if (doc > UINT32_MAX) throw std::runtime_error("Doc ID overflows 32 bits in legacy posting list");
+                ++digits;
+            } else {
+                throw std::runtime_error("Corrupt legacy posting list");
+            }
+        }
+    } else if (version == POSTING_FORMAT_VERSION || version == POSTING_FORMAT_VERSION_V1) {
+        size_t pos = 1;
+        while (pos < data.size()) {
+            PostingBlockHeader header = read_block_header(data, pos, version);
+            decode_block_payload(data, pos, header, out);
+            pos += header.payload_size;
+        }
+    } else {
+        throw std::runtime_error("Unknown posting list format version: " + std::to_string(version));
+    }
+
+    bool sorted = true;
+    for (size_t i = base + 1; i < out.size() && sorted; ++i) {
+        sorted = out[i - 1].doc_id < out[i].doc_id;
+    }
+    if (!sorted) {
+        std::vector<Posting> tail(out.begin() + base, out.end());
+        normalize_postings(tail);
+        out.resize(base);
+        out.insert(out.end(), tail.begin(), tail.end());
+    }
+}
+
+inline std::vector<Posting> decode_postings(std::string_view data) {
+    std::vector<Posting> out;
+    decode_postings(data, out);
+    return out;
+}
+
+/**
+ * @brief Forward-only cursor over one encoded posting list, with block-level skipping.
+ *
+ * All block headers are read up front (a few bytes each); a block's payload is decoded only
+ * when the cursor actually lands in it, so next_geq() over a long list touches just the blocks
+ * that can contain the target. Values that are not a single clean run (legacy comma lists,
+ * overlapping concatenations) are normalized into an owned buffer first.
+ *
+ * @note For version 2+ values the cursor views the caller's bytes; they must outlive it.
+ */
+class PostingCursor {
+public:
+    static constexpr uint32_t END = UINT32_MAX;
+
+    explicit PostingCursor(std::string_view value) : data_(value) {
+        if (!parse_blocks()) {
+            owned_ = encode_postings(decode_postings(value));
+            data_ = owned_;
+            blocks_.clear();
+            doc_freq_ = 0;
+            parse_blocks();
+        }
+        decode_block(0);
+    }
+
+    PostingCursor(const PostingCursor&) = delete;
+    PostingCursor& operator=(const PostingCursor&) = delete;
+    PostingCursor(PostingCursor&& other) noexcept { *this = std::move(other); }
+    PostingCursor& operator=(PostingCursor&& other) noexcept {
+        bool views_own_buffer = other.data_.data() == other.owned_.data();
+        owned_ = std::move(other.owned_);
+        data_ = views_own_buffer ? std::string_view(owned_) : other.data_;
+        version_ = other.version_;
+        blocks_ = std::move(other.blocks_);
+        doc_freq_ = other.doc_freq_;
+        block_idx_ = other.block_idx_;
+        shallow_idx_ = other.shallow_idx_;
+        decoded_ = std::move(other.decoded_);
+        pos_ = other.pos_;
+        return *this;
+    }
+
+    // Number of documents in the list.
+    size_t doc_freq() const { return doc_freq_; }
+
+    // Current doc ID, or END once the list is exhausted.
+    uint32_t doc() const { return pos_ < decoded_.size() ? decoded_[pos_].doc_id : END; }
+    uint32_t tf() const { return decoded_[pos_].tf; }
+
+    void next() {
+        if (++pos_ >= decoded_.size()) decode_block(block_idx_ + 1);
+    }
+
+    // Moves to the first posting with doc_id >= target (never backwards).
+    void next_geq(uint32_t target) {
+        if (doc() >= target) return;
+        size_t idx = block_idx_;
+        while (idx < blocks_.size() && blocks_[idx].header.last_doc < target) ++idx;
+        if (idx != block_idx_) decode_block(idx);
+        while (pos_ < decoded_.size() && decoded_[pos_].doc_id < target) ++pos_;
+    }
+
+    /**
+     * @brief Header of the block that would hold target, without decoding anything.
+     * Targets must be non-decreasing across calls. Returns nullptr past the last block.
+     */
+    const PostingBlockHeader* block_for(uint32_t target) {
+        shallow_idx_ = std::max(shallow_idx_, block_idx_);
+        while (shallow_idx_ < blocks_.size() && blocks_[shallow_idx_].header.last_doc < target) ++shallow_idx_;
+        return shallow_idx_ < blocks_.size() ? &blocks_[shallow_idx_].header : nullptr;
+    }
+
+    // Visits every block header, e.g. to compute a list-wide score bound.
+    template <typename Fn>
+    void for_each_block(Fn&& fn) const {
+        for (const auto& block : blocks_) fn(block.header);
+    }
+
+private:
+    struct BlockRef {
+        PostingBlockHeader header;
+        size_t payload_pos;
+    };
+
+    std::string owned_;
+    std::string_view data_;
+    uint8_t version_ = POSTING_FORMAT_VERSION;
+    std::vector<BlockRef> blocks_;
+    size_t doc_freq_ = 0;
+    size_t block_idx_ = 0;
+    size_t shallow_idx_ = 0;
+    std::vector<Posting> decoded_;  // Postings of blocks_[block_idx_]
+    size_t pos_ = 0;
+
+    // Indexes the block headers; false if the value is not one strictly increasing run.
+    bool parse_blocks() {
+        if (data_.empty()) return true;
+        version_ = static_cast<uint8_t>(data_[0]);
+        if (version_ != POSTING_FORMAT_VERSION && version_ != POSTING_FORMAT_VERSION_V1) return false;
+        size_t pos = 1;
+        while (pos < data_.size()) {
+            PostingBlockHeader header = read_block_header(data_, pos, version_);
+            if (!blocks_.empty() && header.first_doc <= blocks_.back().header.last_doc) return false;
+            blocks_.push_back({header, pos});
+            doc_freq_ += header.count;
+            pos += header.payload_size;
+        }
+        return true;
+    }
+
+    void decode_block(size_t idx) {
+        block_idx_ = idx;
+        decoded_.clear();
+        pos_ = 0;
+        if (idx < blocks_.size()) {
+            decode_block_payload(data_, blocks_[idx].payload_pos, blocks_[idx].header, decoded_);
+        }
+    }
+};
+
+} // namespace indexer
+
+#endif // INDEXER_POSTING_CODEC_HPP
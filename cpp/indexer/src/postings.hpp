@@ -0,0 +1,102 @@
+#ifndef INDEXER_POSTINGS_HPP
+#define INDEXER_POSTINGS_HPP
+
+#include "posting_codec.hpp"
+
+#include <string>
+#include <vector>
+#include <rocksdb/merge_operator.h>
+#include <rocksdb/slice.h>
+
+namespace indexer {
+
+// Keys outside the term space start with a NUL byte; tokens are always alphanumeric.
+constexpr char DOC_LENGTH_KEY_PREFIX[] = "\0doclen/";
+constexpr size_t DOC_LENGTH_KEY_PREFIX_SIZE = sizeof(DOC_LENGTH_KEY_PREFIX) - 1;
+
+// Key holding a document's token count: the prefix followed by the big-endian doc ID.
+inline std::string doc_length_key(uint32_t doc_id) {
+    std::string key(DOC_LENGTH_KEY_PREFIX, DOC_LENGTH_KEY_PREFIX_SIZE);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        key.push_back(static_cast<char>((doc_id >> shift) & 0xFF));
+    }
+    return key;
+}
+
+inline std::string encode_doc_length(uint32_t length) {
+    std::string value;
+    put_varint32(value, length);
+    return value;
+}
+
+inline uint32_t decode_doc_length(std::string_view value) {
+    size_t pos = 0;
+    return get_varint32(value, pos);
+}
+
+/**
+ * @brief RocksDB merge operator for binary posting lists (see posting_codec.hpp).
+ *
+ * The indexer issues a blind Merge(term, encoded_postings) instead of a Get/parse/Put cycle, so
+ * adding postings costs the same no matter how long the list already is. Partial merges just
+ * concatenate blocks; the full merge (on reads and bottom compactions) decodes everything,
+ * sorts, keeps the newest posting per doc and re-encodes, so readers always see one clean,
+ * strictly increasing list.
+ *
+ * @note The indexer now writes segments (see segment.hpp); this stays so the rocksdb_client
+ *       module can read RocksDB indexes built before them. Header-only on purpose: it must
+ *       register the same operator (by name) to read keys that still carry unmerged operands.
+ */
+class PostingListMergeOperator : public rocksdb::MergeOperator {
+public:
+    bool FullMergeV2(const MergeOperationInput& merge_in, MergeOperationOutput* merge_out) const override {
+        try {
+            std::vector<Posting> postings;
+            if (merge_in.existing_value != nullptr) {
+                append_run(to_view(*merge_in.existing_value), postings);
+            }
+            for (const rocksdb::Slice& operand : merge_in.operand_list) {
+                append_run(to_view(operand), postings);
+            }
+            normalize_postings(postings);
+            merge_out->new_value = encode_postings(postings);
+            return true;
+        } catch (const std::exception&) {
+            return false;  // Surfaces as a Corruption status to the caller
+        }
+    }
+
+    bool PartialMerge(const rocksdb::Slice& /*key*/, const rocksdb::Slice& left_operand,
+                      const rocksdb::Slice& right_operand, std::string* new_value,
+                      rocksdb::Logger* /*logger*/) const override {
+        // Only binary operands can be spliced; anything else waits for a full merge
+        if (!is_binary(left_operand) || !is_binary(right_operand)) return false;
+        new_value->clear();
+        new_value->reserve(left_operand.size() + right_operand.size() - 1);
+        new_value->assign(left_operand.data(), left_operand.size());
+        new_value->append(right_operand.data() + 1, right_operand.size() - 1);
+        return true;
+    }
+
+    const char* Name() const override { return "PostingListMergeOperator"; }
+
+private:
+    static std::string_view to_view(const rocksdb::Slice& slice) {
+        return std::string_view(slice.data(), slice.size());
+    }
+
+    static bool is_binary(const rocksdb::Slice& slice) {
+        return !slice.empty() && static_cast<uint8_t>(slice[0]) == POSTING_FORMAT_VERSION;
+    }
+
+    // Runs are appended in write order; the stable sort in normalize_postings() then lets
+    // later runs override earlier postings for the same doc.
+    static void append_run(std::string_view run, std::vector<Posting>& postings) {
+        std::vector<Posting> decoded = decode_postings(run);
+        postings.insert(postings.end(), decoded.begin(), decoded.end());
+    }
+};
+
+} // namespace indexer
+
+#endif // INDEXER_POSTINGS_HPP
@@ -0,0 +1,273 @@
+#ifndef INDEXER_QUERY_ENGINE_HPP
+#define INDEXER_QUERY_ENGINE_HPP
+
+#include "posting_codec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace indexer {
+
+struct ScoredDoc {
+    uint32_t doc_id;
+    double score;
+};
+
+// Okapi BM25 parameters, matching the values the Python ranker has always used.
+struct Bm25Params {
+    double k1 = 1.5;
+    double b = 0.75;
+};
+
+struct CollectionStats {
+    uint64_t total_docs;  // N
+    double avgdl;         // Average document length in tokens
+};
+
+// IDF(q) = log((N - n + 0.5) / (n + 0.5) + 1)
+inline double bm25_idf(uint64_t total_docs, uint64_t doc_freq) {
+    double N = static_cast<double>(total_docs == 0 ? 1 : total_docs);
+    double n = static_cast<double>(doc_freq);
+    return std::log((N - n + 0.5) / (n + 0.5) + 1.0);
+}
+
+inline double bm25_term_score(double idf, uint32_t tf, double doc_len, double avgdl, const Bm25Params& params) {
+    double norm = params.k1 * (1.0 - params.b + params.b * (doc_len / avgdl));
+    return idf * tf * (params.k1 + 1.0) / (tf + norm);
+}
+
+// Orders results best first; ties go to the lower doc ID so output is deterministic.
+inline bool ranks_before(const ScoredDoc& a, const ScoredDoc& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.doc_id < b.doc_id;
+}
+
+/**
+ * @brief Fixed-size collector that keeps the k best documents seen so far.
+ *
+ * Backed by a min-heap on score, so each insert is O(log k) and memory never grows past k,
+ * regardless of how many candidates are scored.
+ */
+class TopKHeap {
+public:
+    explicit TopKHeap(size_t k) : k_(k) { heap_.reserve(k); }
+
+    // Score a candidate must beat to enter the heap (-inf until the heap is full).
+    double threshold() const {
+        return heap_.size() < k_ ? -std::numeric_limits<double>::infinity() : heap_.front().score;
+    }
+
+    void push(uint32_t doc_id, double score) {
+        if (k_ == 0) return;
+        ScoredDoc doc{doc_id, score};
+        if (heap_.size() < k_) {
+            heap_.push_back(doc);
+            std::push_heap(heap_.begin(), heap_.end(), ranks_before);
+        } else if (ranks_before(doc, heap_.front())) {
+            std::pop_heap(heap_.begin(), heap_.end(), ranks_before);
+            heap_.back() = doc;
+            std::push_heap(heap_.begin(), heap_.end(), ranks_before);
+        }
+    }
+
+    // Drains the heap into a best-first vector.
+    std::vector<ScoredDoc> take_sorted() {
+        std::sort_heap(heap_.begin(), heap_.end(), ranks_before);
+        return std::move(heap_);
+    }
+
+private:
+    size_t k_;
+    std::vector<ScoredDoc> heap_;  // Worst kept document at front()
+};
+
+// Returns the length of a document, or 0 if unknown (the scorer then falls back to avgdl).
+using DocLengthLookup = std::function<uint32_t(uint32_t doc_id)>;
+
+// Work counters filled in by the search functions when requested.
+struct SearchStats {
+    size_t docs_scored = 0;  // Documents fully scored (doc length fetched, all terms summed)
+};
+
+/**
+ * @brief Document-at-a-time BM25 over decoded posting lists.
+ *
+ * Walks all lists in doc-ID order, scores each document once with every term it contains and
+ * keeps the best k in a TopKHeap. Posting lists must be sorted by doc ID (as produced by
+ * decode_postings()). Empty lists are ignored; a term repeated in the query counts twice,
+ * as it always has in the Python ranker.
+ *
+ * @return Up to k results, best first.
+ */
+inline std::vector<ScoredDoc> bm25_search(const std::vector<const std::vector<Posting>*>& term_postings,
+                                          const DocLengthLookup& doc_length, const CollectionStats& stats,
+                                          size_t k, const Bm25Params& params = Bm25Params(),
+                                          SearchStats* search_stats = nullptr) {
+    struct TermCursor {
+        const std::vector<Posting>* postings;
+        size_t pos;
+        double idf;
+    };
+
+    double avgdl = stats.avgdl > 0 ? stats.avgdl : 1.0;
+    std::vector<TermCursor> cursors;
+    for (const std::vector<Posting>* postings : term_postings) {
+        if (postings == nullptr || postings->empty()) continue;
+        cursors.push_back({postings, 0, bm25_idf(stats.total_docs, postings->size())});
+    }
+
+    TopKHeap top_k(k);
+    const uint32_t exhausted = std::numeric_limits<uint32_t>::max();
+    while (true) {
+        uint32_t doc = exhausted;
+        for (const auto& cursor : cursors) {
+            if (cursor.pos < cursor.postings->size()) {
+                doc = std::min(doc, (*cursor.postings)[cursor.pos].doc_id);
+            }
+        }
+        if (doc == exhausted) break;
+
+        uint32_t len = doc_length(doc);
+        double doc_len = len > 0 ? static_cast<double>(len) : avgdl;
+        double score = 0.0;
+        for (auto& cursor : cursors) {
+            if (cursor.pos < cursor.postings->size() && (*cursor.postings)[cursor.pos].doc_id == doc) {
+                score += bm25_term_score(cursor.idf, (*cursor.postings)[cursor.pos].tf, doc_len, avgdl, params);
+                ++cursor.pos;
+            }
+        }
+        top_k.push(doc, score);
+        if (search_stats) ++search_stats->docs_scored;
+    }
+    return top_k.take_sorted();
+}
+
+/**
+ * @brief Highest BM25 contribution any posting in a block can make.
+ *
+ * BM25 grows with tf and shrinks with document length, so the block's max_tf and min_doc_len
+ * (written by the indexer) give a safe bound. The length is also capped at avgdl because
+ * documents with an unknown length are scored as if they had exactly avgdl tokens.
+ */
+inline double bm25_block_bound(double idf, const PostingBlockHeader& block, double avgdl, const Bm25Params& params) {
+    double doc_len = std::min(static_cast<double>(block.min_doc_len), avgdl);
+    // Slack so rounding in a different summation order can never prune an exact tie
+    return bm25_term_score(idf, block.max_tf, doc_len, avgdl, params) * (1.0 + 1e-9);
+}
+
+/**
+ * @brief Block-Max WAND top-k BM25 (Ding & Suel, 2011) over encoded posting lists.
+ *
+ * Returns exactly the same documents and scores as bm25_search(), but only fully scores a
+ * document when the per-term maxima, and then the per-block maxima of the blocks it falls in,
+ * say it could beat the current k-th best score. Everything else is skipped using block
+ * headers alone, which is where mixed rare/common term queries win big.
+ *
+ * @param cursors One cursor per query term (may be exhausted); they are consumed.
+ */
+inline std::vector<ScoredDoc> bm25_search_block_max_wand(std::vector<PostingCursor>& cursors,
+                                                         const DocLengthLookup& doc_length,
+                                                         const CollectionStats& stats, size_t k,
+                                                         const Bm25Params& params = Bm25Params(),
+                                                         SearchStats* search_stats = nullptr) {
+    struct Term {
+        PostingCursor* cursor;
+        double idf;
+        double max_score;  // Bound over the whole list
+    };
+
+    double avgdl = stats.avgdl > 0 ? stats.avgdl : 1.0;
+    std::vector<Term> terms;
+    for (auto& cursor : cursors) {
+        if (cursor.doc() == PostingCursor::END) continue;
+        Term term{&cursor, bm25_idf(stats.total_docs, cursor.doc_freq()), 0.0};
+        cursor.for_each_block([&](const PostingBlockHeader& block) {
+            term.max_score = std::max(term.max_score, bm25_block_bound(term.idf, block, avgdl, params));
+        });
+        terms.push_back(term);
+    }
+
+    TopKHeap top_k(k);
+    if (k == 0) return top_k.take_sorted();
+
+    // Insertion sort: queries have a handful of terms and the order barely changes per step
+    auto sort_by_doc = [&]() {
+        for (size_t i = 1; i < terms.size(); ++i) {
+            Term term = terms[i];
+            uint32_t doc = term.cursor->doc();
+            size_t j = i;
+            for (; j > 0 && terms[j - 1].cursor->doc() > doc; --j) terms[j] = terms[j - 1];
+            terms[j] = term;
+        }
+    };
+    // Among terms[0..last], the one with the largest bound whose cursor is before limit
+    auto pick_term_to_advance = [&](size_t last, uint32_t limit) -> PostingCursor* {
+        Term* best = nullptr;
+        for (size_t i = 0; i <= last; ++i) {
+            if (terms[i].cursor->doc() < limit && (!best || terms[i].max_score > best->max_score)) best = &terms[i];
+        }
+        return best->cursor;
+    };
+
+    while (true) {
+        sort_by_doc();
+        double threshold = top_k.threshold();
+
+        // 1. Pivot: first term where the summed list-wide bounds can beat the threshold
+        size_t pivot = terms.size();
+        double bound = 0.0;
+        for (size_t i = 0; i < terms.size() && terms[i].cursor->doc() != PostingCursor::END; ++i) {
+            bound += terms[i].max_score;
+            if (bound > threshold) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot == terms.size()) break;
+
+        uint32_t pivot_doc = terms[pivot].cursor->doc();
+        while (pivot + 1 < terms.size() && terms[pivot + 1].cursor->doc() == pivot_doc) ++pivot;
+
+        // 2. Refine with the maxima of the blocks that would hold pivot_doc
+        double block_bound = 0.0;
+        uint32_t skip_to = PostingCursor::END;
+        for (size_t i = 0; i <= pivot; ++i) {
+            const PostingBlockHeader* block = terms[i].cursor->block_for(pivot_doc);
+            if (block == nullptr) continue;  // List ends before pivot_doc
+            block_bound += bm25_block_bound(terms[i].idf, *block, avgdl, params);
+            skip_to = std::min(skip_to, block->last_doc == PostingCursor::END ? block->last_doc : block->last_doc + 1);
+        }
+
+        if (block_bound > threshold) {
+            if (terms[0].cursor->doc() == pivot_doc) {
+                // 3a. Every term up to the pivot sits on pivot_doc: score it
+                uint32_t len = doc_length(pivot_doc);
+                double doc_len = len > 0 ? static_cast<double>(len) : avgdl;
+                double score = 0.0;
+                for (size_t i = 0; i <= pivot; ++i) {
+                    score += bm25_term_score(terms[i].idf, terms[i].cursor->tf(), doc_len, avgdl, params);
+                    terms[i].cursor->next();
+                }
+                top_k.push(pivot_doc, score);
+                if (search_stats) ++search_stats->docs_scored;
+            } else {
+                // 3b. Bring a lagging term up to the pivot
+                pick_term_to_advance(pivot, pivot_doc)->next_geq(pivot_doc);
+            }
+        } else {
+            // 3c. Nothing before the end of these blocks (or the next term's doc) can qualify
+            if (pivot + 1 < terms.size()) skip_to = std::min(skip_to, terms[pivot + 1].cursor->doc());
+            if (skip_to <= pivot_doc) skip_to = pivot_doc + 1;
+            pick_term_to_advance(pivot, skip_to)->next_geq(skip_to);
+        }
+    }
+    return top_k.take_sorted();
+}
+
+} // namespace indexer
+
+#endif // INDEXER_QUERY_ENGINE_HPP
@@ -0,0 +1,114 @@
+#include "record_decompressor.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <zstd.h>
+
+namespace indexer {
+
+namespace {
+
+const size_t INITIAL_BUFFER_SIZE = 256 * 1024;
+// Segments rotate, so only a few dictionaries are ever live at once
+const size_t MAX_DICTIONARIES = 8;
+const uint32_t SKIPPABLE_MAGIC = 0x184D2A50;
+
+uint32_t read_le32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return uint32_t(u[0]) | (uint32_t(u[1]) << 8) | (uint32_t(u[2]) << 16) | (uint32_t(u[3]) << 24);
+}
+
+bool is_gzip(std::string_view data) {
+    return data.size() >= 2 && static_cast<unsigned char>(data[0]) == 0x1f &&
+           static_cast<unsigned char>(data[1]) == 0x8b;
+}
+
+bool is_zstd(std::string_view data) {
+    return data.size() >= 4 && read_le32(data.data()) == ZSTD_MAGICNUMBER;
+}
+
+} // namespace
+
+RecordDecompressor::RecordDecompressor() : dctx_(ZSTD_createDCtx()) {
+    if (!dctx_) throw std::runtime_error("ZSTD_createDCtx failed");
+}
+
+RecordDecompressor::~RecordDecompressor() {
+    for (const Dictionary& dictionary : dictionaries_) ZSTD_freeDDict(dictionary.ddict);
+    ZSTD_freeDCtx(dctx_);
+}
+
+std::string_view RecordDecompressor::decompress(std::string_view record, std::string_view file) {
+    if (is_gzip(record)) return gzip_.decompress(record);
+    if (is_zstd(record)) return decompress_zstd(record, file);
+    throw std::runtime_error("Record is neither gzip nor zstd");
+}
+
+std::string_view RecordDecompressor::decompress_zstd(std::string_view record, std::string_view file) {
+    ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_and_parameters);
+    unsigned id = ZSTD_getDictID_fromFrame(record.data(), record.size());
+    if (id != 0) ZSTD_DCtx_refDDict(dctx_, dictionary(id, file));
+
+    // The crawler pledges each record's size, so the buffer rarely has to grow mid-record
+    unsigned long long expected = ZSTD_getFrameContentSize(record.data(), record.size());
+    if (expected != ZSTD_CONTENTSIZE_UNKNOWN && expected != ZSTD_CONTENTSIZE_ERROR) {
+        if (expected > MAX_DECOMPRESSED_SIZE) {
+            throw std::runtime_error("Decompressed data exceeds maximum allowed size");
+        }
+        if (buffer_.size() < expected) buffer_.resize(expected);
+    }
+    if (buffer_.empty()) buffer_.resize(INITIAL_BUFFER_SIZE);
+
+    ZSTD_inBuffer input{record.data(), record.size(), 0};
+    size_t produced = 0;
+    size_t ret;
+    do {
+        if (produced == buffer_.size()) {
+            if (buffer_.size() > MAX_DECOMPRESSED_SIZE) {
+                throw std::runtime_error("Decompressed data exceeds maximum allowed size");
+            }
+            buffer_.resize(std::min(buffer_.size() * 2, MAX_DECOMPRESSED_SIZE + 1));
+        }
+        ZSTD_outBuffer output{&buffer_[0], buffer_.size(), produced};
+        ret = ZSTD_decompressStream(dctx_, &output, &input);
+        if (ZSTD_isError(ret)) {
+            throw std::runtime_error(std::string("zstd decompression failed: ") + ZSTD_getErrorName(ret));
+        }
+        produced = output.pos;
+        if (produced > MAX_DECOMPRESSED_SIZE) {
+            throw std::runtime_error("Decompressed data exceeds maximum allowed size");
+        }
+        if (ret != 0 && input.pos == input.size && produced < buffer_.size()) {
+            throw std::runtime_error("zstd record is truncated");
+        }
+    } while (ret != 0);
+
+    return {buffer_.data(), produced};
+}
+
+ZSTD_DDict* RecordDecompressor::dictionary(unsigned id, std::string_view file) {
+    for (const Dictionary& dictionary : dictionaries_) {
+        if (dictionary.id == id) return dictionary.ddict;
+    }
+
+    // The dictionary is the payload of the skippable frame that starts the file
+    if (file.size() < 8 || read_le32(file.data()) != SKIPPABLE_MAGIC || file.size() - 8 < read_le32(file.data() + 4)) {
+        throw std::runtime_error("zstd record needs dictionary " + std::to_string(id) + " but its file has none");
+    }
+    std::string_view raw = file.substr(8, read_le32(file.data() + 4));
+    if (ZSTD_getDictID_fromDict(raw.data(), raw.size()) != id) {
+        throw std::runtime_error("zstd record needs dictionary " + std::to_string(id) + " but its file holds another");
+    }
+    ZSTD_DDict* ddict = ZSTD_createDDict(raw.data(), raw.size());
+    if (!ddict) throw std::runtime_error("Failed to load zstd dictionary " + std::to_string(id));
+
+    if (dictionaries_.size() == MAX_DICTIONARIES) {
+        ZSTD_freeDDict(dictionaries_.front().ddict);
+        dictionaries_.erase(dictionaries_.begin());
+    }
+    dictionaries_.push_back({id, ddict});
+    return ddict;
+}
+
+} // namespace indexer
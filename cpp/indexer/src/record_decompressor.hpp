@@ -0,0 +1,61 @@
+#ifndef INDEXER_RECORD_DECOMPRESSOR_HPP
+#define INDEXER_RECORD_DECOMPRESSOR_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gzip_decompressor.hpp"
+
+struct ZSTD_DCtx_s;
+struct ZSTD_DDict_s;
+
+namespace indexer {
+
+/**
+ * @brief Decompresses one WARC record, whichever codec the crawler wrote it with.
+ *
+ * The codec is told apart by the record's first bytes: gzip members go to a GzipDecompressor,
+ * zstd frames to a reused zstd context. A zstd record compressed with a dictionary names it by
+ * ID; the dictionary itself is read from the skippable frame at the start of the record's file
+ * the first time that ID is seen and kept (digested) for the records after it.
+ *
+ * @note Not thread-safe; give each thread its own instance.
+ */
+class RecordDecompressor {
+public:
+    RecordDecompressor();
+    ~RecordDecompressor();
+
+    RecordDecompressor(const RecordDecompressor&) = delete;
+    RecordDecompressor& operator=(const RecordDecompressor&) = delete;
+
+    /**
+     * @brief Decompresses one record.
+     * @param record The compressed record.
+     * @param file The whole file the record came from; only its head is read, for a dictionary.
+     * @return A view of the record, valid until the next call on this object.
+     * @throws std::runtime_error on unknown formats, corrupt or truncated input, a missing
+     *         dictionary, or past MAX_DECOMPRESSED_SIZE.
+     */
+    std::string_view decompress(std::string_view record, std::string_view file);
+
+private:
+    struct Dictionary {
+        unsigned id;
+        ZSTD_DDict_s* ddict;
+    };
+
+    std::string_view decompress_zstd(std::string_view record, std::string_view file);
+    ZSTD_DDict_s* dictionary(unsigned id, std::string_view file);
+
+    GzipDecompressor gzip_;
+    ZSTD_DCtx_s* dctx_;
+    std::string buffer_;  // Pooled output for zstd records; only ever grows
+    std::vector<Dictionary> dictionaries_;  // Most recently loaded last
+};
+
+} // namespace indexer
+
+#endif // INDEXER_RECORD_DECOMPRESSOR_HPP
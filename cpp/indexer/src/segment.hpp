@@ -0,0 +1,529 @@
+#ifndef INDEXER_SEGMENT_HPP
+#define INDEXER_SEGMENT_HPP
+
+#include "posting_codec.hpp"
+#include "term_dictionary.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace indexer {
+
+/*
+ * Index segment file format (version 2)
+ *
+ *   segment        := header postings doc_table terms block_index postings_index doc_freqs footer
+ *   header         := "IGISEG" version:u8 0:u8
+ *   postings       := posting_list{term_count}  one encode_postings() value per term, in term ID order
+ *   doc_table      := (doc_id:u32 doc_length:u32){doc_count}               sorted by doc_id
+ *   terms          := block{...}                 front-coded term blocks (see term_dictionary.hpp)
+ *   block_index    := block_offset:u32{ceil(term_count / TERM_BLOCK_SIZE)}
+ *   postings_index := postings_offset:u64{term_count + 1}    file offsets; the last one ends postings
+ *   doc_freqs      := doc_freq:u32{term_count}
+ *   footer         := doc_table_offset:u64 terms_offset:u64 block_index_offset:u64
+ *                     postings_index_offset:u64 doc_freqs_offset:u64 total_doc_length:u64
+ *                     term_count:u32 doc_count:u32 header
+ *
+ * Fixed-width integers are little-endian. Terms are identified by their rank in the segment's
+ * sorted dictionary (a dense term ID), which indexes the fixed-width postings_index and
+ * doc_freqs tables directly; document frequencies and collection stats never touch postings.
+ * Version 1 (a varint dictionary parsed at open) is no longer read. Segments are written once
+ * (to a temporary name, then renamed) and never modified; the indexer replaces them wholesale
+ * when it merges.
+ *
+ * An index is a directory of segments plus a manifest, "segments", listing the live ones oldest
+ * first under a generation number that grows with every change. It also records when it was
+ * published (Unix epoch milliseconds) and how many documents the indexer had flushed by then,
+ * re-indexed ones included, so readers can tell how far behind the newest generation they are:
+ *
+ *   generation 7
+ *   published_ms 1760600000000
+ *   docs_flushed 84000
+ *   seg_00000004.seg
+ *   seg_00000006.seg
+ *
+ * The same document may appear in several segments when it was re-indexed; the newest segment
+ * holding it wins. Its length comes from that segment, and its postings in older segments are
+ * superseded (see superseded_docs()): readers skip them, so a term the new version dropped no
+ * longer matches, and merges drop them for good.
+ *
+ * Header-only so the rocksdb_client Python module can read segments without linking the indexer.
+ */
+
+constexpr char SEGMENT_MAGIC[] = "IGISEG";
+constexpr size_t SEGMENT_MAGIC_SIZE = sizeof(SEGMENT_MAGIC) - 1;
+constexpr uint8_t SEGMENT_FORMAT_VERSION = 2;
+constexpr size_t SEGMENT_HEADER_SIZE = SEGMENT_MAGIC_SIZE + 2;
+constexpr size_t SEGMENT_FOOTER_SIZE = 6 * 8 + 2 * 4 + SEGMENT_HEADER_SIZE;
+constexpr size_t SEGMENT_DOC_ENTRY_SIZE = 8;
+constexpr char SEGMENT_MANIFEST_NAME[] = "segments";
+
+inline std::string segment_header() {
+    std::string header(SEGMENT_MAGIC, SEGMENT_MAGIC_SIZE);
+    header.push_back(static_cast<char>(SEGMENT_FORMAT_VERSION));
+    header.push_back('\0');
+    return header;
+}
+
+/**
+ * @brief One immutable index segment, mmap'ed read-only.
+ *
+ * Opening only reads the footer; the term dictionary, its offset and doc freq tables, posting
+ * lists and the doc table are all read straight from the mapping, so opening costs the same
+ * whatever the vocabulary size. Unmapped when the last reference goes away, so a segment stays
+ * readable after a merge has deleted its file.
+ *
+ * @note Thread-safe: all accessors are const.
+ */
+class Segment {
+public:
+    // @throws std::runtime_error if the file cannot be mapped or is not a valid segment.
+    explicit Segment(const std::string& path) : path_(path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open segment: " + path + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("Could not stat segment: " + path + ": " + std::strerror(err));
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ < SEGMENT_HEADER_SIZE + SEGMENT_FOOTER_SIZE) {
+            ::close(fd);
+            throw std::runtime_error("Segment too short: " + path);
+        }
+        addr_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        int err = errno;
+        ::close(fd);  // The mapping keeps the file referenced
+        if (addr_ == MAP_FAILED) {
+            addr_ = nullptr;
+            throw std::runtime_error("Could not mmap segment: " + path + ": " + std::strerror(err));
+        }
+        madvise(addr_, size_, MADV_RANDOM);
+        try {
+            parse();
+        } catch (...) {
+            munmap(addr_, size_);
+            throw;
+        }
+    }
+
+    ~Segment() {
+        if (addr_) munmap(addr_, size_);
+    }
+
+    Segment(const Segment&) = delete;
+    Segment& operator=(const Segment&) = delete;
+
+    const std::string& path() const { return path_; }
+    size_t size_bytes() const { return size_; }
+    size_t term_count() const { return terms_.size(); }
+    size_t doc_count() const { return doc_count_; }
+    uint64_t total_doc_length() const { return total_doc_length_; }
+    // Documents in the doc table with length 0: indexed with no tokens, so they match nothing.
+    size_t empty_doc_count() const { return empty_doc_count_; }
+
+    // The sorted vocabulary; term IDs below are ranks in it.
+    const TermDictionary& terms() const { return terms_; }
+
+    // ID of term, or NO_TERM if the segment does not contain it.
+    uint32_t term_id(std::string_view term) const { return terms_.find(term); }
+
+    uint32_t doc_freq(uint32_t term_id) const { return get_fixed32(doc_freqs_ + term_id * 4); }
+
+    // @throws std::runtime_error if the postings index is corrupt at term_id.
+    std::string_view postings_by_id(uint32_t term_id) const {
+        uint64_t begin = get_fixed64(postings_index_ + term_id * 8);
+        uint64_t end = get_fixed64(postings_index_ + (term_id + 1) * 8);
+        if (begin > end || end > doc_table_offset_) throw std::runtime_error("Corrupt postings index: " + path_);
+        return data().substr(begin, end - begin);
+    }
+
+    // Encoded posting list of term, or an empty view if the segment does not contain it.
+    std::string_view postings(std::string_view term) const {
+        uint32_t id = term_id(term);
+        return id == NO_TERM ? std::string_view() : postings_by_id(id);
+    }
+
+    // Document i of the doc table, in doc ID order.
+    uint32_t doc_id_at(size_t i) const { return get_fixed32(doc_table_ + i * SEGMENT_DOC_ENTRY_SIZE); }
+    uint32_t doc_length_at(size_t i) const { return get_fixed32(doc_table_ + i * SEGMENT_DOC_ENTRY_SIZE + 4); }
+
+    // Length of doc_id, or 0 if the segment does not hold it.
+    uint32_t doc_length(uint32_t doc_id) const {
+        size_t i = doc_index(doc_id);
+        return i < doc_count_ ? doc_length_at(i) : 0;
+    }
+
+    bool holds_doc(uint32_t doc_id) const { return doc_index(doc_id) < doc_count_; }
+
+private:
+    std::string_view data() const { return {static_cast<const char*>(addr_), size_}; }
+
+    // Position of doc_id in the doc table, or doc_count_ if the segment does not hold it.
+    size_t doc_index(uint32_t doc_id) const {
+        size_t lo = 0, hi = doc_count_;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (doc_id_at(mid) < doc_id) lo = mid + 1; else hi = mid;
+        }
+        return lo < doc_count_ && doc_id_at(lo) == doc_id ? lo : doc_count_;
+    }
+
+    void parse() {
+        std::string_view file = data();
+        std::string header = segment_header();
+        const char* footer = file.data() + size_ - SEGMENT_FOOTER_SIZE;
+        if (file.substr(0, SEGMENT_HEADER_SIZE) != header ||
+            file.substr(size_ - SEGMENT_HEADER_SIZE) != header) {
+            throw std::runtime_error("Not a segment, or an unsupported version: " + path_);
+        }
+        doc_table_offset_ = get_fixed64(footer);
+        uint64_t terms_offset = get_fixed64(footer + 8);
+        uint64_t block_index_offset = get_fixed64(footer + 16);
+        uint64_t postings_index_offset = get_fixed64(footer + 24);
+        uint64_t doc_freqs_offset = get_fixed64(footer + 32);
+        total_doc_length_ = get_fixed64(footer + 40);
+        uint32_t term_count = get_fixed32(footer + 48);
+        doc_count_ = get_fixed32(footer + 52);
+        uint64_t footer_offset = size_ - SEGMENT_FOOTER_SIZE;
+        if (doc_table_offset_ < SEGMENT_HEADER_SIZE || terms_offset < doc_table_offset_ ||
+            block_index_offset < terms_offset || postings_index_offset < block_index_offset ||
+            doc_freqs_offset < postings_index_offset || footer_offset < doc_freqs_offset ||
+            terms_offset - doc_table_offset_ != uint64_t(doc_count_) * SEGMENT_DOC_ENTRY_SIZE ||
+            doc_freqs_offset - postings_index_offset != (uint64_t(term_count) + 1) * 8 ||
+            footer_offset - doc_freqs_offset != uint64_t(term_count) * 4) {
+            throw std::runtime_error("Corrupt segment footer: " + path_);
+        }
+        doc_table_ = file.data() + doc_table_offset_;
+        postings_index_ = file.data() + postings_index_offset;
+        doc_freqs_ = file.data() + doc_freqs_offset;
+        try {
+            terms_ = TermDictionary(file.substr(terms_offset, block_index_offset - terms_offset),
+                                    file.substr(block_index_offset, postings_index_offset - block_index_offset),
+                                    term_count);
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(std::string(e.what()) + ": " + path_);
+        }
+        if (get_fixed64(postings_index_) != SEGMENT_HEADER_SIZE ||
+            get_fixed64(postings_index_ + uint64_t(term_count) * 8) != doc_table_offset_) {
+            throw std::runtime_error("Segment postings index does not match its postings: " + path_);
+        }
+        for (size_t i = 0; i < doc_count_; ++i) empty_doc_count_ += doc_length_at(i) == 0;
+    }
+
+    std::string path_;
+    void* addr_ = nullptr;
+    size_t size_ = 0;
+    uint64_t doc_table_offset_ = 0;
+    const char* doc_table_ = nullptr;
+    const char* postings_index_ = nullptr;
+    const char* doc_freqs_ = nullptr;
+    size_t doc_count_ = 0;
+    size_t empty_doc_count_ = 0;
+    uint64_t total_doc_length_ = 0;
+    TermDictionary terms_;
+};
+
+/**
+ * @brief For each of segments (oldest first), the sorted IDs of its documents that a newer one
+ *        also holds: documents re-indexed since, whose postings in that segment are stale.
+ *
+ * Documents are normally indexed once, so this walks the smaller doc table of each pair of
+ * segments whose doc ID ranges overlap, probing the larger one.
+ */
+inline std::vector<std::vector<uint32_t>> superseded_docs(const std::vector<std::shared_ptr<const Segment>>& segments) {
+    std::vector<std::vector<uint32_t>> superseded(segments.size());
+    for (size_t older = 0; older < segments.size(); ++older) {
+        const Segment& old_segment = *segments[older];
+        if (old_segment.doc_count() == 0) continue;
+        for (size_t newer = older + 1; newer < segments.size(); ++newer) {
+            const Segment& new_segment = *segments[newer];
+            if (new_segment.doc_count() == 0 ||
+                new_segment.doc_id_at(0) > old_segment.doc_id_at(old_segment.doc_count() - 1) ||
+                new_segment.doc_id_at(new_segment.doc_count() - 1) < old_segment.doc_id_at(0)) {
+                continue;
+            }
+            bool walk_new = new_segment.doc_count() <= old_segment.doc_count();
+            const Segment& walked = walk_new ? new_segment : old_segment;
+            const Segment& probed = walk_new ? old_segment : new_segment;
+            for (size_t i = 0; i < walked.doc_count(); ++i) {
+                uint32_t doc_id = walked.doc_id_at(i);
+                if (probed.holds_doc(doc_id)) superseded[older].push_back(doc_id);
+            }
+        }
+        std::sort(superseded[older].begin(), superseded[older].end());
+        superseded[older].erase(std::unique(superseded[older].begin(), superseded[older].end()), superseded[older].end());
+    }
+    return superseded;
+}
+
+// Removes postings[from..] whose doc is in superseded (sorted), keeping the rest in order.
+inline void drop_superseded(std::vector<Posting>& postings, size_t from, const std::vector<uint32_t>& superseded) {
+    if (superseded.empty()) return;
+    postings.erase(std::remove_if(postings.begin() + static_cast<std::ptrdiff_t>(from), postings.end(),
+                                  [&superseded](const Posting& posting) {
+                                      return std::binary_search(superseded.begin(), superseded.end(), posting.doc_id);
+                                  }),
+                   postings.end());
+}
+
+// The live segments of an index directory, as listed by its manifest.
+struct SegmentManifest {
+    uint64_t generation = 0;             // 0 when the directory has no manifest yet
+    uint64_t published_ms = 0;           // 0 for manifests written before it was recorded
+    uint64_t docs_flushed = 0;
+    std::vector<std::string> segments;   // File names, oldest first
+};
+
+/**
+ * @brief Reads dir's manifest. A missing manifest is an empty index.
+ * @throws std::runtime_error if the manifest is malformed.
+ */
+inline SegmentManifest read_manifest(const std::string& dir) {
+    SegmentManifest manifest;
+    std::ifstream in(dir + "/" + SEGMENT_MANIFEST_NAME);
+    if (!in) return manifest;
+    std::string keyword;
+    if (!(in >> keyword >> manifest.generation) || keyword != "generation") {
+        throw std::runtime_error("Malformed segment manifest in " + dir);
+    }
+    std::string name;
+    while (in >> name) {
+        if (name == "published_ms" || name == "docs_flushed") {
+            uint64_t& field = name == "published_ms" ? manifest.published_ms : manifest.docs_flushed;
+            if (!(in >> field)) throw std::runtime_error("Malformed segment manifest in " + dir);
+        } else {
+            manifest.segments.push_back(name);
+        }
+    }
+    return manifest;
+}
+
+/**
+ * @brief A fixed set of segments to search: one generation of an index directory.
+ *
+ * Segments are shared_ptrs, so a snapshot keeps reading the same files even after the indexer
+ * has merged them away. Readers look terms up in every segment and combine the results,
+ * letting newer segments win for documents that appear more than once: the postings of a
+ * superseded document are skipped in every older segment.
+ */
+class IndexSnapshot {
+public:
+    IndexSnapshot() = default;
+    IndexSnapshot(uint64_t generation, std::vector<std::shared_ptr<const Segment>> segments,
+                  uint64_t published_ms = 0, uint64_t docs_flushed = 0)
+        : generation_(generation), published_ms_(published_ms), docs_flushed_(docs_flushed),
+          segments_(std::move(segments)), superseded_(superseded_docs(segments_)) {
+        for (size_t s = 0; s < segments_.size(); ++s) {
+            for (uint32_t doc_id : superseded_[s]) {
+                uint32_t length = segments_[s]->doc_length(doc_id);
+                superseded_count_ += length > 0;  // Empty ones are already left out, see doc_count()
+                superseded_length_ += length;
+            }
+        }
+    }
+
+    uint64_t generation() const { return generation_; }
+    // From the manifest this snapshot was opened from (see SegmentManifest).
+    uint64_t published_ms() const { return published_ms_; }
+    uint64_t docs_flushed() const { return docs_flushed_; }
+    const std::vector<std::shared_ptr<const Segment>>& segments() const { return segments_; }
+
+    /**
+     * @brief The term's posting list across all segments, as one encoded value.
+     *
+     * A term held by a single segment is returned as a view into it; otherwise the segments'
+     * lists are concatenated into scratch, oldest first, which PostingCursor and
+     * decode_postings() resolve so the newest posting per doc wins. A list holding superseded
+     * documents is decoded, filtered and re-encoded into scratch instead. Empty if no segment
+     * has a live posting for it.
+     */
+    std::string_view postings(std::string_view term, std::string& scratch) const {
+        std::string_view first;
+        scratch.clear();
+        std::vector<Posting> decoded;  // Everything so far, once a list had to be decoded
+        bool decoding = false;
+        for (size_t s = 0; s < segments_.size(); ++s) {
+            std::string_view list = segments_[s]->postings(term);
+            if (list.empty()) continue;
+            if (!decoding && superseded_[s].empty()) {
+                if (first.empty()) {
+                    first = list;
+                    continue;
+                }
+                if (scratch.empty()) scratch.assign(first);
+                if (list[0] == scratch[0]) {
+                    scratch.append(list.data() + 1, list.size() - 1);
+                    continue;
+                }
+                // Runs of different versions cannot be spliced
+            }
+            if (!decoding) {
+                decode_postings(scratch.empty() ? first : std::string_view(scratch), decoded);
+                decoding = true;
+            }
+            size_t from = decoded.size();
+            decode_postings(list, decoded);
+            drop_superseded(decoded, from, superseded_[s]);
+        }
+        if (!decoding) return scratch.empty() ? first : std::string_view(scratch);
+        if (decoded.empty()) return {};
+        normalize_postings(decoded);
+        scratch = encode_postings(decoded);
+        return scratch;
+    }
+
+    // Length of doc_id in the newest segment holding it, or 0 if none does.
+    uint32_t doc_length(uint32_t doc_id) const {
+        for (auto it = segments_.rbegin(); it != segments_.rend(); ++it) {
+            if ((*it)->holds_doc(doc_id)) return (*it)->doc_length(doc_id);
+        }
+        return 0;
+    }
+
+    /*
+     * Dictionary and collection statistics, read from the term dictionaries and footers. Document
+     * frequencies sum over segments, so a document re-indexed into a newer segment counts once per
+     * segment holding the term until those segments are merged; doc_count() and
+     * total_doc_length() leave superseded documents out. doc_count() also leaves out documents
+     * with no tokens, as the doc length table does (see DocLengthTable), so BM25 sees the same N
+     * whichever of the two with_doc_lengths() reads.
+     */
+
+    uint64_t doc_freq(std::string_view term) const {
+        uint64_t total = 0;
+        for (const auto& segment : segments_) {
+            uint32_t id = segment->term_id(term);
+            if (id != NO_TERM) total += segment->doc_freq(id);
+        }
+        return total;
+    }
+
+    uint64_t doc_count() const {
+        uint64_t total = 0;
+        for (const auto& segment : segments_) total += segment->doc_count() - segment->empty_doc_count();
+        return total - superseded_count_;
+    }
+
+    uint64_t total_doc_length() const {
+        uint64_t total = 0;
+        for (const auto& segment : segments_) total += segment->total_doc_length();
+        return total - superseded_length_;
+    }
+
+    /**
+     * @brief Calls fn(term, doc_freq) for each distinct term in [low, high) across segments, in
+     *        order, until fn returns false. An empty high means no upper bound.
+     */
+    template <typename Fn>
+    void for_each_term(std::string_view low, std::string_view high, Fn&& fn) const {
+        struct Source {
+            const Segment* segment;
+            TermDictionary::Iterator it;
+            uint32_t end;
+        };
+        std::vector<Source> sources;
+        for (const auto& segment : segments_) {
+            auto [first, last] = segment->terms().range(low, high);
+            if (first < last) sources.push_back({segment.get(), segment->terms().seek(first), last});
+        }
+        std::string term;
+        while (!sources.empty()) {
+            // Segments are few, so a linear scan for the smallest term beats keeping a heap
+            term.assign(sources[0].it.term());
+            for (const auto& source : sources) {
+                if (source.it.term() < term) term.assign(source.it.term());
+            }
+            uint64_t doc_freq = 0;
+            for (size_t i = 0; i < sources.size();) {
+                Source& source = sources[i];
+                if (source.it.term() == term) {
+                    doc_freq += source.segment->doc_freq(source.it.id());
+                    source.it.next();
+                    if (source.it.id() >= source.end) {
+                        sources.erase(sources.begin() + static_cast<std::ptrdiff_t>(i));
+                        continue;
+                    }
+                }
+                ++i;
+            }
+            if (!fn(std::string_view(term), doc_freq)) return;
+        }
+    }
+
+    // Up to limit distinct terms starting with prefix, in order, with their doc freqs.
+    std::vector<std::pair<std::string, uint64_t>> terms_with_prefix(std::string_view prefix, size_t limit) const {
+        std::vector<std::pair<std::string, uint64_t>> terms;
+        if (limit == 0) return terms;
+        for_each_term(prefix, TermDictionary::prefix_successor(prefix), [&](std::string_view term, uint64_t df) {
+            terms.emplace_back(term, df);
+            return terms.size() < limit;
+        });
+        return terms;
+    }
+
+private:
+    uint64_t generation_ = 0;
+    uint64_t published_ms_ = 0;
+    uint64_t docs_flushed_ = 0;
+    std::vector<std::shared_ptr<const Segment>> segments_;
+    std::vector<std::vector<uint32_t>> superseded_;  // Per segment, see superseded_docs()
+    uint64_t superseded_count_ = 0;
+    uint64_t superseded_length_ = 0;
+};
+
+/**
+ * @brief Opens the segments dir's manifest currently lists.
+ *
+ * A merge can delete a listed segment between reading the manifest and opening it; the
+ * manifest is then simply read again. Segments previous already has open are shared rather
+ * than mapped again, so refreshing a snapshot only opens what was flushed or merged since.
+ *
+ * @throws std::runtime_error if a segment is unreadable or keeps disappearing.
+ */
+inline IndexSnapshot open_index_snapshot(const std::string& dir, const IndexSnapshot* previous = nullptr) {
+    for (int attempt = 0;; ++attempt) {
+        SegmentManifest manifest = read_manifest(dir);
+        std::vector<std::shared_ptr<const Segment>> segments;
+        try {
+            for (const auto& name : manifest.segments) {
+                std::string path = dir + "/" + name;
+                std::shared_ptr<const Segment> segment;
+                if (previous) {
+                    for (const auto& open : previous->segments()) {
+                        if (open->path() == path) segment = open;
+                    }
+                }
+                segments.push_back(segment ? segment : std::make_shared<const Segment>(path));
+            }
+        } catch (const std::runtime_error&) {
+            bool vanished = false;
+            for (const auto& name : manifest.segments) {
+                vanished = vanished || ::access((dir + "/" + name).c_str(), F_OK) != 0;
+            }
+            if (!vanished || attempt >= 4) throw;
+            continue;
+        }
+        return IndexSnapshot(manifest.generation, std::move(segments), manifest.published_ms, manifest.docs_flushed);
+    }
+}
+
+} // namespace indexer
+
+#endif // INDEXER_SEGMENT_HPP
@@ -0,0 +1,697 @@
+#include "segment_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace indexer {
+
+namespace {
+
+// Rough heap cost of one distinct term in SegmentBuilder beyond its characters: the hash node
+// (key string, posting vector, next pointer, cached hash) plus its bucket slot.
+constexpr size_t TERM_OVERHEAD_BYTES = 96;
+// Same for one document in SegmentBuilder's doc ID set.
+constexpr size_t DOC_OVERHEAD_BYTES = 32;
+
+// Smallest growth step of the doc length table, in doc IDs (256 KB)
+constexpr size_t DOC_LENGTH_MIN_GROWTH = 1 << 16;
+
+constexpr char SEGMENT_PREFIX[] = "seg_";
+constexpr char SEGMENT_SUFFIX[] = ".seg";
+
+std::string filename_of(const std::string& path) {
+    return std::filesystem::path(path).filename().string();
+}
+
+// Flushes a file (or directory entry) to disk, so a rename that follows is durable.
+void sync_path(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("Could not open " + path + " to sync: " + std::strerror(errno));
+    int result = fsync(fd);
+    int err = errno;
+    ::close(fd);
+    if (result != 0) throw std::runtime_error("fsync failed for " + path + ": " + std::strerror(err));
+}
+
+/**
+ * Streams one segment file. Posting lists go straight to disk in term order; the doc table and
+ * the term dictionary with its tables are buffered and written by finish(), which then renames
+ * the file into place.
+ * Destroying an unfinished writer removes its temporary file.
+ */
+class SegmentFileWriter {
+public:
+    explicit SegmentFileWriter(const std::string& path)
+        : path_(path), tmp_path_(path + ".tmp"), out_(tmp_path_, std::ios::binary | std::ios::trunc) {
+        if (!out_) throw std::runtime_error("Failed to open segment file: " + tmp_path_);
+        std::string header = segment_header();
+        out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+        offset_ = header.size();
+    }
+
+    ~SegmentFileWriter() {
+        if (!finished_) {
+            out_.close();
+            std::remove(tmp_path_.c_str());
+        }
+    }
+
+    // Terms must come in strictly increasing order.
+    void add_term(std::string_view term, uint32_t doc_freq, std::string_view postings) {
+        terms_.add(term);
+        put_fixed64(postings_index_, offset_);
+        put_fixed32(doc_freqs_, doc_freq);
+        out_.write(postings.data(), static_cast<std::streamsize>(postings.size()));
+        offset_ += postings.size();
+    }
+
+    // Docs must come in strictly increasing doc ID order.
+    void add_doc(uint32_t doc_id, uint32_t doc_length) {
+        put_fixed32(doc_table_, doc_id);
+        put_fixed32(doc_table_, doc_length);
+        total_doc_length_ += doc_length;
+        ++doc_count_;
+    }
+
+    void finish() {
+        put_fixed64(postings_index_, offset_);  // End of the last posting list
+        const std::string* tables[] = {&doc_table_, &terms_.blocks(), &terms_.block_index(), &postings_index_,
+                                       &doc_freqs_};
+        std::string footer;
+        uint64_t table_offset = offset_;
+        for (const std::string* table : tables) {
+            put_fixed64(footer, table_offset);
+            table_offset += table->size();
+        }
+        put_fixed64(footer, total_doc_length_);
+        put_fixed32(footer, terms_.size());
+        put_fixed32(footer, doc_count_);
+        footer += segment_header();
+        for (const std::string* table : tables) out_.write(table->data(), static_cast<std::streamsize>(table->size()));
+        out_.write(footer.data(), static_cast<std::streamsize>(footer.size()));
+        out_.flush();
+        if (!out_) throw std::runtime_error("Failed to write segment file: " + tmp_path_);
+        out_.close();
+        sync_path(tmp_path_);
+        std::filesystem::rename(tmp_path_, path_);  // Never visible half-written
+        finished_ = true;
+    }
+
+private:
+    std::string path_;
+    std::string tmp_path_;
+    std::ofstream out_;
+    uint64_t offset_ = 0;
+    std::string doc_table_;
+    TermDictionaryBuilder terms_;
+    std::string postings_index_;
+    std::string doc_freqs_;
+    uint64_t total_doc_length_ = 0;
+    uint32_t doc_count_ = 0;
+    bool finished_ = false;
+};
+
+// Sorts (doc_id, length) pairs by doc ID, keeping the last entry added for each doc.
+void normalize_doc_lengths(std::vector<std::pair<uint32_t, uint32_t>>& docs) {
+    std::stable_sort(docs.begin(), docs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    size_t out = 0;
+    for (size_t i = 0; i < docs.size(); ++i) {
+        if (out > 0 && docs[out - 1].first == docs[i].first) {
+            docs[out - 1] = docs[i];
+        } else {
+            docs[out++] = docs[i];
+        }
+    }
+    docs.resize(out);
+}
+
+const std::string& encode_with_version(const std::vector<Posting>& postings, std::string& out) {
+    out.clear();
+    out.push_back(static_cast<char>(POSTING_FORMAT_VERSION));
+    encode_posting_blocks(postings, out);
+    return out;
+}
+
+} // namespace
+
+void SegmentBuilder::add_document(uint32_t doc_id, uint32_t doc_length,
+                                  const std::vector<std::pair<std::string, uint32_t>>& term_freqs) {
+    if (doc_ids_.insert(doc_id).second) {
+        ram_bytes_ += DOC_OVERHEAD_BYTES;
+    } else {
+        // Re-indexed before the flush: remember which terms the new version still has
+        std::unordered_set<std::string>& terms = reindexed_terms_[doc_id];
+        terms.clear();
+        for (const auto& term_freq : term_freqs) {
+            terms.insert(term_freq.first);
+            ram_bytes_ += term_freq.first.size() + TERM_OVERHEAD_BYTES;
+        }
+    }
+    for (const auto& [term, tf] : term_freqs) {
+        auto [it, inserted] = postings_.try_emplace(term);
+        if (inserted) ram_bytes_ += term.size() + TERM_OVERHEAD_BYTES;
+        std::vector<Posting>& list = it->second;
+        size_t capacity = list.capacity();
+        // The doc length feeds the block-max score bounds used for query pruning
+        list.push_back({doc_id, tf, doc_length});
+        ram_bytes_ += (list.capacity() - capacity) * sizeof(Posting);
+    }
+    size_t capacity = doc_lengths_.capacity();
+    doc_lengths_.emplace_back(doc_id, doc_length);
+    ram_bytes_ += (doc_lengths_.capacity() - capacity) * sizeof(doc_lengths_[0]);
+}
+
+void SegmentBuilder::write(const std::string& path) {
+    write_file(path);
+    clear();
+}
+
+void SegmentBuilder::write_file(const std::string& path) {
+    std::vector<std::pair<const std::string, std::vector<Posting>>*> terms;
+    terms.reserve(postings_.size());
+    for (auto& entry : postings_) terms.push_back(&entry);
+    std::sort(terms.begin(), terms.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    SegmentFileWriter out(path);
+    std::string encoded;
+    for (auto* entry : terms) {
+        std::vector<Posting>& list = entry->second;
+        normalize_postings(list);  // Docs can arrive out of order or twice
+        if (!reindexed_terms_.empty()) {
+            // A doc's last version wins outright: drop postings for terms it no longer has
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [&](const Posting& posting) {
+                                          auto it = reindexed_terms_.find(posting.doc_id);
+                                          return it != reindexed_terms_.end() && !it->second.count(entry->first);
+                                      }),
+                       list.end());
+            if (list.empty()) continue;
+        }
+        out.add_term(entry->first, static_cast<uint32_t>(list.size()), encode_with_version(list, encoded));
+    }
+    normalize_doc_lengths(doc_lengths_);
+    for (const auto& [doc_id, length] : doc_lengths_) out.add_doc(doc_id, length);
+    out.finish();
+}
+
+void SegmentBuilder::clear() {
+    postings_.clear();
+    doc_lengths_.clear();
+    doc_ids_.clear();
+    reindexed_terms_.clear();
+    ram_bytes_ = 0;
+}
+
+void merge_segments(const std::vector<std::shared_ptr<const Segment>>& segments, const std::string& path) {
+    SegmentFileWriter out(path);
+
+    // Doc table first: postings rebuilt below take exact lengths from it for their block bounds
+    std::vector<std::pair<uint32_t, uint32_t>> docs;
+    for (const auto& segment : segments) {
+        for (size_t i = 0; i < segment->doc_count(); ++i) docs.emplace_back(segment->doc_id_at(i), segment->doc_length_at(i));
+    }
+    normalize_doc_lengths(docs);
+    auto doc_length = [&docs](uint32_t doc_id) {
+        auto it = std::lower_bound(docs.begin(), docs.end(), std::make_pair(doc_id, uint32_t(0)));
+        return it != docs.end() && it->first == doc_id ? it->second : 0;
+    };
+
+    // Postings of documents a newer input re-indexed are dropped, so terms the new version lost go
+    std::vector<std::vector<uint32_t>> superseded = superseded_docs(segments);
+
+    // K-way merge over the sorted dictionaries, one iterator per segment; ties pop oldest first
+    std::vector<TermDictionary::Iterator> cursors;
+    for (const auto& segment : segments) cursors.push_back(segment->terms().begin());
+    auto later = [&cursors](size_t a, size_t b) {
+        std::string_view term_a = cursors[a].term(), term_b = cursors[b].term();
+        return term_a != term_b ? term_a > term_b : a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+    for (size_t s = 0; s < segments.size(); ++s) {
+        if (cursors[s].valid()) heap.push(s);
+    }
+
+    std::vector<size_t> group;
+    std::string term;
+    std::vector<Posting> postings;
+    std::string encoded;
+    while (!heap.empty()) {
+        term.assign(cursors[heap.top()].term());
+        group.clear();
+        while (!heap.empty() && cursors[heap.top()].term() == term) {
+            group.push_back(heap.top());
+            heap.pop();
+        }
+
+        if (group.size() == 1 && superseded[group[0]].empty()) {
+            const Segment& segment = *segments[group[0]];
+            uint32_t id = cursors[group[0]].id();
+            out.add_term(term, segment.doc_freq(id), segment.postings_by_id(id));
+        } else {
+            postings.clear();
+            for (size_t s : group) {
+                size_t from = postings.size();
+                decode_postings(segments[s]->postings_by_id(cursors[s].id()), postings);
+                drop_superseded(postings, from, superseded[s]);
+            }
+            normalize_postings(postings);  // Stable, so the newest segment's posting wins
+            for (Posting& posting : postings) posting.doc_len_floor = doc_length(posting.doc_id);
+            if (!postings.empty()) {
+                out.add_term(term, static_cast<uint32_t>(postings.size()), encode_with_version(postings, encoded));
+            }
+        }
+
+        for (size_t s : group) {
+            cursors[s].next();
+            if (cursors[s].valid()) heap.push(s);
+        }
+    }
+
+    for (const auto& [doc_id, length] : docs) out.add_doc(doc_id, length);
+    out.finish();
+}
+
+DocLengthTableWriter::DocLengthTableWriter(std::string path) : path_(std::move(path)) {
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0) return;  // rebuild() creates it
+    try {
+        map_file();
+    } catch (const std::exception& e) {
+        std::cerr << "Ignoring unreadable doc length table, it will be rebuilt: " << e.what() << std::endl;
+        unmap_file();
+    }
+}
+
+DocLengthTableWriter::~DocLengthTableWriter() {
+    unmap_file();
+}
+
+uint64_t DocLengthTableWriter::generation() const {
+    return addr_ ? load_header(DOC_LENGTH_GENERATION_OFFSET) : NO_GENERATION;
+}
+
+uint64_t DocLengthTableWriter::doc_count() const {
+    return addr_ ? load_header(DOC_LENGTH_COUNT_OFFSET) : 0;
+}
+
+uint64_t DocLengthTableWriter::total_doc_length() const {
+    return addr_ ? load_header(DOC_LENGTH_TOTAL_OFFSET) : 0;
+}
+
+void DocLengthTableWriter::update(const std::vector<std::pair<uint32_t, uint32_t>>& docs) {
+    if (!addr_) throw std::runtime_error("No doc length table to update: " + path_);
+    uint32_t max_doc = 0;
+    for (const auto& doc : docs) max_doc = std::max(max_doc, doc.first);
+    if (!docs.empty() && max_doc >= capacity()) {
+        grow(std::max({static_cast<size_t>(max_doc) + 1, capacity() * 2, DOC_LENGTH_MIN_GROWTH}));
+    }
+
+    // Readers trust the lengths only while the generation they checked stays put (see DocLengthTable)
+    store_header(DOC_LENGTH_GENERATION_OFFSET, NO_GENERATION);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    uint64_t doc_count = load_header(DOC_LENGTH_COUNT_OFFSET);
+    uint64_t total = load_header(DOC_LENGTH_TOTAL_OFFSET);
+    uint32_t* lengths = this->lengths();
+    for (const auto& [doc_id, length] : docs) {
+        uint32_t old = lengths[doc_id];
+        if (old == 0 && length > 0) ++doc_count;
+        if (old > 0 && length == 0) --doc_count;
+        total = total - old + length;
+        __atomic_store_n(lengths + doc_id, length, __ATOMIC_RELAXED);  // Readers map the file concurrently
+    }
+    store_header(DOC_LENGTH_COUNT_OFFSET, doc_count);
+    store_header(DOC_LENGTH_TOTAL_OFFSET, total);
+}
+
+void DocLengthTableWriter::commit(uint64_t generation) {
+    if (!addr_) throw std::runtime_error("No doc length table to commit: " + path_);
+    // Lengths must be durable before the generation that vouches for them
+    if (msync(addr_, size_, MS_SYNC) != 0) {
+        throw std::runtime_error("msync failed for " + path_ + ": " + std::strerror(errno));
+    }
+    __atomic_store_n(reinterpret_cast<uint64_t*>(addr_ + DOC_LENGTH_GENERATION_OFFSET), generation, __ATOMIC_RELEASE);
+    if (msync(addr_, DOC_LENGTH_TABLE_HEADER_SIZE, MS_SYNC) != 0) {
+        throw std::runtime_error("msync failed for " + path_ + ": " + std::strerror(errno));
+    }
+}
+
+void DocLengthTableWriter::rebuild(const std::vector<std::shared_ptr<const Segment>>& segments, uint64_t generation) {
+    std::vector<uint32_t> lengths;
+    for (const auto& segment : segments) {
+        for (size_t i = 0; i < segment->doc_count(); ++i) {
+            uint32_t doc_id = segment->doc_id_at(i);
+            if (doc_id >= lengths.size()) lengths.resize(static_cast<size_t>(doc_id) + 1, 0);
+            lengths[doc_id] = segment->doc_length_at(i);
+        }
+    }
+    uint64_t doc_count = 0, total = 0;
+    for (uint32_t length : lengths) {
+        doc_count += length > 0;
+        total += length;
+    }
+
+    // Written aside and renamed over, so readers of the old table never see it half built
+    std::string header(DOC_LENGTH_TABLE_MAGIC, sizeof(DOC_LENGTH_TABLE_MAGIC) - 1);
+    header.push_back(static_cast<char>(DOC_LENGTH_TABLE_VERSION));
+    header.push_back('\0');
+    for (uint64_t value : {generation, doc_count, total}) header.append(reinterpret_cast<const char*>(&value), 8);
+    std::string tmp_path = path_ + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        out.write(reinterpret_cast<const char*>(lengths.data()), static_cast<std::streamsize>(lengths.size() * 4));
+        out.flush();
+        if (!out) {
+            out.close();
+            std::remove(tmp_path.c_str());
+            throw std::runtime_error("Failed to write doc length table: " + tmp_path);
+        }
+    }
+    sync_path(tmp_path);
+    std::filesystem::rename(tmp_path, path_);
+    sync_path(std::filesystem::path(path_).parent_path().string());
+
+    unmap_file();
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0) throw std::runtime_error("Could not open doc length table: " + path_ + ": " + std::strerror(errno));
+    map_file();
+}
+
+void DocLengthTableWriter::map_file() {
+    struct stat st;
+    if (fstat(fd_, &st) != 0) throw std::runtime_error("Could not stat " + path_ + ": " + std::strerror(errno));
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size < DOC_LENGTH_TABLE_HEADER_SIZE || (size - DOC_LENGTH_TABLE_HEADER_SIZE) % 4 != 0) {
+        throw std::runtime_error("Doc length table has a bad size: " + path_);
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) throw std::runtime_error("Could not mmap " + path_ + ": " + std::strerror(errno));
+    if (!is_doc_length_table_header(static_cast<const char*>(addr))) {
+        munmap(addr, size);
+        throw std::runtime_error("Not a doc length table, or an unsupported version: " + path_);
+    }
+    addr_ = static_cast<char*>(addr);
+    size_ = size;
+}
+
+void DocLengthTableWriter::unmap_file() {
+    if (addr_) munmap(addr_, size_);
+    if (fd_ >= 0) ::close(fd_);
+    addr_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+}
+
+// Extends the file with zeroed (absent) lengths. Readers keep their smaller mapping valid.
+void DocLengthTableWriter::grow(size_t capacity) {
+    size_t size = DOC_LENGTH_TABLE_HEADER_SIZE + capacity * 4;
+    if (ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        throw std::runtime_error("Could not grow " + path_ + ": " + std::strerror(errno));
+    }
+    munmap(addr_, size_);
+    addr_ = nullptr;
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        int err = errno;
+        unmap_file();
+        throw std::runtime_error("Could not mmap " + path_ + ": " + std::strerror(err));
+    }
+    addr_ = static_cast<char*>(addr);
+    size_ = size;
+}
+
+uint32_t* DocLengthTableWriter::lengths() const {
+    return reinterpret_cast<uint32_t*>(addr_ + DOC_LENGTH_TABLE_HEADER_SIZE);
+}
+
+size_t DocLengthTableWriter::capacity() const {
+    return (size_ - DOC_LENGTH_TABLE_HEADER_SIZE) / 4;
+}
+
+uint64_t DocLengthTableWriter::load_header(size_t offset) const {
+    return __atomic_load_n(reinterpret_cast<const uint64_t*>(addr_ + offset), __ATOMIC_RELAXED);
+}
+
+void DocLengthTableWriter::store_header(size_t offset, uint64_t value) {
+    __atomic_store_n(reinterpret_cast<uint64_t*>(addr_ + offset), value, __ATOMIC_RELAXED);
+}
+
+std::optional<std::pair<size_t, size_t>> find_merge(const std::vector<uint64_t>& sizes, const MergePolicy& policy) {
+    const size_t factor = policy.merge_factor;
+    if (factor < 2 || sizes.size() < factor) return std::nullopt;
+
+    std::vector<size_t> tiers;
+    size_t max_tier = 0;
+    for (uint64_t size : sizes) {
+        size_t tier = 0;
+        for (uint64_t limit = std::max<uint64_t>(policy.floor_segment_bytes, 1); size > limit; ++tier) {
+            if (limit > UINT64_MAX / factor) break;
+            limit *= factor;
+        }
+        tiers.push_back(tier);
+        max_tier = std::max(max_tier, tier);
+    }
+
+    for (size_t tier = 0; tier <= max_tier; ++tier) {
+        std::vector<size_t> run;  // Segments of this tier since the last larger one
+        for (size_t i = 0; i < tiers.size(); ++i) {
+            if (tiers[i] > tier) {
+                run.clear();
+            } else if (tiers[i] == tier) {
+                run.push_back(i);
+                if (run.size() >= factor) return std::make_pair(run[run.size() - factor], i + 1);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+IndexWriter::IndexWriter(const std::string& dir, MergePolicy policy, bool background_merges)
+    : dir_(dir), policy_(policy), doc_lengths_(dir + "/" + DOC_LENGTH_TABLE_NAME) {
+    std::filesystem::create_directories(dir_);
+    SegmentManifest manifest = read_manifest(dir_);
+    generation_ = manifest.generation;
+    published_ms_ = manifest.published_ms;
+    docs_flushed_ = manifest.docs_flushed;
+    for (const auto& name : manifest.segments) {
+        segments_.push_back(std::make_shared<const Segment>(dir_ + "/" + name));
+    }
+
+    // Numbering continues past every file seen; unlisted ones are debris from an interrupted
+    // flush or merge
+    for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(SEGMENT_PREFIX, 0) != 0) continue;
+        next_segment_ = std::max<uint64_t>(next_segment_, std::strtoull(name.c_str() + std::strlen(SEGMENT_PREFIX), nullptr, 10) + 1);
+        if (std::find(manifest.segments.begin(), manifest.segments.end(), name) == manifest.segments.end()) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+
+    if (doc_lengths_.generation() != generation_) {
+        doc_lengths_.rebuild(segments_, generation_);
+        if (!segments_.empty()) {
+            std::cout << "Rebuilt doc length table for generation " << generation_ << " ("
+                      << doc_lengths_.doc_count() << " docs)" << std::endl;
+        }
+    }
+
+    if (background_merges) merge_thread_ = std::thread(&IndexWriter::merge_loop, this);
+}
+
+IndexWriter::~IndexWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    if (merge_thread_.joinable()) merge_thread_.join();  // Lets a running merge finish
+}
+
+void IndexWriter::flush(SegmentBuilder& builder) {
+    if (builder.empty()) return;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path = next_segment_path_locked();
+    }
+    // The builder keeps its documents until the segment is published
+    builder.write_file(path);
+    std::shared_ptr<const Segment> segment;
+    try {
+        segment = std::make_shared<const Segment>(path);
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+    const std::vector<std::pair<uint32_t, uint32_t>>& docs = builder.doc_lengths();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        segments_.push_back(segment);
+        docs_flushed_ += docs.size();
+        try {
+            publish_locked();
+        } catch (...) {
+            docs_flushed_ -= docs.size();
+            segments_.pop_back();
+            std::remove(path.c_str());
+            throw;
+        }
+        sync_doc_lengths_locked(&docs);
+        merge_failed_ = false;
+        bytes_written_ += segment->size_bytes();
+    }
+    builder.clear();
+    changed_.notify_all();
+}
+
+void IndexWriter::maybe_merge() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return !merging_; });
+    while (merge_next(lock, std::nullopt)) {
+    }
+}
+
+void IndexWriter::force_merge() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return !merging_; });
+    if (segments_.size() > 1) merge_next(lock, Range(0, segments_.size()));
+}
+
+IndexSnapshot IndexWriter::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return IndexSnapshot(generation_, segments_, published_ms_, docs_flushed_);
+}
+
+uint64_t IndexWriter::bytes_written() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_written_;
+}
+
+void IndexWriter::merge_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        bool merged = false;
+        if (!merging_ && !merge_failed_) {
+            try {
+                merged = merge_next(lock, std::nullopt);
+            } catch (const std::exception& e) {
+                std::cerr << "Background merge failed: " << e.what() << std::endl;
+            }
+        }
+        if (!merged && !stopping_) changed_.wait(lock);
+    }
+}
+
+// Merges range (or the policy's pick) with the lock released, then swaps the result in. Only
+// flushes can run meanwhile, and they only append, so the range still holds the same segments.
+bool IndexWriter::merge_next(std::unique_lock<std::mutex>& lock, std::optional<Range> range) {
+    if (!range) {
+        std::vector<uint64_t> sizes;
+        for (const auto& segment : segments_) sizes.push_back(segment->size_bytes());
+        range = find_merge(sizes, policy_);
+        if (!range) return false;
+    }
+    std::vector<std::shared_ptr<const Segment>> inputs(segments_.begin() + range->first,
+                                                       segments_.begin() + range->second);
+    std::string path = next_segment_path_locked();
+    merging_ = true;
+    lock.unlock();
+
+    std::shared_ptr<const Segment> merged;
+    std::string error;
+    try {
+        merge_segments(inputs, path);
+        merged = std::make_shared<const Segment>(path);
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+
+    lock.lock();
+    merging_ = false;
+    std::vector<std::shared_ptr<const Segment>> previous = segments_;
+    if (merged) {
+        segments_.erase(segments_.begin() + range->first, segments_.begin() + range->second);
+        segments_.insert(segments_.begin() + range->first, merged);
+        try {
+            publish_locked();
+        } catch (const std::exception& e) {
+            error = e.what();
+            segments_ = std::move(previous);
+            merged.reset();
+        }
+        if (merged) sync_doc_lengths_locked(nullptr);  // Lengths are unchanged; only the generation moves
+    }
+    changed_.notify_all();
+    if (!merged) {
+        std::remove(path.c_str());
+        merge_failed_ = true;
+        throw std::runtime_error("Merging " + std::to_string(inputs.size()) + " segments failed: " + error);
+    }
+
+    bytes_written_ += merged->size_bytes();
+    for (const auto& input : inputs) std::remove(input->path().c_str());
+    std::cout << "Merged " << inputs.size() << " segments into " << filename_of(path) << " ("
+              << merged->doc_count() << " docs, " << merged->size_bytes() / 1024 << " KB)" << std::endl;
+    return true;
+}
+
+std::string IndexWriter::next_segment_path_locked() {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%s%08llu%s", SEGMENT_PREFIX, static_cast<unsigned long long>(next_segment_++),
+                  SEGMENT_SUFFIX);
+    return dir_ + "/" + name;
+}
+
+void IndexWriter::publish_locked() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    uint64_t published_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+    std::string path = dir_ + "/" + SEGMENT_MANIFEST_NAME;
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        out << "generation " << generation_ + 1 << "\n";
+        out << "published_ms " << published_ms << "\n";
+        out << "docs_flushed " << docs_flushed_ << "\n";
+        for (const auto& segment : segments_) out << filename_of(segment->path()) << "\n";
+        out.flush();
+        if (!out) throw std::runtime_error("Failed to write segment manifest: " + tmp_path);
+    }
+    sync_path(tmp_path);
+    std::filesystem::rename(tmp_path, path);  // Readers see the old set or the new one, never a mix
+    sync_path(dir_);
+    ++generation_;
+    published_ms_ = published_ms;
+}
+
+// Brings the doc length table to generation_ right after a publish, adding a flush's docs. The
+// segments are already published, so failures are logged rather than thrown: the table keeps
+// its old generation and is rebuilt from the segments at the next publish.
+void IndexWriter::sync_doc_lengths_locked(const std::vector<std::pair<uint32_t, uint32_t>>* docs) {
+    try {
+        if (doc_lengths_.generation() + 1 != generation_) {
+            doc_lengths_.rebuild(segments_, generation_);
+            return;
+        }
+        if (docs) doc_lengths_.update(*docs);
+        doc_lengths_.commit(generation_);
+    } catch (const std::exception& e) {
+        std::cerr << "Updating the doc length table failed: " << e.what() << std::endl;
+    }
+}
+
+} // namespace indexer
@@ -0,0 +1,225 @@
+#ifndef INDEXER_SEGMENT_WRITER_HPP
+#define INDEXER_SEGMENT_WRITER_HPP
+
+#include "doc_length_table.hpp"
+#include "posting_codec.hpp"
+#include "segment.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace indexer {
+
+/**
+ * @brief In-memory inverted index of the documents since the last flush.
+ *
+ * Maps each term to a growable posting buffer. Nothing is sorted until write(), which lays the
+ * buffers out as one immutable segment (see segment.hpp). ram_bytes() estimates what the
+ * buffers hold so the caller can flush at a memory budget.
+ *
+ * @note Not thread-safe; the commit stage is its only user.
+ */
+class SegmentBuilder {
+public:
+    // Adds a document's postings. A doc added twice keeps only its last postings and length.
+    void add_document(uint32_t doc_id, uint32_t doc_length,
+                      const std::vector<std::pair<std::string, uint32_t>>& term_freqs);
+
+    size_t doc_count() const { return doc_lengths_.size(); }
+    // (doc_id, length) of every document added, in arrival order.
+    const std::vector<std::pair<uint32_t, uint32_t>>& doc_lengths() const { return doc_lengths_; }
+    bool empty() const { return doc_lengths_.empty(); }
+    size_t ram_bytes() const { return ram_bytes_; }
+
+    /**
+     * @brief Writes the buffered documents as a segment file at path, then clears the builder.
+     * @throws std::runtime_error if the file cannot be written; the builder is left intact.
+     */
+    void write(const std::string& path);
+
+    // write() without the clear, for callers that must publish the segment before letting go of
+    // the documents. Writing again rewrites the same segment.
+    void write_file(const std::string& path);
+
+    void clear();
+
+private:
+    std::unordered_map<std::string, std::vector<Posting>> postings_;
+    std::vector<std::pair<uint32_t, uint32_t>> doc_lengths_;  // (doc_id, length), in arrival order
+    std::unordered_set<uint32_t> doc_ids_;
+    // Terms of the last version of each doc added more than once; write() drops the others' postings
+    std::unordered_map<uint32_t, std::unordered_set<std::string>> reindexed_terms_;
+    size_t ram_bytes_ = 0;
+};
+
+/**
+ * @brief Merges segments (oldest first) into one new segment file at path.
+ *
+ * Terms are merged in dictionary order. A term only one input holds has its posting list copied
+ * byte for byte; otherwise the lists are decoded and combined so the newest posting per doc
+ * wins, as IndexSnapshot would resolve them at query time. Postings of documents a newer input
+ * re-indexed are dropped, and so are terms left without postings.
+ *
+ * @throws std::runtime_error if the output cannot be written.
+ */
+void merge_segments(const std::vector<std::shared_ptr<const Segment>>& segments, const std::string& path);
+
+/**
+ * @brief Keeps an index directory's document length table (see doc_length_table.hpp) up to date
+ *        in place, through a writable shared mapping of the file.
+ *
+ * @note Not thread-safe; IndexWriter calls it under its lock.
+ */
+class DocLengthTableWriter {
+public:
+    // Maps the table at path if there is a valid one; otherwise generation() is NO_GENERATION
+    // until rebuild() creates it.
+    explicit DocLengthTableWriter(std::string path);
+    ~DocLengthTableWriter();
+
+    DocLengthTableWriter(const DocLengthTableWriter&) = delete;
+    DocLengthTableWriter& operator=(const DocLengthTableWriter&) = delete;
+
+    uint64_t generation() const;
+    uint64_t doc_count() const;
+    uint64_t total_doc_length() const;
+
+    /**
+     * @brief Sets each document's length (later entries win), growing the file as doc IDs grow,
+     *        and adjusts the doc count and total. A length of 0 removes the document.
+     *
+     * The generation reads NO_GENERATION from the first change until commit().
+     * @throws std::runtime_error if there is no table to update or the file cannot be grown.
+     */
+    void update(const std::vector<std::pair<uint32_t, uint32_t>>& docs);
+
+    // Flushes the lengths to disk, then records that they match manifest generation.
+    void commit(uint64_t generation);
+
+    /**
+     * @brief Replaces the table with one built from segments' doc tables (oldest first, so the
+     *        newest length of each document wins) and marks it as matching generation.
+     * @throws std::runtime_error if the new table cannot be written.
+     */
+    void rebuild(const std::vector<std::shared_ptr<const Segment>>& segments, uint64_t generation);
+
+private:
+    void map_file();
+    void unmap_file();
+    void grow(size_t capacity);
+    uint32_t* lengths() const;
+    size_t capacity() const;
+    uint64_t load_header(size_t offset) const;
+    void store_header(size_t offset, uint64_t value);
+
+    const std::string path_;
+    int fd_ = -1;
+    char* addr_ = nullptr;
+    size_t size_ = 0;
+};
+
+// When IndexWriter merges segments in the background.
+struct MergePolicy {
+    size_t merge_factor = 10;                // Segments of one size tier merged at once
+    uint64_t floor_segment_bytes = 1 << 20;  // Segments up to this size all count as the smallest tier
+};
+
+/**
+ * @brief Picks the next merge for segments of the given sizes (oldest first), if any.
+ *
+ * Segments are grouped into tiers by size, each merge_factor times larger than the last. Once
+ * merge_factor segments of one tier follow each other with no larger segment in between, that
+ * stretch is merged (smaller segments inside it included), smallest tier first. Only adjacent
+ * segments are merged so that newer segments keep winning over older ones, and each document is
+ * rewritten about log_f(index size / flush size) times overall.
+ *
+ * @return The range [first, last) to merge.
+ */
+std::optional<std::pair<size_t, size_t>> find_merge(const std::vector<uint64_t>& sizes, const MergePolicy& policy);
+
+/**
+ * @brief Owns an index directory: publishes flushed segments and merges them in the background.
+ *
+ * Every change writes a new manifest (to a temporary name, then renamed) with the next
+ * generation, so a reader that opens the directory always sees a complete set of segments.
+ * Files of merged-away segments are deleted once the manifest no longer lists them; readers
+ * that still have them mapped are unaffected. Segment files the manifest does not list (left
+ * by a crash mid-flush or mid-merge) are removed when the writer opens the directory.
+ *
+ * The directory's document length table follows every publish. If it ever misses one (a crash
+ * or a failed update), it is rebuilt from the segments at the next publish or open.
+ *
+ * @note Thread-safe, but meant for a single writer process per directory.
+ */
+class IndexWriter {
+public:
+    /**
+     * @param background_merges Merge on a background thread after each flush. Without it,
+     *        merges only happen in maybe_merge() and force_merge().
+     * @throws std::runtime_error if dir cannot be created or its segments cannot be opened.
+     */
+    explicit IndexWriter(const std::string& dir, MergePolicy policy = MergePolicy(), bool background_merges = true);
+    ~IndexWriter();
+
+    IndexWriter(const IndexWriter&) = delete;
+    IndexWriter& operator=(const IndexWriter&) = delete;
+
+    /**
+     * @brief Writes builder's documents as a new segment and publishes it, then clears builder.
+     * @throws std::runtime_error if the segment or the manifest cannot be written. builder is
+     *         left intact, so the flush can be retried.
+     */
+    void flush(SegmentBuilder& builder);
+
+    // Runs merges the policy asks for until none is left, on the calling thread.
+    void maybe_merge();
+
+    // Merges every segment into one, e.g. at the end of a bulk rebuild.
+    void force_merge();
+
+    // The current segments and generation, as a reader opening the directory would see them.
+    IndexSnapshot snapshot() const;
+
+    // Segment bytes written by flushes and merges since the writer opened; divided by the index
+    // size, this is the write amplification.
+    uint64_t bytes_written() const;
+
+private:
+    using Range = std::pair<size_t, size_t>;
+
+    void merge_loop();
+    bool merge_next(std::unique_lock<std::mutex>& lock, std::optional<Range> range);
+    std::string next_segment_path_locked();
+    void publish_locked();
+    void sync_doc_lengths_locked(const std::vector<std::pair<uint32_t, uint32_t>>* docs);
+
+    const std::string dir_;
+    const MergePolicy policy_;
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<std::shared_ptr<const Segment>> segments_;  // Oldest first
+    DocLengthTableWriter doc_lengths_;
+    uint64_t generation_ = 0;
+    uint64_t published_ms_ = 0;
+    uint64_t docs_flushed_ = 0;  // Documents flushed over the index's lifetime, as the manifest records
+    uint64_t next_segment_ = 1;
+    uint64_t bytes_written_ = 0;
+    bool merging_ = false;       // One merge at a time, so segment positions only move under it
+    bool merge_failed_ = false;  // Pauses background merges until the next flush
+    bool stopping_ = false;
+    std::thread merge_thread_;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_SEGMENT_WRITER_HPP
@@ -0,0 +1,220 @@
+#ifndef INDEXER_TERM_DICTIONARY_HPP
+#define INDEXER_TERM_DICTIONARY_HPP
+
+#include "posting_codec.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace indexer {
+
+/*
+ * Term dictionary format (front-coded blocks)
+ *
+ *   blocks      := block{block_count}
+ *   block       := first_size:varint first_term (shared:varint suffix_size:varint suffix){count - 1}
+ *   block_index := block_offset:u32{block_count}             little-endian, offsets into blocks
+ *
+ * Terms are sorted bytewise and numbered 0..n-1 in that order: a term's ID is its rank. Every
+ * block holds TERM_BLOCK_SIZE terms (the last one may hold fewer), so term ID t lives in block
+ * t / TERM_BLOCK_SIZE. The first term of a block is stored whole, which makes blocks binary
+ * searchable; each following term stores only the length of the prefix it shares with the
+ * previous term and the rest. Nothing needs to be parsed up front, so the dictionary can be
+ * searched straight out of an mmap.
+ *
+ * Header-only so the rocksdb_client Python module can share it without linking the indexer.
+ */
+
+constexpr uint32_t TERM_BLOCK_SIZE = 16;
+constexpr uint32_t NO_TERM = UINT32_MAX;
+
+/**
+ * @brief Read-only view of a front-coded term dictionary.
+ *
+ * Lookups binary search the first terms of the blocks, then decode at most one block, so a
+ * lookup touches O(log(n / TERM_BLOCK_SIZE)) block heads plus ~TERM_BLOCK_SIZE short entries.
+ *
+ * @note Views the caller's bytes, which must outlive it. Thread-safe: all accessors are const.
+ */
+class TermDictionary {
+public:
+    /**
+     * @brief Walks terms in ID order, decoding the front coding incrementally.
+     *
+     * term() views a buffer owned by the iterator, valid until the next call to next().
+     */
+    class Iterator {
+    public:
+        uint32_t id() const { return id_; }
+        bool valid() const { return id_ < dict_->size(); }
+        std::string_view term() const { return term_; }
+
+        void next() {
+            if (++id_ >= dict_->size()) return;
+            if (id_ % TERM_BLOCK_SIZE == 0) {
+                load_block_head();
+            } else {
+                uint32_t shared = get_varint32(dict_->blocks_, pos_);
+                uint32_t suffix = get_varint32(dict_->blocks_, pos_);
+                if (shared > term_.size()) throw std::runtime_error("Corrupt term dictionary block");
+                term_.resize(shared);
+                term_.append(dict_->read(pos_, suffix));
+            }
+        }
+
+    private:
+        friend class TermDictionary;
+
+        Iterator(const TermDictionary* dict, uint32_t id) : dict_(dict), id_(id) {
+            if (!valid()) return;
+            id_ = id - id % TERM_BLOCK_SIZE;
+            load_block_head();
+            while (id_ < id) next();
+        }
+
+        // Decodes the first term of the block holding id_, which starts one.
+        void load_block_head() {
+            pos_ = dict_->block_offset(id_ / TERM_BLOCK_SIZE);
+            uint32_t size = get_varint32(dict_->blocks_, pos_);
+            term_.assign(dict_->read(pos_, size));
+        }
+
+        const TermDictionary* dict_;
+        uint32_t id_;
+        size_t pos_ = 0;
+        std::string term_;
+    };
+
+    TermDictionary() = default;
+
+    /**
+     * @throws std::runtime_error if block_index does not have one entry per block of term_count
+     *         terms, or an offset points outside blocks.
+     */
+    TermDictionary(std::string_view blocks, std::string_view block_index, uint32_t term_count)
+        : blocks_(blocks), block_index_(block_index), size_(term_count) {
+        size_t block_count = (static_cast<size_t>(term_count) + TERM_BLOCK_SIZE - 1) / TERM_BLOCK_SIZE;
+        if (block_index.size() != block_count * 4) throw std::runtime_error("Term dictionary index has the wrong size");
+        for (size_t b = 0; b < block_count; ++b) {
+            if (block_offset(static_cast<uint32_t>(b)) >= blocks.size()) {
+                throw std::runtime_error("Term dictionary block offset out of range");
+            }
+        }
+    }
+
+    uint32_t size() const { return size_; }
+
+    Iterator begin() const { return Iterator(this, 0); }
+
+    // Iterator positioned at term ID id (invalid if id >= size()).
+    Iterator seek(uint32_t id) const { return Iterator(this, id); }
+
+    std::string term(uint32_t id) const { return std::string(seek(id).term()); }
+
+    // ID of the first term >= term, or size() if there is none.
+    uint32_t lower_bound(std::string_view term) const {
+        // Last block whose first term is <= term
+        uint32_t lo = 0, hi = block_count();
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (first_term(mid) <= term) lo = mid + 1; else hi = mid;
+        }
+        if (lo == 0) return 0;
+        for (Iterator it = seek((lo - 1) * TERM_BLOCK_SIZE); it.valid(); it.next()) {
+            if (it.term() >= term) return it.id();
+            if (it.id() + 1 == lo * TERM_BLOCK_SIZE) return it.id() + 1;  // The next block starts above term
+        }
+        return size_;
+    }
+
+    // ID of term, or NO_TERM if the dictionary does not contain it.
+    uint32_t find(std::string_view term) const {
+        uint32_t id = lower_bound(term);
+        return id < size_ && seek(id).term() == term ? id : NO_TERM;
+    }
+
+    // IDs [first, last) of the terms in [low, high); an empty high means no upper bound.
+    std::pair<uint32_t, uint32_t> range(std::string_view low, std::string_view high) const {
+        uint32_t first = lower_bound(low);
+        uint32_t last = high.empty() ? size_ : lower_bound(high);
+        return {first, std::max(first, last)};
+    }
+
+    // IDs [first, last) of the terms that start with prefix.
+    std::pair<uint32_t, uint32_t> prefix_range(std::string_view prefix) const {
+        return range(prefix, prefix_successor(prefix));
+    }
+
+    // Smallest string above every string that starts with prefix; empty if there is none.
+    static std::string prefix_successor(std::string_view prefix) {
+        std::string successor(prefix);
+        while (!successor.empty() && static_cast<uint8_t>(successor.back()) == 0xFF) successor.pop_back();
+        if (!successor.empty()) successor.back() = static_cast<char>(static_cast<uint8_t>(successor.back()) + 1);
+        return successor;
+    }
+
+private:
+    uint32_t block_count() const { return static_cast<uint32_t>(block_index_.size() / 4); }
+    size_t block_offset(uint32_t block) const { return get_fixed32(block_index_.data() + block * 4); }
+
+    std::string_view read(size_t& pos, uint32_t size) const {
+        if (size > blocks_.size() - pos) throw std::runtime_error("Corrupt term dictionary block");
+        std::string_view bytes = blocks_.substr(pos, size);
+        pos += size;
+        return bytes;
+    }
+
+    std::string_view first_term(uint32_t block) const {
+        size_t pos = block_offset(block);
+        uint32_t size = get_varint32(blocks_, pos);
+        return read(pos, size);
+    }
+
+    std::string_view blocks_;
+    std::string_view block_index_;
+    uint32_t size_ = 0;
+};
+
+/**
+ * @brief Builds the blocks and block index of a TermDictionary from terms added in order.
+ * @throws std::invalid_argument if terms are not strictly increasing.
+ */
+class TermDictionaryBuilder {
+public:
+    void add(std::string_view term) {
+        if (count_ > 0 && term <= previous_) throw std::invalid_argument("Terms must be strictly increasing");
+        if (count_ % TERM_BLOCK_SIZE == 0) {
+            if (blocks_.size() > UINT32_MAX) throw std::length_error("Term dictionary too large");
+            put_fixed32(block_index_, static_cast<uint32_t>(blocks_.size()));
+            put_varint32(blocks_, static_cast<uint32_t>(term.size()));
+            blocks_.append(term);
+        } else {
+            size_t shared = 0;
+            size_t limit = std::min(term.size(), previous_.size());
+            while (shared < limit && term[shared] == previous_[shared]) ++shared;
+            put_varint32(blocks_, static_cast<uint32_t>(shared));
+            put_varint32(blocks_, static_cast<uint32_t>(term.size() - shared));
+            blocks_.append(term.substr(shared));
+        }
+        previous_.assign(term);
+        ++count_;
+    }
+
+    uint32_t size() const { return count_; }
+    const std::string& blocks() const { return blocks_; }
+    const std::string& block_index() const { return block_index_; }
+
+private:
+    std::string blocks_;
+    std::string block_index_;
+    std::string previous_;
+    uint32_t count_ = 0;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_TERM_DICTIONARY_HPP
@@ -0,0 +1,106 @@
+#include "tokenizer.hpp"
+
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace indexer {
+
+namespace {
+
+inline char lower_ascii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+// On lowercased bytes; anything >= 0x80 is a separator.
+inline bool is_token_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+}
+
+#if defined(__AVX2__)
+constexpr size_t BLOCK = 32;
+
+// Lowercases one block into out and returns a bitmask of its token bytes. Signed compares keep
+// bytes >= 0x80 out of every range.
+inline uint32_t lower_block(const char* in, char* out) {
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+    c = _mm256_or_si256(c, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), c);
+    __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+    __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(alpha, digit)));
+}
+#elif defined(__SSE2__)
+constexpr size_t BLOCK = 16;
+
+inline uint32_t lower_block(const char* in, char* out) {
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    c = _mm_or_si128(c, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), c);
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(alpha, digit)));
+}
+#endif
+
+} // namespace
+
+const std::vector<std::string_view>& Tokenizer::tokenize(std::string_view text) {
+    tokens_.clear();
+    if (buffer_.size() < text.size()) buffer_.resize(text.size());
+    char* out = &buffer_[0];
+
+    size_t pos = 0;
+    size_t start = 0;
+    bool in_token = false;
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    for (; pos + BLOCK <= text.size(); pos += BLOCK) {
+        uint32_t mask = lower_block(text.data() + pos, out + pos);
+        // Jump between token boundaries inside the block instead of testing every byte
+        uint32_t remaining = BLOCK == 32 ? ~uint32_t(0) : (uint32_t(1) << BLOCK) - 1;
+        while (remaining != 0) {
+            uint32_t hits = (in_token ? ~mask : mask) & remaining;
+            if (hits == 0) break;
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(hits));
+            if (in_token) {
+                emit(start, pos + bit);
+            } else {
+                start = pos + bit;
+            }
+            in_token = !in_token;
+            remaining &= ~((uint32_t(1) << bit) - 1);  // The opposite class cannot match at bit itself
+        }
+    }
+#endif
+
+    for (; pos < text.size(); ++pos) {
+        char c = lower_ascii(text[pos]);
+        out[pos] = c;
+        if (is_token_char(c)) {
+            if (!in_token) start = pos;
+            in_token = true;
+        } else if (in_token) {
+            emit(start, pos);
+            in_token = false;
+        }
+    }
+    if (in_token) emit(start, text.size());
+    return tokens_;
+}
+
+void Tokenizer::emit(size_t start, size_t end) {
+    if (end - start >= MIN_TOKEN_LENGTH) tokens_.emplace_back(buffer_.data() + start, end - start);
+}
+
+} // namespace indexer
@@ -0,0 +1,42 @@
+#ifndef INDEXER_TOKENIZER_HPP
+#define INDEXER_TOKENIZER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace indexer {
+
+// Tokens shorter than this are dropped.
+constexpr size_t MIN_TOKEN_LENGTH = 3;
+
+/**
+ * @brief Reusable tokenizer: lowercase ASCII alphanumeric runs of at least MIN_TOKEN_LENGTH.
+ *
+ * Lowercases the whole text once into a buffer it keeps across calls and returns views into that
+ * buffer, so steady-state tokenizing allocates nothing. Full blocks are classified and lowercased
+ * 32 (AVX2) or 16 (SSE2) bytes at a time; the tail, and builds without either, take the scalar
+ * path. Classification is fixed to ASCII, as isalnum() is in the "C" locale the indexer runs in:
+ * bytes of multibyte UTF-8 sequences separate tokens like punctuation does.
+ *
+ * @note Not thread-safe; give each thread its own instance.
+ */
+class Tokenizer {
+public:
+    /**
+     * @brief Splits text into tokens, in order of appearance.
+     * @return Views of the tokens, valid until the next call on this object.
+     */
+    const std::vector<std::string_view>& tokenize(std::string_view text);
+
+private:
+    void emit(size_t start, size_t end);
+
+    std::string buffer_;  // Lowercased copy of the last text; only ever grows
+    std::vector<std::string_view> tokens_;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_TOKENIZER_HPP
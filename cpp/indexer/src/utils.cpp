@@ -1,11 +1,11 @@
 #include "utils.hpp"
+#include "gzip_decompressor.hpp"
+#include "tokenizer.hpp"
 
 #include <cstdlib>
 #include <cctype>
 #include <sstream>
 #include <stdexcept>
-#include <climits>
-#include <zlib.h>
 
 namespace indexer {
 
@@ -66,62 +66,15 @@ ExtractedContent extract_content(GumboNode* node) {
     return content;
 }
 
-std::string decompress_gzip(const std::string& compressed_data) {
-    if (compressed_data.size() > UINT_MAX) {
-        throw std::runtime_error("Compressed data too large (> 4GB)");
-    }
-    
-    const size_t MAX_DECOMPRESSED_SIZE = 100 * 1024 * 1024; // 100MB limit
-
-    z_stream zs;
-    zs.zalloc = Z_NULL;
-    zs.zfree = Z_NULL;
-    zs.opaque = Z_NULL;
-    zs.avail_in = (uInt)compressed_data.size();
-    zs.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(compressed_data.data()));
-
-    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) {
-        throw std::runtime_error("inflateInit2 failed");
-    }
-
-    int ret;
-    char buffer[32768];
-    std::string outstring;
-
-    do {
-        zs.avail_out = sizeof(buffer);
-        zs.next_out = (Bytef*)buffer;
-        ret = inflate(&zs, Z_NO_FLUSH);
-        if (ret != Z_OK && ret != Z_STREAM_END) {
-            inflateEnd(&zs);
-            throw std::runtime_error("inflate failed with code: " + std::to_string(ret));
-        }
-        if (outstring.size() < zs.total_out) {
-            outstring.append(buffer, zs.total_out - outstring.size());
-        }
-        if (outstring.size() > MAX_DECOMPRESSED_SIZE) {
-            inflateEnd(&zs);
-            throw std::runtime_error("Decompressed data exceeds maximum allowed size");
-        }
-    } while (ret == Z_OK);
-
-    inflateEnd(&zs);
-    return outstring;
+std::string decompress_gzip(std::string_view compressed_data) {
+    thread_local GzipDecompressor decompressor;
+    return std::string(decompressor.decompress(compressed_data));
 }
 
 std::vector<std::string> tokenize(const std::string& text) {
-    std::vector<std::string> tokens;
-    std::string token;
-    for (char c : text) {
-        if (isalnum(static_cast<unsigned char>(c))) {
-            token += tolower(static_cast<unsigned char>(c));
-        } else if (!token.empty()) {
-            if (token.length() > 2) tokens.push_back(token); // Min word length 3
-            token = "";
-        }
-    }
-    if (!token.empty() && token.length() > 2) tokens.push_back(token);
-    return tokens;
+    thread_local Tokenizer tokenizer;
+    const auto& tokens = tokenizer.tokenize(text);
+    return std::vector<std::string>(tokens.begin(), tokens.end());
 }
 
 } // namespace indexer
@@ -2,6 +2,7 @@
 #define INDEXER_UTILS_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <gumbo.h>
 
@@ -18,13 +19,19 @@ std::string build_db_conn_str();
 struct ExtractedContent {
     std::string text;
     std::string title;
+    // Only HtmlTextExtractor fills these
+    std::vector<std::string> links;  // href of every <a>, entity-decoded but not resolved
+    std::string headings;            // Text inside <h1>..<h6>
+    std::string anchor_text;         // Text inside <a>
 };
 ExtractedContent extract_content(GumboNode* node);
 
-// Decompress a gzip-compressed string.
-std::string decompress_gzip(const std::string& compressed_data);
+// Decompress a gzip-compressed buffer into a new string. Hot paths should use a
+// GzipDecompressor directly and skip the copy.
+std::string decompress_gzip(std::string_view compressed_data);
 
-// Tokenize a string into words (lowercase, alphanumeric, min length 3).
+// Tokenize a string into words (lowercase, alphanumeric, min length 3) as owned strings. Hot paths
+// should use a Tokenizer directly and work on its views.
 std::vector<std::string> tokenize(const std::string& text);
 
 } // namespace indexer
@@ -0,0 +1,108 @@
+#include "warc_reader.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace indexer {
+
+MappedWarcFile::MappedWarcFile(const std::string& path, bool sequential) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Could not stat file: " + path + ": " + std::strerror(err));
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ > 0) {
+        addr_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr_ == MAP_FAILED) {
+            int err = errno;
+            addr_ = nullptr;
+            ::close(fd);
+            throw std::runtime_error("Could not mmap file: " + path + ": " + std::strerror(err));
+        }
+        madvise(addr_, size_, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+    ::close(fd); // The mapping keeps the file referenced
+}
+
+MappedWarcFile::~MappedWarcFile() {
+    if (addr_) munmap(addr_, size_);
+}
+
+WarcReader::WarcReader(size_t max_open_files, AccessPattern pattern)
+    : max_open_files_(max_open_files > 0 ? max_open_files : 1), pattern_(pattern) {}
+
+WarcSpan WarcReader::read(const std::string& path, int64_t offset, int64_t length) {
+    if (offset < 0 || length < 0) {
+        throw std::runtime_error("Invalid record range in " + path);
+    }
+    size_t end = static_cast<size_t>(offset) + static_cast<size_t>(length);
+
+    std::shared_ptr<const MappedWarcFile> file;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file = map_locked(path, end);
+    }
+    if (file->size() < end) {
+        throw std::runtime_error("Failed to read full record: expected " + std::to_string(length) +
+                                 " bytes at offset " + std::to_string(offset) + ", file has " +
+                                 std::to_string(file->size()));
+    }
+
+    std::string_view data = file->data().substr(static_cast<size_t>(offset), static_cast<size_t>(length));
+    if (pattern_ == AccessPattern::Random && length > 0) {
+        // Prefetch the record's pages in one go rather than faulting them in one by one
+        static const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t start = reinterpret_cast<uintptr_t>(data.data()) & ~(page_size - 1);
+        uintptr_t stop = reinterpret_cast<uintptr_t>(data.data() + data.size());
+        madvise(reinterpret_cast<void*>(start), stop - start, MADV_WILLNEED);
+    }
+    return {std::move(file), data};
+}
+
+std::shared_ptr<const MappedWarcFile> WarcReader::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return map_locked(path, 0);
+}
+
+size_t WarcReader::open_files() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+std::shared_ptr<const MappedWarcFile> WarcReader::map_locked(const std::string& path, size_t min_size) {
+    auto it = index_.find(path);
+    if (it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        if (it->second->second->size() >= min_size) {
+            return it->second->second;
+        }
+        // The file grew since we mapped it: drop the stale mapping and map it again
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    auto file = std::make_shared<const MappedWarcFile>(path, pattern_ == AccessPattern::Sequential);
+    lru_.emplace_front(path, file);
+    index_[path] = lru_.begin();
+
+    while (lru_.size() > max_open_files_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back(); // Outstanding WarcSpans keep the mapping alive until they are done
+    }
+    return file;
+}
+
+} // namespace indexer
@@ -0,0 +1,86 @@
+#ifndef INDEXER_WARC_READER_HPP
+#define INDEXER_WARC_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace indexer {
+
+// A read-only mmap of one WARC file. Unmapped when the last reference goes away.
+class MappedWarcFile {
+public:
+    MappedWarcFile(const std::string& path, bool sequential);
+    ~MappedWarcFile();
+
+    MappedWarcFile(const MappedWarcFile&) = delete;
+    MappedWarcFile& operator=(const MappedWarcFile&) = delete;
+
+    std::string_view data() const { return {static_cast<const char*>(addr_), size_}; }
+    size_t size() const { return size_; }
+
+private:
+    void* addr_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief A record's bytes inside a mapped WARC file.
+ *
+ * Holds a reference to the mapping, so the view stays valid even if the reader evicts the file
+ * in the meantime.
+ */
+struct WarcSpan {
+    std::shared_ptr<const MappedWarcFile> file;
+    std::string_view data;
+};
+
+/**
+ * @brief Zero-copy access to WARC records by (file, offset, length).
+ *
+ * Keeps up to max_open_files WARC files mmap'ed in an LRU, so reading a record costs a hash
+ * lookup instead of an open/seek/read and two heap copies. A file that has grown past its
+ * mapping (the crawler keeps appending) is remapped on demand.
+ *
+ * With AccessPattern::Random, each read() also asks the kernel to prefetch just the record's
+ * pages (MADV_WILLNEED); Sequential suits bulk scans that walk a file front to back.
+ *
+ * @note Thread-safe. Multiple pipeline workers can share one reader.
+ */
+class WarcReader {
+public:
+    enum class AccessPattern { Random, Sequential };
+
+    explicit WarcReader(size_t max_open_files = 16, AccessPattern pattern = AccessPattern::Random);
+
+    /**
+     * @brief Returns the compressed record at [offset, offset + length) of path.
+     * @throws std::runtime_error if the file cannot be mapped or is too short.
+     */
+    WarcSpan read(const std::string& path, int64_t offset, int64_t length);
+
+    // Maps (or returns the cached mapping of) a whole file.
+    std::shared_ptr<const MappedWarcFile> open(const std::string& path);
+
+    size_t open_files() const;
+
+private:
+    using LruList = std::list<std::pair<std::string, std::shared_ptr<const MappedWarcFile>>>;
+
+    std::shared_ptr<const MappedWarcFile> map_locked(const std::string& path, size_t min_size);
+
+    const size_t max_open_files_;
+    const AccessPattern pattern_;
+    mutable std::mutex mutex_;
+    LruList lru_;  // Most recently used first
+    std::unordered_map<std::string, LruList::iterator> index_;
+};
+
+} // namespace indexer
+
+#endif // INDEXER_WARC_READER_HPP
@@ -0,0 +1,84 @@
+#include "../src/arena.hpp"
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+void test_alignment_and_bump() {
+    indexer::Arena arena(1024);
+    char* a = static_cast<char*>(arena.allocate(3, 1));
+    void* b = arena.allocate(8, 8);
+    void* c = arena.allocate(16, 64);
+    ASSERT(reinterpret_cast<uintptr_t>(b) % 8 == 0, "Allocations should honor 8-byte alignment");
+    ASSERT(reinterpret_cast<uintptr_t>(c) % 64 == 0, "Allocations should honor 64-byte alignment");
+    ASSERT(static_cast<char*>(b) > a && static_cast<char*>(b) - a < 16, "Small allocations should be packed");
+    ASSERT(arena.used() == 27, "Used bytes should count what was asked for");
+    std::cout << "test_alignment_and_bump passed" << std::endl;
+}
+
+void test_reset_reuses_memory() {
+    indexer::Arena arena(1024);
+    void* first = arena.allocate(100);
+    arena.reset();
+    ASSERT(arena.used() == 0, "Reset should release everything");
+    ASSERT(arena.allocate(100) == first, "Memory should be reused after a reset");
+    std::cout << "test_reset_reuses_memory passed" << std::endl;
+}
+
+void test_growth_is_merged_on_reset() {
+    indexer::Arena arena(1024);
+    for (int i = 0; i < 100; ++i) (void)arena.allocate(200);  // Spills over several blocks
+    size_t capacity = arena.capacity();
+    ASSERT(capacity >= 100 * 200, "Blocks should be added as needed");
+
+    arena.reset();
+    ASSERT(arena.capacity() == capacity, "Reset should keep the memory in one block");
+    char* first = static_cast<char*>(arena.allocate(200, 1));
+    for (int i = 1; i < 100; ++i) {
+        char* next = static_cast<char*>(arena.allocate(200, 1));
+        ASSERT(next == first + i * 200, "The same document should now fit in one block");
+    }
+    ASSERT(arena.capacity() == capacity, "No block should be added the second time");
+
+    (void)arena.allocate(32 * 1024 * 1024);  // One outlier document
+    arena.reset();
+    ASSERT(arena.capacity() == 1024, "Reset should not hold on to an outlier's memory");
+    std::cout << "test_growth_is_merged_on_reset passed" << std::endl;
+}
+
+void test_pmr_containers() {
+    indexer::Arena arena;
+    for (int round = 0; round < 3; ++round) {
+        arena.reset();
+        std::pmr::unordered_map<std::string, int> counts(&arena);
+        std::pmr::vector<int> values(&arena);
+        for (int i = 0; i < 1000; ++i) {
+            counts["term" + std::to_string(i % 50)]++;
+            values.push_back(i);
+        }
+        ASSERT(counts.size() == 50 && counts["term7"] == 20, "A pmr map should work on the arena");
+        ASSERT(values.size() == 1000 && values[999] == 999, "A pmr vector should work on the arena");
+    }
+    std::cout << "test_pmr_containers passed" << std::endl;
+}
+
+int main() {
+    test_alignment_and_bump();
+    test_reset_reuses_memory();
+    test_growth_is_merged_on_reset();
+    test_pmr_containers();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
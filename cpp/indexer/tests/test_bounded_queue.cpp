@@ -0,0 +1,108 @@
+#include "../src/bounded_queue.hpp"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+void test_fifo_order() {
+    indexer::BoundedQueue<int> queue(4);
+    for (int i = 0; i < 4; ++i) queue.push(i);
+    for (int i = 0; i < 4; ++i) {
+        auto item = queue.pop();
+        ASSERT(item && *item == i, "Items should come out in FIFO order");
+    }
+    std::cout << "test_fifo_order passed" << std::endl;
+}
+
+void test_pop_for_times_out() {
+    indexer::BoundedQueue<int> queue(1);
+    auto start = std::chrono::steady_clock::now();
+    auto item = queue.pop_for(std::chrono::milliseconds(20));
+    ASSERT(!item, "pop_for on an empty queue should time out");
+    ASSERT(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20), "pop_for should wait for the timeout");
+    std::cout << "test_pop_for_times_out passed" << std::endl;
+}
+
+void test_full_queue_blocks_producer() {
+    indexer::BoundedQueue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&] {
+        queue.push(3);
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT(!pushed, "push should block while the queue is full");
+    ASSERT(queue.pop().value() == 1, "Consumer should get the oldest item");
+    producer.join();
+    ASSERT(pushed && queue.size() == 2, "Blocked producer should complete once space frees up");
+    std::cout << "test_full_queue_blocks_producer passed" << std::endl;
+}
+
+void test_close_drains_then_stops() {
+    indexer::BoundedQueue<int> queue(8);
+    queue.push(7);
+    queue.close();
+    ASSERT(!queue.push(8), "push after close should fail");
+    ASSERT(queue.pop().value() == 7, "Items queued before close should still be delivered");
+    ASSERT(!queue.pop(), "pop on a closed, empty queue should return nullopt");
+    std::cout << "test_close_drains_then_stops passed" << std::endl;
+}
+
+void test_many_producers_and_consumers() {
+    indexer::BoundedQueue<int> queue(16);
+    const int producers = 4, per_producer = 5000;
+    std::atomic<long> sum{0};
+    std::atomic<int> count{0};
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 3; ++c) {
+        consumers.emplace_back([&] {
+            while (auto item = queue.pop()) {
+                sum += *item;
+                ++count;
+            }
+        });
+    }
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            for (int i = 1; i <= per_producer; ++i) queue.push(i);
+        });
+    }
+    for (auto& t : threads) t.join();
+    queue.close();
+    for (auto& t : consumers) t.join();
+
+    ASSERT(count == producers * per_producer, "Every item should be consumed exactly once");
+    ASSERT(sum == static_cast<long>(producers) * per_producer * (per_producer + 1) / 2, "No item should be lost or duplicated");
+    std::cout << "test_many_producers_and_consumers passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_fifo_order();
+        test_pop_for_times_out();
+        test_full_queue_blocks_producer();
+        test_close_drains_then_stops();
+        test_many_producers_and_consumers();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
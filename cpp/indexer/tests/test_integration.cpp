@@ -1,5 +1,7 @@
 #include "../src/utils.hpp"
+#include "../src/document_processor.hpp"
 #include "../../crawler/src/warc_writer.hpp"
+#include "../../crawler/src/record_codec.hpp"
 #include <iostream>
 #include <fstream>
 #include <cassert>
@@ -80,9 +82,84 @@ void test_crawler_indexer_integration() {
     std::cout << "test_crawler_indexer_integration passed" << std::endl;
 }
 
+void test_process_document_from_warc() {
+    std::string filename = "test_process_document.warc.gz";
+    FileCleaner cleaner(filename);
+
+    std::string content = "<html><head><title>Pipeline Page</title></head>"
+                          "<body><p>Indexer pipeline pipeline test</p></body></html>";
+    crawler::WarcRecordInfo second;
+    {
+        crawler::WarcWriter writer(filename);
+        writer.write_record("http://example.com/first", "<html><body>First</body></html>");
+        second = writer.write_record("http://example.com/second", content);
+    }
+
+    indexer::WarcReader reader;
+    indexer::IndexedDocument doc = indexer::process_document({42, filename, second.offset, second.length}, reader);
+    ASSERT(doc.doc_id == 42, "Doc ID should be carried through");
+    ASSERT(doc.title == "Pipeline Page", "Title should be extracted");
+    ASSERT(doc.snippet.find("Indexer pipeline") != std::string::npos, "Snippet should hold the page text");
+
+    uint32_t pipeline_tf = 0;
+    for (const auto& [term, tf] : doc.term_freqs) {
+        if (term == "pipeline") pipeline_tf = tf;
+    }
+    ASSERT(pipeline_tf == 3, "Term frequency should count title and body occurrences");
+    ASSERT(doc.doc_length == 6, "Doc length should count every token");
+
+    indexer::IndexedDocument gumbo_doc = indexer::process_document({42, filename, second.offset, second.length}, reader,
+                                                                   indexer::HtmlParser::Gumbo);
+    ASSERT(gumbo_doc.title == doc.title && gumbo_doc.term_freqs == doc.term_freqs,
+           "Both HTML parsers should index the page the same way");
+
+    bool threw = false;
+    try {
+        indexer::process_document({43, filename, second.offset, second.length + 1000}, reader);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "A short read should be reported as an error");
+
+    std::cout << "test_process_document_from_warc passed" << std::endl;
+}
+
+void test_process_document_from_zstd_warc() {
+    std::string filename = "test_process_document.warc.zst";
+    FileCleaner cleaner(filename);
+
+    std::vector<std::string> samples;
+    for (int i = 0; i < 100; ++i) {
+        samples.push_back("<html><head><title>Sample " + std::to_string(i) + "</title></head><body><p>Shared " +
+                          "boilerplate paragraph number " + std::to_string(i * 13 % 41) + "</p></body></html>");
+    }
+    crawler::WarcWriterOptions options;
+    options.codec = crawler::RecordCodec::Zstd;
+    options.zstd_dictionary = crawler::train_zstd_dictionary(samples, 4 * 1024);
+    ASSERT(!options.zstd_dictionary.empty(), "Dictionary should train on the samples");
+
+    std::string content = "<html><head><title>Zstd Page</title></head><body><p>Zstd record test</p></body></html>";
+    crawler::WarcRecordInfo info;
+    {
+        crawler::WarcWriter writer(filename, options);
+        writer.write_record("http://example.com/first", samples[0]);
+        info = writer.write_record("http://example.com/zstd", content);
+    }
+
+    // The reader is never told the codec: it goes by the record's magic bytes
+    indexer::WarcReader reader;
+    indexer::IndexedDocument doc = indexer::process_document({44, filename, info.offset, info.length}, reader);
+    ASSERT(doc.title == "Zstd Page", "Title should be extracted from a zstd record");
+    ASSERT(doc.snippet.find("Zstd record test") != std::string::npos, "Snippet should hold the page text");
+
+    std::cout << "test_process_document_from_zstd_warc passed" << std::endl;
+}
+
 int main() {
     try {
         test_crawler_indexer_integration();
+        test_process_document_from_warc();
+        test_process_document_from_zstd_warc();
         std::cout << "All integration tests passed!" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Integration test failed: " << e.what() << std::endl;
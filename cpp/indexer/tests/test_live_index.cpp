@@ -0,0 +1,236 @@
+#include "../src/live_index.hpp"
+#include "../src/query_engine.hpp"
+#include "../src/segment_writer.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+// Docs [first, first + count), each with "common" and its own "docN" term, length doc_id % 7 + 1.
+void flush_docs(indexer::IndexWriter& writer, uint32_t first, uint32_t count) {
+    indexer::SegmentBuilder builder;
+    for (uint32_t doc_id = first; doc_id < first + count; ++doc_id) {
+        builder.add_document(doc_id, doc_id % 7 + 1, {{"common", 1}, {"doc" + std::to_string(doc_id), 1}});
+    }
+    writer.flush(builder);
+}
+
+size_t common_doc_count(const indexer::IndexView& view) {
+    std::string scratch;
+    return indexer::decode_postings(view.snapshot.postings("common", scratch)).size();
+}
+
+void test_refresh_swaps_views() {
+    std::string dir = "test_live_index";
+    std::filesystem::remove_all(dir);
+    indexer::IndexWriter writer(dir, {3, 1}, false);
+    flush_docs(writer, 1, 100);
+
+    indexer::LiveIndex live(dir);
+    std::shared_ptr<const indexer::IndexView> before = live.acquire();
+    ASSERT(before->snapshot.generation() == 1 && common_doc_count(*before) == 100, "Should open the published index");
+    ASSERT(!live.refresh(), "Nothing to refresh while the manifest is unchanged");
+
+    flush_docs(writer, 101, 50);
+    indexer::RefreshStats stats = live.stats();
+    ASSERT(stats.generation == 1 && stats.published_generation == 2, "Stats should see the unserved generation");
+    ASSERT(stats.lag_docs == 50 && stats.lag_seconds >= 0, "Lag should count the documents not served yet");
+
+    ASSERT(live.refresh(), "A new generation should be swapped in");
+    std::shared_ptr<const indexer::IndexView> after = live.acquire();
+    ASSERT(after->snapshot.generation() == 2 && common_doc_count(*after) == 150, "New queries should see new docs");
+    ASSERT(before->snapshot.generation() == 1 && common_doc_count(*before) == 100,
+           "A held view should keep its generation");
+    ASSERT(after->snapshot.segments()[0] == before->snapshot.segments()[0], "Open segments should be reused");
+    ASSERT(after->doc_length(120) == 120 % 7 + 1, "The new view should know the new docs' lengths");
+
+    stats = live.stats();
+    ASSERT(stats.refreshes == 1 && stats.refresh_failures == 0 && stats.last_refresh_seconds >= 0,
+           "The refresh should be counted");
+    ASSERT(stats.generation == 2 && stats.lag_docs == 0 && stats.lag_seconds == 0, "No lag once current");
+
+    // A merge deletes the files the held views map; they keep reading them
+    flush_docs(writer, 151, 10);
+    writer.force_merge();
+    ASSERT(live.refresh(), "The merged generation should be swapped in");
+    ASSERT(common_doc_count(*before) == 100 && common_doc_count(*after) == 150, "Old views should survive merges");
+    ASSERT(common_doc_count(*live.acquire()) == 160 && live.acquire()->snapshot.segments().size() == 1,
+           "The merged view should hold every doc");
+
+    live.close();
+    ASSERT(!live.acquire() && !live.refresh(), "A closed index should serve nothing");
+    ASSERT(common_doc_count(*after) == 150, "Views held across close() should stay readable");
+
+    std::filesystem::remove_all(dir);
+    std::cout << "test_refresh_swaps_views passed" << std::endl;
+}
+
+void test_refresh_follows_doc_length_table() {
+    std::string dir = "test_live_index_lengths";
+    std::filesystem::remove_all(dir);
+    {
+        indexer::IndexWriter writer(dir, {3, 1}, false);
+        flush_docs(writer, 1, 10);
+    }
+    std::filesystem::remove(dir + "/" + indexer::DOC_LENGTH_TABLE_NAME);
+
+    indexer::LiveIndex live(dir);
+    ASSERT(!live.acquire()->doc_lengths, "An index without a table should open without one");
+    ASSERT(live.acquire()->doc_length(5) == 5 % 7 + 1 && live.acquire()->collection_stats().first == 10,
+           "Lengths and stats should come from the segments without a table");
+
+    // Reopening the writer rebuilds the table without publishing a new generation
+    { indexer::IndexWriter writer(dir, {3, 1}, false); }
+    ASSERT(live.refresh(), "A rebuilt table should be picked up");
+    auto view = live.acquire();
+    ASSERT(view->doc_lengths && view->snapshot.generation() == 1, "The same generation should gain the table");
+    ASSERT(view->collection_stats() == std::make_pair(uint64_t(10), view->snapshot.total_doc_length()),
+           "Stats should come from the table");
+
+    std::filesystem::remove_all(dir);
+    std::cout << "test_refresh_follows_doc_length_table passed" << std::endl;
+}
+
+// The indexer updates the doc length table in place; a held view must keep scoring its own generation.
+void test_doc_lengths_match_view_generation() {
+    std::string dir = "test_live_index_generations";
+    std::filesystem::remove_all(dir);
+    indexer::IndexWriter writer(dir, {3, 1}, false);
+    flush_docs(writer, 1, 10);
+
+    indexer::LiveIndex live(dir);
+    auto before = live.acquire();
+    auto before_stats = before->collection_stats();
+    ASSERT(before->doc_lengths && before->doc_lengths->generation() == 1, "The table should hold generation 1");
+    ASSERT(before_stats == std::make_pair(uint64_t(10), before->snapshot.total_doc_length()),
+           "Stats should come from the table while it holds the view's generation");
+
+    // Re-index doc 5 with a new length, without refreshing
+    indexer::SegmentBuilder builder;
+    builder.add_document(5, 40, {{"common", 1}});
+    writer.flush(builder);
+    ASSERT(before->doc_lengths->generation() == 2, "The shared table should have moved on");
+    ASSERT(before->doc_length(5) == 5 % 7 + 1, "A held view should keep its generation's length");
+    ASSERT(before->collection_stats() == before_stats, "A held view should keep its generation's stats");
+
+    ASSERT(live.refresh(), "The re-indexed generation should be swapped in");
+    auto after = live.acquire();
+    ASSERT(after->doc_length(5) == 40, "The new view should see the new length");
+    ASSERT(after->collection_stats() == std::make_pair(uint64_t(10), before_stats.second - (5 % 7 + 1) + 40),
+           "The new view's stats should count the re-indexed doc once");
+
+    // A flush while a query reads the table makes it read again from the segments
+    int calls = 0;
+    uint32_t length = after->with_doc_lengths([&](const indexer::IndexView::DocLengthFn& doc_length, uint64_t,
+                                                  uint64_t) {
+        if (++calls == 1) flush_docs(writer, 11, 5);
+        return doc_length(5);
+    });
+    ASSERT(calls == 2 && length == 40, "A table updated mid-query should not be trusted");
+    ASSERT(after->doc_length(15) == 0, "Docs newer than the view should not be seen through the table");
+
+    std::filesystem::remove_all(dir);
+    std::cout << "test_doc_lengths_match_view_generation passed" << std::endl;
+}
+
+// A ranker may start before the indexer has published anything.
+void test_follows_index_created_later() {
+    std::string dir = "test_live_index_later";
+    std::filesystem::remove_all(dir);
+
+    indexer::LiveIndex live(dir);
+    auto empty = live.acquire();
+    ASSERT(empty->snapshot.generation() == 0 && empty->snapshot.segments().empty() && !empty->doc_lengths,
+           "A missing index should open as an empty generation 0");
+    ASSERT(common_doc_count(*empty) == 0 && empty->collection_stats().first == 0,
+           "An empty index should match nothing");
+    ASSERT(!live.refresh(), "Nothing to refresh before the first flush");
+
+    indexer::IndexWriter writer(dir, {3, 1}, false);
+    flush_docs(writer, 1, 10);
+    ASSERT(live.stats().lag_docs == 10, "The first flush should show as lag");
+    ASSERT(live.refresh() && common_doc_count(*live.acquire()) == 10, "The first generation should be picked up");
+    ASSERT(live.acquire()->doc_lengths, "The indexer's doc length table should be picked up with it");
+
+    live.close();
+    std::filesystem::remove_all(dir);
+    std::cout << "test_follows_index_created_later passed" << std::endl;
+}
+
+// Queries run against a background-refreshing index while the writer flushes and merges.
+void test_background_refresh_under_load() {
+    std::string dir = "test_live_index_background";
+    std::filesystem::remove_all(dir);
+    indexer::IndexWriter writer(dir, {3, 1}, true);
+    flush_docs(writer, 1, 20);
+
+    indexer::LiveIndex live(dir, std::chrono::milliseconds(5));
+    std::atomic<bool> done{false};
+    std::atomic<size_t> queries{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            size_t seen = 0;
+            while (!done) {
+                auto view = live.acquire();
+                if (!view) break;
+                std::string scratch;
+                std::vector<indexer::PostingCursor> cursors;
+                cursors.emplace_back(view->snapshot.postings("common", scratch));
+                auto [total_docs, total_length] = view->collection_stats();
+                auto doc_length = [&view](uint32_t doc_id) { return view->doc_length(doc_id); };
+                auto results = indexer::bm25_search_block_max_wand(
+                    cursors, doc_length, {total_docs, total_length / std::max<double>(total_docs, 1)}, 10);
+                size_t matched = common_doc_count(*view);
+                ASSERT(!results.empty() && matched >= seen, "A refresh should never go back in time");
+                seen = matched;
+                ++queries;
+            }
+        });
+    }
+
+    for (uint32_t batch = 1; batch < 20; ++batch) {
+        flush_docs(writer, batch * 20 + 1, 20);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (common_doc_count(*live.acquire()) < 400 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+
+    ASSERT(common_doc_count(*live.acquire()) == 400, "The background refresh should catch up with the writer");
+    ASSERT(live.stats().refreshes > 0 && queries > 0, "Queries and refreshes should both have run");
+    live.close();
+    std::filesystem::remove_all(dir);
+    std::cout << "test_background_refresh_under_load passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_refresh_swaps_views();
+        test_refresh_follows_doc_length_table();
+        test_doc_lengths_match_view_generation();
+        test_follows_index_created_later();
+        test_background_refresh_under_load();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include "../src/posting_codec.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+using indexer::Posting;
+
+bool same_postings(const std::vector<Posting>& a, const std::vector<Posting>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].doc_id != b[i].doc_id || a[i].tf != b[i].tf) return false;
+    }
+    return true;
+}
+
+void test_roundtrip_single_block() {
+    std::vector<Posting> postings = {{1, 1}, {2, 5}, {7, 2}, {1000000, 3}};
+    std::string encoded = indexer::encode_postings(postings);
+    ASSERT(static_cast<uint8_t>(encoded[0]) == indexer::POSTING_FORMAT_VERSION, "Value should start with the version byte");
+    ASSERT(same_postings(indexer::decode_postings(encoded), postings), "Decoded postings should match");
+    std::cout << "test_roundtrip_single_block passed" << std::endl;
+}
+
+void test_roundtrip_multiple_blocks() {
+    std::vector<Posting> postings;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        postings.push_back({i * 3 + 1, i % 7 + 1});
+    }
+    std::string encoded = indexer::encode_postings(postings);
+    ASSERT(same_postings(indexer::decode_postings(encoded), postings), "Decoded postings should match across blocks");
+    // Small gaps and TFs should need about two bytes per posting, far below "1234,"
+    ASSERT(encoded.size() < postings.size() * 3, "Encoding should be compact");
+    std::cout << "test_roundtrip_multiple_blocks passed" << std::endl;
+}
+
+void test_block_headers_as_skip_data() {
+    std::vector<Posting> postings;
+    for (uint32_t i = 1; i <= 300; ++i) {
+        postings.push_back({i * 10, i == 150 ? 42u : 1u});
+    }
+    std::string encoded = indexer::encode_postings(postings);
+
+    size_t pos = 1;
+    std::vector<indexer::PostingBlockHeader> headers;
+    while (pos < encoded.size()) {
+        headers.push_back(indexer::read_block_header(encoded, pos));
+        pos += headers.back().payload_size;
+    }
+    ASSERT(headers.size() == 3, "300 postings should form 3 blocks");
+    ASSERT(headers[0].count == 128 && headers[2].count == 44, "Blocks should be full except the last");
+    ASSERT(headers[0].first_doc == 10 && headers[0].last_doc == 1280, "First block bounds");
+    ASSERT(headers[1].max_tf == 42 && headers[0].max_tf == 1, "Block max TF");
+    std::cout << "test_block_headers_as_skip_data passed" << std::endl;
+}
+
+void test_concatenated_runs_last_wins() {
+    std::string first = indexer::encode_postings({{5, 1}, {9, 1}});
+    std::string second = indexer::encode_postings({{2, 4}, {9, 7}});
+    std::string merged = first + second.substr(1);
+
+    std::vector<Posting> expected = {{2, 4}, {5, 1}, {9, 7}};
+    ASSERT(same_postings(indexer::decode_postings(merged), expected), "Concatenated runs should be sorted with the newest TF");
+    std::cout << "test_concatenated_runs_last_wins passed" << std::endl;
+}
+
+void test_legacy_format() {
+    std::vector<Posting> expected = {{3, 1}, {12, 1}, {40, 1}};
+    ASSERT(same_postings(indexer::decode_postings("12,3,40,3"), expected), "Legacy lists should decode with tf = 1");
+    ASSERT(same_postings(indexer::decode_postings("12,,3,40,"), expected), "Empty legacy entries should be skipped");
+    ASSERT(indexer::decode_postings(",").empty(), "A legacy list of empty entries should hold no postings");
+    std::cout << "test_legacy_format passed" << std::endl;
+}
+
+void test_block_bounds_survive_reencoding() {
+    std::vector<Posting> postings = {{1, 2, 300}, {2, 9, 40}, {3, 1, 700}};
+    std::string encoded = indexer::encode_postings(postings);
+    size_t pos = 1;
+    auto header = indexer::read_block_header(encoded, pos);
+    ASSERT(header.max_tf == 9 && header.min_doc_len == 40, "Block should record max TF and min doc length");
+
+    // Re-encoding decoded postings (as the merge operator does) keeps a valid lower bound
+    std::string reencoded = indexer::encode_postings(indexer::decode_postings(encoded));
+    pos = 1;
+    ASSERT(indexer::read_block_header(reencoded, pos).min_doc_len == 40, "Min doc length should carry over");
+    std::cout << "test_block_bounds_survive_reencoding passed" << std::endl;
+}
+
+void test_cursor_skipping() {
+    std::vector<Posting> postings;
+    for (uint32_t i = 1; i <= 1000; ++i) {
+        postings.push_back({i * 2, i});
+    }
+    std::string encoded = indexer::encode_postings(postings);
+    indexer::PostingCursor cursor(encoded);
+    ASSERT(cursor.doc_freq() == 1000, "Cursor should report the document frequency");
+    ASSERT(cursor.doc() == 2 && cursor.tf() == 1, "Cursor should start at the first posting");
+
+    cursor.next();
+    ASSERT(cursor.doc() == 4, "next() should step one posting");
+    cursor.next_geq(1001);
+    ASSERT(cursor.doc() == 1002 && cursor.tf() == 501, "next_geq() should land on the first doc >= target");
+    cursor.next_geq(10);
+    ASSERT(cursor.doc() == 1002, "next_geq() should never move backwards");
+
+    const indexer::PostingBlockHeader* block = cursor.block_for(1900);
+    ASSERT(block != nullptr && block->first_doc <= 1900 && block->last_doc >= 1900, "block_for() should find the covering block");
+    ASSERT(cursor.doc() == 1002, "block_for() should not move the cursor");
+    ASSERT(cursor.block_for(5000) == nullptr, "block_for() past the end should return nullptr");
+
+    cursor.next_geq(2000);
+    ASSERT(cursor.doc() == 2000, "Cursor should reach the last posting");
+    cursor.next();
+    ASSERT(cursor.doc() == indexer::PostingCursor::END, "Cursor should be exhausted");
+
+    indexer::PostingCursor legacy("9,3,5");
+    ASSERT(legacy.doc_freq() == 3 && legacy.doc() == 3, "Legacy values should be normalized for the cursor");
+    indexer::PostingCursor moved(std::move(legacy));
+    moved.next();
+    ASSERT(moved.doc() == 5, "A moved cursor should keep its position and owned buffer");
+    std::cout << "test_cursor_skipping passed" << std::endl;
+}
+
+void test_rejects_bad_input() {
+    bool threw = false;
+    try {
+        indexer::encode_postings({{5, 1}, {5, 1}});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT(threw, "Encoding duplicate doc IDs should throw");
+
+    std::string encoded = indexer::encode_postings({{1, 1}, {2, 1}, {3, 1}});
+    threw = false;
+    try {
+        indexer::decode_postings(encoded.substr(0, encoded.size() - 1));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Decoding a truncated value should throw");
+
+    threw = false;
+    try {
+        indexer::decode_postings(std::string("\x7f", 1));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Decoding an unknown version should throw");
+
+    threw = false;
+    try {
+        indexer::decode_postings("1,4294967296");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "A legacy doc ID past 32 bits should throw");
+
+    // Block header whose count varint carries bits past 32 in its fifth byte
+    std::string overflow = {static_cast<char>(indexer::POSTING_FORMAT_VERSION), '\x81', '\x80', '\x80', '\x80', '\x10'};
+    size_t pos = 1;
+    threw = false;
+    try {
+        indexer::get_varint32(overflow, pos);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "A varint past 32 bits should throw");
+    std::cout << "test_rejects_bad_input passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_roundtrip_single_block();
+        test_roundtrip_multiple_blocks();
+        test_block_headers_as_skip_data();
+        test_concatenated_runs_last_wins();
+        test_legacy_format();
+        test_block_bounds_survive_reencoding();
+        test_cursor_skipping();
+        test_rejects_bad_input();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
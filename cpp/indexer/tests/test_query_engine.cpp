@@ -0,0 +1,164 @@
+#include "../src/query_engine.hpp"
+#include <iostream>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+using indexer::Posting;
+using indexer::ScoredDoc;
+
+// Same arithmetic as the Python ranker's scoring loop, kept deliberately naive.
+std::map<uint32_t, double> reference_scores(const std::vector<std::vector<Posting>>& lists,
+                                            const std::map<uint32_t, uint32_t>& lengths,
+                                            uint64_t N, double avgdl) {
+    const double k1 = 1.5, b = 0.75;
+    std::map<uint32_t, double> scores;
+    for (const auto& list : lists) {
+        if (list.empty()) continue;
+        double n = static_cast<double>(list.size());
+        double idf = std::log((N - n + 0.5) / (n + 0.5) + 1);
+        for (const auto& p : list) {
+            auto it = lengths.find(p.doc_id);
+            double dl = it != lengths.end() ? it->second : avgdl;
+            scores[p.doc_id] += idf * p.tf * (k1 + 1) / (p.tf + k1 * (1 - b + b * (dl / avgdl)));
+        }
+    }
+    return scores;
+}
+
+void test_matches_reference_bm25() {
+    std::vector<std::vector<Posting>> lists = {
+        {{1, 3}, {4, 1}, {9, 2}},
+        {{2, 1}, {4, 5}},
+        {{4, 1}, {9, 1}, {12, 7}},
+    };
+    std::map<uint32_t, uint32_t> lengths = {{1, 50}, {2, 10}, {4, 200}, {9, 80}};  // 12 is unknown
+    std::vector<const std::vector<Posting>*> term_postings = {&lists[0], &lists[1], &lists[2]};
+    auto lookup = [&](uint32_t doc) -> uint32_t {
+        auto it = lengths.find(doc);
+        return it != lengths.end() ? it->second : 0;
+    };
+
+    auto results = indexer::bm25_search(term_postings, lookup, {100, 90.0}, 10);
+    auto expected = reference_scores(lists, lengths, 100, 90.0);
+
+    ASSERT(results.size() == expected.size(), "Every candidate should be returned when k is large");
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT(std::fabs(results[i].score - expected[results[i].doc_id]) < 1e-9, "Score should match reference BM25");
+        if (i > 0) ASSERT(results[i - 1].score >= results[i].score, "Results should be best first");
+    }
+    std::cout << "test_matches_reference_bm25 passed" << std::endl;
+}
+
+void test_keeps_only_top_k() {
+    std::vector<Posting> list;
+    for (uint32_t doc = 1; doc <= 1000; ++doc) {
+        list.push_back({doc, doc % 17 + 1});
+    }
+    std::vector<const std::vector<Posting>*> term_postings = {&list};
+    auto constant_length = [](uint32_t) -> uint32_t { return 100; };
+
+    auto results = indexer::bm25_search(term_postings, constant_length, {5000, 100.0}, 5);
+    ASSERT(results.size() == 5, "Should return exactly k results");
+    for (const auto& doc : results) {
+        ASSERT(doc.doc_id % 17 == 16, "Top results should be the docs with the highest TF");
+    }
+    ASSERT(results[0].doc_id == 16 && results[4].doc_id == 84, "Ties should be broken by lower doc ID");
+    std::cout << "test_keeps_only_top_k passed" << std::endl;
+}
+
+void test_empty_inputs() {
+    std::vector<Posting> empty;
+    std::vector<const std::vector<Posting>*> term_postings = {&empty};
+    auto no_length = [](uint32_t) -> uint32_t { return 0; };
+    ASSERT(indexer::bm25_search(term_postings, no_length, {10, 10.0}, 10).empty(), "No postings should give no results");
+
+    std::vector<Posting> list = {{1, 1}};
+    term_postings = {&list};
+    ASSERT(indexer::bm25_search(term_postings, no_length, {10, 10.0}, 0).empty(), "k = 0 should give no results");
+    std::cout << "test_empty_inputs passed" << std::endl;
+}
+
+// Random lists with skewed lengths, mimicking a mix of rare and common terms.
+std::vector<std::vector<Posting>> random_lists(std::mt19937& rng, const std::vector<uint32_t>& lengths_by_doc,
+                                               const std::vector<double>& densities) {
+    std::vector<std::vector<Posting>> lists;
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::uniform_int_distribution<uint32_t> tf_dist(1, 12);
+    for (double density : densities) {
+        std::vector<Posting> list;
+        for (uint32_t doc = 1; doc < lengths_by_doc.size(); ++doc) {
+            if (coin(rng) < density) list.push_back({doc, tf_dist(rng), lengths_by_doc[doc]});
+        }
+        lists.push_back(list);
+    }
+    return lists;
+}
+
+void test_block_max_wand_matches_exhaustive() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> len_dist(20, 2000);
+    std::vector<uint32_t> lengths(20000);
+    for (auto& len : lengths) len = len_dist(rng);
+    auto lookup = [&](uint32_t doc) -> uint32_t { return lengths[doc]; };
+    indexer::CollectionStats stats{lengths.size(), 1000.0};
+
+    const std::vector<std::vector<double>> queries = {
+        {0.5}, {0.6, 0.001}, {0.3, 0.05, 0.002}, {0.9, 0.8}, {0.01, 0.02, 0.4, 0.7},
+    };
+    for (const auto& densities : queries) {
+        auto lists = random_lists(rng, lengths, densities);
+        std::vector<const std::vector<Posting>*> term_postings;
+        std::vector<std::string> encoded;
+        for (const auto& list : lists) {
+            term_postings.push_back(&list);
+            encoded.push_back(indexer::encode_postings(list));
+        }
+
+        for (size_t k : {1, 10, 100}) {
+            indexer::SearchStats exhaustive_stats, wand_stats;
+            auto expected = indexer::bm25_search(term_postings, lookup, stats, k, {}, &exhaustive_stats);
+
+            std::vector<indexer::PostingCursor> cursors;
+            for (const auto& value : encoded) cursors.emplace_back(value);
+            auto actual = indexer::bm25_search_block_max_wand(cursors, lookup, stats, k, {}, &wand_stats);
+
+            ASSERT(actual.size() == expected.size(), "BMW should return as many results as exhaustive search");
+            for (size_t i = 0; i < actual.size(); ++i) {
+                ASSERT(actual[i].doc_id == expected[i].doc_id, "BMW should return the same documents in order");
+                ASSERT(std::fabs(actual[i].score - expected[i].score) < 1e-9, "BMW scores should match");
+            }
+            ASSERT(wand_stats.docs_scored <= exhaustive_stats.docs_scored, "BMW should never score more documents");
+            if (densities.size() > 1 && k == 10) {
+                ASSERT(wand_stats.docs_scored < exhaustive_stats.docs_scored, "BMW should prune on multi-term queries");
+            }
+        }
+    }
+    std::cout << "test_block_max_wand_matches_exhaustive passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_matches_reference_bm25();
+        test_keeps_only_top_k();
+        test_empty_inputs();
+        test_block_max_wand_matches_exhaustive();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
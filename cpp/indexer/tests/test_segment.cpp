@@ -0,0 +1,541 @@
+#include "../src/doc_length_table.hpp"
+#include "../src/query_engine.hpp"
+#include "../src/segment.hpp"
+#include "../src/segment_writer.hpp"
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+using indexer::Posting;
+using TermFreqs = std::vector<std::pair<std::string, uint32_t>>;
+
+struct Doc {
+    uint32_t doc_id;
+    uint32_t length;
+    TermFreqs term_freqs;
+};
+
+// Random documents over a small vocabulary, so terms repeat across docs and segments.
+std::vector<Doc> random_docs(size_t count, uint32_t first_id, std::mt19937& rng) {
+    std::uniform_int_distribution<int> word(0, 199), terms_per_doc(1, 30), tf(1, 5);
+    std::vector<Doc> docs;
+    for (size_t i = 0; i < count; ++i) {
+        std::map<std::string, uint32_t> counts;
+        int n = terms_per_doc(rng);
+        for (int t = 0; t < n; ++t) counts["term" + std::to_string(word(rng))] += tf(rng);
+        Doc doc{first_id + static_cast<uint32_t>(i), 0, {}};
+        for (const auto& [term, count] : counts) {
+            doc.term_freqs.emplace_back(term, count);
+            doc.length += count;
+        }
+        docs.push_back(doc);
+    }
+    return docs;
+}
+
+// Expected index contents. Re-indexing a doc replaces it outright: its length, and its postings,
+// including those of terms the new version no longer has.
+struct Reference {
+    std::map<uint32_t, Doc> docs;
+    std::map<std::string, std::map<uint32_t, uint32_t>> terms;
+
+    void add(const Doc& doc) {
+        auto old = docs.find(doc.doc_id);
+        if (old != docs.end()) {
+            for (const auto& term_freq : old->second.term_freqs) {
+                terms[term_freq.first].erase(doc.doc_id);
+                if (terms[term_freq.first].empty()) terms.erase(term_freq.first);
+            }
+        }
+        docs[doc.doc_id] = doc;
+        for (const auto& [term, tf] : doc.term_freqs) terms[term][doc.doc_id] = tf;
+    }
+
+    std::map<std::string, std::vector<Posting>> postings() const {
+        std::map<std::string, std::vector<Posting>> lists;
+        for (const auto& [term, tfs] : terms) {
+            for (const auto& [doc_id, tf] : tfs) lists[term].push_back({doc_id, tf});
+        }
+        return lists;
+    }
+};
+
+void add_all(indexer::SegmentBuilder& builder, const std::vector<Doc>& docs, Reference* reference = nullptr) {
+    for (const auto& doc : docs) {
+        builder.add_document(doc.doc_id, doc.length, doc.term_freqs);
+        if (reference) reference->add(doc);
+    }
+}
+
+bool same_postings(const std::vector<Posting>& a, const std::vector<Posting>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].doc_id != b[i].doc_id || a[i].tf != b[i].tf) return false;
+    }
+    return true;
+}
+
+// Every term of reference resolves to the same postings in snapshot, and every doc to its length.
+void check_snapshot(const indexer::IndexSnapshot& snapshot, const Reference& reference) {
+    std::string scratch;
+    for (const auto& [term, expected] : reference.postings()) {
+        auto actual = indexer::decode_postings(snapshot.postings(term, scratch));
+        ASSERT(same_postings(actual, expected), "Snapshot postings should match the reference for " + term);
+    }
+    ASSERT(snapshot.postings("absent", scratch).empty(), "Unknown terms should have no postings");
+    for (const auto& [doc_id, doc] : reference.docs) {
+        ASSERT(snapshot.doc_length(doc_id) == doc.length, "Snapshot should return the newest doc length");
+    }
+}
+
+std::vector<indexer::ScoredDoc> search(const indexer::IndexSnapshot& snapshot, const std::vector<std::string>& terms) {
+    std::vector<std::string> buffers(terms.size());
+    std::vector<indexer::PostingCursor> cursors;
+    for (size_t i = 0; i < terms.size(); ++i) cursors.emplace_back(snapshot.postings(terms[i], buffers[i]));
+    auto doc_length = [&snapshot](uint32_t doc_id) { return snapshot.doc_length(doc_id); };
+    return indexer::bm25_search_block_max_wand(cursors, doc_length, {1000, 40.0}, 10);
+}
+
+void test_builder_writes_sorted_segment() {
+    std::string path = "test_segment_builder.seg";
+    indexer::SegmentBuilder builder;
+    builder.add_document(9, 4, {{"beta", 1}, {"gamma", 3}});
+    builder.add_document(2, 7, {{"alpha", 2}, {"beta", 5}});
+    builder.add_document(5, 1, {{"beta", 1}, {"delta", 1}});
+    builder.add_document(2, 3, {{"beta", 3}});  // Re-indexed without alpha: replaces the earlier postings
+    ASSERT(builder.doc_count() == 4 && builder.ram_bytes() > 0, "Builder should account for what it buffers");
+
+    builder.write(path);
+    ASSERT(builder.empty() && builder.ram_bytes() == 0, "write() should clear the builder");
+    ASSERT(!std::filesystem::exists(path + ".tmp"), "The temporary file should be renamed into place");
+
+    indexer::Segment segment(path);
+    ASSERT(segment.term_count() == 3, "Segment should hold each distinct live term once");
+    ASSERT(segment.terms().term(0) == "beta" && segment.terms().term(1) == "delta" &&
+           segment.terms().term(2) == "gamma", "Dictionary should be sorted");
+    ASSERT(segment.term_id("beta") == 0 && segment.term_id("epsilon") == indexer::NO_TERM,
+           "Term IDs should be dictionary ranks");
+    ASSERT(segment.doc_count() == 3, "Duplicate docs should collapse in the doc table");
+    ASSERT(segment.total_doc_length() == 3 + 1 + 4, "Total length should count each doc's newest length");
+    ASSERT(segment.doc_length(2) == 3 && segment.doc_length(5) == 1 && segment.doc_length(9) == 4,
+           "Doc table should hold the newest lengths");
+    ASSERT(segment.doc_length(3) == 0, "Unknown docs should have length 0");
+
+    auto beta = indexer::decode_postings(segment.postings("beta"));
+    ASSERT(same_postings(beta, {{2, 3}, {5, 1}, {9, 1}}), "Postings should be sorted with the newest tf per doc");
+    ASSERT(segment.doc_freq(0) == 3, "Dictionary should record document frequency");
+    ASSERT(segment.postings_by_id(0) == segment.postings("beta"), "Postings should be addressable by term ID");
+    ASSERT(segment.postings("epsilon").empty(), "Unknown terms should have no postings");
+    ASSERT(segment.postings("alpha").empty(), "A term only the replaced version of a doc had should be gone");
+
+    std::filesystem::remove(path);
+    std::cout << "test_builder_writes_sorted_segment passed" << std::endl;
+}
+
+void test_rejects_corrupt_segment() {
+    std::string path = "test_segment_corrupt.seg";
+    indexer::SegmentBuilder builder;
+    builder.add_document(1, 2, {{"alpha", 2}});
+    builder.write(path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+    bool threw = false;
+    try {
+        indexer::Segment segment(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "A truncated segment should be rejected");
+    std::filesystem::remove(path);
+    std::cout << "test_rejects_corrupt_segment passed" << std::endl;
+}
+
+void test_snapshot_and_merge_resolve_newest() {
+    std::mt19937 rng(22);
+    Reference reference;
+    std::vector<std::shared_ptr<const indexer::Segment>> segments;
+    for (int s = 0; s < 4; ++s) {
+        indexer::SegmentBuilder builder;
+        // Overlapping ID ranges: later segments re-index some of the earlier docs
+        add_all(builder, random_docs(300, static_cast<uint32_t>(s * 200), rng), &reference);
+        std::string path = "test_segment_merge_" + std::to_string(s) + ".seg";
+        builder.write(path);
+        segments.push_back(std::make_shared<const indexer::Segment>(path));
+    }
+
+    indexer::IndexSnapshot snapshot(1, segments);
+    check_snapshot(snapshot, reference);
+
+    std::string merged_path = "test_segment_merged.seg";
+    indexer::merge_segments(segments, merged_path);
+    indexer::IndexSnapshot merged(2, {std::make_shared<const indexer::Segment>(merged_path)});
+    check_snapshot(merged, reference);
+    ASSERT(merged.segments()[0]->doc_count() == reference.docs.size(), "Merged doc table should hold each doc once");
+
+    // Rebuilt blocks carry exact lengths, so their bounds are as tight as a fresh segment's
+    std::string scratch;
+    indexer::PostingCursor cursor(merged.postings("term7", scratch));
+    cursor.for_each_block([&](const indexer::PostingBlockHeader& block) {
+        ASSERT(block.min_doc_len > 0, "Merged blocks should keep a doc length bound");
+    });
+
+    for (const auto& query : std::vector<std::vector<std::string>>{{"term1"}, {"term3", "term50"}, {"term9", "term9", "term120"}}) {
+        auto expected = search(snapshot, query);
+        auto actual = search(merged, query);
+        ASSERT(actual.size() == expected.size(), "Merging should not change results");
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT(actual[i].doc_id == expected[i].doc_id && std::fabs(actual[i].score - expected[i].score) < 1e-9,
+                   "Merging should not change results");
+        }
+    }
+
+    for (const auto& segment : segments) std::filesystem::remove(segment->path());
+    std::filesystem::remove(merged_path);
+    std::cout << "test_snapshot_and_merge_resolve_newest passed" << std::endl;
+}
+
+void test_snapshot_term_statistics() {
+    std::vector<std::shared_ptr<const indexer::Segment>> segments;
+    std::vector<std::vector<Doc>> batches = {
+        {{1, 3, {{"search", 1}, {"seat", 2}}}, {2, 2, {{"search", 2}}}},
+        {{3, 4, {{"sea", 1}, {"search", 3}}}, {4, 1, {{"zebra", 1}}}},
+    };
+    for (size_t s = 0; s < batches.size(); ++s) {
+        indexer::SegmentBuilder builder;
+        add_all(builder, batches[s]);
+        std::string path = "test_segment_stats_" + std::to_string(s) + ".seg";
+        builder.write(path);
+        segments.push_back(std::make_shared<const indexer::Segment>(path));
+    }
+    indexer::IndexSnapshot snapshot(1, segments);
+
+    ASSERT(snapshot.doc_freq("search") == 3 && snapshot.doc_freq("sea") == 1 && snapshot.doc_freq("absent") == 0,
+           "Doc freqs should sum over segments");
+    ASSERT(snapshot.doc_count() == 4 && snapshot.total_doc_length() == 10, "Collection stats should sum footers");
+
+    auto terms = snapshot.terms_with_prefix("sea", 10);
+    ASSERT(terms.size() == 3 && terms[0].first == "sea" && terms[1].first == "search" && terms[2].first == "seat",
+           "Prefix enumeration should merge segments in order");
+    ASSERT(terms[1].second == 3, "A term in several segments should be listed once with its summed doc freq");
+    ASSERT(snapshot.terms_with_prefix("sea", 2).size() == 2, "Enumeration should stop at the limit");
+    ASSERT(snapshot.terms_with_prefix("", 10).size() == 4, "An empty prefix should list every term");
+    ASSERT(snapshot.terms_with_prefix("x", 10).empty(), "No term should match an absent prefix");
+
+    std::vector<std::string> range;
+    snapshot.for_each_term("seat", "zebra", [&](std::string_view term, uint64_t) {
+        range.emplace_back(term);
+        return true;
+    });
+    ASSERT(range == std::vector<std::string>{"seat"}, "Ranges should include the low bound and exclude the high one");
+
+    for (const auto& segment : segments) std::filesystem::remove(segment->path());
+    std::cout << "test_snapshot_term_statistics passed" << std::endl;
+}
+
+// A doc re-indexed without a term must stop matching it, whether the versions sit in separate
+// segments or a merge has combined them.
+void test_reindexed_doc_drops_terms() {
+    std::vector<std::shared_ptr<const indexer::Segment>> segments;
+    std::vector<std::vector<Doc>> batches = {
+        {{1, 10, {{"alpha", 4}, {"beta", 6}}}, {2, 4, {{"alpha", 1}, {"beta", 3}}}},
+        {{1, 5, {{"beta", 5}}}, {3, 2, {{"gamma", 2}}}},
+    };
+    Reference reference;
+    for (size_t s = 0; s < batches.size(); ++s) {
+        indexer::SegmentBuilder builder;
+        add_all(builder, batches[s], &reference);
+        std::string path = "test_segment_reindex_" + std::to_string(s) + ".seg";
+        builder.write(path);
+        segments.push_back(std::make_shared<const indexer::Segment>(path));
+    }
+
+    indexer::IndexSnapshot snapshot(1, segments);
+    check_snapshot(snapshot, reference);
+    std::string scratch;
+    ASSERT(same_postings(indexer::decode_postings(snapshot.postings("alpha", scratch)), {{2, 1}}),
+           "The old version's postings should be masked at query time");
+    ASSERT(snapshot.doc_count() == 3 && snapshot.total_doc_length() == 4 + 5 + 2,
+           "Collection stats should count the re-indexed doc once, at its new length");
+    auto results = search(snapshot, {"alpha"});
+    ASSERT(results.size() == 1 && results[0].doc_id == 2, "The re-indexed doc should no longer match alpha");
+
+    std::string merged_path = "test_segment_reindex_merged.seg";
+    indexer::merge_segments(segments, merged_path);
+    indexer::IndexSnapshot merged(2, {std::make_shared<const indexer::Segment>(merged_path)});
+    check_snapshot(merged, reference);
+    indexer::PostingCursor cursor(merged.postings("beta", scratch));
+    cursor.for_each_block([&](const indexer::PostingBlockHeader& block) {
+        ASSERT(block.min_doc_len == 4, "Merged bounds should use the docs' current lengths");
+    });
+    ASSERT(merged.segments()[0]->doc_freq(merged.segments()[0]->term_id("alpha")) == 1,
+           "Merged doc freqs should leave the dropped posting out");
+
+    // A term only the old version had disappears from the merged dictionary
+    indexer::SegmentBuilder builder;
+    builder.add_document(7, 3, {{"omega", 3}});
+    builder.write("test_segment_reindex_2.seg");
+    segments.push_back(std::make_shared<const indexer::Segment>("test_segment_reindex_2.seg"));
+    builder.add_document(7, 2, {{"beta", 2}});
+    builder.write("test_segment_reindex_3.seg");
+    segments.push_back(std::make_shared<const indexer::Segment>("test_segment_reindex_3.seg"));
+    indexer::merge_segments(segments, merged_path);
+    indexer::Segment remerged(merged_path);
+    ASSERT(remerged.term_id("omega") == indexer::NO_TERM, "Terms left without postings should be dropped");
+    ASSERT(remerged.doc_count() == 4 && remerged.doc_length(7) == 2, "The doc table should keep the newest length");
+
+    for (const auto& segment : segments) std::filesystem::remove(segment->path());
+    std::filesystem::remove(merged_path);
+    std::cout << "test_reindexed_doc_drops_terms passed" << std::endl;
+}
+
+void test_find_merge_policy() {
+    indexer::MergePolicy policy{3, 100};
+    ASSERT(!indexer::find_merge({50, 60}, policy), "Fewer than merge_factor segments should not merge");
+    auto range = indexer::find_merge({5000, 50, 60, 70}, policy);
+    ASSERT(range && range->first == 1 && range->second == 4, "A run of small segments should merge");
+    ASSERT(!indexer::find_merge({50, 5000, 60, 70}, policy), "Only adjacent segments merge");
+    range = indexer::find_merge({250, 280, 90, 260}, policy);
+    ASSERT(range && range->first == 0 && range->second == 4, "A tier should absorb smaller segments in between");
+    range = indexer::find_merge({250, 280, 290, 10, 20, 30}, policy);
+    ASSERT(range && range->first == 3 && range->second == 6, "The smallest tier should merge first");
+    ASSERT(!indexer::find_merge({250, 10, 20}, {1, 100}), "A merge factor below 2 disables merging");
+    std::cout << "test_find_merge_policy passed" << std::endl;
+}
+
+void test_index_writer_publishes_and_merges() {
+    std::string dir = "test_segment_index";
+    std::filesystem::remove_all(dir);
+    std::mt19937 rng(7);
+    Reference reference;
+    {
+        indexer::IndexWriter writer(dir, {3, 1}, false);
+        for (int s = 0; s < 7; ++s) {
+            indexer::SegmentBuilder builder;
+            add_all(builder, random_docs(50, static_cast<uint32_t>(s * 40), rng), &reference);
+            writer.flush(builder);
+        }
+        indexer::IndexSnapshot before = writer.snapshot();
+        ASSERT(before.segments().size() == 7 && before.generation() == 7, "Each flush should publish a generation");
+        check_snapshot(indexer::open_index_snapshot(dir), reference);
+
+        writer.maybe_merge();
+        indexer::IndexSnapshot after = writer.snapshot();
+        ASSERT(after.segments().size() < 7, "maybe_merge should merge a run of flushed segments");
+        ASSERT(std::filesystem::exists(before.segments()[0]->path()) == false, "Merged-away files should be deleted");
+        check_snapshot(before, reference);  // Old snapshots keep reading their mapped segments
+        check_snapshot(indexer::open_index_snapshot(dir), reference);
+    }
+
+    // Debris from an interrupted flush is cleaned up and never reused
+    std::ofstream(dir + "/seg_00000099.seg.tmp") << "partial";
+    {
+        indexer::IndexWriter writer(dir, {3, 1}, false);
+        ASSERT(!std::filesystem::exists(dir + "/seg_00000099.seg.tmp"), "Unlisted segment files should be removed");
+        indexer::SegmentBuilder builder;
+        add_all(builder, random_docs(20, 5, rng), &reference);
+        writer.flush(builder);
+        ASSERT(writer.snapshot().segments().back()->path() == dir + "/seg_00000100.seg",
+               "Numbering should continue past every file seen");
+
+        writer.force_merge();
+        indexer::IndexSnapshot merged = writer.snapshot();
+        ASSERT(merged.segments().size() == 1, "force_merge should leave one segment");
+        check_snapshot(merged, reference);
+    }
+    indexer::IndexSnapshot reopened = indexer::open_index_snapshot(dir);
+    ASSERT(reopened.segments().size() == 1, "The manifest should list the merged segment");
+    check_snapshot(reopened, reference);
+
+    std::filesystem::remove_all(dir);
+    std::cout << "test_index_writer_publishes_and_merges passed" << std::endl;
+}
+
+// A flush that cannot publish keeps the builder's documents, so the caller can retry it.
+void test_failed_flush_keeps_builder() {
+    std::string dir = "test_segment_failed_flush";
+    std::filesystem::remove_all(dir);
+    indexer::IndexWriter writer(dir, {3, 1}, false);
+    uint64_t generation = writer.snapshot().generation();
+    indexer::SegmentBuilder builder;
+    for (uint32_t doc_id = 1; doc_id <= 10; ++doc_id) builder.add_document(doc_id, doc_id, {{"term", 1}});
+
+    std::filesystem::create_directory(dir + "/" + indexer::SEGMENT_MANIFEST_NAME + ".tmp");  // Blocks the manifest
+    bool threw = false;
+    try {
+        writer.flush(builder);
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    ASSERT(threw && builder.doc_count() == 10, "A failed flush should leave the builder intact");
+    ASSERT(writer.snapshot().generation() == generation && writer.snapshot().segments().empty(),
+           "A failed flush should publish nothing");
+
+    std::filesystem::remove(dir + "/" + indexer::SEGMENT_MANIFEST_NAME + ".tmp");
+    writer.flush(builder);
+    ASSERT(builder.empty() && writer.snapshot().doc_count() == 10, "The retried flush should publish every doc");
+    ASSERT(writer.snapshot().segments().size() == 1, "Only the retried segment should be left");
+
+    std::filesystem::remove_all(dir);
+    std::cout << "test_failed_flush_keeps_builder passed" << std::endl;
+}
+
+// The table's lengths and stats match reference, and its generation the writer's manifest.
+void check_doc_lengths(const std::string& dir, const Reference& reference, uint64_t generation) {
+    indexer::DocLengthTable table(dir + "/" + indexer::DOC_LENGTH_TABLE_NAME);
+    ASSERT(table.generation() == generation, "The doc length table should match the manifest generation");
+    uint64_t total = 0;
+    for (const auto& [doc_id, doc] : reference.docs) {
+        ASSERT(table.length(doc_id) == doc.length, "The doc length table should hold the newest length");
+        total += doc.length;
+    }
+    ASSERT(table.doc_count() == reference.docs.size() && table.total_doc_length() == total,
+           "The doc length table should count each doc once");
+}
+
+void test_doc_length_table() {
+    std::string dir = "test_segment_lengths";
+    std::filesystem::remove_all(dir);
+    std::mt19937 rng(24);
+    Reference reference;
+    {
+        indexer::IndexWriter writer(dir, {3, 1}, false);
+        check_doc_lengths(dir, reference, 0);
+        indexer::SegmentBuilder builder;
+        add_all(builder, random_docs(100, 1, rng), &reference);
+        writer.flush(builder);
+        check_doc_lengths(dir, reference, 1);
+
+        // A reader mapped before later flushes sees their lengths in place
+        indexer::DocLengthTable live(dir + "/" + indexer::DOC_LENGTH_TABLE_NAME);
+        add_all(builder, random_docs(100, 50, rng), &reference);  // Re-indexes docs 50..100
+        writer.flush(builder);
+        check_doc_lengths(dir, reference, 2);
+        ASSERT(live.length(75) == reference.docs[75].length && live.doc_count() == reference.docs.size(),
+               "An open mapping should see in-place updates");
+
+        // Doc IDs past the current capacity grow the file
+        add_all(builder, random_docs(3, 200000, rng), &reference);
+        writer.flush(builder);
+        check_doc_lengths(dir, reference, 3);
+        ASSERT(live.length(200001) == 0, "An old mapping should read IDs past its capacity as absent");
+
+        writer.force_merge();
+        check_doc_lengths(dir, reference, 4);
+    }
+
+    // A table that missed a publish (crash before its generation was written) is rebuilt
+    {
+        std::fstream file(dir + "/" + indexer::DOC_LENGTH_TABLE_NAME, std::ios::binary | std::ios::in | std::ios::out);
+        uint64_t stale = 3;
+        file.seekp(indexer::DOC_LENGTH_GENERATION_OFFSET);
+        file.write(reinterpret_cast<const char*>(&stale), sizeof(stale));
+    }
+    { indexer::IndexWriter writer(dir, {3, 1}, false); }
+    check_doc_lengths(dir, reference, 4);
+
+    // So is a missing one, e.g. for an index written before the table existed
+    std::filesystem::remove(dir + "/" + indexer::DOC_LENGTH_TABLE_NAME);
+    {
+        indexer::IndexWriter writer(dir, {3, 1}, false);
+        indexer::SegmentBuilder builder;
+        add_all(builder, random_docs(10, 300, rng), &reference);
+        writer.flush(builder);
+    }
+    check_doc_lengths(dir, reference, 5);
+
+    std::filesystem::remove_all(dir);
+    std::cout << "test_doc_length_table passed" << std::endl;
+}
+
+// Docs with no tokens are left out of N both by the table and the segments' stats
+void test_empty_docs_collection_stats() {
+    std::string dir = "test_segment_empty_docs";
+    std::filesystem::remove_all(dir);
+    indexer::IndexWriter writer(dir, {3, 1}, false);
+    indexer::DocLengthTable table(dir + "/" + indexer::DOC_LENGTH_TABLE_NAME);
+    auto check = [&](uint64_t doc_count, uint64_t total, const char* message) {
+        indexer::IndexSnapshot snapshot = writer.snapshot();
+        ASSERT(snapshot.doc_count() == doc_count && snapshot.total_doc_length() == total, message);
+        ASSERT(table.doc_count() == doc_count && table.total_doc_length() == total, message);
+    };
+
+    indexer::SegmentBuilder builder;
+    builder.add_document(1, 5, {{"alpha", 5}});
+    builder.add_document(2, 0, {});
+    builder.add_document(3, 2, {{"beta", 2}});
+    writer.flush(builder);
+    check(2, 7, "A doc indexed with no tokens should not count");
+
+    builder.add_document(1, 0, {});  // Re-indexed empty: its old version is superseded
+    builder.add_document(2, 3, {{"gamma", 3}});
+    writer.flush(builder);
+    check(2, 5, "Re-indexing to or from an empty doc should move it in or out of the count");
+    ASSERT(writer.snapshot().doc_length(1) == 0, "An empty newest version should win over an older length");
+
+    writer.force_merge();
+    check(2, 5, "Merging should keep the counts");
+
+    std::filesystem::remove_all(dir);
+    std::cout << "test_empty_docs_collection_stats passed" << std::endl;
+}
+
+void test_background_merges() {
+    std::string dir = "test_segment_background";
+    std::filesystem::remove_all(dir);
+    std::mt19937 rng(11);
+    Reference reference;
+    indexer::IndexWriter writer(dir, {4, 1 << 20}, true);  // Every segment is in the smallest tier
+    for (int s = 0; s < 16; ++s) {
+        indexer::SegmentBuilder builder;
+        add_all(builder, random_docs(30, static_cast<uint32_t>(s * 30), rng), &reference);
+        writer.flush(builder);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (writer.snapshot().segments().size() >= 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT(writer.snapshot().segments().size() < 4, "The merge thread should merge flushed segments");
+    check_snapshot(writer.snapshot(), reference);
+
+    std::filesystem::remove_all(dir);
+    std::cout << "test_background_merges passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_builder_writes_sorted_segment();
+        test_rejects_corrupt_segment();
+        test_snapshot_and_merge_resolve_newest();
+        test_snapshot_term_statistics();
+        test_reindexed_doc_drops_terms();
+        test_find_merge_policy();
+        test_index_writer_publishes_and_merges();
+        test_failed_flush_keeps_builder();
+        test_doc_length_table();
+        test_empty_docs_collection_stats();
+        test_background_merges();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
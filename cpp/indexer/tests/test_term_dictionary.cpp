@@ -0,0 +1,167 @@
+#include "../src/term_dictionary.hpp"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// Simple assertion macro
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "Assertion failed: " << (message) << "\n" \
+                      << "File: " << __FILE__ << ", Line: " << __LINE__ << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+struct BuiltDictionary {
+    indexer::TermDictionaryBuilder builder;
+    indexer::TermDictionary dict;
+
+    explicit BuiltDictionary(const std::vector<std::string>& terms) {
+        for (const auto& term : terms) builder.add(term);
+        dict = indexer::TermDictionary(builder.blocks(), builder.block_index(), builder.size());
+    }
+};
+
+// Sorted random words over a small alphabet, so neighbours share long prefixes.
+std::vector<std::string> random_vocabulary(size_t count, std::mt19937& rng) {
+    std::uniform_int_distribution<int> letter('a', 'e'), length(1, 9);
+    std::set<std::string> words;
+    while (words.size() < count) {
+        std::string word;
+        for (int i = length(rng); i > 0; --i) word.push_back(static_cast<char>(letter(rng)));
+        words.insert(word);
+    }
+    return {words.begin(), words.end()};
+}
+
+void test_lookup_and_iteration() {
+    std::mt19937 rng(23);
+    std::vector<std::string> terms = random_vocabulary(1000, rng);
+    BuiltDictionary built(terms);
+    const indexer::TermDictionary& dict = built.dict;
+    ASSERT(dict.size() == terms.size(), "Dictionary should hold every term");
+
+    size_t raw_bytes = 0;
+    for (const auto& term : terms) raw_bytes += term.size() + 1;
+    ASSERT(built.builder.blocks().size() < raw_bytes, "Front coding should shrink sorted terms");
+
+    uint32_t id = 0;
+    for (auto it = dict.begin(); it.valid(); it.next(), ++id) {
+        ASSERT(it.id() == id && it.term() == terms[id], "Iteration should visit terms in ID order");
+    }
+    ASSERT(id == terms.size(), "Iteration should stop after the last term");
+
+    for (uint32_t i = 0; i < terms.size(); ++i) {
+        ASSERT(dict.find(terms[i]) == i, "Every term should be found at its rank: " + terms[i]);
+        ASSERT(dict.term(i) == terms[i], "Term IDs should map back to their terms");
+    }
+
+    // Probes between, before and after the stored terms
+    for (const std::string probe : {"", "a", "aaaaaaaaaa", "abz", "ca", "eeeeeeeeef", "f", "zzz"}) {
+        uint32_t expected = static_cast<uint32_t>(std::lower_bound(terms.begin(), terms.end(), probe) - terms.begin());
+        ASSERT(dict.lower_bound(probe) == expected, "lower_bound should match the sorted vocabulary for " + probe);
+        bool present = expected < terms.size() && terms[expected] == probe;
+        ASSERT(dict.find(probe) == (present ? expected : indexer::NO_TERM), "find should report absent terms");
+    }
+    std::cout << "test_lookup_and_iteration passed" << std::endl;
+}
+
+void test_prefix_and_range() {
+    std::mt19937 rng(24);
+    std::vector<std::string> terms = random_vocabulary(500, rng);
+    BuiltDictionary built(terms);
+    const indexer::TermDictionary& dict = built.dict;
+
+    for (const std::string prefix : {"", "a", "bc", "dda", "eeee", "x"}) {
+        auto [first, last] = dict.prefix_range(prefix);
+        size_t expected = std::count_if(terms.begin(), terms.end(),
+                                        [&](const std::string& t) { return t.compare(0, prefix.size(), prefix) == 0; });
+        ASSERT(last - first == expected, "Prefix range should cover every term with the prefix: " + prefix);
+        for (uint32_t i = first; i < last; ++i) {
+            ASSERT(terms[i].compare(0, prefix.size(), prefix) == 0, "Prefix range should hold only matching terms");
+        }
+    }
+
+    auto [first, last] = dict.range("b", "d");
+    for (uint32_t i = 0; i < terms.size(); ++i) {
+        bool inside = terms[i] >= "b" && terms[i] < "d";
+        ASSERT(inside == (i >= first && i < last), "Range should be [low, high)");
+    }
+    ASSERT(dict.range("d", "b").first == dict.range("d", "b").second, "An inverted range should be empty");
+    ASSERT(indexer::TermDictionary::prefix_successor("ab\xff\xff") == "ac", "Successor should skip 0xFF bytes");
+    ASSERT(indexer::TermDictionary::prefix_successor("\xff").empty(), "An all-0xFF prefix has no successor");
+    std::cout << "test_prefix_and_range passed" << std::endl;
+}
+
+void test_block_edges() {
+    for (size_t count : {0, 1, 15, 16, 17, 32, 33}) {
+        std::vector<std::string> terms;
+        for (size_t i = 0; i < count; ++i) terms.push_back("term" + std::to_string(1000 + i));
+        BuiltDictionary built(terms);
+        ASSERT(built.builder.block_index().size() == 4 * ((count + 15) / 16), "One index entry per block");
+        for (uint32_t i = 0; i < count; ++i) {
+            ASSERT(built.dict.find(terms[i]) == i && built.dict.seek(i).term() == terms[i],
+                   "Terms at block edges should be found");
+        }
+        ASSERT(built.dict.lower_bound("zzz") == count, "Past the last term should be size()");
+        ASSERT(!built.dict.seek(static_cast<uint32_t>(count)).valid(), "Seeking past the end should be invalid");
+    }
+    std::cout << "test_block_edges passed" << std::endl;
+}
+
+void test_rejects_bad_input() {
+    indexer::TermDictionaryBuilder builder;
+    builder.add("beta");
+    bool threw = false;
+    try {
+        builder.add("alpha");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT(threw, "Out of order terms should be rejected");
+
+    threw = false;
+    try {
+        indexer::TermDictionary dict(builder.blocks(), builder.block_index(), 17);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "A block index that does not match the term count should be rejected");
+
+    // A shared prefix longer than the previous term is corrupt
+    std::string blocks;
+    indexer::put_varint32(blocks, 1);
+    blocks += "a";
+    indexer::put_varint32(blocks, 5);
+    indexer::put_varint32(blocks, 1);
+    blocks += "b";
+    std::string index;
+    indexer::put_fixed32(index, 0);
+    indexer::TermDictionary corrupt(blocks, index, 2);
+    threw = false;
+    try {
+        corrupt.find("b");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Corrupt front coding should be rejected");
+    std::cout << "test_rejects_bad_input passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_lookup_and_iteration();
+        test_prefix_and_range();
+        test_block_edges();
+        test_rejects_bad_input();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
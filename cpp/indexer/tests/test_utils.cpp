@@ -1,5 +1,10 @@
 #include "../src/utils.hpp"
+#include "../src/gzip_decompressor.hpp"
+#include "../src/tokenizer.hpp"
+#include "../src/html_extractor.hpp"
+#include <functional>
 #include <iostream>
+#include <random>
 #include <cassert>
 #include <vector>
 #include <string>
@@ -41,6 +46,53 @@ void test_tokenize_special_chars() {
     std::cout << "test_tokenize_special_chars passed" << std::endl;
 }
 
+// The byte-at-a-time tokenizer the SIMD one replaced; outputs must match it exactly.
+std::vector<std::string> reference_tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string token;
+    for (char c : text) {
+        if (isalnum(static_cast<unsigned char>(c))) {
+            token += tolower(static_cast<unsigned char>(c));
+        } else if (!token.empty()) {
+            if (token.length() > 2) tokens.push_back(token);
+            token = "";
+        }
+    }
+    if (!token.empty() && token.length() > 2) tokens.push_back(token);
+    return tokens;
+}
+
+void test_tokenizer_matches_reference() {
+    // Letters around the case boundaries, digits, punctuation, and UTF-8 bytes, at lengths that
+    // land tokens on both sides of every block edge
+    const std::string alphabet = "AZaz09Mm@[`{/: \t\n-\xc3\xa9\xe2\x80\x94";
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<int> run(1, 9);
+    indexer::Tokenizer tokenizer;
+    for (size_t length = 0; length < 200; ++length) {
+        std::string text;
+        while (text.size() < length) {
+            char c = alphabet[pick(rng)];
+            text.append(static_cast<size_t>(run(rng)), c);
+        }
+        text.resize(length);
+        std::vector<std::string> expected = reference_tokenize(text);
+        const auto& tokens = tokenizer.tokenize(text);
+        ASSERT(tokens.size() == expected.size(), "Token count should match the reference for length " + std::to_string(length));
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            ASSERT(tokens[i] == expected[i], "Token should match the reference: " + expected[i]);
+        }
+    }
+
+    const auto& tokens = tokenizer.tokenize("Caf\xc3\xa9 MIXED case 12345 \xe2\x80\x94" "dash");
+    ASSERT(tokens.size() == 5, "UTF-8 bytes should split tokens");
+    ASSERT(tokens[0] == "caf" && tokens[1] == "mixed" && tokens[2] == "case" && tokens[3] == "12345" && tokens[4] == "dash",
+           "Tokens should be lowercased ASCII runs");
+    ASSERT(tokenizer.tokenize("").empty(), "Empty text should have no tokens");
+    std::cout << "test_tokenizer_matches_reference passed" << std::endl;
+}
+
 // --- Test: extract_content ---
 void test_clean_text_simple() {
     const char* html = "<html><body><p>Hello World</p></body></html>";
@@ -82,6 +134,138 @@ void test_extract_title() {
     std::cout << "test_extract_title passed" << std::endl;
 }
 
+// --- Test: HtmlTextExtractor ---
+// Collapses whitespace runs and trims, since the two extractors space tag boundaries differently.
+std::string normalize_space(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        bool space = c == ' ' || c == '\t' || c == '\n' || c == '\f' || c == '\r';
+        if (!space) {
+            out += c;
+        } else if (!out.empty() && out.back() != ' ') {
+            out += ' ';
+        }
+    }
+    if (!out.empty() && out.back() == ' ') out.pop_back();
+    return out;
+}
+
+// Well-formed pages built from random nested markup, entities, comments, scripts and attributes.
+std::string random_page(std::mt19937& rng) {
+    static const std::vector<std::string> words = {
+        "alpha", "Beta", "gamma42", "caf&eacute;", "fish &amp; chips", "&lt;tag&gt;", "&#8212;", "&#x263A;",
+        "&copy; 2024", "&copy 2024", "a&nbsp;b", "&quot;quoted&quot;", "x &lt y", "AT&amp;T", "&#128;", "plain"};
+    std::uniform_int_distribution<size_t> pick_word(0, words.size() - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    auto phrase = [&] {
+        std::string out;
+        for (int n = 1 + percent(rng) % 4; n > 0; --n) out += words[pick_word(rng)] + (percent(rng) < 20 ? "\n" : " ");
+        return out;
+    };
+
+    std::function<std::string(int, bool)> inline_content = [&](int depth, bool in_anchor) {
+        std::string out;
+        for (int n = 1 + percent(rng) % 4; n > 0; --n) {
+            int p = percent(rng);
+            if (depth > 3 || p < 40) {
+                out += phrase();
+            } else if (p < 50) {
+                out += "<!-- note > " + std::to_string(p) + " -->";
+            } else if (p < 55) {
+                out += "<br>";
+            } else if (p < 60) {
+                out += "<img src=\"/i.png\" alt=\"a > b\">";
+            } else if (p < 75 && !in_anchor) {
+                out += "<a href=\"/wiki/Page_" + std::to_string(p) + "?x=1&amp;y=2\" title='go > there'>" +
+                       inline_content(depth + 1, true) + "</a>";
+            } else {
+                const char* tags[] = {"span", "b", "i", "em", "strong"};
+                std::string tag = tags[p % 5];
+                out += "<" + tag + " class=\"c" + std::to_string(p) + "\">" + inline_content(depth + 1, in_anchor) +
+                       "</" + tag + ">";
+            }
+        }
+        return out;
+    };
+
+    std::function<std::string(int)> blocks = [&](int depth) {
+        std::string out;
+        for (int n = 1 + percent(rng) % 4; n > 0; --n) {
+            int p = percent(rng);
+            if (depth > 2 || p < 35) {
+                out += "<p>" + inline_content(0, false) + "</p>\n";
+            } else if (p < 50) {
+                out += "<h2 id=\"s" + std::to_string(p) + "\">" + inline_content(1, false) + "</h2>\n";
+            } else if (p < 65) {
+                out += "<ul>\n";
+                for (int i = 0; i < 1 + p % 3; ++i) out += "  <li>" + inline_content(1, false) + "</li>\n";
+                out += "</ul>\n";
+            } else if (p < 75) {
+                out += "<script>if (a < b && c > d) document.write('<p>hidden</p>');</script>\n";
+            } else {
+                out += "<div class=\"box\">" + blocks(depth + 1) + "</div>\n";
+            }
+        }
+        return out;
+    };
+
+    return "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n<meta charset=\"utf-8\">\n<title>" + phrase() +
+           "</title>\n<style>p > a { color: red; }</style>\n</head>\n<body>\n" + blocks(0) + "</body>\n</html>\n";
+}
+
+void test_html_extractor_matches_gumbo() {
+    std::vector<std::string> corpus = {
+        "<html><body><p>Hello World</p></body></html>",
+        "<html><head><title>My Title</title></head><body><p>Content</p></body></html>",
+        "<!DOCTYPE html><html><head><title>Fish &amp; Chips &mdash; Menu</title>"
+        "<script type=\"text/javascript\">var s = \"</div>\"; if (x < 3) {}</script>"
+        "<style>body > p { margin: 0 }</style></head>"
+        "<body><h1>Menu</h1><!-- nav --><p>Cod &pound;5, haddock &#163;6 &amp; chips&hellip;</p>"
+        "<table><tr><td>Mon</td><td>Closed</td></tr><tr><td>Tue&ndash;Sun</td><td>12&ndash;22</td></tr></table>"
+        "<p>Call <a href=\"tel:123\">us</a> or <b>visit</b><br>us<i>today</i>.</p>"
+        "<pre>\n  spaced   out\n</pre><textarea>&lt;raw&gt;</textarea>"
+        "<p>&#x1F600; &#65;&#x42; &euro;10 &copy 2024</p></body></html>",
+        "<p>No html or body tags, <em>just</em> a fragment",
+        "<html><head><title>   </title></head><body>Whitespace title</body></html>",
+    };
+    std::mt19937 rng(17);
+    for (int i = 0; i < 300; ++i) corpus.push_back(random_page(rng));
+
+    indexer::HtmlTextExtractor extractor;
+    for (const auto& html : corpus) {
+        GumboOutput* output = gumbo_parse(html.c_str());
+        indexer::ExtractedContent expected = indexer::extract_content(output->root);
+        gumbo_destroy_output(&kGumboDefaultOptions, output);
+
+        const indexer::ExtractedContent& actual = extractor.extract(html);
+        ASSERT(actual.title == expected.title, "Title should match Gumbo for: " + html);
+        ASSERT(normalize_space(actual.text) == normalize_space(expected.text),
+               "Text should match Gumbo for: " + html + "\nexpected: " + normalize_space(expected.text) +
+               "\nactual:   " + normalize_space(actual.text));
+    }
+    std::cout << "test_html_extractor_matches_gumbo passed" << std::endl;
+}
+
+void test_html_extractor_links_and_headings() {
+    indexer::HtmlTextExtractor extractor;
+    const indexer::ExtractedContent& content = extractor.extract(
+        "<h1>Main <span>Title</span></h1><p>See <a href=\"/a?x=1&amp;copy=2\">first <b>link</b></a>"
+        " and <A HREF=/b>second</A> or <a>no href</a>.</p><h3>Sub</h3>"
+        "<noscript>Enable JS</noscript><script>ignored()</script><p>x &lt; y<!-- gone -->z</p>");
+    ASSERT(content.links.size() == 2, "Anchors with an href should be listed");
+    ASSERT(content.links[0] == "/a?x=1&copy=2", "Href should be entity-decoded, keeping &copy= in a query");
+    ASSERT(content.links[1] == "/b", "Uppercase tags and unquoted values should be read");
+    ASSERT(normalize_space(content.headings) == "Main Title Sub", "Heading text should be collected");
+    ASSERT(normalize_space(content.anchor_text) == "first link second no href", "Anchor text should be collected");
+    ASSERT(content.text.find("Enable JS") == std::string::npos, "noscript should be skipped");
+    ASSERT(content.text.find("ignored") == std::string::npos, "script should be skipped");
+    ASSERT(normalize_space(content.text).find("x < y z") != std::string::npos, "Entities should be decoded");
+
+    ASSERT(extractor.extract("plain text").text == "plain text", "State should reset between pages");
+    ASSERT(extractor.extract("").links.empty(), "Links should reset between pages");
+    std::cout << "test_html_extractor_links_and_headings passed" << std::endl;
+}
+
 // --- Test: decompress_gzip ---
 // Helper to compress a string with gzip
 std::string compress_gzip(const std::string& data) {
@@ -133,17 +317,89 @@ void test_decompress_gzip_empty() {
     std::cout << "test_decompress_gzip_empty passed" << std::endl;
 }
 
+void test_gzip_decompressor_reuse() {
+    indexer::GzipDecompressor decompressor;
+    std::string small = "short record";
+    std::string large(500000, 'x');  // Forces the pooled buffer to grow
+    ASSERT(decompressor.decompress(compress_gzip(small)) == small, "First record should decompress");
+    ASSERT(decompressor.decompress(compress_gzip(large)) == large, "Buffer should grow for a larger record");
+    ASSERT(decompressor.decompress(compress_gzip(small)) == small, "Decompressor should reset between records");
+    std::cout << "test_gzip_decompressor_reuse passed" << std::endl;
+}
+
+void test_gzip_decompressor_members() {
+    // A .warc.gz is a series of gzip members, one per record
+    std::string first = compress_gzip("first member");
+    std::string file = first + compress_gzip("second member");
+    indexer::GzipDecompressor decompressor;
+
+    std::string_view view(file);
+    ASSERT(decompressor.decompress(view) == "first member", "Should stop at the end of the first member");
+    ASSERT(decompressor.consumed() == first.size(), "consumed() should be the member's length");
+    view.remove_prefix(decompressor.consumed());
+    ASSERT(decompressor.decompress(view) == "second member", "Should decompress the next member");
+    std::cout << "test_gzip_decompressor_members passed" << std::endl;
+}
+
+void test_gzip_decompressor_streaming() {
+    std::string original;
+    for (int i = 0; i < 50000; ++i) original += "word" + std::to_string(i) + " ";
+    indexer::GzipDecompressor decompressor;
+
+    std::string streamed;
+    size_t chunks = 0;
+    decompressor.decompress(compress_gzip(original), [&](std::string_view chunk) {
+        streamed.append(chunk);
+        ++chunks;
+    });
+    ASSERT(streamed == original, "Streamed chunks should reassemble the record");
+    ASSERT(chunks > 1, "A large record should arrive in several chunks");
+    std::cout << "test_gzip_decompressor_streaming passed" << std::endl;
+}
+
+void test_gzip_decompressor_errors() {
+    indexer::GzipDecompressor decompressor;
+    std::string compressed = compress_gzip("a record that will be cut short");
+
+    bool threw = false;
+    try {
+        decompressor.decompress(std::string_view(compressed).substr(0, compressed.size() / 2));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Truncated input should throw");
+
+    threw = false;
+    std::string bomb = compress_gzip(std::string(indexer::MAX_DECOMPRESSED_SIZE + 1, '\0'));
+    try {
+        decompressor.decompress(bomb, [](std::string_view) {});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Records over the size limit should throw");
+
+    ASSERT(decompressor.decompress(compress_gzip("still usable")) == "still usable", "Errors should not poison the decompressor");
+    std::cout << "test_gzip_decompressor_errors passed" << std::endl;
+}
+
 int main() {
     try {
         test_tokenize_basic();
         test_tokenize_min_length();
         test_tokenize_special_chars();
+        test_tokenizer_matches_reference();
         test_clean_text_simple();
         test_clean_text_ignores_script();
         test_clean_text_ignores_style();
         test_extract_title();
+        test_html_extractor_matches_gumbo();
+        test_html_extractor_links_and_headings();
         test_decompress_gzip_basic();
         test_decompress_gzip_empty();
+        test_gzip_decompressor_reuse();
+        test_gzip_decompressor_members();
+        test_gzip_decompressor_streaming();
+        test_gzip_decompressor_errors();
         std::cout << "All tests passed!" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Test failed with exception: " << e.what() << std::endl;
@@ -0,0 +1,125 @@
+#include "../src/warc_reader.hpp"
+#include "../src/utils.hpp"
+#include "../../crawler/src/warc_writer.hpp"
+#include <iostream>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+// Simple assertion macro that throws instead of exiting
+#define ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            throw std::runtime_error(std::string("Assertion failed: ") + (message) + \
+                                     "\nFile: " + __FILE__ + ", Line: " + std::to_string(__LINE__)); \
+        } \
+    } while (false)
+
+// RAII Guard for file cleanup
+class FileCleaner {
+public:
+    explicit FileCleaner(std::string filename) : filename_(std::move(filename)) {
+        std::filesystem::remove(filename_);
+    }
+    ~FileCleaner() { std::filesystem::remove(filename_); }
+
+    FileCleaner(const FileCleaner&) = delete;
+    FileCleaner& operator=(const FileCleaner&) = delete;
+
+private:
+    std::string filename_;
+};
+
+void test_reads_records_by_span() {
+    std::string filename = "test_warc_reader_spans.warc.gz";
+    FileCleaner cleaner(filename);
+
+    std::vector<crawler::WarcRecordInfo> records;
+    {
+        crawler::WarcWriter writer(filename);
+        for (int i = 0; i < 5; ++i) {
+            records.push_back(writer.write_record("http://example.com/" + std::to_string(i),
+                                                  "<html><body>Page " + std::to_string(i) + "</body></html>"));
+        }
+    }
+
+    indexer::WarcReader reader;
+    // Read out of order, as the indexer does
+    for (int i : {3, 0, 4, 1, 2}) {
+        indexer::WarcSpan span = reader.read(filename, records[i].offset, records[i].length);
+        ASSERT(span.data.size() == static_cast<size_t>(records[i].length), "Span should cover the whole record");
+        std::string record = indexer::decompress_gzip(span.data);
+        ASSERT(record.find("Page " + std::to_string(i)) != std::string::npos, "Span should decompress to its own record");
+    }
+    ASSERT(reader.open_files() == 1, "Repeated reads should share one mapping");
+
+    bool threw = false;
+    try {
+        reader.read(filename, records[4].offset, records[4].length + 1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "A span past the end of the file should be reported");
+
+    std::cout << "test_reads_records_by_span passed" << std::endl;
+}
+
+void test_remaps_grown_file() {
+    std::string filename = "test_warc_reader_grow.warc.gz";
+    FileCleaner cleaner(filename);
+
+    indexer::WarcReader reader;
+    crawler::WarcRecordInfo first, second;
+    {
+        crawler::WarcWriter writer(filename);
+        first = writer.write_record("http://example.com/a", "<html><body>First</body></html>");
+    }
+    indexer::WarcSpan old_span = reader.read(filename, first.offset, first.length);
+
+    {
+        // The crawler appends while the indexer already holds a mapping
+        crawler::WarcWriter writer(filename);
+        second = writer.write_record("http://example.com/b", "<html><body>Second</body></html>");
+    }
+    indexer::WarcSpan new_span = reader.read(filename, second.offset, second.length);
+    ASSERT(indexer::decompress_gzip(new_span.data).find("Second") != std::string::npos, "Grown file should be remapped");
+    ASSERT(indexer::decompress_gzip(old_span.data).find("First") != std::string::npos, "Old spans should stay valid");
+    std::cout << "test_remaps_grown_file passed" << std::endl;
+}
+
+void test_lru_eviction_keeps_spans_alive() {
+    std::vector<std::string> filenames = {"test_warc_reader_0.warc.gz", "test_warc_reader_1.warc.gz",
+                                          "test_warc_reader_2.warc.gz"};
+    std::vector<std::unique_ptr<FileCleaner>> cleaners;
+    std::vector<crawler::WarcRecordInfo> records;
+    for (const auto& filename : filenames) {
+        cleaners.push_back(std::make_unique<FileCleaner>(filename));
+        crawler::WarcWriter writer(filename);
+        records.push_back(writer.write_record("http://example.com/" + filename, "<html><body>" + filename + "</body></html>"));
+    }
+
+    indexer::WarcReader reader(2);
+    indexer::WarcSpan first = reader.read(filenames[0], records[0].offset, records[0].length);
+    reader.read(filenames[1], records[1].offset, records[1].length);
+    reader.read(filenames[2], records[2].offset, records[2].length);
+    ASSERT(reader.open_files() == 2, "Reader should keep at most max_open_files mappings");
+
+    // The first file was evicted, but the span still owns its mapping
+    ASSERT(indexer::decompress_gzip(first.data).find(filenames[0]) != std::string::npos, "Evicted span should stay readable");
+    std::cout << "test_lru_eviction_keeps_spans_alive passed" << std::endl;
+}
+
+int main() {
+    try {
+        test_reads_records_by_span();
+        test_remaps_grown_file();
+        test_lru_eviction_keeps_spans_alive();
+        std::cout << "All tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -18,6 +18,13 @@ def health():
     status = "healthy" if ranker else "degraded"
     return jsonify({"status": status, "service": "ranker"})
 
+@app.route('/metrics')
+def metrics():
+    stats = ranker.index_stats() if ranker else None
+    if stats is None:
+        return jsonify({"index": None, "error": "No live index open"}), 503
+    return jsonify({"index": stats})
+
 @app.route('/search')
 def search():
     global ranker
@@ -6,7 +6,7 @@ from collections import defaultdict
 
 # Try to import our custom C++ extension
 try:
-    from rocksdb_client import RocksDBReader
+    from rocksdb_client import RocksDBReader, SegmentIndexReader
     ROCKSDB_AVAILABLE = True
 except ImportError:
     ROCKSDB_AVAILABLE = False
@@ -35,29 +35,65 @@ class Ranker:
             print(f"Failed to connect to Postgres: {e}")
             self.db_conn = None
         
-        # 2. Open RocksDB (Inverted Index) - Read Only
+        # 2. Open the Inverted Index - Read Only
+        # The indexer writes immutable segments under INDEX_PATH; a RocksDB index at ROCKSDB_PATH
+        # is only read until it has been rebuilt into segments (indexer --bulk). Without either,
+        # INDEX_PATH is opened empty and followed until the indexer publishes its first segment.
+        index_path = os.environ.get("INDEX_PATH", "/shared_data/search_index")
         rocksdb_path = os.environ.get("ROCKSDB_PATH", "/shared_data/search_index.db")
         self.index_db = None
         
         if ROCKSDB_AVAILABLE:
             try:
-                # We only need read access
-                self.index_db = RocksDBReader(rocksdb_path)
-                print(f"Opened RocksDB at {rocksdb_path}")
+                has_segments = os.path.exists(os.path.join(index_path, "segments"))
+                if has_segments or not os.path.exists(rocksdb_path):
+                    # New generations are picked up in the background; searches in flight keep theirs
+                    refresh_interval_ms = int(os.environ.get("INDEX_REFRESH_INTERVAL_MS", "1000"))
+                    self.index_db = SegmentIndexReader(index_path, refresh_interval_ms)
+                    print(f"Opened index at {index_path} ({self.index_db.segment_count()} segments)")
+                else:
+                    # We only need read access
+                    self.index_db = RocksDBReader(rocksdb_path)
+                    print(f"Opened RocksDB at {rocksdb_path}")
             except Exception as e:
-                print(f"Failed to open RocksDB: {e}")
+                print(f"Failed to open index: {e}")
         
         # Mock Index for fallback
         self.mock_index = {
-            "computer": "1,2",
-            "cats": "3,4"
+            "computer": [(1, 1), (2, 3)],
+            "cats": [(3, 2), (4, 1)]
         }
         
         # 3. Load Global Stats (avgdl, total_docs)
-        self.avgdl = self._calculate_avgdl()
-        self.total_docs = self._get_total_docs()
+        # A segmented index keeps them in its doc length table, which the indexer updates, so each
+        # search reads them from the view it scores; the legacy RocksDB and mock indexes take them
+        # from Postgres once
+        self.stats_from_index = ROCKSDB_AVAILABLE and isinstance(self.index_db, SegmentIndexReader)
+        if self.stats_from_index:
+            self.avgdl, self.total_docs = self._index_stats()
+        else:
+            self.avgdl = self._calculate_avgdl()
+            self.total_docs = self._get_total_docs()
         print(f"Ranker initialized. AvgDL: {self.avgdl}, Total Docs: {self.total_docs}")
 
+    def _index_stats(self):
+        """
+        Returns (avgdl, total_docs) from the index's doc length table. No SQL involved.
+        """
+        total_docs, total_length = self.index_db.collection_stats()
+        avgdl = total_length / total_docs if total_docs else 100.0 #Default to 100 to avoid dividing by 0
+        return avgdl, total_docs
+
+    def index_stats(self):
+        """
+        Refresh latency and index lag of a segmented index as a dict, or None for other indexes.
+        lag_docs counts documents the indexer has published that searches do not see yet;
+        lag_seconds is how long ago the newest unseen generation was published.
+        """
+        if not self.stats_from_index or not self.index_db:
+            return None
+        return self.index_db.refresh_stats()
+
     def _calculate_avgdl(self):
         if not self.db_conn:
             return 100.0 # Default if DB not connected
@@ -82,51 +118,11 @@ class Ranker:
             print(f"Error fetching total docs: {e}")
             return 1000
 
-    def _get_doc_lengths(self, doc_ids):
-        """
-        Fetches document lengths for a list of doc_ids.
-        Returns a dictionary: {doc_id: length}
-        """
-        if not self.db_conn or not doc_ids:
-            return {}
-        
-        lengths = {}
-        try:
-            with self.db_conn.cursor() as cur:
-                # Use tuple(doc_ids) for SQL IN clause
-                # Handle single item tuple correctly
-                if len(doc_ids) == 1:
-                    query = "SELECT id, doc_length FROM documents WHERE id = %s"
-                    params = (doc_ids[0],)
-                else:
-                    query = "SELECT id, doc_length FROM documents WHERE id IN %s"
-                    params = (tuple(doc_ids),)
-                
-                cur.execute(query, params)
-                rows = cur.fetchall()
-                for r in rows:
-                    lengths[r[0]] = r[1]
-        except Exception as e:
-            print(f"Error fetching doc lengths: {e}")
-        return lengths
-
-    def search(self, query, k=10):
+    def _score_python(self, tokens, k):
         """
-        Performs BM25 search for the given query.
-        Returns top k results: [{'url': ..., 'title': ..., 'score': ...}]
+        Reference BM25 scorer over the mock index.
+        Returns [(doc_id, score)] for the top k documents, best first.
         """
-        # Preprocessing to match Indexer:
-        # 1. Lowercase
-        # 2. Remove non-alphanumeric (keep spaces)
-        # 3. Split by whitespace
-        # 4. Filter length >= 3
-        
-        query_clean = re.sub(r'[^a-z0-9\s]', '', query.lower())
-        tokens = [t for t in query_clean.split() if len(t) >= 3]
-        
-        if not tokens:
-            return []
-
         # BM25 Constants
         k1 = 1.5
         b = 0.75
@@ -135,46 +131,25 @@ class Ranker:
         scores = defaultdict(float)
         
         # 1. Retrieve all posting lists and candidate docs
-        token_postings = {} # token -> [doc_ids]
+        token_postings = {} # token -> [(doc_id, tf)]
         candidate_doc_ids = set()
 
         for token in tokens:
-            # A. Get Posting List from RocksDB or Mock
-            postings_str = None
-            
-            if self.index_db:
-                try:
-                    val = self.index_db.get(token.encode('utf-8'))
-                    if val:
-                        postings_str = val.decode('utf-8')
-                except Exception as e:
-                    print(f"Error fetching token {token}: {e}")
-            else:
-                # Fallback to mock
-                postings_str = self.mock_index.get(token)
-
-            if not postings_str:
+            postings = self.mock_index.get(token)
+            if not postings:
                 continue
-                
-            # Format: "doc_id1,doc_id2,..." (Simplified for now, ideally should have TF)
-            # For this phase, we assume TF=1 for all occurrences in the simplified index
-            if isinstance(postings_str, bytes):
-                postings_str = postings_str.decode('utf-8')
-            
-            doc_ids = [int(d) for d in postings_str.split(',')]
-            token_postings[token] = doc_ids
-            candidate_doc_ids.update(doc_ids)
+
+            token_postings[token] = postings
+            candidate_doc_ids.update(doc_id for doc_id, _ in postings)
 
         if not candidate_doc_ids:
             return []
 
-        # 2. Batch fetch document lengths
-        doc_lengths = self._get_doc_lengths(list(candidate_doc_ids))
-
-        # 3. Calculate BM25 Scores
+        # 2. Calculate BM25 Scores
+        # The mock index has no document lengths, so every document counts as average length
         for token in tokens:
-            doc_ids = token_postings.get(token, [])
-            if not doc_ids:
+            postings = token_postings.get(token, [])
+            if not postings:
                 continue
 
             # Calculate IDF
@@ -182,27 +157,51 @@ class Ranker:
             N = self.total_docs
             if N == 0: N = 1 # Avoid division by zero issues if DB is empty
             
-            n_qi = len(doc_ids)
+            n_qi = len(postings)
             idf = np.log((N - n_qi + 0.5) / (n_qi + 0.5) + 1)
             
-            for doc_id in doc_ids:
-                # TODO: Fetch real TF from index. Currently index only stores doc_ids.
-                # We assume TF=1 for now.
-                tf = 1 
-                
-                # Get doc_len, fallback to avgdl if missing (e.g. sync issue)
-                doc_len = doc_lengths.get(doc_id, self.avgdl)
-                if doc_len is None or doc_len == 0:
-                    doc_len = self.avgdl # Safety fallback
-                
+            for doc_id, tf in postings:
+                doc_len = self.avgdl
+
                 # BM25 Score for this term
                 numerator = idf * tf * (k1 + 1)
                 denominator = tf + k1 * (1 - b + b * (doc_len / self.avgdl))
                 scores[doc_id] += numerator / denominator
 
         # Sort by score
-        sorted_docs = sorted(scores.items(), key=lambda item: item[1], reverse=True)[:k]
+        return sorted(scores.items(), key=lambda item: item[1], reverse=True)[:k]
+
+    def search(self, query, k=10):
+        """
+        Performs BM25 search for the given query.
+        Returns top k results: [{'url': ..., 'title': ..., 'score': ...}]
+        """
+        # Preprocessing to match Indexer:
+        # 1. Lowercase
+        # 2. Remove non-alphanumeric (keep spaces)
+        # 3. Split by whitespace
+        # 4. Filter length >= 3
+        
+        query_clean = re.sub(r'[^a-z0-9\s]', '', query.lower())
+        tokens = [t for t in query_clean.split() if len(t) >= 3]
         
+        if not tokens:
+            return []
+
+        # Score candidates natively when the index is open (top-k heap, no GIL);
+        # the pure-Python scorer only serves the mock index.
+        if self.index_db:
+            try:
+                if self.stats_from_index:
+                    sorted_docs = self.index_db.search(tokens, k)
+                else:
+                    sorted_docs = self.index_db.search(tokens, k, self.total_docs, self.avgdl)
+            except Exception as e:
+                print(f"Error searching index: {e}")
+                sorted_docs = []
+        else:
+            sorted_docs = self._score_python(tokens, k)
+
         # Fetch Metadata for top results
         results = []
         if self.db_conn and sorted_docs:
@@ -253,9 +252,9 @@ class Ranker:
         if self.index_db:
             try:
                 self.index_db.close()
-                print("Closed RocksDB connection")
+                print("Closed index")
             except Exception as e:
-                print(f"Error closing RocksDB connection: {e}")
+                print(f"Error closing index: {e}")
             finally:
                 self.index_db = None
 
@@ -1,18 +1,53 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <rocksdb/db.h>
+#include <chrono>
 #include <string>
 #include <stdexcept>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+#include "doc_length_table.hpp"
+#include "live_index.hpp"
+#include "postings.hpp"
+#include "query_engine.hpp"
+#include "segment.hpp"
 
 namespace py = pybind11;
 
+using SearchResults = std::vector<std::pair<uint32_t, double>>;
+
+// Block-Max WAND: same top k as exhaustive scoring, but skips blocks that cannot compete
+SearchResults search_cursors(std::vector<indexer::PostingCursor>& cursors, const indexer::DocLengthLookup& doc_length,
+                             size_t k, uint64_t total_docs, double avgdl) {
+    SearchResults results;
+    for (const auto& doc : indexer::bm25_search_block_max_wand(cursors, doc_length, {total_docs, avgdl}, k)) {
+        results.emplace_back(doc.doc_id, doc.score);
+    }
+    return results;
+}
+
+py::object decoded_postings(std::string_view value) {
+    std::vector<std::pair<uint32_t, uint32_t>> postings;
+    for (const auto& posting : indexer::decode_postings(value)) {
+        postings.emplace_back(posting.doc_id, posting.tf);
+    }
+    return py::cast(postings);
+}
+
+// Legacy index: postings merged into one RocksDB key per term, as written before segments.
 class RocksDBReader {
     rocksdb::DB* db;
     bool is_open;
+    std::shared_mutex db_mutex;  // close() must not free the DB under a GIL-free search()
 public:
     RocksDBReader(const std::string& path) : db(nullptr), is_open(false) {
         rocksdb::Options options;
         // Use default comparator (Bytewise)
+        // Must match the indexer's operator to resolve keys that still hold merge operands
+        options.merge_operator = std::make_shared<indexer::PostingListMergeOperator>();
         rocksdb::Status status = rocksdb::DB::OpenForReadOnly(options, path, &db);
         if (!status.ok()) {
             throw std::runtime_error("Failed to open RocksDB: " + status.ToString());
@@ -25,12 +60,16 @@ public:
     }
 
     py::object get(const py::bytes& key) {
-        if (!is_open) return py::none();
-        
         std::string key_str = key;
         std::string value;
-        rocksdb::Status status = db->Get(rocksdb::ReadOptions(), key_str, &value);
-        
+        rocksdb::Status status;
+        {
+            py::gil_scoped_release release;
+            std::shared_lock<std::shared_mutex> lock(db_mutex);
+            if (!is_open) status = rocksdb::Status::NotFound();
+            else status = db->Get(rocksdb::ReadOptions(), key_str, &value);
+        }
+
         if (status.IsNotFound()) {
             return py::none();
         }
@@ -39,8 +78,62 @@ public:
         }
         return py::bytes(value);
     }
+
+    // Decoded posting list for a term as [(doc_id, tf), ...], or None if the term is unknown.
+    py::object get_postings(const std::string& term) {
+        std::string value;
+        rocksdb::Status status;
+        {
+            py::gil_scoped_release release;
+            std::shared_lock<std::shared_mutex> lock(db_mutex);
+            if (!is_open) status = rocksdb::Status::NotFound();
+            else status = db->Get(rocksdb::ReadOptions(), term, &value);
+        }
+        if (status.IsNotFound()) {
+            return py::none();
+        }
+        if (!status.ok()) {
+            throw std::runtime_error("Error reading postings: " + status.ToString());
+        }
+
+        return decoded_postings(value);
+    }
     
+    /**
+     * BM25 top-k search (Block-Max WAND) over the given (already normalized) query tokens.
+     * Returns [(doc_id, score), ...] best first. Runs without the GIL.
+     */
+    SearchResults search(const std::vector<std::string>& tokens, size_t k, uint64_t total_docs, double avgdl) {
+        SearchResults results;
+        py::gil_scoped_release release;
+        std::shared_lock<std::shared_mutex> lock(db_mutex);
+        if (!is_open) return results;
+
+        // Cursors view these buffers, so they must stay put until scoring is done
+        std::vector<std::string> values(tokens.size());
+        std::vector<indexer::PostingCursor> cursors;
+        cursors.reserve(tokens.size());
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            rocksdb::Status status = db->Get(rocksdb::ReadOptions(), tokens[i], &values[i]);
+            if (status.IsNotFound()) continue;
+            if (!status.ok()) {
+                throw std::runtime_error("Error reading postings: " + status.ToString());
+            }
+            cursors.emplace_back(values[i]);
+        }
+
+        auto doc_length = [this](uint32_t doc_id) -> uint32_t {
+            std::string length_value;
+            rocksdb::Status status = db->Get(rocksdb::ReadOptions(), indexer::doc_length_key(doc_id), &length_value);
+            return status.ok() ? indexer::decode_doc_length(length_value) : 0;
+        };
+
+        return search_cursors(cursors, doc_length, k, total_docs, avgdl);
+    }
+
     void close() {
+        py::gil_scoped_release release;
+        std::unique_lock<std::shared_mutex> lock(db_mutex);
         if (is_open && db) {
             delete db;
             db = nullptr;
@@ -49,9 +142,164 @@ public:
     }
 };
 
+// Zero-copy buffer over a mapped doc length table, indexed by doc ID (np.frombuffer(view, np.uint32)).
+// Holds the mapping itself, so it stays valid after the reader closes.
+struct DocLengthsView {
+    std::shared_ptr<const indexer::DocLengthTable> table;
+};
+
+// The segmented index the indexer writes (see segment.hpp), following its manifest. Each call
+// reads one view of the index, so a search scores against a single generation even while a
+// refresh swaps in the next one.
+class SegmentIndexReader {
+    indexer::LiveIndex live;
+
+public:
+    // refresh_interval_ms: how often a background thread picks up new generations; 0 for only on refresh().
+    SegmentIndexReader(const std::string& path, int64_t refresh_interval_ms)
+        : live(path, std::chrono::milliseconds(refresh_interval_ms)) {}
+
+    ~SegmentIndexReader() {
+        close();
+    }
+
+    // Decoded posting list for a term across all segments, or None if the term is unknown.
+    py::object get_postings(const std::string& term) {
+        auto view = live.acquire();
+        if (!view) return py::none();
+        std::string scratch;
+        std::string_view value = view->snapshot.postings(term, scratch);
+        if (value.empty()) return py::none();
+        return decoded_postings(value);
+    }
+
+    // Same contract as RocksDBReader.search(). With total_docs 0, N and avgdl come from the same
+    // generation as the postings and doc lengths it scores (see IndexView::with_doc_lengths()).
+    SearchResults search(const std::vector<std::string>& tokens, size_t k, uint64_t total_docs, double avgdl) {
+        py::gil_scoped_release release;
+        auto view = live.acquire();  // Keeps this generation's segments mapped until scoring is done
+        if (!view) return {};
+
+        return view->with_doc_lengths([&](const indexer::DocLengthLookup& doc_length, uint64_t docs,
+                                          uint64_t total_length) {
+            uint64_t n = total_docs;
+            double average = avgdl;
+            if (n == 0) {
+                n = docs;
+                average = docs ? static_cast<double>(total_length) / docs : 100.0;
+            }
+            // Cursors view these buffers (or the mapped segments), which must stay put until scoring is done
+            std::vector<std::string> buffers(tokens.size());
+            std::vector<indexer::PostingCursor> cursors;
+            cursors.reserve(tokens.size());
+            for (size_t i = 0; i < tokens.size(); ++i) {
+                std::string_view value = view->snapshot.postings(tokens[i], buffers[i]);
+                if (!value.empty()) cursors.emplace_back(value);
+            }
+            return search_cursors(cursors, doc_length, k, n, average);
+        });
+    }
+
+    // Number of documents containing term, from the term dictionaries alone (no postings read).
+    uint64_t doc_freq(const std::string& term) {
+        auto view = live.acquire();
+        return view ? view->snapshot.doc_freq(term) : 0;
+    }
+
+    // Up to limit (term, doc_freq) pairs for the terms starting with prefix, in term order.
+    std::vector<std::pair<std::string, uint64_t>> terms(const std::string& prefix, size_t limit) {
+        py::gil_scoped_release release;
+        auto view = live.acquire();
+        if (!view) return {};
+        return view->snapshot.terms_with_prefix(prefix, limit);
+    }
+
+    // (N, total doc length) for BM25 in the current view's generation: from the doc length table
+    // while it holds that generation, summed from the view's segments otherwise.
+    std::pair<uint64_t, uint64_t> collection_stats() {
+        auto view = live.acquire();
+        return view ? view->collection_stats() : std::pair<uint64_t, uint64_t>{0, 0};
+    }
+
+    // The doc length table as a uint32 buffer indexed by doc ID, or None without one. The buffer is
+    // live: the indexer updates it in place, so it may already hold a newer generation's lengths.
+    py::object doc_length_view() {
+        auto view = live.acquire();
+        if (!view || !view->doc_lengths) return py::none();
+        return py::cast(DocLengthsView{view->doc_lengths});
+    }
+
+    size_t segment_count() {
+        auto view = live.acquire();
+        return view ? view->snapshot.segments().size() : 0;
+    }
+
+    uint64_t generation() {
+        auto view = live.acquire();
+        return view ? view->snapshot.generation() : 0;
+    }
+
+    // Swaps in the newest published generation now; True if there was one.
+    bool refresh() {
+        py::gil_scoped_release release;
+        return live.refresh();
+    }
+
+    // Refresh latency and how far the served view lags the indexer, as a dict.
+    py::dict refresh_stats() {
+        indexer::RefreshStats stats;
+        {
+            py::gil_scoped_release release;
+            stats = live.stats();
+        }
+        py::dict result;
+        result["generation"] = stats.generation;
+        result["published_generation"] = stats.published_generation;
+        result["lag_docs"] = stats.lag_docs;
+        result["lag_seconds"] = stats.lag_seconds;
+        result["refreshes"] = stats.refreshes;
+        result["refresh_failures"] = stats.refresh_failures;
+        result["last_refresh_seconds"] = stats.last_refresh_seconds;
+        result["max_refresh_seconds"] = stats.max_refresh_seconds;
+        return result;
+    }
+
+    // Searches already running finish against the view they hold.
+    void close() {
+        py::gil_scoped_release release;
+        live.close();
+    }
+};
+
 PYBIND11_MODULE(rocksdb_client, m) {
     py::class_<RocksDBReader>(m, "RocksDBReader")
         .def(py::init<const std::string&>())
         .def("get", &RocksDBReader::get)
+        .def("get_postings", &RocksDBReader::get_postings)
+        .def("search", &RocksDBReader::search,
+             py::arg("tokens"), py::arg("k"), py::arg("total_docs"), py::arg("avgdl"))
         .def("close", &RocksDBReader::close);
+
+    py::class_<DocLengthsView>(m, "DocLengthsView", py::buffer_protocol())
+        .def_buffer([](DocLengthsView& view) {
+            return py::buffer_info(const_cast<uint32_t*>(view.table->lengths()), sizeof(uint32_t),
+                                   py::format_descriptor<uint32_t>::format(), 1,
+                                   {static_cast<py::ssize_t>(view.table->capacity())}, {sizeof(uint32_t)},
+                                   /*readonly=*/true);
+        });
+
+    py::class_<SegmentIndexReader>(m, "SegmentIndexReader")
+        .def(py::init<const std::string&, int64_t>(), py::arg("path"), py::arg("refresh_interval_ms") = 0)
+        .def("get_postings", &SegmentIndexReader::get_postings)
+        .def("search", &SegmentIndexReader::search,
+             py::arg("tokens"), py::arg("k"), py::arg("total_docs") = 0, py::arg("avgdl") = 0.0)
+        .def("doc_freq", &SegmentIndexReader::doc_freq)
+        .def("terms", &SegmentIndexReader::terms, py::arg("prefix"), py::arg("limit") = 10)
+        .def("collection_stats", &SegmentIndexReader::collection_stats)
+        .def("doc_length_view", &SegmentIndexReader::doc_length_view)
+        .def("segment_count", &SegmentIndexReader::segment_count)
+        .def("generation", &SegmentIndexReader::generation)
+        .def("refresh", &SegmentIndexReader::refresh)
+        .def("refresh_stats", &SegmentIndexReader::refresh_stats)
+        .def("close", &SegmentIndexReader::close);
 }
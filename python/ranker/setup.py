@@ -1,11 +1,15 @@
+import os
 from setuptools import setup, Extension
 import pybind11
 
+# Headers shared with the C++ indexer (posting list format, merge operator)
+INDEXER_SRC_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "cpp", "indexer", "src")
+
 ext_modules = [
     Extension(
         "rocksdb_client",
         ["rocksdb_client.cpp"],
-        include_dirs=[pybind11.get_include()],
+        include_dirs=[pybind11.get_include(), INDEXER_SRC_DIR],
         libraries=["rocksdb"],
         language="c++",
         extra_compile_args=["-std=c++17"],